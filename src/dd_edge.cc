@@ -26,14 +26,14 @@
 // #define DEBUG_ITER_BEGIN
 
 // Helper functions
-inline void linkNode(MEDDLY::forest* p, int node)
+inline void linkNode(MEDDLY::forest* p, MEDDLY::node_handle node)
 {
   MEDDLY_DCASSERT(p);
   MEDDLY_DCASSERT(smart_cast<MEDDLY::expert_forest*>(p));
   smart_cast<MEDDLY::expert_forest*>(p)->linkNode(node);
 }
 
-inline void unlinkNode(MEDDLY::forest* p, int node)
+inline void unlinkNode(MEDDLY::forest* p, MEDDLY::node_handle node)
 {
   if (p) {
     MEDDLY_DCASSERT(smart_cast<MEDDLY::expert_forest*>(p));
@@ -136,7 +136,7 @@ void MEDDLY::dd_edge::destroy()
 {
   if (index) {
     // still registered; unregister before discarding
-    int old = node;
+    node_handle old = node;
     node = 0;
     unlinkNode(parent, old);
     if (parent) parent->unregisterEdge(*this);
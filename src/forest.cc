@@ -37,6 +37,11 @@
 #include <sys/time.h>
 #endif
 
+#ifdef MEDDLY_THREADS
+#include <thread>
+#include <vector>
+#endif
+
 //#include <set>
 //#include <queue>
 //#include <vector>
@@ -83,6 +88,8 @@ MEDDLY::forest::policies::policies()
 {
   nodemm = 0;   // 
   nodestor = 0; // should cause an exception later
+  swap_threads = 1;
+  split_threads = 1;
 }
 
 MEDDLY::forest::policies::policies(bool rel) 
@@ -116,6 +123,8 @@ void MEDDLY::forest::policies::useDefaults(bool rel)
 
   reorder = reordering_type::SINK_DOWN;
   swap = variable_swap_type::VAR;
+  swap_threads = 1;
+  split_threads = 1;
 }
 
 // ******************************************************************
@@ -547,6 +556,11 @@ void MEDDLY::forest::registerEdge(dd_edge& e)
       unsigned new_sz = edge_sz * 2;
       edge_data* new_edge =
           (edge_data*) realloc(edge, new_sz * sizeof(edge_data));
+      if (0 == new_edge) {
+        // Reclaim what we can, and try again
+        memory_budget::recover();
+        new_edge = (edge_data*) realloc(edge, new_sz * sizeof(edge_data));
+      }
       if (0 == new_edge) throw error(error::INSUFFICIENT_MEMORY, __FILE__, __LINE__);
       edge = new_edge;
       for (unsigned i = edge_sz; i < new_sz; ++i)
@@ -739,7 +753,7 @@ MEDDLY::expert_forest::nodecounter::~nodecounter()
 
 void MEDDLY::expert_forest::nodecounter::visit(dd_edge &e)
 {
-  int n = e.getNode();
+  node_handle n = e.getNode();
   if (parent->isTerminalNode(n)) return;
   MEDDLY_DCASSERT(n>0);
   MEDDLY_DCASSERT(n<=parent->getLastNode());
@@ -785,6 +799,57 @@ void MEDDLY::expert_forest::nodemarker::visit(dd_edge &e)
   parent->markNode(e.getNode());
 }
 
+// ******************************************************************
+// *                                                                *
+// *                expert_forest::rootlister  class                *
+// *                                                                *
+// ******************************************************************
+
+class MEDDLY::expert_forest::rootlister: public edge_visitor {
+    expert_forest* parent;
+  public:
+    node_handle* roots;
+    int nroots;
+    int size;
+  public:
+    rootlister(expert_forest *p);
+    virtual ~rootlister();
+    virtual void visit(dd_edge &e);
+};
+
+
+// ******************************************************************
+// *               expert_forest::rootlister  methods               *
+// ******************************************************************
+
+MEDDLY::expert_forest::rootlister::rootlister(expert_forest *p)
+ : edge_visitor()
+{
+  parent = p;
+  roots = 0;
+  nroots = 0;
+  size = 0;
+}
+
+MEDDLY::expert_forest::rootlister::~rootlister()
+{
+  free(roots);
+}
+
+void MEDDLY::expert_forest::rootlister::visit(dd_edge &e)
+{
+  if (e.getForest() != parent) return;
+  if (parent->isTerminalNode(e.getNode())) return;
+  if (nroots >= size) {
+    size += 1024;
+    node_handle* new_roots = (node_handle*) 
+      realloc(roots, size*sizeof(node_handle));
+    if (0==new_roots) throw error(error::INSUFFICIENT_MEMORY, __FILE__, __LINE__);
+    roots = new_roots;
+  }
+  roots[nroots++] = e.getNode();
+}
+
 // ******************************************************************
 // *                                                                *
 // *                                                                *
@@ -837,6 +902,9 @@ MEDDLY::expert_forest::expert_forest(int ds, domain *d, bool rel, range_type t,
   in_validate = 0;
   in_val_size = 0;
   delete_depth = 0;
+  deleting_nodes = false;
+  removing_lo = 1;
+  removing_hi = 0;
 
   //
   // Initialize node characteristics to defaults
@@ -1497,7 +1565,7 @@ void MEDDLY::expert_forest
 
   // move a pointer to the end of the list, and
   // find the largest node index we're writing
-  int maxnode = 0;
+  node_handle maxnode = 0;
   int last;
   for (last = 0; output2index[last]; last++) { 
     maxnode = MAX(maxnode, output2index[last]);
@@ -1529,7 +1597,7 @@ void MEDDLY::expert_forest
 
   // build the inverse mapping
   node_handle* index2output = new node_handle[maxnode+1];
-  for (int i=0; i<maxnode; i++) index2output[i] = 0;
+  for (node_handle i=0; i<maxnode; i++) index2output[i] = 0;
   for (int i=0; output2index[i]; i++) {
     MEDDLY_CHECK_RANGE(1, output2index[i], maxnode+1);
     index2output[output2index[i]] = i+1;
@@ -1545,7 +1613,7 @@ void MEDDLY::expert_forest
   }
   printf("\n");
   printf("Got inverse list:\n");
-  for (int i=0; i<=maxnode; i++) {
+  for (node_handle i=0; i<=maxnode; i++) {
     if (i) printf(", ");
     printf("%ld", long(index2output[i]));
   }
@@ -1835,6 +1903,104 @@ void MEDDLY::expert_forest::compactMemory()
 
 */
 
+void MEDDLY::expert_forest::compactMemory()
+{
+  // Stale entries are the only thing keeping disconnected nodes
+  removeStaleComputeTableEntries();
+  nodeMan->collectGarbage(true);
+}
+
+bool MEDDLY::expert_forest::compactMemory(node_layout layout)
+{
+  const node_handle a_last = nodeHeaders.lastUsedHandle();
+
+  rootlister R(this);
+  visitRegisteredEdges(R);
+
+  bool* placed = new bool[a_last+1];
+  for (node_handle p=0; p<=a_last; p++) placed[p] = false;
+  node_handle* order = new node_handle[a_last+1];
+  long n = 0;
+
+  if (DEPTH_FIRST == layout) {
+    //
+    // Depth-first, children in index order, with an explicit stack.
+    // Nodes are marked when pushed, so each is pushed once.
+    //
+    unpacked_node *M = unpacked_node::useUnpackedNode();
+    node_handle* stack = new node_handle[a_last+1];
+    long top = 0;
+    for (int r=R.nroots-1; r>=0; r--) {
+      if (placed[R.roots[r]]) continue;
+      placed[R.roots[r]] = true;
+      stack[top++] = R.roots[r];
+    }
+    while (top) {
+      node_handle p = stack[--top];
+      if (0==getNodeAddress(p)) continue;
+      order[n++] = p;
+      M->initFromNode(this, p, false);
+      for (int z=M->getNNZs()-1; z>=0; z--) {
+        if (isTerminalNode(M->d(z))) continue;
+        if (placed[M->d(z)]) continue;
+        placed[M->d(z)] = true;
+        stack[top++] = M->d(z);
+      }
+    } // while
+    delete[] stack;
+    unpacked_node::recycle(M);
+  } else {
+    //
+    // Breadth-first, then a stable sort by level:
+    // k, -k, k-1, -(k-1), ..., 1, -1.
+    //
+    node_handle* list = R.nroots 
+      ? markNodesInSubgraph(R.roots, R.nroots, false) 
+      : 0;
+    const int nkeys = 2*getNumVariables()+2;
+    long* start = new long[nkeys+1];
+    for (int k=0; k<=nkeys; k++) start[k] = 0;
+    long nlist = 0;
+    for (; list && list[nlist]; nlist++) {
+      int k = getNodeLevel(list[nlist]);
+      start[ nkeys - 1 - (k>0 ? 2*k+1 : -2*k) ]++;
+    }
+    for (int k=1; k<=nkeys; k++) start[k] += start[k-1];
+    for (int k=nkeys; k>0; k--) start[k] = start[k-1];
+    start[0] = 0;
+    for (long i=0; i<nlist; i++) {
+      int k = getNodeLevel(list[i]);
+      order[ start[ nkeys - 1 - (k>0 ? 2*k+1 : -2*k) ]++ ] = list[i];
+      placed[list[i]] = true;
+    }
+    n = nlist;
+    delete[] start;
+    free(list);
+    // drop any nodes without storage
+    long m = 0;
+    for (long i=0; i<n; i++) {
+      if (getNodeAddress(order[i])) order[m++] = order[i];
+    }
+    n = m;
+  }
+
+  //
+  // Everything else, by handle
+  //
+  for (node_handle p=1; p<=a_last; p++) {
+    if (placed[p]) continue;
+    if (!isActiveNode(p)) continue;
+    if (0==getNodeAddress(p)) continue;
+    order[n++] = p;
+  }
+  delete[] placed;
+
+  bool ok = nodeMan->relocateNodes(order, n);
+  delete[] order;
+  if (ok) stats.num_compactions++;
+  return ok;
+}
+
 void MEDDLY::expert_forest::showInfo(output &s, int verb)
 {
   // Show forest with appropriate level of detail
@@ -1953,9 +2119,87 @@ void MEDDLY::expert_forest::readUnhashedHeader(input &s, unpacked_node &nb) cons
   throw error(error::TYPE_MISMATCH, __FILE__, __LINE__);
 }
 
+namespace MEDDLY {
+  // Cofactors of hnodes[from..to); see gatherSwapCofactors().
+  static void gatherSwapCofactorRange(const expert_forest* f, int level,
+    const node_handle* hnodes, int from, int to, int hsize, int lsize,
+    node_handle* down, long* ev)
+  {
+    for (int i = from; i < to; i++) {
+      for (int j = 0; j < hsize; j++) {
+        node_handle d;
+        long ev1 = 0;
+        if (ev) {
+          f->getDownPtr(hnodes[i], j, ev1, d);
+        } else {
+          d = f->getDownPtr(hnodes[i], j);
+        }
+
+        node_handle* dp = down + long(i) * lsize * hsize + j;
+        long* ep = ev ? ev + long(i) * lsize * hsize + j : 0;
+        if (isLevelAbove(level, f->getNodeLevel(d))) {
+          // Does not depend on the variable moved up
+          for (int k = 0; k < lsize; k++) {
+            dp[k * hsize] = d;
+            if (ep) ep[k * hsize] = ev1;
+          }
+          continue;
+        }
+        for (int k = 0; k < lsize; k++) {
+          if (ep) {
+            long ev2;
+            f->getDownPtr(d, k, ev2, dp[k * hsize]);
+            ep[k * hsize] = ev1 + ev2;
+          } else {
+            dp[k * hsize] = f->getDownPtr(d, k);
+          }
+        }
+      }
+    }
+  }
+};
+
+void MEDDLY::expert_forest::gatherSwapCofactors(int level,
+  const node_handle* hnodes, int n, int hsize, int lsize,
+  node_handle* down, long* ev) const
+{
+#ifdef MEDDLY_THREADS
+  int nt = MIN(int(deflt.swap_threads), n);
+  if (nt > 1) {
+    std::vector<std::thread> workers;
+    int per = (n + nt - 1) / nt;
+    for (int from = 0; from < n; from += per) {
+      workers.push_back(std::thread(gatherSwapCofactorRange, this, level,
+        hnodes, from, MIN(from + per, n), hsize, lsize, down, ev));
+    }
+    for (unsigned t = 0; t < workers.size(); t++) {
+      workers[t].join();
+    }
+    return;
+  }
+#endif
+  gatherSwapCofactorRange(this, level, hnodes, 0, n, hsize, lsize, down, ev);
+}
+
+void MEDDLY::expert_forest::removeComputeTableEntriesForLevels(int lo, int hi)
+{
+  if (lo > hi) return;
+  removing_lo = lo;
+  removing_hi = hi;
+  removeStaleComputeTableEntries();
+  removing_lo = 1;
+  removing_hi = 0;
+}
+
 void MEDDLY::expert_forest::reorderVariables(const int* level2var)
 {
-  removeAllComputeTableEntries();
+  // Only the levels between the lowest and highest
+  // that change variable are touched by the swaps
+  int lo = 1;
+  int hi = getNumVariables();
+  while (lo <= hi && getVarByLevel(lo) == level2var[lo]) lo++;
+  while (hi >= lo && getVarByLevel(hi) == level2var[hi]) hi--;
+  removeComputeTableEntriesForLevels(lo, hi);
 
   // Create a temporary variable order
   // Support in-place update and avoid interfering other forests
@@ -1976,7 +2220,28 @@ void MEDDLY::expert_forest::reorderVariables(const int* level2var)
 // ''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''
 
 
-void MEDDLY::expert_forest::deleteNode(node_handle p)
+void MEDDLY::expert_forest::deleteNode(node_handle p, bool recycle)
+{
+  if (deleting_nodes) {
+    // called from below, while unlinking children; finish that first
+    pending_deletions.push_back(recycle ? p : -p);
+    return;
+  }
+  deleting_nodes = true;
+  for (;;) {
+    deleteOneNode(p);
+    if (recycle) nodeHeaders.recycleNodeHandle(p);
+
+    if (pending_deletions.empty()) break;
+    p = pending_deletions.back();
+    pending_deletions.pop_back();
+    recycle = (p > 0);
+    if (p < 0) p = -p;
+  }
+  deleting_nodes = false;
+}
+
+void MEDDLY::expert_forest::deleteOneNode(node_handle p)
 {
 #ifdef TRACK_DELETIONS
   for (int i=0; i<delete_depth; i++) printf(" ");
@@ -2045,6 +2310,27 @@ void MEDDLY::expert_forest::deleteNode(node_handle p)
 
 
 
+MEDDLY::node_handle MEDDLY::expert_forest
+::makeNodeOrRecycle(unpacked_node &nb, node_address &addr)
+{
+  node_handle p = 0;
+  try {
+    p = nodeHeaders.getFreeNodeHandle();
+    nodeHeaders.setNodeLevel(p, nb.getLevel());
+    addr = nodeMan->makeNode(p, nb, getNodeStorage());
+    return p;
+  }
+  catch (error &e) {
+    // Out of memory; give the handle back, and drop nb
+    if (p) {
+      nodeHeaders.deactivate(p);
+      nodeHeaders.recycleNodeHandle(p);
+    }
+    dropUnusedNode(&nb);
+    throw e;
+  }
+}
+
 MEDDLY::node_handle MEDDLY::expert_forest
 ::createReducedHelper(int in, unpacked_node &nb)
 {
@@ -2161,9 +2447,10 @@ MEDDLY::node_handle MEDDLY::expert_forest
   // if (isTimeToGc()) garbageCollect();
 #endif
 
-  // Grab a new node
-  node_handle p = nodeHeaders.getFreeNodeHandle();
-  nodeHeaders.setNodeLevel(p, nb.getLevel());
+  // Grab a new node; all of the work is in nodeMan now :^)
+  node_address addr;
+  node_handle p = makeNodeOrRecycle(nb, addr);
+
   if (deflt.useReferenceCounts) {
     MEDDLY_DCASSERT(0 == nodeHeaders.getIncomingCount(p));
     MEDDLY_DCASSERT(0 == nodeHeaders.getNodeCacheCount(p));
@@ -2177,8 +2464,7 @@ MEDDLY::node_handle MEDDLY::expert_forest
     theLogger->addToActiveNodeCount(this, nb.getLevel(), 1);
   }
 
-  // All of the work is in nodeMan now :^)
-  nodeHeaders.setNodeAddress(p, nodeMan->makeNode(p, nb, getNodeStorage()));
+  nodeHeaders.setNodeAddress(p, addr);
   linkNode(p);
 
   // add to UT
@@ -2309,9 +2595,9 @@ MEDDLY::node_handle MEDDLY::expert_forest
     useExpertDomain()->enlargeVariableBound(nb.getLevel(), false, -(nb_ext_i+1));
   }
 
-  // Grab a new node
-  node_handle p = nodeHeaders.getFreeNodeHandle();
-  nodeHeaders.setNodeLevel(p, nb.getLevel());
+  // Grab a new node; all of the work is in nodeMan now :^)
+  node_address addr;
+  node_handle p = makeNodeOrRecycle(nb, addr);
   MEDDLY_DCASSERT(0 == nodeHeaders.getNodeCacheCount(p));
   MEDDLY_DCASSERT(0 == nodeHeaders.getIncomingCount(p));
 
@@ -2320,8 +2606,7 @@ MEDDLY::node_handle MEDDLY::expert_forest
     theLogger->addToActiveNodeCount(this, nb.getLevel(), 1);
   }
 
-  // All of the work is in nodeMan now :^)
-  nodeHeaders.setNodeAddress(p, nodeMan->makeNode(p, nb, getNodeStorage()));
+  nodeHeaders.setNodeAddress(p, addr);
   // TODO: need to link?
   linkNode(p);
 
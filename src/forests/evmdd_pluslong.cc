@@ -202,72 +202,39 @@ void MEDDLY::evmdd_pluslong::swapAdjacentVariables(int level)
   // Update the variable order
   std::const_pointer_cast<variable_order>(var_order)->exchange(hvar, lvar);
 
-  node_handle** children = new node_handle*[hsize];
-  long** sum_evs = new long*[hsize];
-  for (int i = 0; i < hsize; i++) {
-    children[i] = new node_handle[lsize];
-    sum_evs[i] = new long[lsize];
-  }
-
-  // Process the rest of nodes for the variable to be moved down
-  for (int i = 0; i < hnum; i++) {
-    unpacked_node* high_nr = unpacked_node::useUnpackedNode();
-    high_nr->initFromNode(this, hnodes[i], true);
-
-    unpacked_node* high_nb = unpacked_node::newFull(this, level + 1, lsize);
-    for (int j = 0; j < hsize; j++) {
-      long ev1 = high_nr->ei(j);
-      MEDDLY_DCASSERT(ev1 >= 0);
-
-      if (isLevelAbove(level, getNodeLevel(high_nr->d(j)))) {
-        for (int k = 0; k < lsize; k++) {
-          children[j][k] = high_nr->d(j);
-          sum_evs[j][k] = ev1;
+  // Process the rest of nodes for the variable to be moved down,
+  // a batch at a time: gather the cofactors, then build the nodes
+  const int batch = MIN(hnum, SWAP_BATCH);
+  node_handle* children = new node_handle[long(batch) * lsize * hsize];
+  long* sum_evs = new long[long(batch) * lsize * hsize];
+  for (int first = 0; first < hnum; first += batch) {
+    int n = MIN(batch, hnum - first);
+    gatherSwapCofactors(level, hnodes + first, n, hsize, lsize, children, sum_evs);
+
+    for (int i = 0; i < n; i++) {
+      unpacked_node* high_nb = unpacked_node::newFull(this, level + 1, lsize);
+      for (int j = 0; j < lsize; j++) {
+        long off = (long(i) * lsize + j) * hsize;
+        unpacked_node* low_nb = unpacked_node::newFull(this, level, hsize);
+        for (int k = 0; k < hsize; k++) {
+          MEDDLY_DCASSERT(sum_evs[off + k] >= 0);
+          low_nb->d_ref(k) = linkNode(children[off + k]);
+          low_nb->setEdge(k, sum_evs[off + k]);
         }
+        node_handle node = 0;
+        long ev = 0;
+        createReducedNode(-1, low_nb, ev, node);
+        high_nb->d_ref(j) = node;
+        high_nb->setEdge(j, ev);
       }
-      else {
-        unpacked_node* nr = unpacked_node::useUnpackedNode();
-        nr->initFromNode(this, high_nr->d(j), true);
-
-        MEDDLY_DCASSERT(nr->getSize() == lsize);
-        for (int k = 0; k < lsize; k++) {
-          children[j][k] = nr->d(k);
 
-          long ev2 = nr->ei(k);
-          MEDDLY_DCASSERT(ev2 >= 0);
-
-          sum_evs[j][k] = ev1 + ev2;
-        }
-        unpacked_node::recycle(nr);
-      }
-    }
-
-    for (int j = 0; j < lsize; j++) {
-      unpacked_node* low_nb = unpacked_node::newFull(this, level, hsize);
-      for (int k = 0; k < hsize; k++) {
-        low_nb->d_ref(k) = linkNode(children[k][j]);
-        low_nb->setEdge(k, sum_evs[k][j]);
-      }
-      node_handle node = 0;
-      long ev = 0;
-      createReducedNode(-1, low_nb, ev, node);
-      high_nb->d_ref(j) = node;
-      high_nb->setEdge(j, ev);
+      // The reduced node of high_nb must be at level+1
+      // Assume the reduced node is at level
+      // Then high_nodes[i] corresponds to a function that
+      // is independent of the variable to be moved up
+      // This is a contradiction
+      modifyReducedNodeInPlace(high_nb, hnodes[first + i]);
     }
-
-    unpacked_node::recycle(high_nr);
-
-    // The reduced node of high_nb must be at level+1
-    // Assume the reduced node is at level
-    // Then high_nodes[i] corresponds to a function that
-    // is independent of the variable to be moved up
-    // This is a contradiction
-    modifyReducedNodeInPlace(high_nb, hnodes[i]);
-  }
-
-  for (int i = 0; i < hsize; i++) {
-    delete[] children[i];
-    delete[] sum_evs[i];
   }
   delete[] children;
   delete[] sum_evs;
@@ -480,7 +447,7 @@ void MEDDLY::evmdd_index_set_long::getElement(const dd_edge &a, long index, int*
     e[0] = 0;
     return;
   }
-  int p = a.getNode();
+  node_handle p = a.getNode();
   unpacked_node* R = unpacked_node::useUnpackedNode();
   for (int k = getNumVariables(); k > 0; k--) {
 	int var = getVarByLevel(k);
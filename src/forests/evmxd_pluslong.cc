@@ -362,7 +362,7 @@ bool MEDDLY::evmxd_pluslong::evtrmxd_fixedrow_iter::first(int k, node_handle dow
   // Check that this "row" node has a non-zero pointer
   // for the fixed index.
   MEDDLY_DCASSERT(k>0);
-  int cdown;
+  node_handle cdown;
   if (isLevelAbove(k, F->getNodeLevel(down))) {
     // skipped unprimed level, must be "fully" reduced
     cdown = down;
@@ -496,7 +496,7 @@ bool MEDDLY::evmxd_pluslong::evtrmxd_fixedcol_iter::first(int k, node_handle dow
       return first(downLevel(k), down);
     }
     long ev;
-    int cdown;
+    node_handle cdown;
     F->getDownPtr(down, index[k], ev, cdown);
     if (0==cdown) return false;
     acc_evs[downLevel(k)] = acc_evs[k] + ev;
@@ -529,7 +529,7 @@ bool MEDDLY::evmxd_pluslong::evtrmxd_fixedcol_iter::first(int k, node_handle dow
     // next level is not skipped.
     // See if there is a valid path below.
     long ev;
-    int cdown;
+    node_handle cdown;
     F->getDownPtr(down, index[kpr], ev, cdown);
     if (0==cdown) return false;
     acc_evs[downLevel(kpr)] = acc_evs[kpr] * ev;
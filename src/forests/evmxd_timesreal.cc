@@ -352,7 +352,7 @@ bool MEDDLY::evmxd_timesreal::evtrmxd_fixedrow_iter::first(int k, node_handle do
   // Check that this "row" node has a non-zero pointer
   // for the fixed index.
   MEDDLY_DCASSERT(k>0);
-  int cdown;
+  node_handle cdown;
   if (isLevelAbove(k, F->getNodeLevel(down))) {
     // skipped unprimed level, must be "fully" reduced
     cdown = down;
@@ -486,7 +486,7 @@ bool MEDDLY::evmxd_timesreal::evtrmxd_fixedcol_iter::first(int k, node_handle do
       return first(downLevel(k), down);
     }
     float ev;
-    int cdown;
+    node_handle cdown;
     F->getDownPtr(down, index[k], ev, cdown);
     if (0==cdown) return false;
     acc_evs[downLevel(k)] = acc_evs[k] * ev;
@@ -519,7 +519,7 @@ bool MEDDLY::evmxd_timesreal::evtrmxd_fixedcol_iter::first(int k, node_handle do
     // next level is not skipped.
     // See if there is a valid path below.
     float ev;
-    int cdown;
+    node_handle cdown;
     F->getDownPtr(down, index[kpr], ev, cdown);
     if (0==cdown) return false;
     acc_evs[downLevel(kpr)] = acc_evs[kpr] * ev;
@@ -69,7 +69,7 @@ bool MEDDLY::mt_forest::isRedundant(const unpacked_node &nb) const
   } else {
     int rawsize = nb.isSparse() ? nb.getNNZs() : nb.getSize();
     if (rawsize < getLevelSize(nb.getLevel())) return false;
-    int common = nb.d(0);
+    node_handle common = nb.d(0);
     for (int i=1; i<rawsize; i++) 
       if (nb.d(i) != common) return false;
     return true;
@@ -87,57 +87,34 @@ void MEDDLY::mtmdd_forest::swapAdjacentVariables(int level)
   // Update the variable order
   std::const_pointer_cast<variable_order>(var_order)->exchange(hvar, lvar);
 
-  node_handle** children = new node_handle*[hsize];
-  for (int i = 0; i < hsize; i++) {
-    children[i] = new node_handle[lsize];
-  }
-
-  // Process the rest of nodes for the variable to be moved down
-  for (int i = 0; i < hnum; i++) {
-    MEDDLY_DCASSERT(isActiveNode(hnodes[i]));
-
-    unpacked_node* high_nr = unpacked_node::useUnpackedNode();
-    high_nr->initFromNode(this, hnodes[i], true);
-
-    unpacked_node* high_nb = unpacked_node::newFull(this, level + 1, lsize);
-    for (int j = 0; j < hsize; j++) {
-      if (isLevelAbove(level, getNodeLevel(high_nr->d(j)))) {
-        for (int k = 0; k < lsize; k++) {
-          children[j][k] = high_nr->d(j);
+  // Process the rest of nodes for the variable to be moved down,
+  // a batch at a time: gather the cofactors, then build the nodes
+  const int batch = MIN(hnum, SWAP_BATCH);
+  node_handle* children = new node_handle[long(batch) * lsize * hsize];
+  for (int first = 0; first < hnum; first += batch) {
+    int n = MIN(batch, hnum - first);
+    gatherSwapCofactors(level, hnodes + first, n, hsize, lsize, children, 0);
+
+    for (int i = 0; i < n; i++) {
+      MEDDLY_DCASSERT(isActiveNode(hnodes[first + i]));
+
+      unpacked_node* high_nb = unpacked_node::newFull(this, level + 1, lsize);
+      for (int j = 0; j < lsize; j++) {
+        const node_handle* column = children + (long(i) * lsize + j) * hsize;
+        unpacked_node* low_nb = unpacked_node::newFull(this, level, hsize);
+        for (int k = 0; k < hsize; k++) {
+          low_nb->d_ref(k) = linkNode(column[k]);
         }
+        high_nb->d_ref(j) = createReducedNode(-1, low_nb);
       }
-      else {
-        unpacked_node* nr = unpacked_node::useUnpackedNode();
-        nr->initFromNode(this, high_nr->d(j), true);
 
-        MEDDLY_DCASSERT(nr->getSize() == lsize);
-        for (int k = 0; k < lsize; k++) {
-          children[j][k] = nr->d(k);
-        }
-        unpacked_node::recycle(nr);
-      }
+      // The reduced node of high_nb must be at level+1
+      // Assume the reduced node is at level
+      // Then high_nodes[i] corresponds to a function that
+      // is independent of the variable to be moved up
+      // This is a contradiction
+      modifyReducedNodeInPlace(high_nb, hnodes[first + i]);
     }
-
-    for (int j = 0; j < lsize; j++) {
-      unpacked_node* low_nb = unpacked_node::newFull(this, level, hsize);
-      for (int k = 0; k < hsize; k++) {
-        low_nb->d_ref(k) = linkNode(children[k][j]);
-      }
-      high_nb->d_ref(j) = createReducedNode(-1, low_nb);
-    }
-
-    unpacked_node::recycle(high_nr);
-
-    // The reduced node of high_nb must be at level+1
-    // Assume the reduced node is at level
-    // Then high_nodes[i] corresponds to a function that
-    // is independent of the variable to be moved up
-    // This is a contradiction
-    modifyReducedNodeInPlace(high_nb, hnodes[i]);
-  }
-
-  for (int i = 0; i < hsize; i++) {
-    delete[] children[i];
   }
   delete[] children;
 
@@ -156,7 +133,7 @@ void MEDDLY::mtmdd_forest::moveDownVariable(int high, int low)
   MEDDLY_DCASSERT(low>=1);
   MEDDLY_DCASSERT(high<=getNumVariables());
 
-  removeAllComputeTableEntries();
+  removeComputeTableEntriesForLevels(low, high);
 
   for(int level=high-1; level>=low; level--) {
     swapAdjacentVariables(level);
@@ -169,7 +146,7 @@ void MEDDLY::mtmdd_forest::moveUpVariable(int low, int high)
   MEDDLY_DCASSERT(low>=1);
   MEDDLY_DCASSERT(high<=getNumVariables());
 
-  removeAllComputeTableEntries();
+  removeComputeTableEntriesForLevels(low, high);
 
   for(int level=low; level<high; level++) {
     swapAdjacentVariables(level);
@@ -182,7 +159,7 @@ void MEDDLY::mtmdd_forest::dynamicReorderVariables(int top, int bottom)
   MEDDLY_DCASSERT(top <= getNumVariables());
   MEDDLY_DCASSERT(bottom >= 1);
 
-  removeAllComputeTableEntries();
+  removeComputeTableEntriesForLevels(bottom, top);
 
   std::vector<int> vars;
   vars.reserve(top - bottom + 1);
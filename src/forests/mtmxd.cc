@@ -23,6 +23,10 @@
 #include "mtmxd.h"
 #include "../unique_table.h"
 
+#ifdef MEDDLY_THREADS
+#include <thread>
+#endif
+
 MEDDLY::mtmxd_forest
 ::mtmxd_forest(unsigned dsl, domain* d, range_type t, const policies &p, int* level_reduction_rule)
  : mt_forest(dsl, d, true, t, p, level_reduction_rule)
@@ -60,7 +64,8 @@ void MEDDLY::mtmxd_forest::swapAdjacentVariablesByVarSwap(int level)
   int hvar = getVarByLevel(level+1);
   int lvar = getVarByLevel(level);
   int hsize = getVariableSize(hvar);
-  // int lsize = getVariableSize(lvar);
+  int lsize = getVariableSize(lvar);
+  const long gsize = long(lsize) * lsize * hsize * hsize;
 
   // Renumber the level of nodes for VarHigh
   int hnum = unique->getNumEntries(hvar);
@@ -108,9 +113,15 @@ void MEDDLY::mtmxd_forest::swapAdjacentVariablesByVarSwap(int level)
   std::vector<node_handle> t;
   std::unordered_map<node_handle, node_handle> dup;
 
-  // Reconstruct nodes for VarHigh
+  // Reconstruct nodes for VarHigh, a batch at a time:
+  // gather the cofactor grids, then build the nodes
+  int batch = MIN(hnum, SWAP_BATCH);
+  node_handle* grids = new node_handle[batch * gsize];
   for (int i = 0; i < hnum; i++) {
-    node_handle node = swapAdjacentVariablesOf(hnodes[i]);
+    if (0 == i % batch) {
+      gatherSwapGrids(level, hnodes + i, MIN(batch, hnum - i), grids);
+    }
+    node_handle node = swapAdjacentVariablesOf(level, grids + (i % batch) * gsize);
     if (hnodes[i] == node) {
       // VarLow is DONT_CHANGE in the MxD
       unlinkNode(node);
@@ -183,27 +194,36 @@ void MEDDLY::mtmxd_forest::swapAdjacentVariablesByVarSwap(int level)
     phnum = j;
   }
 
-  // Reconstruct nodes for VarHigh'
-  for (int i = 0; i < phnum; i++) {
-    MEDDLY_DCASSERT(isActiveNode(phnodes[i]));
-
-    unpacked_node* nr = unpacked_node::useUnpackedNode();
-    nr->initFromNode(this, phnodes[i], true);
-    bool skip = true;
-    for (int j = 0; j < hsize; j++){
-      if (!isLevelAbove(-level, getNodeLevel(nr->d(j)))) {
-        skip = false;
-        break;
+  // Skip the nodes for VarHigh' where VarLow is DONT_CARE + DONT_CHANGE
+  {
+    int j = 0;
+    for (int i = 0; i < phnum; i++) {
+      MEDDLY_DCASSERT(isActiveNode(phnodes[i]));
+
+      unpacked_node* nr = unpacked_node::useUnpackedNode();
+      nr->initFromNode(this, phnodes[i], true);
+      for (int k = 0; k < hsize; k++){
+        if (!isLevelAbove(-level, getNodeLevel(nr->d(k)))) {
+          phnodes[j++] = phnodes[i];
+          break;
+        }
       }
+      unpacked_node::recycle(nr);
     }
-    unpacked_node::recycle(nr);
+    phnum = j;
+  }
 
-    if (skip) {
-      // VarLow is DONT_CARE + DONT_CHANGE in the MxD
-      continue;
+  // Reconstruct nodes for VarHigh', a batch at a time
+  if (phnum > batch) {
+    delete[] grids;
+    batch = MIN(phnum, SWAP_BATCH);
+    grids = new node_handle[batch * gsize];
+  }
+  for (int i = 0; i < phnum; i++) {
+    if (0 == i % batch) {
+      gatherSwapGrids(level, phnodes + i, MIN(batch, phnum - i), grids);
     }
-
-    node_handle node = swapAdjacentVariablesOf(phnodes[i]);
+    node_handle node = swapAdjacentVariablesOf(level, grids + (i % batch) * gsize);
     MEDDLY_DCASSERT(phnodes[i] != node);
 
     if (getNodeInCount(node) > 1) {
@@ -223,6 +243,7 @@ void MEDDLY::mtmxd_forest::swapAdjacentVariablesByVarSwap(int level)
     }
   }
   delete[] phnodes;
+  delete[] grids;
 
   // XXX: Duplicate code
   if (!dup.empty()) {
@@ -275,9 +296,71 @@ void MEDDLY::mtmxd_forest::swapAdjacentVariablesByVarSwap(int level)
   //	printf("#Node: %d\n", getCurrentNumNodes());
 }
 
-MEDDLY::node_handle MEDDLY::mtmxd_forest::swapAdjacentVariablesOf(node_handle node)
+namespace {
+  // Cofactor grids of nodes[from..to); see gatherSwapGrids().
+  void gatherSwapGridRange(const MEDDLY::mtmxd_forest* f, int level,
+    const MEDDLY::node_handle* nodes, int from, int to, int hsize, int lsize,
+    MEDDLY::node_handle* grids)
+  {
+    using MEDDLY::node_handle;
+    const bool identity = f->isIdentityReduced();
+    const long gsize = long(lsize) * lsize * hsize * hsize;
+    for (int i = from; i < to; i++) {
+      const node_handle node = nodes[i];
+      node_handle* g = grids + i * gsize;
+      for (int m = 0; m < lsize; m++) {
+        for (int n = 0; n < lsize; n++) {
+          for (int p = 0; p < hsize; p++) {
+            for (int q = 0; q < hsize; q++, g++) {
+              node_handle node_p = (f->getNodeLevel(node) == level ? f->getDownPtr(node, p) : node);
+              if (identity && f->getNodeLevel(node_p) != -(level) && q != p) {
+                *g = f->getTransparentNode();
+                continue;
+              }
+              node_handle node_pq = (f->getNodeLevel(node_p) == -(level) ? f->getDownPtr(node_p, q) : node_p);
+              node_handle node_pqm = (f->getNodeLevel(node_pq) == (level+1) ? f->getDownPtr(node_pq, m) : node_pq);
+              if (identity && f->getNodeLevel(node_pqm) != -(level+1) && n != m) {
+                *g = f->getTransparentNode();
+                continue;
+              }
+              *g = (f->getNodeLevel(node_pqm) == -(level+1) ? f->getDownPtr(node_pqm, n) : node_pqm);
+            }
+          }
+        }
+      }
+    }
+  }
+};
+
+void MEDDLY::mtmxd_forest::gatherSwapGrids(int level,
+  const node_handle* nodes, int n, node_handle* grids) const
+{
+  if (!isFullyReduced() && !isQuasiReduced() && !isIdentityReduced()) {
+    throw error(error::NOT_IMPLEMENTED, __FILE__, __LINE__);
+  }
+  int hsize = getVariableSize(getVarByLevel(level));
+  int lsize = getVariableSize(getVarByLevel(level+1));
+#ifdef MEDDLY_THREADS
+  int nt = MIN(int(deflt.swap_threads), n);
+  if (nt > 1) {
+    std::vector<std::thread> workers;
+    int per = (n + nt - 1) / nt;
+    for (int from = 0; from < n; from += per) {
+      workers.push_back(std::thread(gatherSwapGridRange, this, level,
+        nodes, from, MIN(from + per, n), hsize, lsize, grids));
+    }
+    for (unsigned t = 0; t < workers.size(); t++) {
+      workers[t].join();
+    }
+    return;
+  }
+#endif
+  gatherSwapGridRange(this, level, nodes, 0, n, hsize, lsize, grids);
+}
+
+MEDDLY::node_handle MEDDLY::mtmxd_forest::swapAdjacentVariablesOf(int level,
+  const node_handle* grid)
 {
-  int level = ABS(getNodeLevel(node));
   int hvar = getVarByLevel(level);
   int lvar = getVarByLevel(level+1);
   int hsize = getVariableSize(hvar);
@@ -285,66 +368,24 @@ MEDDLY::node_handle MEDDLY::mtmxd_forest::swapAdjacentVariablesOf(node_handle no
 
   // Unprimed high node builder
   unpacked_node* hnb = unpacked_node::newFull(this, level + 1, lsize);
-  if (isFullyReduced() || isQuasiReduced()) {
-    for (int m = 0; m < lsize; m++) {
-      // Primed high node builder
-      unpacked_node* phnb = unpacked_node::newFull(this, -(level + 1), lsize);
-      for (int n = 0; n < lsize; n++) {
-        // Unprimed low node builder
-        unpacked_node* lnb = unpacked_node::newFull(this, level, hsize);
-        for (int p = 0; p < hsize; p++) {
-          // Primed low node builder
-          unpacked_node* plnb = unpacked_node::newFull(this, -level, hsize);
-          for (int q = 0; q < hsize; q++){
-            node_handle node_p = (getNodeLevel(node) == level ? getDownPtr(node, p) : node);
-            node_handle node_pq = (getNodeLevel(node_p) == -(level) ? getDownPtr(node_p, q) : node_p);
-            node_handle node_pqm = (getNodeLevel(node_pq) == (level+1) ? getDownPtr(node_pq, m) : node_pq);
-            plnb->d_ref(q) = linkNode(getNodeLevel(node_pqm) == -(level+1) ? getDownPtr(node_pqm, n) : node_pqm);
-          }
-          lnb->d_ref(p) = createReducedNode(p, plnb);
-        }
-        phnb->d_ref(n) = createReducedNode(-1, lnb);
-      }
-      hnb->d_ref(m) = createReducedNode(m, phnb);
-    }
-  }
-  else if (isIdentityReduced()) {
-    for (int m = 0; m < lsize; m++) {
-      // Primed high node builder
-      unpacked_node* phnb = unpacked_node::newFull(this, -(level + 1), lsize);
-      for (int n = 0; n < lsize; n++) {
-        // Unprimed low node builder
-        unpacked_node* lnb = unpacked_node::newFull(this, level, hsize);
-        for (int p = 0; p < hsize; p++) {
-          // Primed low node builder
-          unpacked_node* plnb = unpacked_node::newFull(this, -level, hsize);
-          for (int q = 0; q < hsize; q++) {
-            node_handle node_p = (getNodeLevel(node) == level ? getDownPtr(node, p) : node);
-            if (getNodeLevel(node_p) != -(level) && q != p) {
-              plnb->d_ref(q) = linkNode(getTransparentNode());
-            }
-            else {
-              node_handle node_pq = (getNodeLevel(node_p) == -(level) ? getDownPtr(node_p, q) : node_p);
-              node_handle node_pqm = (getNodeLevel(node_pq) == (level+1) ? getDownPtr(node_pq, m) : node_pq);
-              if (getNodeLevel(node_pqm) != -(level+1) && n != m) {
-                plnb->d_ref(q) = linkNode(getTransparentNode());
-              }
-              else {
-                plnb->d_ref(q) = linkNode(getNodeLevel(node_pqm) == -(level+1) ? getDownPtr(node_pqm, n) : node_pqm);
-              }
-            }
-          }
-          lnb->d_ref(p) = createReducedNode(p, plnb);
+  for (int m = 0; m < lsize; m++) {
+    // Primed high node builder
+    unpacked_node* phnb = unpacked_node::newFull(this, -(level + 1), lsize);
+    for (int n = 0; n < lsize; n++) {
+      // Unprimed low node builder
+      unpacked_node* lnb = unpacked_node::newFull(this, level, hsize);
+      for (int p = 0; p < hsize; p++) {
+        // Primed low node builder
+        unpacked_node* plnb = unpacked_node::newFull(this, -level, hsize);
+        for (int q = 0; q < hsize; q++) {
+          plnb->d_ref(q) = linkNode(*grid++);
         }
-        phnb->d_ref(n) = createReducedNode(-1, lnb);
+        lnb->d_ref(p) = createReducedNode(p, plnb);
       }
-      hnb->d_ref(m) = createReducedNode(m, phnb);
+      phnb->d_ref(n) = createReducedNode(-1, lnb);
     }
+    hnb->d_ref(m) = createReducedNode(m, phnb);
   }
-  else {
-    throw error(error::NOT_IMPLEMENTED, __FILE__, __LINE__);
-  }
-
   return createReducedNode(-1, hnb);
 }
 
@@ -474,7 +515,7 @@ void MEDDLY::mtmxd_forest::dynamicReorderVariables(int top, int bottom)
   MEDDLY_DCASSERT(top <= getNumVariables());
   MEDDLY_DCASSERT(bottom >= 1);
 
-  removeAllComputeTableEntries();
+  removeComputeTableEntriesForLevels(bottom, top);
 
   std::vector<int> vars;
   vars.reserve(top - bottom + 1);
@@ -742,7 +783,7 @@ bool MEDDLY::mtmxd_forest::mtmxd_fixedrow_iter::first(int k, node_handle down)
   // Check that this "row" node has a non-zero pointer
   // for the fixed index.
   MEDDLY_DCASSERT(k>0);
-  int cdown;
+  node_handle cdown;
   if (isLevelAbove(k, F->getNodeLevel(down))) {
     // skipped unprimed level, must be "fully" reduced
     cdown = down;
@@ -866,7 +907,7 @@ bool MEDDLY::mtmxd_forest::mtmxd_fixedcol_iter::first(int k, node_handle down)
       }
       return first(downLevel(k), down);
     }
-    int cdown = F->getDownPtr(down, index[k]);
+    node_handle cdown = F->getDownPtr(down, index[k]);
     if (0==cdown) return false;
     return first(downLevel(k), cdown);
   }
@@ -895,7 +936,7 @@ bool MEDDLY::mtmxd_forest::mtmxd_fixedcol_iter::first(int k, node_handle down)
     }
     // next level is not skipped.
     // See if there is a valid path below.
-    int cdown = F->getDownPtr(down, index[kpr]);
+    node_handle cdown = F->getDownPtr(down, index[kpr]);
     if (0==cdown) return false;
     if (!first(kpr, cdown)) return false;
     path[k].initRedundant(F, k, down, false);
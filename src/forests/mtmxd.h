@@ -97,10 +97,21 @@ class MEDDLY::mtmxd_forest : public mt_forest {
     };
 
     void swapAdjacentVariablesByVarSwap(int level);
+    /** Gather, for each node at level or -level, its grid of cofactors
+        for swapping the variables at level and level+1; the levels must
+        already be renumbered.  Entry (((i*lsize + m)*lsize + n)*hsize + p)
+        *hsize + q of grids is the node reached from the i-th node by
+        p, q at level and -level and by m, n at level+1 and -(level+1),
+        where lsize is the size of the variable at level+1.
+        The forest is only read, so when built with MEDDLY_THREADS the
+        nodes are split across policies::swap_threads threads.
+    */
+    void gatherSwapGrids(int level, const node_handle* nodes, int n,
+        node_handle* grids) const;
     /** Return the root node after swapping the adjacent variables
-        in the MxD with the given root node.
+        at level and level+1, built from the cofactor grid of one node.
     */
-    node_handle swapAdjacentVariablesOf(node_handle node);
+    node_handle swapAdjacentVariablesOf(int level, const node_handle* grid);
 
     void swapAdjacentVariablesByLevelSwap(int level);
     void swapAdjacentLevels(int level);
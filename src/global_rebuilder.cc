@@ -11,37 +11,47 @@
 #include <unordered_map>
 #include <algorithm>
 
-size_t MEDDLY::global_rebuilder::RestrictKeyHasher::operator()(
-    const RestrictKey &key) const {
-  MEDDLY::hash_stream s;
-  s.start(0);
-  s.push(key.p, key.var, key.idx);
-  return s.finish();
-}
-
-size_t MEDDLY::global_rebuilder::TransformKeyHasher::operator()(
-    const TransformKey &key) const {
-  MEDDLY::hash_stream s;
-  s.start(0);
-  s.push(key.sig);
-//  s.push(key.sig, key.var);
-  return s.finish();
-}
+namespace {
+  // Ways per set in the transform table
+  const unsigned TRANSFORM_WAYS = 4;
+  const int WORD_BITS = 8 * sizeof(unsigned long);
+};
 
 MEDDLY::global_rebuilder::global_rebuilder(expert_forest* source,
-    expert_forest* target) :
+    expert_forest* target, unsigned cache_size) :
     _source(source), _target(target), _hit(0), _total(0) {
   if (_source->getDomain() != _target->getDomain()) {
     throw error(error::DOMAIN_MISMATCH, __FILE__, __LINE__);
   }
 
+  unsigned size = TRANSFORM_WAYS;
+  while (size < cache_size) {
+    size <<= 1;
+  }
+
+  _restrict_table = new RestrictEntry[size];
+  memset(_restrict_table, 0, size * sizeof(RestrictEntry));
+  _restrict_mask = size - 1;
+  _restrict_epoch = 1;
+
+  _pa_words = _source->getNumVariables() / WORD_BITS + 1;
+  _transform_table = new TransformEntry[size];
+  memset(_transform_table, 0, size * sizeof(TransformEntry));
+  _transform_pa = new unsigned long[size_t(size) * 2 * _pa_words];
+  _transform_mask = size - 1;
+  _transform_victim = 0;
+
   _sg = new TopDownSignatureGenerator(*this);
 //  _sc = new BottomUpSignatureComputer(*this);
   _sg->precompute();
 }
 
 MEDDLY::global_rebuilder::~global_rebuilder() {
+  clearCache();
   delete _sg;
+  delete[] _restrict_table;
+  delete[] _transform_table;
+  delete[] _transform_pa;
 }
 
 int MEDDLY::global_rebuilder::check_dependency(node_handle p, int target_level) const
@@ -88,6 +98,7 @@ int MEDDLY::global_rebuilder::check_dependency(node_handle p, int target_level)
     for(int i = 1; i < size; i++) {
       if(nr->d(i) != nr->d(0)) {
         if(var == top_var) {
+          unpacked_node::recycle(nr);
           return top_var;
         }
         else {
@@ -121,21 +132,33 @@ int MEDDLY::global_rebuilder::check_dependency(node_handle p, int target_level)
 }
 
 MEDDLY::dd_edge MEDDLY::global_rebuilder::rebuild(const dd_edge& e) {
-  if (e.getForest() != _source) {
-    throw error(error::FOREST_MISMATCH, __FILE__, __LINE__);
+  dd_edge out(_target);
+  rebuild(&e, &out, 1);
+  return out;
+}
+
+void MEDDLY::global_rebuilder::rebuild(const dd_edge* src, dd_edge* dst,
+    int n) {
+  if (n < 0 || (n > 0 && (0 == src || 0 == dst))) {
+    throw error(error::INVALID_ARGUMENT, __FILE__, __LINE__);
+  }
+  for (int i = 0; i < n; i++) {
+    if (src[i].getForest() != _source || dst[i].getForest() != _target) {
+      throw error(error::FOREST_MISMATCH, __FILE__, __LINE__);
+    }
   }
 
-  int num_var = e.getForest()->getDomain()->getNumVariables();
-  _root = e.getNode();
+  int num_var = _source->getDomain()->getNumVariables();
 
   // Partial assignment
   std::vector<int> pa;
-  node_handle pt = transform(_root, num_var, pa);
+  for (int i = 0; i < n; i++) {
+    _root = src[i].getNode();
+    node_handle pt = transform(_root, num_var, pa);
+    MEDDLY_DCASSERT(pa.empty());
+    dst[i].set(pt);
+  }
   clearCache();
-
-  dd_edge out(_target);
-  out.set(pt);
-  return out;
 }
 
 MEDDLY::node_handle MEDDLY::global_rebuilder::transform(node_handle p,
@@ -159,20 +182,23 @@ MEDDLY::node_handle MEDDLY::global_rebuilder::transform(node_handle p,
   target_level = _target->getLevelByVar(top_var);
 
   int sig = signature(p);
-  auto search = _computed_transform.equal_range( { sig });
-//  auto search = _computed_transform.equal_range( { sig, top_var });
   _total++;
-  for (auto entry = search.first; entry != search.second; entry++) {
+  unsigned set = (unsigned(sig) * 2654435761u) & _transform_mask
+      & ~(TRANSFORM_WAYS - 1);
+  for (unsigned w = 0; w < TRANSFORM_WAYS; w++) {
+    const TransformEntry& entry = _transform_table[set + w];
+    if (0 == entry.root || entry.sig != sig) {
+      continue;
+    }
+    unpackAssignment(set + w, _pa_buf);
     node_handle result;
-    bool exist = restrict_exist(_root, entry->second.pa, 0, result);
-    _computed_restrict.clear();
+    bool exist = restrict_exist(entry.root, _pa_buf, 0, result);
+    clearRestrict();
     _source->unlinkNode(result);
 
     if (exist && result == p) {
       _hit++;
-//			printf("Hit %d Target %d\n", result, _target->getCurrentNumNodes());
-      fflush(stdout);
-      return _target->linkNode(entry->second.p);
+      return _target->linkNode(entry.p);
     }
   }
 
@@ -188,7 +214,7 @@ MEDDLY::node_handle MEDDLY::global_rebuilder::transform(node_handle p,
 //    int top_pr = check_dependency(pr, _target->getNumVariables());
 //    MEDDLY_DCASSERT(_target->getLevelByVar(top_pr) < _target->getLevelByVar(top_var));
 
-    _computed_restrict.clear();
+    clearRestrict();
     nb->d_ref(i) = transform(pr, target_level - 1, pa);
     _source->unlinkNode(pr);
     pa.pop_back();
@@ -201,15 +227,7 @@ MEDDLY::node_handle MEDDLY::global_rebuilder::transform(node_handle p,
 //  }
 
   // Saved in the computed table
-  std::vector<int> cpa(pa);
-  std::sort(cpa.begin(), cpa.end(),
-      [this](const int& x, const int& y) {
-        MEDDLY_DCASSERT(ABS(x) != ABS(y));
-        return this->_source->getLevelByVar(ABS(x)) > this->_source->getLevelByVar(ABS(y));
-      });
-  _computed_transform.insert( { { sig }, { cpa, pt } });
-//  _computed_transform.emplace({ sig }, { cpa, pt });
-//  _computed_transform.insert( { { sig, top_var }, { cpa, pt } });
+  saveTransform(sig, pa, pt);
   return pt;
 }
 
@@ -224,9 +242,9 @@ MEDDLY::node_handle MEDDLY::global_rebuilder::restrict(node_handle p,
   } else {
     int idx = (pa.back() < 0 ? 0 : 1);
 
-    auto search = _computed_restrict.find( { p, var, idx });
-    if (search != _computed_restrict.end()) {
-      return _source->linkNode(search->second);
+    node_handle cached;
+    if (findRestrict(p, pa.back(), cached)) {
+      return _source->linkNode(cached);
     }
 
     if (level1 > level2) {
@@ -244,7 +262,7 @@ MEDDLY::node_handle MEDDLY::global_rebuilder::restrict(node_handle p,
       node_handle pr = _source->createReducedNode(-1, nb);
 
       // Saved in the computed table
-      _computed_restrict.insert( { { p, var, idx }, pr });
+      saveRestrict(p, pa.back(), pr);
       return pr;
     } else {
       node_handle d = _source->getDownPtr(p, idx);
@@ -339,9 +357,8 @@ bool MEDDLY::global_rebuilder::restrict_exist(node_handle p,
   } else {
     int idx = (pa[start] < 0 ? 0 : 1);
 
-    auto search = _computed_restrict.find( { p, var, idx });
-    if (search != _computed_restrict.end()) {
-      result = _source->linkNode(search->second);
+    if (findRestrict(p, pa[start], result)) {
+      result = _source->linkNode(result);
       return true;
     }
 
@@ -373,7 +390,7 @@ bool MEDDLY::global_rebuilder::restrict_exist(node_handle p,
       }
 
       // Saved in the computed table
-      _computed_restrict.insert( { { p, var, idx }, result });
+      saveRestrict(p, pa[start], result);
       return true;
     } else {
       node_handle d = _source->getDownPtr(p, idx);
@@ -382,41 +399,99 @@ bool MEDDLY::global_rebuilder::restrict_exist(node_handle p,
   }
 }
 
-void MEDDLY::global_rebuilder::clearCache() {
-  _computed_restrict.clear();
-
-//  printf("Size: %d\n", _computed_transform.size());
-//  printf("Load factor: %f\n", _computed_transform.load_factor());
-//  size_t max = 0;
-//  size_t total = 0;
-//  size_t num_non_empty = 0;
-//  for (size_t i = 0; i < _computed_transform.bucket_count(); i++) {
-//    size_t size = _computed_transform.bucket_size(i);
-//    if (size > 0) {
-//      total += size;
-//      num_non_empty++;
-//      if (max < size) {
-//        max = size;
-//      }
-//    }
-//
-//  }
-//  printf("Avg non-empty bucket size: %f\n", (float) total / num_non_empty);
-//  printf("Max bucket size: %d\n", max);
-
-//  std::unordered_set<node_handle> seen;
-//  for(auto e : _computed_transform) {
-//    printf("(%d) -> (%d)\n", e.first.sig, e.second.p);
-//    if(seen.find(e.second.p) != seen.end()) {
-//      printf("Error!\n");
-//    }
-//    else {
-//      seen.emplace(e.second.p);
-//    }
-////    printf("(%d, %d) -> (%d)\n", e.first.sig, e.first.var, e.second.p);
-//  }
+bool MEDDLY::global_rebuilder::findRestrict(node_handle p, int var,
+    node_handle& result) const {
+  MEDDLY::hash_stream s;
+  s.start(0);
+  s.push(p, var);
+  const RestrictEntry& entry = _restrict_table[s.finish() & _restrict_mask];
+  if (entry.epoch != _restrict_epoch || entry.p != p || entry.var != var) {
+    return false;
+  }
+  result = entry.result;
+  return true;
+}
+
+void MEDDLY::global_rebuilder::saveRestrict(node_handle p, int var,
+    node_handle result) {
+  MEDDLY::hash_stream s;
+  s.start(0);
+  s.push(p, var);
+  RestrictEntry& entry = _restrict_table[s.finish() & _restrict_mask];
+  entry.p = p;
+  entry.var = var;
+  entry.result = result;
+  entry.epoch = _restrict_epoch;
+}
+
+void MEDDLY::global_rebuilder::clearRestrict() {
+  // Entries from older epochs are ignored,
+  // so the table is only wiped when the counter wraps.
+  if (0 == ++_restrict_epoch) {
+    memset(_restrict_table, 0, (_restrict_mask + 1) * sizeof(RestrictEntry));
+    _restrict_epoch = 1;
+  }
+}
+
+void MEDDLY::global_rebuilder::saveTransform(int sig,
+    const std::vector<int>& pa, node_handle pt) {
+  unsigned set = (unsigned(sig) * 2654435761u) & _transform_mask
+      & ~(TRANSFORM_WAYS - 1);
+  unsigned slot = set;
+  for (unsigned w = 0; w < TRANSFORM_WAYS; w++) {
+    if (0 == _transform_table[set + w].root) {
+      slot = set + w;
+      break;
+    }
+    if (w + 1 == TRANSFORM_WAYS) {
+      // Set is full; overwrite in round-robin order
+      slot = set + (_transform_victim++ % TRANSFORM_WAYS);
+    }
+  }
+
+  TransformEntry& entry = _transform_table[slot];
+  if (entry.root) {
+    _target->unlinkNode(entry.p);
+  }
+  entry.sig = sig;
+  entry.root = _root;
+  entry.p = _target->linkNode(pt);
+
+  unsigned long* assigned = _transform_pa + size_t(slot) * 2 * _pa_words;
+  unsigned long* value = assigned + _pa_words;
+  memset(assigned, 0, 2 * _pa_words * sizeof(unsigned long));
+  for (unsigned i = 0; i < pa.size(); i++) {
+    int var = ABS(pa[i]);
+    assigned[var / WORD_BITS] |= 1ul << (var % WORD_BITS);
+    if (pa[i] > 0) {
+      value[var / WORD_BITS] |= 1ul << (var % WORD_BITS);
+    }
+  }
+}
 
-  _computed_transform.clear();
+void MEDDLY::global_rebuilder::unpackAssignment(unsigned slot,
+    std::vector<int>& pa) const {
+  const unsigned long* assigned = _transform_pa + size_t(slot) * 2 * _pa_words;
+  const unsigned long* value = assigned + _pa_words;
+  pa.clear();
+  for (int level = _source->getNumVariables(); level > 0; level--) {
+    int var = _source->getVarByLevel(level);
+    unsigned long bit = 1ul << (var % WORD_BITS);
+    if (assigned[var / WORD_BITS] & bit) {
+      pa.push_back((value[var / WORD_BITS] & bit) ? var : -var);
+    }
+  }
+}
+
+void MEDDLY::global_rebuilder::clearCache() {
+  clearRestrict();
+  for (unsigned i = 0; i <= _transform_mask; i++) {
+    TransformEntry& entry = _transform_table[i];
+    if (entry.root) {
+      _target->unlinkNode(entry.p);
+      entry.root = 0;
+    }
+  }
 }
 
 int MEDDLY::global_rebuilder::signature(node_handle p) const {
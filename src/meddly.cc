@@ -51,6 +51,13 @@ namespace MEDDLY {
   size_t memstats::global_memory_alloc = 0;
   size_t memstats::global_peak_used = 0;
   size_t memstats::global_peak_alloc = 0;
+  size_t memstats::budget = 0;
+  size_t memstats::budget_trigger = 0;
+
+  bool memory_budget::reorder = false;
+  bool memory_budget::reclaiming = false;
+  bool memory_budget::compacting = false;
+  int memory_budget::depth = 0;
 
   // cache of operations
   operation** op_cache = 0;
@@ -69,6 +76,9 @@ namespace MEDDLY {
   unsigned operation::list_alloc = 0;
   unsigned operation::free_list = 0;
 
+  // Use explicit stacks instead of recursion?
+  bool operation::explicit_stack = false;
+
   //
   // List of all domains
   //
@@ -100,6 +110,236 @@ MEDDLY::memstats::memstats()
   peak_memory_alloc = 0;
 }
 
+//----------------------------------------------------------------------
+// front end - memory budget
+//----------------------------------------------------------------------
+
+void MEDDLY::setMemoryBudget(size_t bytes, bool reorder)
+{
+  // Start reclaiming when we are within 1/8 of the budget
+  memstats::setBudget(bytes, bytes - bytes/8);
+  memory_budget::setReordering(reorder);
+}
+
+void MEDDLY::reclaimMemory()
+{
+  if (memstats::isOverBudget()) memory_budget::reclaim();
+}
+
+//----------------------------------------------------------------------
+// front end - recursion
+//----------------------------------------------------------------------
+
+void MEDDLY::setExplicitStack(bool on)
+{
+  operation::setExplicitStack(on);
+}
+
+void MEDDLY::memory_budget::setReordering(bool r)
+{
+  reorder = r;
+}
+
+void MEDDLY::memory_budget::reclaim()
+{
+  if (relieve()) return;
+  logRemedy("Memory budget: exceeded");
+  throw error(error::INSUFFICIENT_MEMORY, __FILE__, __LINE__);
+}
+
+bool MEDDLY::memory_budget::relieve()
+{
+  if (reclaiming) return true;
+  const size_t budget = memstats::getBudget();
+  if (0==budget) return true;
+  reclaiming = true;
+
+  try {
+    //
+    // Remedies, cheapest first
+    //
+    logRemedy("Memory budget: removing stale compute table entries");
+    removeStales();
+
+    if (!isRelieved()) {
+      logRemedy("Memory budget: clearing compute tables");
+      clearComputeTables();
+    }
+
+    if (!isRelieved()) {
+      logRemedy("Memory budget: compacting node storage");
+      compactForests();
+    }
+
+    if (!isRelieved() && reorder) {
+      logRemedy("Memory budget: reordering variables");
+      reorderForests();
+      compactForests();
+    }
+  }
+  catch (error &e) {
+    reclaiming = false;
+    throw e;
+  }
+  reclaiming = false;
+
+  const size_t alloc = memstats::getGlobalMemAlloc();
+  if (alloc > budget) return false;
+
+  //
+  // Next time, start reclaiming half way between here and the budget
+  // (or at the usual point, if we got back there).
+  //
+  if (isRelieved()) {
+    memstats::setBudget(budget, budget - budget/8);
+  } else {
+    memstats::setBudget(budget, alloc + (budget-alloc)/2);
+  }
+  return true;
+}
+
+void MEDDLY::memory_budget::recover()
+{
+  if (reclaiming) return;
+  reclaiming = true;
+  try {
+    logRemedy("Memory budget: allocation failed, removing stale compute table entries");
+    removeStales();
+    logRemedy("Memory budget: allocation failed, compacting node storage");
+    compactForests();
+  }
+  catch (error &e) {
+    reclaiming = false;
+    throw e;
+  }
+  reclaiming = false;
+}
+
+MEDDLY::memory_budget::guard::guard()
+{
+  left = false;
+  if (0==depth++ && memstats::isOverBudget()) {
+    try {
+      reclaim();
+    }
+    catch (error &e) {
+      depth--;
+      left = true;
+      throw e;
+    }
+  }
+}
+
+void MEDDLY::memory_budget::guard::leave()
+{
+  MEDDLY_DCASSERT(!left);
+  left = true;
+  if (0==--depth && memstats::isOverBudget()) {
+    //
+    // The result is already built; if the budget is still exceeded,
+    // the next front-end call will report it.
+    //
+    try {
+      relieve();
+    }
+    catch (error &e) {
+    }
+  }
+}
+
+MEDDLY::memory_budget::guard::~guard()
+{
+  // unwinding; no checks
+  if (!left) depth--;
+}
+
+void MEDDLY::memory_budget::logRemedy(const char* what)
+{
+  for (int d=0; d<domain::dom_list_size; d++) {
+    domain* D = domain::dom_list[d];
+    if (0==D) continue;
+    for (unsigned i=0; i<D->szForests; i++) {
+      expert_forest* f = static_cast <expert_forest*> (D->forests[i]);
+      if (0==f) continue;
+      if (f->getLogger()) f->getLogger()->newPhase(f, what);
+    }
+  }
+}
+
+bool MEDDLY::memory_budget::isRelieved()
+{
+  const size_t budget = memstats::getBudget();
+  return memstats::getGlobalMemAlloc() <= budget - budget/8;
+}
+
+void MEDDLY::memory_budget::removeStales()
+{
+  if (operation::usesMonolithicComputeTable()) {
+    operation::removeStalesFromMonolithic();
+    return;
+  }
+  for (unsigned i=0; i<operation::getOpListSize(); i++) {
+    operation* op = operation::getOpWithIndex(i);
+    if (op) op->removeStaleComputeTableEntries();
+  }
+}
+
+void MEDDLY::memory_budget::clearComputeTables()
+{
+  if (operation::usesMonolithicComputeTable()) {
+    operation::removeAllFromMonolithic();
+  } else {
+    for (unsigned i=0; i<operation::getOpListSize(); i++) {
+      operation* op = operation::getOpWithIndex(i);
+      if (op) op->removeAllComputeTableEntries();
+    }
+  }
+  // Empty tables are shrunk when scanned again
+  removeStales();
+}
+
+void MEDDLY::memory_budget::compactForests()
+{
+  // Compaction needs a second copy of a forest's nodes for a moment;
+  // that is allowed past the budget.
+  compacting = true;
+  try {
+    for (int d=0; d<domain::dom_list_size; d++) {
+      domain* D = domain::dom_list[d];
+      if (0==D) continue;
+      for (unsigned i=0; i<D->szForests; i++) {
+        expert_forest* f = static_cast <expert_forest*> (D->forests[i]);
+        if (f) f->compactMemory();
+      }
+    }
+  }
+  catch (error &e) {
+    compacting = false;
+    throw e;
+  }
+  compacting = false;
+}
+
+void MEDDLY::memory_budget::reorderForests()
+{
+  for (int d=0; d<domain::dom_list_size; d++) {
+    domain* D = domain::dom_list[d];
+    if (0==D) continue;
+    for (unsigned i=0; i<D->szForests; i++) {
+      expert_forest* f = static_cast <expert_forest*> (D->forests[i]);
+      if (0==f) continue;
+      if (f->getNumVariables() < 2) continue;
+      try {
+        f->dynamicReorderVariables(f->getNumVariables(), 1);
+      }
+      catch (error &e) {
+        // Not every forest can reorder itself; skip those.
+        if (error::NOT_IMPLEMENTED != e.getCode()) throw e;
+      }
+    }
+  }
+}
+
 //----------------------------------------------------------------------
 // front end - unary operations
 //----------------------------------------------------------------------
@@ -196,6 +436,8 @@ MEDDLY::binary_operation* MEDDLY::getOperation(const binary_opname* code,
 
   // none present, build a new one...
   curr = code->buildOperation(arg1, arg2, res);
+  if (0==curr)
+    throw error(error::TYPE_MISMATCH, __FILE__, __LINE__);
   // ...move it to the front...
   curr->setNext(op_cache[code->getIndex()]);
   op_cache[code->getIndex()] = curr;
@@ -232,8 +474,10 @@ void MEDDLY::apply(const unary_opname* code, const dd_edge &a, dd_edge &c)
     throw error(error::UNINITIALIZED, __FILE__, __LINE__);
   if (0==code)  
     throw error(error::UNKNOWN_OPERATION, __FILE__, __LINE__);
+  memory_budget::guard G;
   unary_operation* op = getOperation(code, a, c);
   op->compute(a, c);
+  G.leave();
 }
 
 void MEDDLY::apply(const unary_opname* code, const dd_edge &a, long &c)
@@ -242,8 +486,10 @@ void MEDDLY::apply(const unary_opname* code, const dd_edge &a, long &c)
     throw error(error::UNINITIALIZED, __FILE__, __LINE__);
   if (0==code)
     throw error(error::UNKNOWN_OPERATION, __FILE__, __LINE__);
+  memory_budget::guard G;
   unary_operation* op = getOperation(code, a, INTEGER);
   op->compute(a, c);
+  G.leave();
 }
 
 void MEDDLY::apply(const unary_opname* code, const dd_edge &a, double &c)
@@ -252,8 +498,10 @@ void MEDDLY::apply(const unary_opname* code, const dd_edge &a, double &c)
     throw error(error::UNINITIALIZED, __FILE__, __LINE__);
   if (0==code)
     throw error(error::UNKNOWN_OPERATION, __FILE__, __LINE__);
+  memory_budget::guard G;
   unary_operation* op = getOperation(code, a, REAL);
   op->compute(a, c);
+  G.leave();
 }
 
 void MEDDLY::apply(const unary_opname* code, const dd_edge &a, opnd_type cr,
@@ -263,8 +511,10 @@ void MEDDLY::apply(const unary_opname* code, const dd_edge &a, opnd_type cr,
     throw error(error::UNINITIALIZED, __FILE__, __LINE__);
   if (0==code)
     throw error(error::UNKNOWN_OPERATION, __FILE__, __LINE__);
+  memory_budget::guard G;
   unary_operation* op = getOperation(code, a, cr);
   op->compute(a, c);
+  G.leave();
 }
 
 void MEDDLY::apply(const binary_opname* code, const dd_edge &a, 
@@ -274,8 +524,24 @@ void MEDDLY::apply(const binary_opname* code, const dd_edge &a,
     throw error(error::UNINITIALIZED, __FILE__, __LINE__);
   if (0==code)
     throw error(error::UNKNOWN_OPERATION, __FILE__, __LINE__);
+  memory_budget::guard G;
   binary_operation* op = getOperation(code, a, b, c);
   op->compute(a, b, c);
+  G.leave();
+}
+
+void MEDDLY::apply(const binary_opname* code, const dd_edge &a,
+  const dd_edge &b, bool &c)
+{
+  if (!libraryRunning) 
+    throw error(error::UNINITIALIZED, __FILE__, __LINE__);
+  if (0==code)
+    throw error(error::UNKNOWN_OPERATION, __FILE__, __LINE__);
+  memory_budget::guard G;
+  binary_operation* op = getOperation(code, (expert_forest*) a.getForest(),
+    (expert_forest*) b.getForest(), (expert_forest*) 0);
+  op->compute(a, b, c);
+  G.leave();
 }
 
 //----------------------------------------------------------------------
@@ -49,6 +49,9 @@
 #include <memory>
 #include <cassert>
 
+// Build options that change the interface (generated by configure)
+#include "meddly_config.h"
+
 // Flags for development version only. Significant reduction in performance.
 #ifdef DEVELOPMENT_CODE
 #define RANGE_CHECK_ON
@@ -93,13 +96,22 @@ namespace MEDDLY {
   /** Handles for nodes.
       This should be either int or long, and effectively limits
       the number of possible nodes per forest.
-      As an int, we get 2^32-1 possible nodes per forest,
+      As an int, we get 2^31-1 possible nodes per forest,
       which should be enough for most applications.
-      As a long on a 64-bit machine, we get 2^64-1 possible nodes
+      As a long on a 64-bit machine, we get 2^63-1 possible nodes
       per forest, at the expense of nearly doubling the memory used.
       This also specifies the incoming count range for each node.
+
+      The default is int; to use long, build the library with
+      configure option --enable-64bit-handles.
+      The choice is recorded in meddly_config.h, which is installed
+      with this file, so applications always agree with the library.
   */
+#ifdef MEDDLY_64BIT_HANDLES
+  typedef long node_handle;
+#else
   typedef int  node_handle;
+#endif
 
   /** Node addresses.
       This is used for internal storage of a node,
@@ -254,6 +266,20 @@ namespace MEDDLY {
   /// Randomly select one state from a set of states
   extern const unary_opname* SELECT;
 
+  /** Transitive closure R+ of a relation (BOOLEAN, identity-reduced MXD),
+      by iterative squaring: C = C + C*C until C stops changing,
+      so the number of compositions is logarithmic in the diameter.
+  */
+  extern const unary_opname* TRANSITIVE_CLOSURE_SQUARE;
+
+  /** Transitive closure R+ of a relation (BOOLEAN, identity-reduced MXD),
+      saturation style: the relation is split by top level,
+      and the closure is built from the bottom level up;
+      at each level only the new paths, which start and end at
+      that level, are closed with iterative squaring.
+  */
+  extern const unary_opname* TRANSITIVE_CLOSURE_SAT;
+
   // ******************************************************************
   // *                    Named  binary operations                    *
   // ******************************************************************
@@ -275,6 +301,31 @@ namespace MEDDLY {
   /// Works for BOOLEAN forests.
   extern const binary_opname* CROSS;
 
+  /** Set predicates, for forests with range_type of BOOLEAN.
+      The result is a bool (see the matching apply()),
+      and no nodes are built: the check stops
+      as soon as the answer is known.
+      SUBSET: is every element of a also in b?
+      DISJOINT: is the intersection of a and b empty?
+      Both operands must have the same reduction rule.
+  */
+  extern const binary_opname* SUBSET;
+  extern const binary_opname* DISJOINT;
+
+  /** Generalized cofactor, following Coudert and Madre.
+      The first operand is any multi-terminal function f, the second
+      operand is a BOOLEAN care set c, and the result g is stored
+      in the same forest as f, and equals f wherever c is true.
+      At each node, values of the variable outside the care set are
+      mapped to another value, so g is usually smaller than f.
+      CONSTRAIN maps every variable the care set depends on;
+      RESTRICT also removes from the care set the variables
+      that f does not depend on, and is usually smaller still.
+      Both require fully-reduced forests.
+  */
+  extern const binary_opname* RESTRICT;
+  extern const binary_opname* CONSTRAIN;
+
   /// For forests with range_type of INTEGER and REAL. All operands must
   /// belong to the same forest.
   extern const binary_opname* MINIMUM;
@@ -355,6 +406,8 @@ namespace MEDDLY {
   /** Matrix multiplication, where the first argument is a matrix (MXD),
       the second argument is a matrix (MXD), and the result is a matrix (MXD),
       such that, C[m][n] += A[m][i] * B[i][n], for all m, n and i.
+      For BOOLEAN (identity-reduced) forests, this is the composition
+      of two relations: C[m][n] = OR of A[m][i] AND B[i][n].
   */
   extern const binary_opname* MM_MULTIPLY;
 
@@ -389,6 +442,47 @@ namespace MEDDLY {
   */
   const char* getLibraryInfo(int what = 0);
 
+  /** Set a global memory budget.
+      Between operations (on entry to and exit from the apply()
+      functions, and in reclaimMemory()), once the memory allocated
+      by the library gets within 1/8 of the budget, the following
+      remedies are tried, in order, until enough memory is reclaimed:
+        (1) remove stale compute table entries, which also discards
+            the disconnected nodes that only they kept alive,
+        (2) clear and shrink the compute tables,
+        (3) compact the node storage of all forests,
+        (4) reorder the variables of all forests (if allowed).
+      While an operation is running, node storage and compute tables
+      do not grow past the budget; when node storage cannot grow,
+      remedies (1) and (3) are tried before giving up.
+      Each step is reported to the loggers of the forests.
+      Only if the budget is still exceeded after all remedies,
+      an INSUFFICIENT_MEMORY error is thrown.
+        @param  bytes     The budget; 0 means no budget (the default).
+        @param  reorder   Allow variable reordering as a remedy.
+  */
+  void setMemoryBudget(size_t bytes, bool reorder = false);
+
+  /** Apply the memory budget remedies now, if we are close to the budget.
+      Must be called between operations.
+        @throws   INSUFFICIENT_MEMORY, if the budget is still exceeded.
+  */
+  void reclaimMemory();
+
+  /** Run operations with an explicit stack, instead of native recursion.
+      Recursion depth is then limited by heap memory, rather than by
+      the thread stack, which matters for domains with very many
+      variables.
+      Currently supported by the binary apply operations on
+      non-extensible levels (union, intersection, difference,
+      maximum, minimum, and the comparisons on sets), and by
+      forward saturation with a pregenerated relation, when no
+      checkpoints are written; other operations still recurse.
+      Node deletion never recurses.
+      Off by default; may be changed between operations.
+  */
+  void setExplicitStack(bool on);
+
   // ******************************************************************
   // *                   object creation  functions                   *
   // ******************************************************************
@@ -528,6 +622,17 @@ namespace MEDDLY {
   void apply(const binary_opname* op, const dd_edge &a, const dd_edge &b,
     dd_edge &c);
 
+  /** Apply a binary operator whose result is a bool, like SUBSET.
+      \a a and \a b may belong to different forests.
+
+      @param  op    Operator handle.
+      @param  a     First operand.
+      @param  b     Second operand.
+      @param  c     Output parameter: the result of \a a \a op \a b.
+  */
+  void apply(const binary_opname* op, const dd_edge &a, const dd_edge &b,
+    bool &c);
+
 
 };  // namespace MEDDLY
 
@@ -643,6 +748,15 @@ class MEDDLY::error {
       static size_t getGlobalPeakMemUsed();
       static size_t getGlobalPeakMemAlloc();
 
+      /// Global memory budget, in bytes; 0 means no budget.
+      static size_t getBudget();
+      /// Memory allocated, above which we should reclaim memory.
+      static size_t getBudgetTrigger();
+      static void setBudget(size_t b, size_t trigger);
+
+      /// Have we reached the budget trigger?
+      static bool isOverBudget();
+
     private:
       /// Current memory used 
       size_t memory_used;
@@ -658,6 +772,10 @@ class MEDDLY::error {
       static size_t global_memory_alloc;
       static size_t global_peak_used;
       static size_t global_peak_alloc;
+
+      // memory budget
+      static size_t budget;
+      static size_t budget_trigger;
   };
 
 // ******************************************************************
@@ -1133,6 +1251,13 @@ class MEDDLY::forest {
       reordering_type reorder;
       // Default variable swap strategy.
       variable_swap_type swap;
+      /// Number of threads used to gather cofactors when swapping
+      /// adjacent variables.  Ignored unless built with MEDDLY_THREADS.
+      unsigned swap_threads;
+      /// Number of threads used to read the diagonals when splitting
+      /// a pregenerated relation by levels.
+      /// Ignored unless built with MEDDLY_THREADS.
+      unsigned split_threads;
 
       /// Backend memory management mechanism for nodes.
       const memory_manager_style* nodemm;
@@ -1191,6 +1316,7 @@ class MEDDLY::forest {
 
       void setVarSwap();
       void setLevelSwap();
+      void setSwapThreads(unsigned n);
     }; // end of struct policies
 
     /// Collection of various stats for performance measurement
@@ -2307,6 +2433,7 @@ class MEDDLY::domain {
 
     friend void MEDDLY::destroyDomain(domain* &d);
     friend void MEDDLY::cleanup();
+    friend class memory_budget;
 
   public:
     bool hasForests() const;
@@ -165,6 +165,27 @@ inline size_t MEDDLY::memstats::getGlobalPeakMemAlloc()
   return global_peak_alloc;
 }
 
+inline size_t MEDDLY::memstats::getBudget()
+{
+  return budget;
+}
+
+inline size_t MEDDLY::memstats::getBudgetTrigger()
+{
+  return budget_trigger;
+}
+
+inline void MEDDLY::memstats::setBudget(size_t b, size_t trigger)
+{
+  budget = b;
+  budget_trigger = trigger;
+}
+
+inline bool MEDDLY::memstats::isOverBudget()
+{
+  return budget_trigger && (global_memory_alloc > budget_trigger);
+}
+
 // ******************************************************************
 // *                                                                *
 // *                                                                *
@@ -250,6 +271,10 @@ inline void MEDDLY::forest::policies::setLevelSwap() {
   swap = variable_swap_type::LEVEL;
 }
 
+inline void MEDDLY::forest::policies::setSwapThreads(unsigned n) {
+  swap_threads = n ? n : 1;
+}
+
 // end of struct policies
 
 // forest::statset::
@@ -62,6 +62,8 @@ namespace MEDDLY {
   // EXPERIMENTAL - matrix wrappers for unprimed, primed pairs of nodes
   // class unpacked_matrix;
   class relation_node;
+  class affine_relation_node;
+  class relation_node_pool;
   
   /*
   
@@ -100,6 +102,11 @@ namespace MEDDLY {
   class satotf_opname;
   class satimpl_opname;
   class constrained_opname;
+  class quantify_opname;
+  class cofactor_opname;
+  class rename_opname;
+  class nary_opname;
+  class trace_opname;
 
   class ct_initializer;
   class compute_table_style;
@@ -111,6 +118,7 @@ namespace MEDDLY {
   class specialized_operation;
 
   class global_rebuilder;
+  class memory_budget;
 
   // classes defined elsewhere
   class base_table;
@@ -156,6 +164,18 @@ namespace MEDDLY {
   */
   extern const satpregen_opname* SATURATION_BACKWARD;
 
+  /** Forward reachability using breadth-first search.
+      Transition relation is already known, as partitions;
+      each iteration images only the newly reached states.
+  */
+  extern const satpregen_opname* BFS_FORWARD;
+
+  /** Forward reachability using breadth-first search with chaining.
+      Same as BFS_FORWARD, except that states reached by one
+      partition are imaged by the later ones in the same iteration.
+  */
+  extern const satpregen_opname* CHAINED_BFS_FORWARD;
+
   /** Forward reachability using saturation.
       Transition relation is not completely known,
       will be built along with reachability set.
@@ -174,6 +194,74 @@ namespace MEDDLY {
   extern const constrained_opname* CONSTRAINED_BACKWARD_DFS;
   extern const constrained_opname* TRANSITIVE_CLOSURE_DFS;
 
+  // ******************************************************************
+  // *                                                                *
+  // *                Named quantification operations                 *
+  // *                                                                *
+  // ******************************************************************
+
+  /** Existential quantification.
+      The result does not depend on the quantified variables,
+      and is true wherever the argument is true for some value
+      of the quantified variables.
+  */
+  extern const quantify_opname* EXISTS;
+
+  /** Universal quantification.
+      The result does not depend on the quantified variables,
+      and is true wherever the argument is true for all values
+      of the quantified variables.
+  */
+  extern const quantify_opname* FORALL;
+
+  /** Existential quantification of a conjunction.
+      Binary operation; gives the same result as EXISTS applied to the
+      INTERSECTION of the two arguments, without building the
+      intersection first.
+  */
+  extern const quantify_opname* AND_EXISTS;
+
+  /** Cofactor.
+      Fixes some variables to given values; the result does not
+      depend on those variables.
+  */
+  extern const cofactor_opname* COFACTOR;
+
+  /** Renaming.
+      Moves a function onto a permutation of its variables,
+      in the same forest or another one.
+  */
+  extern const rename_opname* RENAME;
+
+  /** Shortest traces.
+      Walks backward from a target set, along minimum edge values
+      of a distance EV+MDD (as built by REACHABLE_STATES_DFS),
+      and returns one shortest path from an initial state.
+  */
+  extern const trace_opname* SHORTEST_TRACE;
+
+  // ******************************************************************
+  // *                                                                *
+  // *                    Named n-ary operations                      *
+  // *                                                                *
+  // ******************************************************************
+
+  /** N-ary union.
+      Same result as a chain of binary UNION operations,
+      but the operands are traversed together, so intermediate
+      results are never built.
+  */
+  extern const nary_opname* NARY_UNION;
+
+  /// N-ary intersection; see NARY_UNION.
+  extern const nary_opname* NARY_INTERSECTION;
+
+  /// N-ary sum, for integer or real forests; see NARY_UNION.
+  extern const nary_opname* NARY_PLUS;
+
+  /// N-ary maximum, for integer or real forests; see NARY_UNION.
+  extern const nary_opname* NARY_MAXIMUM;
+
   // ******************************************************************
   // *                                                                *
   // *                      Operation management                      *
@@ -552,6 +640,16 @@ public:
    */
   virtual bool equals(const relation_node* n) const;
   
+  /** Is this an affine piece: i goes to i + delta,
+   for lower <= i <= upper, and nothing else?
+   Saturation fires affine pieces in bulk, without nextOf().
+   The default returns false.
+   @param  delta   Output: change to the variable.
+   @param  lower   Output: smallest enabled value.
+   @param  upper   Output: largest enabled value, or -1 if none.
+   */
+  virtual bool isAffine(long &delta, long &lower, long &upper) const;
+  
 private:
   size_t signature;
   int level;
@@ -560,12 +658,136 @@ private:
   long* token_update;
   long piece_size;        
   
-  // used by the hash table in implicit_relation
+  // used by the hash table in relation_node_pool
   relation_node* hash_chain;
   
-  // friend class implicit_relation;
+  friend class relation_node_pool;
 };  // class relation_node
 
+// ******************************************************************
+// *                                                                *
+// *                  affine_relation_node  class                   *
+// *                                                                *
+// ******************************************************************
+
+/** Built-in affine piece of an implicit relation.
+ 
+ The variable goes from i to i + delta, if lower <= i <= upper.
+ This covers the usual Petri net arcs:
+ input arcs (delta < 0, lower = weight),
+ output arcs (delta > 0), inhibitor arcs (upper = bound),
+ and pure tests (delta = 0).
+ Register these with implicit_relation::registerNode(),
+ like any other relation_node.
+ */
+class MEDDLY::affine_relation_node : public relation_node {
+public:
+  /** Constructor.
+   @param  level   Level affected.
+   @param  down    Handle to a relation node below us.
+   @param  delta   Change to the variable.
+   @param  lower   Smallest enabled value.
+   @param  upper   Largest enabled value, or -1 for no upper bound.
+   */
+  affine_relation_node(int level, rel_node_handle down, long delta,
+    long lower = 0, long upper = -1);
+  virtual ~affine_relation_node();
+  
+  virtual long nextOf(long i);
+  virtual bool equals(const relation_node* n) const;
+  virtual bool isAffine(long &delta, long &lower, long &upper) const;
+  
+private:
+  long delta;
+  long lower;
+  long upper;
+};  // class affine_relation_node
+
+// ******************************************************************
+// *                                                                *
+// *                   relation_node_pool  class                    *
+// *                                                                *
+// ******************************************************************
+
+/** Unique table of relation_nodes, shared by implicit relations.
+
+ Equal nodes (according to relation_node::equals()) registered
+ in the same pool get the same handle, no matter which
+ implicit_relation registers them, so relations built over one
+ pool share node storage and the nextOf() values memoized in
+ each node.
+ Handle 1 is the terminal node, and is never freed.
+
+ Every registration adds a reference to the handle, and every
+ node holds a reference to its down node.
+ A node is destroyed, and its handle recycled, when its last
+ reference is dropped.
+ The pool itself is reference counted as well:
+ the creator holds the first link, and each implicit_relation
+ that uses the pool holds one more.
+ The creator releases its link when it no longer needs the pool,
+ with  if (pool->unlinkPool()) delete pool;
+ so the pool outlives whichever of them is done last.
+ Implemented in operations/sat_impl.cc.
+ */
+class MEDDLY::relation_node_pool {
+public:
+  /// The new pool has one link, held by the caller.
+  relation_node_pool();
+  ~relation_node_pool();
+
+  /// Add a link to the pool.
+  void linkPool();
+
+  /** Remove a link to the pool.
+   @return true, iff that was the last link and the pool
+           should now be deleted.
+   */
+  bool unlinkPool();
+
+  /** Register a relation node.
+   If an equal node is already in the pool, n is destroyed
+   and the existing handle is returned.
+   Either way, the handle gains one reference.
+   */
+  rel_node_handle registerNode(relation_node* n);
+
+  /** Find a node equal to n.
+   @return The handle of the equal node, or 0 if there is none.
+   */
+  rel_node_handle isUniqueNode(const relation_node* n) const;
+
+  /// Get the node with handle h, or 0 if there is none.
+  relation_node* nodeExists(rel_node_handle h) const;
+
+  /// Add a reference to handle h.
+  void linkNode(rel_node_handle h);
+
+  /// Remove a reference to handle h; destroy the node if unused.
+  void unlinkNode(rel_node_handle h);
+
+  /// Number of nodes in the pool, including the terminal.
+  long getNumNodes() const;
+
+private:
+  void expandTable();
+
+private:
+  /// Nodes by handle; 0 for unused handles.
+  std::vector<relation_node*> nodes;
+  /// References by handle; for unused handles, the next free handle.
+  std::vector<long> refs;
+  /// List of unused handles, or 0.
+  rel_node_handle free_list;
+  long num_nodes;
+
+  /// Hash table on signatures, chained through hash_chain.
+  relation_node** table;
+  size_t table_size;
+
+  long pool_links;
+};  // class relation_node_pool
+
 // ******************************************************************
 // *                                                                *
 // *                      unpacked_node  class                      *
@@ -646,6 +868,12 @@ class MEDDLY::unpacked_node {
     static unpacked_node* newIdentity(const expert_forest *f, int k, unsigned i, long ev, node_handle node, bool full);
     static unpacked_node* newIdentity(const expert_forest *f, int k, unsigned i, float ev, node_handle node, bool full);
 
+    /** Full reader for the primed node below row i of the unprimed
+        node u at level k.  If that level is skipped, the row is
+        redundant, or identity if f is an identity reduced relation.
+    */
+    static unpacked_node* newRow(const expert_forest *f, int k, const unpacked_node* u, unsigned i);
+
     /** Create a zeroed-out full node */
     static unpacked_node* newFull(const expert_forest *f, int level, unsigned tsz);
 
@@ -1933,6 +2161,19 @@ class MEDDLY::node_storage {
     */
     virtual void collectGarbage(bool shrink) = 0;
 
+    /** Move every stored node to fresh memory, in the given order,
+        so that nodes adjacent in the order are adjacent in memory.
+        Node handles do not change; the forest is told the new addresses.
+        The default does nothing and returns false.
+
+          @param  order   Handles of all nodes with storage, each once.
+          @param  n       Dimension of \a order.
+
+          @return   true on success; false if nodes cannot be relocated,
+                    in which case nothing was changed.
+    */
+    virtual bool relocateNodes(const node_handle* order, long n);
+
     /** Show various stats.
           @param  s       Output stream to write to
           @param  pad     Padding string, written at the start of
@@ -2134,6 +2375,8 @@ class MEDDLY::node_storage {
     void moveNodeOffset(node_handle node, node_address old_addr, 
         node_address new_addr);
 
+    node_address getNodeAddress(node_handle node) const;
+
     //
     // Methods for derived classes to deal with
     // members owned by the base class
@@ -2151,6 +2394,85 @@ class MEDDLY::node_storage {
 };
 
 
+// ******************************************************************
+// *                                                                *
+// *                      memory_budget  class                      *
+// *                                                                *
+// ******************************************************************
+
+/** Remedies for the global memory budget; see setMemoryBudget().
+
+    The budget is checked at two kinds of points.
+    Safe points, when no operation is running: the front-end apply()
+    functions, on entry and exit, and reclaimMemory().
+    There, every remedy may be used (see reclaim()).
+    Failure points, in the middle of an operation, where node storage
+    or the list of registered edges cannot grow, either because
+    the allocation failed or because it would exceed the budget.
+    There, only remedies that leave the nodes and compute table
+    entries of the running operation alone are used (see recover()),
+    and the caller tries the allocation once more.
+*/
+class MEDDLY::memory_budget {
+  public:
+    /** Try to reclaim memory, one remedy at a time.
+        Must be called only at a safe point.
+          @throws INSUFFICIENT_MEMORY if the budget is still exceeded.
+    */
+    static void reclaim();
+
+    /** Reclaim what can be reclaimed while an operation is running:
+        remove stale compute table entries, which discards the
+        disconnected nodes they held, then compact the node storage.
+        Called where an allocation failed; the caller should retry it.
+    */
+    static void recover();
+
+    /** Can we allocate this many more bytes, within the budget?
+        Always true if there is no budget, or while compacting.
+    */
+    static bool allowsGrowth(size_t bytes);
+
+    static void setReordering(bool r);
+
+    /** Marks a front-end call; the outermost one is a safe point.
+        Library code never calls the front end while it runs
+        an operation, but a guard makes sure of it.
+    */
+    class guard {
+      public:
+        guard();
+        ~guard();
+        /// Reclaim memory on the way out, if needed; never throws.
+        void leave();
+      private:
+        bool left;
+    };
+
+  private:
+    /// Report the remedy to the forest loggers.
+    static void logRemedy(const char* what);
+    /// Have we reclaimed enough?
+    static bool isRelieved();
+    /** Apply the remedies, as in reclaim().
+          @return false if the budget is still exceeded.
+    */
+    static bool relieve();
+
+    static void removeStales();
+    static void clearComputeTables();
+    static void compactForests();
+    static void reorderForests();
+
+    static bool reorder;
+    static bool reclaiming;
+    /// True while compacting; the copies are temporary.
+    static bool compacting;
+    /// Number of front-end calls in progress.
+    static int depth;
+};
+
+
 // ******************************************************************
 // *                                                                *
 // *                                                                *
@@ -2207,6 +2529,9 @@ class MEDDLY::expert_forest: public forest
     // *                                                          *
     // ************************************************************
 
+    /// The sign bit of a node handle; set for encoded terminals.
+    static node_handle terminal_bit();
+
     /** Encoding for booleans into (terminal) node handles */
     class bool_Tencoder {
         // -1 true
@@ -2493,6 +2818,8 @@ class MEDDLY::expert_forest: public forest
     /// If we don't use reference counts and instead mark and sweep,
     ///  then a node cannot be recovered once it is "unreachable"
     ///  because its children might have been recycled
+    /// While removeComputeTableEntriesForLevels() runs, nodes at the
+    /// given levels are reported as dead.
     MEDDLY::forest::node_status getNodeStatus(node_handle node) const;
 
   // ------------------------------------------------------------
@@ -2722,6 +3049,30 @@ class MEDDLY::expert_forest: public forest
      */
     node_handle modifyReducedNodeInPlace(unpacked_node* un, node_handle p);
 
+    /** Gather the cofactors for swapping the variables at level and level+1.
+        The nodes in hnodes must depend on both variables, and the levels
+        must already be renumbered: hnodes at level, the nodes of the
+        variable moved up at level+1.
+        For the i-th node, entry (i*lsize + k)*hsize + j of down is the
+        node reached by value j of the variable moved down and value k
+        of the variable moved up; if ev is not null, the same entry of ev
+        is the sum of the edge values along the way.
+        The forest is only read, so when built with MEDDLY_THREADS the
+        nodes are split across policies::swap_threads threads.
+    */
+    void gatherSwapCofactors(int level, const node_handle* hnodes, int n,
+        int hsize, int lsize, node_handle* down, long* ev) const;
+
+    /// Number of nodes whose cofactors are gathered at once during a swap.
+    static const int SWAP_BATCH = 4096;
+
+    /** Remove the compute table entries with a node, in this forest,
+        at a level from lo to hi inclusive (primed or unprimed).
+        Other entries, including those for other forests, are kept.
+        Called before swapping the variables at those levels.
+    */
+    void removeComputeTableEntriesForLevels(int lo, int hi);
+
   // ------------------------------------------------------------
   // virtual in the base class, but implemented here.
   // See meddly.h for descriptions of these methods.
@@ -2732,6 +3083,50 @@ class MEDDLY::expert_forest: public forest
     // virtual void compactMemory();
     virtual void showInfo(output &strm, int verbosity);
 
+    /** Compact the memory for all variables in this forest.
+        Stale compute table entries for this forest are removed first,
+        which discards the disconnected nodes that only they held;
+        then the node storage collects its garbage (for the simple
+        storage styles, the nodes are copied into fresh memory
+        without holes).
+    */
+    void compactMemory();
+
+    /// Node orders for compactMemory(node_layout).
+    enum node_layout {
+      /// Depth-first from the registered edges, parents before children.
+      DEPTH_FIRST,
+      /// By level, top level first; within a level, breadth-first
+      /// from the registered edges.
+      LEVEL_MAJOR
+    };
+
+    /** Compact the memory for this forest, and store the nodes
+        contiguously in the given order, so that traversals
+        touch neighboring memory.
+        Nodes not reachable from any registered edge
+        (for example, nodes kept alive by the compute tables)
+        are stored after the others.
+        Node handles do not change, so compute table entries
+        and dd_edges remain valid.
+        Memory for two copies of the nodes is needed while this runs.
+          @param  layout  Order to store the nodes.
+          @return   true on success; false if the node storage
+                    cannot relocate nodes, or memory ran out,
+                    in which case the forest is unchanged.
+    */
+    bool compactMemory(node_layout layout);
+
+    /// Logger for this forest, or 0 if none.
+    logger* getLogger() const;
+
+  protected:
+    /// Unlink the down pointers of a node we could not create,
+    /// and recycle it.
+    void dropUnusedNode(unpacked_node* un);
+
+  public:
+
   // ------------------------------------------------------------
   // abstract virtual, must be overridden.
   //
@@ -3025,8 +3420,14 @@ class MEDDLY::expert_forest: public forest
     /**
         Disconnects all downward pointers from p,
         and removes p from the unique table.
+        If recycle is set, the handle of p is recycled as well.
+        Children that become unreachable are deleted in a loop,
+        not recursively, so deep diagrams do not exhaust the stack.
     */
-    void deleteNode(node_handle p);
+    void deleteNode(node_handle p, bool recycle);
+
+    /// Delete one node; deleteNode() without the loop.
+    void deleteOneNode(node_handle p);
 
     /** Apply reduction rule to the temporary node and finalize it. 
         Once a node is reduced, its contents cannot be modified.
@@ -3034,8 +3435,18 @@ class MEDDLY::expert_forest: public forest
                         Or -1.
           @param  un    Unpacked node.
           @return       Handle to a node that encodes the same thing.
+          @throws       INSUFFICIENT_MEMORY, after dropping un.
     */
     node_handle createReducedHelper(int in, unpacked_node &nb);
+
+    /** Grab a handle and store nb with nodeMan->makeNode().
+        If that throws, the handle is given back, and nb's down pointers
+        are unlinked and nb is recycled, before the error propagates.
+          @param  nb    Unpacked node, reduced and not a duplicate.
+          @param  addr  Output: address of the stored node.
+          @return       The new node's handle.
+    */
+    node_handle makeNodeOrRecycle(unpacked_node &nb, node_address &addr);
   
     /** Create implicit node in the forest. Just add a handle and it points to original location
      @param  un    Relation node.
@@ -3088,6 +3499,17 @@ class MEDDLY::expert_forest: public forest
     // depth of delete/zombie stack; validate when 0
     int delete_depth;
 
+    // Node deletion in progress
+    bool deleting_nodes;
+    // Nodes to delete once the current deletion finishes;
+    // negated for nodes whose handle is not recycled.
+    std::vector<node_handle> pending_deletions;
+
+    // Levels whose compute table entries are being removed;
+    // empty when removing_lo > removing_hi.
+    int removing_lo;
+    int removing_hi;
+
     /// Node header information
     node_headers nodeHeaders;
 
@@ -3103,6 +3525,7 @@ class MEDDLY::expert_forest: public forest
 
     class nodecounter;
     class nodemarker;
+    class rootlister;
 };
 // end of expert_forest class.
 
@@ -3289,6 +3712,16 @@ class MEDDLY::satpregen_opname : public specialized_opname {
         virtual ~pregen_relation();
         void addToRelation(const dd_edge &r);
 
+        /** Add several relations at once.
+            For a relation "by levels", the relations added to the
+            same level are combined as a balanced binary tree
+            of unions, which is usually much cheaper than adding them
+            one at a time.
+              @param  r   Array of relations.
+              @param  n   Dimension of array r.
+        */
+        void addToRelation(const dd_edge* r, unsigned n);
+
         // Options for controlling the amount of processing performed by
         // \a finalize(splittingOption).
         enum splittingOption {
@@ -3336,7 +3769,7 @@ class MEDDLY::satpregen_opname : public specialized_opname {
         // subtracts the intersection of events[k] and adds it to events[k-1].
         void splitMxd(splittingOption split);
         // helper for finalize
-        // adds all event[k]; sets all event[k] to 0;
+        // adds all event[k], as a balanced tree; sets all event[k] to 0;
         // sets events[level(sum)] = sum
         void unionLevels();
 
@@ -3421,6 +3854,9 @@ class MEDDLY::satotf_opname : public specialized_opname {
         /// Is this an enabling subevent
         bool isEnabling() const;
 
+        /// Does this subevent depend on extensible variables?
+        bool usesExtensibleVariables() const;
+
         /**
           Rebuild the function to include the
           local state "index" for the variable "v".
@@ -3430,10 +3866,16 @@ class MEDDLY::satotf_opname : public specialized_opname {
         virtual void confirm(otf_relation &rel, int v, int index) = 0;
 
         /// If num_minterms > 0,
-        ///   Add all minterms to the root
-        ///   Delete all minterms.
+        ///   Build a diagram from the pending minterms only,
+        ///   union it into the root, and
+        ///   discard the pending minterms (their storage is kept).
+        /// The diagram of the newly added minterms is kept in delta.
         void buildRoot();
 
+        /// Get the diagram of the minterms added by the last buildRoot().
+        /// Empty if the last buildRoot() had nothing to add.
+        const dd_edge& getDelta() const;
+
         /// Debugging info
         void showInfo(output& out) const;
 
@@ -3442,13 +3884,19 @@ class MEDDLY::satotf_opname : public specialized_opname {
 
       protected:
         bool addMinterm(const int* from, const int* to);
-        bool usesExtensibleVariables() const;
 
         int* vars;
         int num_vars;
         dd_edge root;
+        dd_edge delta;
         int top;
         expert_forest* f;
+        // Pending minterms are stored contiguously in minterm_arena:
+        // minterm i occupies 2*minterm_width integers, the unprimed
+        // part followed by the primed part.
+        // unpminterms[i] and pminterms[i] point into the arena.
+        int* minterm_arena;
+        int minterm_width;
         int** unpminterms;
         int** pminterms;
         int num_minterms;
@@ -3523,7 +3971,13 @@ class MEDDLY::satotf_opname : public specialized_opname {
         void buildEventMask();
 
       private:
+        // Intersects e with every subevent root, except for subevent skip.
+        void conjunctSubevents(dd_edge &e, int skip) const;
+
         subevent** subevents;
+        // Subevent roots used for the last (successful) rebuild,
+        // or 0 if the event has never been built.
+        dd_edge* built_roots;
         int num_subevents;
         int top;
         int num_vars;
@@ -3739,10 +4193,17 @@ class MEDDLY::satimpl_opname: public specialized_opname {
 
             @param  inmdd       MDD forest containing initial states
             @param  outmdd      MDD forest containing result
+            @param  pool        Pool of relation nodes to register into,
+                                shared with other relations;
+                                the relation adds its own link
+                                to it, so the caller keeps (and
+                                must release) its link.
+                                If 0, a private pool is used.
 
             Not 100% sure we need these...
         */
-        implicit_relation(forest* inmdd, forest* relmxd, forest* outmdd);
+        implicit_relation(forest* inmdd, forest* relmxd, forest* outmdd,
+                          relation_node_pool* pool = 0);
         virtual ~implicit_relation();
       
         /// Returns the Relation forest that stores the mix of relation nodes and mxd nodes
@@ -3785,6 +4246,9 @@ class MEDDLY::satimpl_opname: public specialized_opname {
         */
         rel_node_handle isUniqueNode(relation_node* n);
 
+        /// Returns the pool holding the relation nodes.
+        relation_node_pool* getNodePool() const;
+
 
         /** Indicate that there will be no more registered nodes.
             Allows us to preprocess the events or cleanup or convert
@@ -3813,16 +4277,11 @@ class MEDDLY::satimpl_opname: public specialized_opname {
         int num_levels;
 
       private:
+        /// Unique table of relation nodes, possibly shared.
+        relation_node_pool* node_pool;
 
-        /// Last used ID of \a relation node.
-        long last_in_node_array;
-
-      private:
-        // TBD - add a data structure for the "uniqueness table"
-        // of relation_nodes, so if we register a node that
-        // is already present in a node_array, we can detect it.
-
-        std::unordered_map<rel_node_handle, relation_node*> impl_unique;
+        /// Handles registered by this relation; one reference each.
+        std::vector<rel_node_handle> registered;
 
       private:
         // TBD - add a data structure for list of events with top level k,
@@ -3936,6 +4395,337 @@ public:
 	};
 };
 
+// ******************************************************************
+// *                                                                *
+// *                     quantify_opname  class                     *
+// *                                                                *
+// ******************************************************************
+
+/** Quantification operation names.
+    Implemented in operations/quantify.cc
+
+    The variables to quantify are part of the arguments, so an
+    operation is built once per set of variables, for example:
+
+      bool* vars = new bool[K+1];     // vars[k]: quantify variable k
+      ...
+      specialized_operation* op = EXISTS->buildOperation(
+        new quantify_opname::quantify_args(f, vars)
+      );
+      op->compute(a, c);
+      destroyOperation(op);
+*/
+class MEDDLY::quantify_opname : public specialized_opname {
+  public:
+    quantify_opname(const char* n);
+    virtual ~quantify_opname();
+
+    /// Arguments should have type "quantify_args".
+    virtual specialized_operation* buildOperation(arguments* a) const = 0;
+
+    /** Forest and variables for a quantification operation.
+        The forest must be multi-terminal, boolean, and either
+        fully reduced, or (for relations) identity reduced.
+        Arguments and result are all in the same forest.
+    */
+    class quantify_args : public specialized_opname::arguments {
+      public:
+        /** Constructor.
+              @param  f       Forest for arguments and result.
+              @param  vars    Variables to quantify, an array of dimension
+                              (number of variables + 1);
+                              vars[k] is true to quantify variable k.
+                              The array is copied.
+              @param  pvars   For relations: primed variables to quantify,
+                              same format as vars.
+                              If null, no primed variables are quantified.
+        */
+        quantify_args(forest* f, const bool* vars, const bool* pvars = 0);
+        virtual ~quantify_args();
+
+        inline forest* getForest() const { return F; }
+        inline bool isQuantified(int k) const { return vars[k]; }
+        inline bool isPrimedQuantified(int k) const { return pvars[k]; }
+
+      private:
+        forest* F;
+        bool* vars;
+        bool* pvars;
+    };
+};
+
+// ******************************************************************
+// *                                                                *
+// *                     cofactor_opname  class                     *
+// *                                                                *
+// ******************************************************************
+
+/** Cofactor operation names.
+    Implemented in operations/cofactor.cc
+
+    As for quantification, the variable values are part of the
+    arguments, and an operation is built once per assignment.
+*/
+class MEDDLY::cofactor_opname : public specialized_opname {
+  public:
+    cofactor_opname(const char* n);
+    virtual ~cofactor_opname();
+
+    /// Arguments should have type "cofactor_args".
+    virtual specialized_operation* buildOperation(arguments* a) const = 0;
+
+    /** Forest and variable assignment for a cofactor operation.
+        The forest must be multi-terminal, and either fully reduced,
+        or (for relations) identity reduced.
+        Argument and result are in the same forest.
+    */
+    class cofactor_args : public specialized_opname::arguments {
+      public:
+        /** Constructor.
+              @param  f       Forest for argument and result.
+              @param  vals    Values of the variables, an array of
+                              dimension (number of variables + 1);
+                              vals[k] is the value for variable k,
+                              or DONT_CARE to leave it free.
+                              The array is copied.
+              @param  pvals   For relations: values of the primed
+                              variables, same format as vals.
+                              If null, primed variables are free.
+        */
+        cofactor_args(forest* f, const int* vals, const int* pvals = 0);
+        virtual ~cofactor_args();
+
+        inline forest* getForest() const { return F; }
+        inline int getValue(int k) const { return vals[k]; }
+        inline int getPrimedValue(int k) const { return pvals[k]; }
+
+      private:
+        forest* F;
+        int* vals;
+        int* pvals;
+    };
+};
+
+// ******************************************************************
+// *                                                                *
+// *                      rename_opname  class                      *
+// *                                                                *
+// ******************************************************************
+
+/** Renaming operation names.
+    Implemented in operations/rename.cc
+
+    The variable map is part of the arguments, and an operation
+    is built once per map.  Maps that preserve the variable order
+    simply relabel the nodes; other maps rebuild the function
+    one variable at a time.
+*/
+class MEDDLY::rename_opname : public specialized_opname {
+  public:
+    rename_opname(const char* n);
+    virtual ~rename_opname();
+
+    /// Arguments should have type "rename_args".
+    virtual specialized_operation* buildOperation(arguments* a) const = 0;
+
+    /** Forests and variable map for a renaming operation.
+        Both forests must be multi-terminal, with the same range,
+        and either both fully reduced, or both identity reduced
+        (relations only).
+    */
+    class rename_args : public specialized_opname::arguments {
+      public:
+        /** Constructor.
+              @param  inF       Forest containing the argument.
+              @param  outF      Forest containing the result;
+                                may be the same as inF.
+              @param  map       Variable map, an array of dimension
+                                (number of variables + 1);
+                                the variable at level k in inF
+                                becomes the variable at level map[k]
+                                in outF.  Must be one to one,
+                                between variables of the same size.
+                                map[k] may be 0 for levels the
+                                argument does not depend on; if it
+                                does, compute() throws INVALID_ASSIGNMENT.
+                                The array is copied.
+              @param  transpose For relations: if true, unprimed
+                                variables also become primed and
+                                vice versa.
+        */
+        rename_args(forest* inF, forest* outF, const int* map,
+          bool transpose = false);
+        virtual ~rename_args();
+
+        inline forest* getInForest() const { return inF; }
+        inline forest* getOutForest() const { return outF; }
+        inline int getMap(int k) const { return map[k]; }
+        inline bool isTranspose() const { return transpose; }
+
+        /** Does the map keep the variable order of the mapped levels,
+            without transposing?
+        */
+        bool preservesOrder() const;
+
+      private:
+        forest* inF;
+        forest* outF;
+        int* map;
+        bool transpose;
+    };
+};
+
+// ******************************************************************
+// *                                                                *
+// *                      trace_opname  class                       *
+// *                                                                *
+// ******************************************************************
+
+/** Trace extraction operation names.
+    Implemented in operations/trace.cc
+
+    The operation is built once per distance function and list
+    of events, and then asked for traces to any number of targets:
+
+      specialized_operation* op = SHORTEST_TRACE->buildOperation(
+        new trace_opname::trace_args(dist, events, n)
+      );
+      trace_opname::trace t;
+      op->compute(target, t);
+
+    The trace is found one step at a time, from the target back
+    to an initial state; no sets of states are built.
+*/
+class MEDDLY::trace_opname : public specialized_opname {
+  public:
+    trace_opname(const char* n);
+    virtual ~trace_opname();
+
+    /// Arguments should have type "trace_args".
+    virtual specialized_operation* buildOperation(arguments* a) const = 0;
+
+    /** Distances and events for a trace extraction operation.
+        The distance function must be an EV+MDD that gives 0 for
+        initial states, infinity (no path) for unreachable states,
+        and for every other reachable state s, one more than the
+        smallest distance of a state with an event to s.
+        The events must be boolean MxDs, fully or identity reduced,
+        over the same domain; their union is the transition relation.
+    */
+    class trace_args : public specialized_opname::arguments {
+      public:
+        /** Constructor.
+              @param  dist      Distance function.
+              @param  events    Array of events; the dd_edges are copied.
+              @param  n         Dimension of array events.
+        */
+        trace_args(const dd_edge &dist, const dd_edge* events, unsigned n);
+        virtual ~trace_args();
+
+        inline const dd_edge& getDistances() const { return dist; }
+        inline const dd_edge& getEvent(unsigned i) const {
+          MEDDLY_DCASSERT(i<num_events);
+          return events[i];
+        }
+        inline unsigned getNumEvents() const { return num_events; }
+
+      private:
+        dd_edge dist;
+        dd_edge* events;
+        unsigned num_events;
+    };
+
+    /** A path s_0, ..., s_n, where s_0 is an initial state, and
+        some event takes each state s_{i-1} to s_i.
+        States are arrays indexed by variable, like the minterms
+        given to createEdge(); element 0 is unused.
+    */
+    class trace {
+      public:
+        trace();
+
+        /// Number of states on the path; 0 if there is no path.
+        inline unsigned getNumStates() const {
+          return num_states;
+        }
+        /// State i, for 0 <= i < getNumStates().
+        inline const int* getState(unsigned i) const {
+          MEDDLY_DCASSERT(i<num_states);
+          return states.data() + (num_states-1-i) * size_t(num_vars+1);
+        }
+        /// Index of the event from state i-1 to state i, for i > 0.
+        inline unsigned getEvent(unsigned i) const {
+          MEDDLY_DCASSERT(i>0 && i<num_states);
+          return events[num_states-1-i];
+        }
+
+        /// Remove every state.
+        void clear();
+
+        /** Start a path (backwards) at its last state.
+              @param  state   Last state; copied.
+              @param  nv      Number of variables.
+        */
+        void start(const int* state, int nv);
+
+        /** Extend the path backwards.
+              @param  state   New first state; copied.
+              @param  event   Event from state to the old first state.
+        */
+        void addPredecessor(const int* state, unsigned event);
+
+      private:
+        // states and events are stored from the last one
+        std::vector<int> states;
+        std::vector<unsigned> events;
+        unsigned num_states;
+        int num_vars;
+    };
+};
+
+// ******************************************************************
+// *                                                                *
+// *                       nary_opname  class                       *
+// *                                                                *
+// ******************************************************************
+
+/** N-ary operation names.
+    Implemented in operations/nary.cc
+
+    The operation is built once per forest, and then applied
+    to any number of operands:
+
+      specialized_operation* op = NARY_UNION->buildOperation(
+        new nary_opname::nary_args(f)
+      );
+      op->compute(sets, n, c);
+      destroyOperation(op);
+*/
+class MEDDLY::nary_opname : public specialized_opname {
+  public:
+    nary_opname(const char* n);
+    virtual ~nary_opname();
+
+    /// Arguments should have type "nary_args".
+    virtual specialized_operation* buildOperation(arguments* a) const = 0;
+
+    /** Forest for an n-ary operation.
+        The forest must be multi-terminal, and either fully reduced,
+        quasi reduced (sets only) or identity reduced (relations only).
+        Operands and result are all in the same forest.
+    */
+    class nary_args : public specialized_opname::arguments {
+      public:
+        nary_args(forest* f);
+        virtual ~nary_args();
+
+        inline forest* getForest() const { return F; }
+
+      private:
+        forest* F;
+    };
+};
+
 // ******************************************************************
 // *                                                                *
 // *                         ct_object class                        *
@@ -4670,6 +5460,8 @@ class MEDDLY::operation {
     static unsigned list_alloc;
     // declared and initialized in meddly.cc
     static unsigned free_list;
+    // declared and initialized in meddly.cc
+    static bool explicit_stack;
 
     // should ONLY be called during library cleanup.
     static void destroyAllOps();
@@ -4743,6 +5535,12 @@ class MEDDLY::operation {
     operation* getNext();
 
     static bool usesMonolithicComputeTable();
+
+    /** Should operations that support it use an explicit stack
+        of frames, instead of native recursion?
+    */
+    static bool usesExplicitStack();
+    static void setExplicitStack(bool on);
     static void removeStalesFromMonolithic();
     static void removeAllFromMonolithic();
 
@@ -4857,6 +5655,9 @@ class MEDDLY::binary_operation : public operation {
     */
     void compute(const dd_edge &ar1, const dd_edge &ar2, dd_edge &res);
 
+    /// For operations whose result is a bool, like SUBSET.
+    virtual void compute(const dd_edge &ar1, const dd_edge &ar2, bool &res);
+
     virtual void computeDDEdge(const dd_edge &ar1, const dd_edge &ar2, dd_edge &res)
       = 0;
 
@@ -4929,6 +5730,32 @@ class MEDDLY::specialized_operation : public operation {
         Default behavior is to throw an exception.
     */
     virtual void compute(const dd_edge &ar1, const dd_edge &ar2, const dd_edge &ar3, dd_edge &res);
+
+    /** For n-ary operations.
+        Default behavior is to throw an exception.
+    */
+    virtual void compute(const dd_edge* args, unsigned n, dd_edge &res);
+
+    /** For trace extraction.
+        Default behavior is to throw an exception.
+    */
+    virtual void compute(const dd_edge &arg, trace_opname::trace &res);
+
+    /** Checkpointing, for long-running operations (saturation).
+        Once at least \a seconds seconds have passed since the last
+        checkpoint, the operation writes its partial result, and any
+        other state needed to continue, to file \a filename
+        at its next safe point.
+        Default behavior is to throw an exception.
+    */
+    virtual void enableCheckpoints(const char* filename, long seconds);
+
+    /** Continue an operation from a checkpoint file.
+        Like compute(const dd_edge&, dd_edge&), but the operation starts
+        from the state saved in \a filename instead of an argument.
+        Default behavior is to throw an exception.
+    */
+    virtual void resume(const char* filename, dd_edge &res);
 };
 
 // ******************************************************************
@@ -4941,46 +5768,31 @@ class MEDDLY::specialized_operation : public operation {
     The source and target forests may have different variable orders.
     While rebuilding, extra nodes may be created in the source forest
     because of the restrict operation.
+
+    Intermediate results are kept in two bounded tables, in the style
+    of the compute tables: a direct-mapped table for restrictions and
+    a set-associative table for transformed nodes, whose partial
+    assignments are packed into bit vectors.  Entries are overwritten
+    when their slot is needed, so memory use is fixed by the table size
+    given to the constructor.
 */
 
 class MEDDLY::global_rebuilder {
 private:
-  struct RestrictKey {
+  struct RestrictEntry {
     node_handle p;
+    node_handle result;
+    // Restricted variable, negated for index 0.
     int var;
-    int idx;
-
-    bool operator==(const RestrictKey &other) const {
-      return (p == other.p && var == other.var && idx == other.idx);
-    }
-  };
-
-  struct RestrictKeyHasher {
-    size_t operator()(const RestrictKey &key) const;
-  };
-
-  struct TransformKey {
-    int sig;
-//    int var;
-
-    bool operator==(const TransformKey &other) const {
-      return sig == other.sig;
-//      return (sig == other.sig && var == other.var);
-    }
+    unsigned epoch;
   };
 
   struct TransformEntry {
-    // Partial assignment
-    std::vector<int> pa;
+    int sig;
+    // Source root the partial assignment applies to; 0 if unused.
+    node_handle root;
+    // Node in the target forest; the table holds a link to it.
     node_handle p;
-
-    bool operator==(const TransformEntry &other) const {
-      return p == other.p;
-    }
-  };
-
-  struct TransformKeyHasher {
-    size_t operator()(const TransformKey &key) const;
   };
 
   class SignatureGenerator {
@@ -5014,8 +5826,20 @@ private:
     int signature(node_handle p) override;
   };
 
-  std::unordered_map<RestrictKey, node_handle, RestrictKeyHasher> _computed_restrict;
-  std::unordered_multimap<TransformKey, TransformEntry, TransformKeyHasher> _computed_transform;
+  RestrictEntry* _restrict_table;
+  unsigned _restrict_mask;
+  unsigned _restrict_epoch;
+
+  TransformEntry* _transform_table;
+  // Packed partial assignments: for each entry, _pa_words words of
+  // "assigned" bits followed by _pa_words words of "value" bits,
+  // indexed by variable.
+  unsigned long* _transform_pa;
+  unsigned _transform_mask;
+  unsigned _transform_victim;
+  int _pa_words;
+  std::vector<int> _pa_buf;
+
   SignatureGenerator* _sg;
 
   expert_forest* _source;
@@ -5029,6 +5853,16 @@ private:
 
   bool restrict_exist(node_handle p, const std::vector<int>& pa, int start,
       node_handle& result);
+
+  bool findRestrict(node_handle p, int var, node_handle& result) const;
+  void saveRestrict(node_handle p, int var, node_handle result);
+  void clearRestrict();
+
+  void saveTransform(int sig, const std::vector<int>& pa, node_handle pt);
+  // Expand the packed assignment of an entry, ordered by source level
+  // from the top.
+  void unpackAssignment(unsigned slot, std::vector<int>& pa) const;
+
   int signature(node_handle p) const;
 
   // Return the top variable in the sub-order of the target variable order
@@ -5039,10 +5873,28 @@ private:
 public:
   friend class SignatureGenerator;
 
-  global_rebuilder(expert_forest* source, expert_forest* target);
+  /** Constructor.
+        @param  source      Forest to rebuild from.
+        @param  target      Forest to rebuild into.
+        @param  cache_size  Number of entries in each of the tables,
+                            rounded up to a power of two.
+  */
+  global_rebuilder(expert_forest* source, expert_forest* target,
+      unsigned cache_size = 65536);
   ~global_rebuilder();
 
   dd_edge rebuild(const dd_edge& e);
+
+  /** Rebuild several dd_edges in one pass.
+      The tables are kept across the roots, so work on sub-diagrams
+      shared between roots is done once.
+        @param  src   Array of \a n edges in the source forest.
+        @param  dst   Array of \a n edges attached to the target forest;
+                      on return, dst[i] is the rebuilt src[i].
+        @param  n     Number of edges.
+  */
+  void rebuild(const dd_edge* src, dd_edge* dst, int n);
+
   void clearCache();
   double hitRate() const;
 };
@@ -1266,8 +1266,7 @@ MEDDLY::node_headers::uncacheNode(MEDDLY::node_handle p)
         parent.stats.unreachable_nodes--;
 #endif
 
-        parent.deleteNode(p);
-        recycleNodeHandle(p);
+        parent.deleteNode(p, true);
       }
   }
 
@@ -1313,8 +1312,7 @@ MEDDLY::node_headers::uncacheNode(MEDDLY::node_handle p)
 #ifdef TRACK_UNREACHABLE_NODES
       parent.stats.unreachable_nodes--;
 #endif
-      parent.deleteNode(p);
-      recycleNodeHandle(p);
+      parent.deleteNode(p, true);
     }
   }
 
@@ -1481,8 +1479,7 @@ MEDDLY::node_headers::unlinkNode(node_handle p)
   // If we're not in any caches, delete
   //
   if (0==address[p].cache_count) {
-        parent.deleteNode(p);
-        recycleNodeHandle(p);
+        parent.deleteNode(p, true);
         return;
   }
 
@@ -1491,7 +1488,7 @@ MEDDLY::node_headers::unlinkNode(node_handle p)
   //
   
   if (pessimistic) {
-    parent.deleteNode(p);
+    parent.deleteNode(p, false);
   } else {
 #ifdef TRACK_UNREACHABLE_NODES
     parent.stats.unreachable_nodes++;
@@ -1529,8 +1526,7 @@ MEDDLY::node_headers::unlinkNode(node_handle p)
     //
     // Unreachable and not in any caches.  Delete and recycle handle.
     //
-    parent.deleteNode(p);
-    recycleNodeHandle(p);
+    parent.deleteNode(p, true);
     return;
   }
   
@@ -1538,7 +1534,7 @@ MEDDLY::node_headers::unlinkNode(node_handle p)
     //
     // Delete; keep handle until caches are cleared.
     //
-    parent.deleteNode(p);
+    parent.deleteNode(p, false);
   } else {
     //
     // Optimistic.  Keep unreachables around.
@@ -1820,12 +1816,25 @@ MEDDLY::node_storage::moveNodeOffset(MEDDLY::node_handle node, node_address old_
   parent->moveNodeOffset(node, old_addr, new_addr);
 }
 
+inline MEDDLY::node_address
+MEDDLY::node_storage::getNodeAddress(MEDDLY::node_handle node) const
+{
+  MEDDLY_DCASSERT(parent);
+  return parent->getNodeAddress(node);
+}
+
 // ******************************************************************
 // *                                                                *
 // *                 inlined  expert_forest methods                 *
 // *                                                                *
 // ******************************************************************
 
+inline MEDDLY::node_handle
+MEDDLY::expert_forest::terminal_bit()
+{
+  return node_handle(1) << (8*sizeof(node_handle) - 1);
+}
+
 inline MEDDLY::node_handle
 MEDDLY::expert_forest::bool_Tencoder::value2handle(bool v)
 {
@@ -1845,14 +1854,13 @@ MEDDLY::expert_forest::bool_Tencoder::handle2value(MEDDLY::node_handle h)
 inline MEDDLY::node_handle
 MEDDLY::expert_forest::int_Tencoder::value2handle(int v)
 {
-  MEDDLY_DCASSERT(4 == sizeof(MEDDLY::node_handle));
   if (v < -1073741824 || v > 1073741823) {
     // Can't fit in 31 bits (signed)
     throw error(error::VALUE_OVERFLOW, __FILE__, __LINE__);
   }
   if (v)
-    v |= 0x80000000; // sets the sign bit
-  return v;
+    return node_handle(v) | terminal_bit(); // sets the sign bit
+  return 0;
 }
 
 inline int
@@ -1860,31 +1868,29 @@ MEDDLY::expert_forest::int_Tencoder::handle2value(MEDDLY::node_handle h)
 {
   // << 1 kills the sign bit
   // >> 1 puts us back, and extends the (new) sign bit
-  return (h << 1) >> 1;
+  return int((h << 1) >> 1);
 }
 
 inline MEDDLY::node_handle
 MEDDLY::expert_forest::float_Tencoder::value2handle(float v)
 {
-  MEDDLY_DCASSERT(4 == sizeof(MEDDLY::node_handle));
   MEDDLY_DCASSERT(sizeof(float) <= sizeof(MEDDLY::node_handle));
   if (0.0 == v)
     return 0;
   intfloat x;
   x.real = v;
   // strip lsb in fraction, and add sign bit
-  return node_handle( (unsigned(x.integer) >> 1) | 0x80000000 );
+  return node_handle(unsigned(x.integer) >> 1) | terminal_bit();
 }
 
 inline float
 MEDDLY::expert_forest::float_Tencoder::handle2value(MEDDLY::node_handle h)
 {
-  MEDDLY_DCASSERT(4 == sizeof(MEDDLY::node_handle));
   MEDDLY_DCASSERT(sizeof(float) <= sizeof(MEDDLY::node_handle));
   if (0 == h)
     return 0.0;
   intfloat x;
-  x.integer = (h << 1); // remove sign bit
+  x.integer = int(h << 1); // remove sign bit
   return x.real;
 }
 
@@ -2065,6 +2071,30 @@ MEDDLY::expert_forest::changeMemStats()
   return mstats;
 }
 
+inline bool
+MEDDLY::memory_budget::allowsGrowth(size_t bytes)
+{
+  const size_t budget = memstats::getBudget();
+  if (0==budget || compacting) return true;
+  return memstats::getGlobalMemAlloc() + bytes <= budget;
+}
+
+// ******************************************************************
+
+inline MEDDLY::forest::logger*
+MEDDLY::expert_forest::getLogger() const
+{
+  return theLogger;
+}
+
+inline void
+MEDDLY::expert_forest::dropUnusedNode(MEDDLY::unpacked_node *un)
+{
+  const int rawsize = un->isSparse() ? un->getNNZs() : un->getSize();
+  for (int i = 0; i<rawsize; i++) unlinkNode(un->d(i));
+  unpacked_node::recycle(un);
+}
+
 inline unsigned char
 MEDDLY::expert_forest::edgeBytes() const
 {
@@ -2433,6 +2463,13 @@ MEDDLY::expert_forest::getNodeStatus(MEDDLY::node_handle node) const
   if (isDeletedNode(node)) {
     return MEDDLY::forest::DEAD;
   }
+  if (removing_lo <= removing_hi) {
+    int k = getNodeLevel(node);
+    if (k < 0) k = -k;
+    if (k >= removing_lo && k <= removing_hi) {
+      return MEDDLY::forest::DEAD;
+    }
+  }
   // Active node.
 
   // If we're using reference counts,
@@ -2523,6 +2560,7 @@ MEDDLY::expert_forest::createReducedNode(int in, MEDDLY::unpacked_node *un)
   MEDDLY_DCASSERT(un);
   MEDDLY_DCASSERT(un->isBuildNode());
   un->computeHash();
+  // if this throws, un and its down pointers have been dropped
   MEDDLY::node_handle q = createReducedHelper(in, *un);
 #ifdef TRACK_DELETIONS
   printf("Created node %d\n", q);
@@ -2552,6 +2590,7 @@ MEDDLY::expert_forest::createReducedNode(int in, MEDDLY::unpacked_node *un, T& e
   normalize(*un, ev);
   MEDDLY_DCASSERT(ev >= 0);
   un->computeHash();
+  // if this throws, un and its down pointers have been dropped
   node = createReducedHelper(in, *un);
 #ifdef TRACK_DELETIONS
   printf("Created node %d\n", node);
@@ -2785,6 +2824,11 @@ MEDDLY::satotf_opname::subevent::getRoot() const {
   return root;
 }
 
+inline const MEDDLY::dd_edge&
+MEDDLY::satotf_opname::subevent::getDelta() const {
+  return delta;
+}
+
 inline bool
 MEDDLY::satotf_opname::subevent::usesExtensibleVariables() const {
   return uses_extensible_variables;
@@ -2917,6 +2961,45 @@ MEDDLY::relation_node::setTokenUpdate(long* n_token_update)
   token_update = n_token_update;
 }
 
+// ******************************************************************
+// *                                                                *
+// *               inlined  relation_node_pool methods              *
+// *                                                                *
+// ******************************************************************
+
+inline void
+MEDDLY::relation_node_pool::linkPool()
+{
+  pool_links++;
+}
+
+inline bool
+MEDDLY::relation_node_pool::unlinkPool()
+{
+  MEDDLY_DCASSERT(pool_links > 0);
+  return 0==--pool_links;
+}
+
+inline MEDDLY::relation_node*
+MEDDLY::relation_node_pool::nodeExists(rel_node_handle h) const
+{
+  if (h <= 0 || size_t(h) >= nodes.size()) return 0;
+  return nodes[h];
+}
+
+inline void
+MEDDLY::relation_node_pool::linkNode(rel_node_handle h)
+{
+  MEDDLY_DCASSERT(nodeExists(h));
+  refs[h]++;
+}
+
+inline long
+MEDDLY::relation_node_pool::getNumNodes() const
+{
+  return num_nodes;
+}
+
 // ******************************************************************
 // *                                                                *
 // *                 inlined  satimpl_opname methods                *
@@ -2927,11 +3010,13 @@ MEDDLY::relation_node::setTokenUpdate(long* n_token_update)
 inline MEDDLY::relation_node*
 MEDDLY::satimpl_opname::implicit_relation::nodeExists(rel_node_handle n)
 {
-  std::unordered_map<rel_node_handle, relation_node*>::iterator finder = impl_unique.find(n);
-  if(finder!=impl_unique.end())
-    return finder->second;
-  else
-    return NULL;
+  return node_pool->nodeExists(n);
+}
+
+inline MEDDLY::relation_node_pool*
+MEDDLY::satimpl_opname::implicit_relation::getNodePool() const
+{
+  return node_pool;
 }
 
 inline bool
@@ -3015,7 +3100,7 @@ inline bool
 MEDDLY::satimpl_opname::implicit_relation::isConfirmedState(int level,int i)
 {
 
-  return (i < insetF->getLevelSize(level) && confirmed[level][i]);
+  return (i < confirmed_array_size[level] && confirmed[level][i]);
 }
 
 
@@ -3595,6 +3680,18 @@ MEDDLY::operation::usesMonolithicComputeTable()
   return Monolithic_CT;
 }
 
+inline bool
+MEDDLY::operation::usesExplicitStack()
+{
+  return explicit_stack;
+}
+
+inline void
+MEDDLY::operation::setExplicitStack(bool on)
+{
+  explicit_stack = on;
+}
+
 inline unsigned
 MEDDLY::operation::getIndex() const
 {
@@ -286,6 +286,10 @@ MEDDLY::node_address MEDDLY::hole_manager<INT>::allocateFromArray(size_t numSlot
       size_t want_size = last_used_slot + numSlots;
       want_size += want_size/2;
       ok = resize(want_size);
+      if (!ok) {
+        // Near the memory budget?  Grab just what we need.
+        ok = resize(last_used_slot + numSlots + 1);
+      }
     }
 
     if (!ok) {
@@ -325,6 +329,12 @@ bool MEDDLY::hole_manager<INT>::resize(size_t new_alloc)
   printf(" data %lx, new size %ld\n", (size_t)data, new_alloc);
 #endif
 
+  if (new_alloc > data_alloc) {
+    if (!memory_budget::allowsGrowth((new_alloc - data_alloc) * sizeof(INT))) {
+      return false;
+    }
+  }
+
   INT* new_data = (INT*) realloc(data, new_alloc * sizeof(INT));
 
 #ifdef TRACE_REALLOCS
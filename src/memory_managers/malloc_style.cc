@@ -109,6 +109,7 @@ MEDDLY::malloc_manager::~malloc_manager()
 MEDDLY::node_address MEDDLY::malloc_manager::requestChunk(size_t &numSlots)
 {
   size_t bytes = numSlots * granularity;
+  if (!memory_budget::allowsGrowth(bytes)) return 0;
   void* chunk = malloc(bytes);
   if (chunk) {
     bytes_allocd_not_freed += bytes;
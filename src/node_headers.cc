@@ -1371,7 +1371,7 @@ void MEDDLY::node_headers::expandHandleList()
 #ifdef OLD_NODE_HEADERS
       for (node_handle p=1; p<=a_last; p++) {
         if (address[p].incoming_count) continue;
-        if (!isDeleted(p)) parent.deleteNode(p);
+        if (!isDeleted(p)) parent.deleteNode(p, false);
       }
 #else
       MEDDLY_DCASSERT(is_reachable);
@@ -1379,7 +1379,7 @@ void MEDDLY::node_headers::expandHandleList()
       for (;;) {
           unrch = is_reachable->firstZero(++unrch);
           if (unrch >= a_size) break;
-          if (!isDeleted(unrch)) parent.deleteNode(unrch);
+          if (!isDeleted(unrch)) parent.deleteNode(unrch, false);
       }
 #endif
 
@@ -254,6 +254,21 @@ void MEDDLY::unpacked_node::initIdentity(const expert_forest *f, int k,
   }
 }
 
+MEDDLY::unpacked_node* MEDDLY::unpacked_node::newRow(const expert_forest *f,
+  int k, const unpacked_node* u, unsigned i)
+{
+  MEDDLY_DCASSERT(f);
+  MEDDLY_DCASSERT(u);
+  const node_handle p = u->d(i);
+  if (!isLevelAbove(-k, f->getNodeLevel(p))) {
+    return newFromNode(f, p, true);
+  }
+  if (f->isForRelations() && f->isIdentityReduced()) {
+    return newIdentity(f, -k, i, p, true);
+  }
+  return newRedundant(f, -k, p, true);
+}
+
 /*
   Usage
 */
@@ -703,6 +718,11 @@ MEDDLY::node_storage::~node_storage()
   // nothing, derived classes must handle everything
 }
 
+bool MEDDLY::node_storage::relocateNodes(const node_handle*, long)
+{
+  return false;
+}
+
 void MEDDLY::node_storage::dumpInternal(output &s, unsigned flags) const
 {
   dumpInternalInfo(s);
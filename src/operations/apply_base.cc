@@ -60,10 +60,15 @@ void MEDDLY::generic_binary_mdd::computeDDEdge(const dd_edge &a, const dd_edge &
   );
 #endif
   node_handle cnode = compute(a.getNode(), b.getNode());
-  const int num_levels = resF->getDomain()->getNumVariables();
+  // In a quasi-reduced forest, the result goes at the level of the
+  // operands (saturation unions nodes below the top), and constants
+  // go at the top level.
+  int k = MAX(arg1F->getNodeLevel(a.getNode()),
+    arg2F->getNodeLevel(b.getNode()));
+  if (0 == k) k = resF->getDomain()->getNumVariables();
   if (resF->isQuasiReduced() && cnode != resF->getTransparentNode()
-    && resF->getNodeLevel(cnode) < num_levels) {
-    node_handle temp = ((mt_forest*)resF)->makeNodeAtLevel(num_levels, cnode);
+    && resF->getNodeLevel(cnode) < k) {
+    node_handle temp = ((mt_forest*)resF)->makeNodeAtLevel(k, cnode);
     resF->unlinkNode(cnode);
     cnode = temp;
   }
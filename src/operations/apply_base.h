@@ -20,6 +20,8 @@
 #ifndef APPLY_BASE_H
 #define APPLY_BASE_H
 
+#include "../forests/mt.h"
+
 /*
     Useful base classes for binary apply operations.
 */
@@ -32,6 +34,10 @@ namespace MEDDLY {
   class generic_binary_evplus;
   class generic_binary_evplus_mxd;
   class generic_binary_evtimes;
+
+  template <class FRAME> class frame_stack;
+  template <class OP, bool COMMUTES> class binary_mdd_kernel;
+  template <class OP, bool COMMUTES> class binary_mxd_kernel;
 }
 
 // ******************************************************************
@@ -383,5 +389,749 @@ class MEDDLY::generic_binary_evtimes : public generic_binary_ev {
 };
 
 
+// ******************************************************************
+// *                                                                *
+// *                     apply kernel templates                     *
+// *                                                                *
+// ******************************************************************
+
+/*
+    Pooled stack of frames, for operations that run with an explicit
+    stack instead of native recursion (see operation::usesExplicitStack).
+    FRAME must be plain old data; frames are moved by realloc.
+    The array is kept between calls, so it is only allocated while
+    a deeper stack than ever before is needed.
+*/
+template <class FRAME>
+class MEDDLY::frame_stack {
+  public:
+    frame_stack() {
+      frames = 0;
+      size = 0;
+      depth = 0;
+    }
+    ~frame_stack() {
+      free(frames);
+    }
+
+    inline unsigned getDepth() const { return depth; }
+
+    /// Push a frame, to be filled in by the caller.
+    inline FRAME& push() {
+      if (depth >= size) enlarge();
+      return frames[depth++];
+    }
+    inline FRAME& top() {
+      MEDDLY_DCASSERT(depth);
+      return frames[depth-1];
+    }
+    inline void pop() {
+      MEDDLY_DCASSERT(depth);
+      depth--;
+    }
+    /** Discard frames down to depth d; after an exception.
+        Each frame is given to owner->discardFrame(), so that
+        whatever it holds can be released.
+    */
+    template <class OWNER>
+    inline void popTo(unsigned d, OWNER* owner) {
+      while (depth > d) {
+        owner->discardFrame(frames[--depth]);
+      }
+    }
+
+  private:
+    void enlarge() {
+      const unsigned nsize = size ? 2*size : 256;
+      FRAME* nf = (FRAME*) realloc(frames, nsize * sizeof(FRAME));
+      if (0==nf) throw error(error::INSUFFICIENT_MEMORY, __FILE__, __LINE__);
+      frames = nf;
+      size = nsize;
+    }
+
+  private:
+    FRAME* frames;
+    unsigned size;
+    unsigned depth;
+};
+
+// ******************************************************************
+
+/*
+    Kernels for binary apply operations, using the curiously
+    recurring template pattern.  The operation class OP derives from
+    the kernel, and provides a (non-virtual) inline method
+
+      bool terminals(node_handle a, node_handle b, node_handle &c);
+
+    with the same contract as checkTerminals().  COMMUTES fixes the
+    compute table key layout at compile time.
+
+    The recursion over non-extensible levels is instantiated for each
+    operation, so terminal rules and compute table keys are inlined
+    instead of going through virtual calls; extensible levels use
+    the generic code, which calls back into the kernel via compute().
+
+    With operation::usesExplicitStack(), compute_s() replaces the
+    recursion over non-extensible levels by a loop over a frame_stack;
+    each frame is a node being built, with the index of its next child.
+*/
+
+template <class OP, bool COMMUTES>
+class MEDDLY::binary_mdd_kernel : public generic_binary_mdd {
+  public:
+    binary_mdd_kernel(const binary_opname* code, expert_forest* arg1,
+      expert_forest* arg2, expert_forest* res)
+      : generic_binary_mdd(code, arg1, arg2, res)
+    {
+      if (COMMUTES) operationCommutes();
+    }
+
+    virtual node_handle compute(node_handle a, node_handle b) {
+      return usesExplicitStack() ? compute_s(a, b) : compute_k(a, b);
+    }
+    virtual node_handle compute_normal(node_handle a, node_handle b) {
+      return compute_normal_k(a, b);
+    }
+
+  protected:
+    virtual bool checkTerminals(node_handle a, node_handle b, node_handle& c) {
+      return static_cast<OP*>(this)->terminals(a, b, c);
+    }
+
+    inline compute_table::entry_key*
+    findResult_k(node_handle a, node_handle b, node_handle &c)
+    {
+      compute_table::entry_key* CTsrch = CT0->useEntryKey(etype[0], 0);
+      MEDDLY_DCASSERT(CTsrch);
+      if (COMMUTES && a > b) {
+        CTsrch->writeN(b);
+        CTsrch->writeN(a);
+      } else {
+        CTsrch->writeN(a);
+        CTsrch->writeN(b);
+      }
+      CT0->find(CTsrch, CTresult[0]);
+      if (!CTresult[0]) return CTsrch;
+      c = resF->linkNode(CTresult[0].readN());
+      CT0->recycle(CTsrch);
+      return 0;
+    }
+
+    node_handle compute_k(node_handle a, node_handle b);
+    node_handle compute_normal_k(node_handle a, node_handle b);
+    node_handle compute_s(node_handle a, node_handle b);
+
+  private:
+    struct frame {
+      node_handle a;
+      node_handle b;
+      compute_table::entry_key* key;
+      unpacked_node* A;
+      unpacked_node* B;
+      unpacked_node* C;
+      unsigned i;
+    };
+
+    /// Push a frame for a, b, after a compute table miss.
+    void push_s(node_handle a, node_handle b, compute_table::entry_key* key);
+    /// Build the node of the top frame, and pop it.
+    node_handle pop_s();
+
+  public:
+    /// Release what a frame holds, after an exception.
+    void discardFrame(frame &F);
+
+  private:
+    frame_stack<frame> stack;
+};
+
+// ******************************************************************
+
+template <class OP, bool COMMUTES>
+class MEDDLY::binary_mxd_kernel : public generic_binary_mxd {
+  public:
+    binary_mxd_kernel(const binary_opname* code, expert_forest* arg1,
+      expert_forest* arg2, expert_forest* res)
+      : generic_binary_mxd(code, arg1, arg2, res)
+    {
+      if (COMMUTES) operationCommutes();
+    }
+
+    virtual node_handle compute(node_handle a, node_handle b) {
+      return usesExplicitStack() ? compute_s(a, b) : compute_k(a, b);
+    }
+    virtual node_handle compute_normal(node_handle a, node_handle b) {
+      return compute_normal_k(a, b);
+    }
+
+  protected:
+    virtual bool checkTerminals(node_handle a, node_handle b, node_handle& c) {
+      return static_cast<OP*>(this)->terminals(a, b, c);
+    }
+
+    inline compute_table::entry_key*
+    findResult_k(node_handle a, node_handle b, node_handle &c)
+    {
+      compute_table::entry_key* CTsrch = CT0->useEntryKey(etype[0], 0);
+      MEDDLY_DCASSERT(CTsrch);
+      if (COMMUTES && a > b) {
+        CTsrch->writeN(b);
+        CTsrch->writeN(a);
+      } else {
+        CTsrch->writeN(a);
+        CTsrch->writeN(b);
+      }
+      CT0->find(CTsrch, CTresult[0]);
+      if (!CTresult[0]) return CTsrch;
+      c = resF->linkNode(CTresult[0].readN());
+      CT0->recycle(CTsrch);
+      return 0;
+    }
+
+    node_handle compute_k(node_handle a, node_handle b);
+    node_handle compute_normal_k(node_handle a, node_handle b);
+    node_handle compute_r_k(int in, int k, node_handle a, node_handle b);
+    node_handle compute_s(node_handle a, node_handle b);
+
+  private:
+    /// Unprimed frames have a key, and in == -1; primed frames have no key.
+    struct frame {
+      node_handle a;
+      node_handle b;
+      compute_table::entry_key* key;
+      unpacked_node* A;
+      unpacked_node* B;
+      unpacked_node* C;
+      unsigned i;
+      int in;
+    };
+
+    /// Push an unprimed frame for a, b, after a compute table miss.
+    void push_s(node_handle a, node_handle b, compute_table::entry_key* key);
+  public:
+    /// Release what a frame holds, after an exception.
+    void discardFrame(frame &F);
+  private:
+    /// Push a frame for row in of primed level k.
+    void push_r_s(int in, int k, node_handle a, node_handle b);
+    /// Build the node of the top frame, and pop it.
+    node_handle pop_s();
+
+    frame_stack<frame> stack;
+};
+
+// ******************************************************************
+// *                                                                *
+// *                    binary_mdd_kernel methods                   *
+// *                                                                *
+// ******************************************************************
+
+template <class OP, bool COMMUTES>
+MEDDLY::node_handle
+MEDDLY::binary_mdd_kernel<OP, COMMUTES>::compute_k(node_handle a, node_handle b)
+{
+  node_handle result = 0;
+  if (static_cast<OP*>(this)->terminals(a, b, result))
+    return result;
+
+  compute_table::entry_key* Key = findResult_k(a, b, result);
+  if (0==Key) return result;
+
+  const int aLevel = arg1F->getNodeLevel(a);
+  const int bLevel = arg2F->getNodeLevel(b);
+  const int resultLevel = MAX(aLevel, bLevel);
+
+  result =
+    resF->isExtensibleLevel(resultLevel)
+    ? compute_ext(a, b)
+    : compute_normal_k(a, b);
+
+  saveResult(Key, a, b, result);
+  return result;
+}
+
+template <class OP, bool COMMUTES>
+MEDDLY::node_handle
+MEDDLY::binary_mdd_kernel<OP, COMMUTES>::compute_normal_k(node_handle a,
+  node_handle b)
+{
+  const int aLevel = arg1F->getNodeLevel(a);
+  const int bLevel = arg2F->getNodeLevel(b);
+  const int resultLevel = MAX(aLevel, bLevel);
+  const unsigned resultSize = unsigned(resF->getLevelSize(resultLevel));
+
+  MEDDLY_DCASSERT(!resF->isExtensibleLevel(resultLevel));
+
+  unpacked_node* C = unpacked_node::newFull(resF, resultLevel, resultSize);
+
+  unpacked_node *A = (aLevel < resultLevel)
+    ? unpacked_node::newRedundant(arg1F, resultLevel, a, true)
+    : unpacked_node::newFromNode(arg1F, a, true)
+  ;
+  unpacked_node *B = (bLevel < resultLevel)
+    ? unpacked_node::newRedundant(arg2F, resultLevel, b, true)
+    : unpacked_node::newFromNode(arg2F, b, true)
+  ;
+  MEDDLY_DCASSERT(A->isFull() && resultSize == A->getSize());
+  MEDDLY_DCASSERT(B->isFull() && resultSize == B->getSize());
+
+  for (unsigned i=0; i<resultSize; i++) {
+    C->d_ref(i) = compute_k(A->d(i), B->d(i));
+  }
+
+  if (resF->isQuasiReduced()) {
+    const int nextLevel = resultLevel - 1;
+    for (unsigned i=0; i<resultSize; i++) {
+      if (resF->getNodeLevel(C->d(i)) < nextLevel) {
+        node_handle temp = ((mt_forest*)resF)->makeNodeAtLevel(nextLevel, C->d(i));
+        resF->unlinkNode(C->d(i));
+        C->d_ref(i) = temp;
+      }
+    }
+  }
+
+  unpacked_node::recycle(B);
+  unpacked_node::recycle(A);
+
+  return resF->createReducedNode(-1, C);
+}
+
+template <class OP, bool COMMUTES>
+MEDDLY::node_handle
+MEDDLY::binary_mdd_kernel<OP, COMMUTES>::compute_s(node_handle a, node_handle b)
+{
+  node_handle result = 0;
+  if (static_cast<OP*>(this)->terminals(a, b, result))
+    return result;
+
+  compute_table::entry_key* Key = findResult_k(a, b, result);
+  if (0==Key) return result;
+
+  if (resF->isExtensibleLevel(MAX(arg1F->getNodeLevel(a), arg2F->getNodeLevel(b)))) {
+    result = compute_ext(a, b);
+    saveResult(Key, a, b, result);
+    return result;
+  }
+
+  // compute_ext may start another loop on this stack, above ours
+  const unsigned base = stack.getDepth();
+  // key of a child computed outside the loop, if that throws
+  compute_table::entry_key* pending = 0;
+  try {
+    push_s(a, b, Key);
+    for (;;) {
+      frame& F = stack.top();
+      unpacked_node* A = F.A;
+      unpacked_node* B = F.B;
+      unpacked_node* C = F.C;
+      if (F.i < C->getSize()) {
+        const unsigned i = F.i++;
+        const node_handle ai = A->d(i);
+        const node_handle bi = B->d(i);
+        if (static_cast<OP*>(this)->terminals(ai, bi, result)) {
+          C->d_ref(i) = result;
+          continue;
+        }
+        Key = findResult_k(ai, bi, result);
+        if (0==Key) {
+          C->d_ref(i) = result;
+          continue;
+        }
+        if (resF->isExtensibleLevel(MAX(arg1F->getNodeLevel(ai), arg2F->getNodeLevel(bi)))) {
+          pending = Key;
+          result = compute_ext(ai, bi);
+          pending = 0;
+          saveResult(Key, ai, bi, result);
+          C->d_ref(i) = result;
+          continue;
+        }
+        push_s(ai, bi, Key);
+        continue;
+      }
+
+      // all children done
+      result = pop_s();
+      if (stack.getDepth() == base) return result;
+      frame& P = stack.top();
+      P.C->d_ref(P.i-1) = result;
+    }
+  }
+  catch (...) {
+    if (pending) CT0->recycle(pending);
+    stack.popTo(base, this);
+    throw;
+  }
+}
+
+template <class OP, bool COMMUTES>
+void MEDDLY::binary_mdd_kernel<OP, COMMUTES>::push_s(node_handle a,
+  node_handle b, compute_table::entry_key* key)
+{
+  const int aLevel = arg1F->getNodeLevel(a);
+  const int bLevel = arg2F->getNodeLevel(b);
+  const int resultLevel = MAX(aLevel, bLevel);
+  const unsigned resultSize = unsigned(resF->getLevelSize(resultLevel));
+
+  frame* Fp;
+  try {
+    Fp = &stack.push();
+  }
+  catch (...) {
+    CT0->recycle(key);
+    throw;
+  }
+  frame& F = *Fp;
+  F.a = a;
+  F.b = b;
+  F.key = key;
+  F.i = 0;
+  F.A = F.B = F.C = 0;
+  F.A = (aLevel < resultLevel)
+    ? unpacked_node::newRedundant(arg1F, resultLevel, a, true)
+    : unpacked_node::newFromNode(arg1F, a, true)
+  ;
+  F.B = (bLevel < resultLevel)
+    ? unpacked_node::newRedundant(arg2F, resultLevel, b, true)
+    : unpacked_node::newFromNode(arg2F, b, true)
+  ;
+  F.C = unpacked_node::newFull(resF, resultLevel, resultSize);
+}
+
+template <class OP, bool COMMUTES>
+MEDDLY::node_handle MEDDLY::binary_mdd_kernel<OP, COMMUTES>::pop_s()
+{
+  frame& F = stack.top();
+  unpacked_node* C = F.C;
+
+  if (resF->isQuasiReduced()) {
+    const int nextLevel = C->getLevel() - 1;
+    for (unsigned i=0; i<C->getSize(); i++) {
+      if (resF->getNodeLevel(C->d(i)) < nextLevel) {
+        node_handle temp = ((mt_forest*)resF)->makeNodeAtLevel(nextLevel, C->d(i));
+        resF->unlinkNode(C->d(i));
+        C->d_ref(i) = temp;
+      }
+    }
+  }
+
+  unpacked_node::recycle(F.B);
+  unpacked_node::recycle(F.A);
+  F.A = F.B = F.C = 0;
+
+  // createReducedNode() releases C, even if it throws
+  const node_handle result = resF->createReducedNode(-1, C);
+  saveResult(F.key, F.a, F.b, result);
+  stack.pop();
+  return result;
+}
+
+template <class OP, bool COMMUTES>
+void MEDDLY::binary_mdd_kernel<OP, COMMUTES>::discardFrame(frame &F)
+{
+  if (F.A) unpacked_node::recycle(F.A);
+  if (F.B) unpacked_node::recycle(F.B);
+  if (F.C) {
+    // children not computed yet are still 0
+    for (unsigned i=0; i<F.C->getSize(); i++) {
+      resF->unlinkNode(F.C->d(i));
+    }
+    unpacked_node::recycle(F.C);
+  }
+  if (F.key) CT0->recycle(F.key);
+}
+
+// ******************************************************************
+// *                                                                *
+// *                    binary_mxd_kernel methods                   *
+// *                                                                *
+// ******************************************************************
+
+template <class OP, bool COMMUTES>
+MEDDLY::node_handle
+MEDDLY::binary_mxd_kernel<OP, COMMUTES>::compute_k(node_handle a, node_handle b)
+{
+  node_handle result = 0;
+  if (static_cast<OP*>(this)->terminals(a, b, result))
+    return result;
+
+  compute_table::entry_key* Key = findResult_k(a, b, result);
+  if (0==Key) return result;
+
+  const int aLevel = arg1F->getNodeLevel(a);
+  const int bLevel = arg2F->getNodeLevel(b);
+  const int resultLevel = ABS(topLevel(aLevel, bLevel));
+
+  result =
+    resF->isExtensibleLevel(resultLevel)
+    ? compute_ext(a, b)
+    : compute_normal_k(a, b);
+
+  saveResult(Key, a, b, result);
+  return result;
+}
+
+template <class OP, bool COMMUTES>
+MEDDLY::node_handle
+MEDDLY::binary_mxd_kernel<OP, COMMUTES>::compute_normal_k(node_handle a,
+  node_handle b)
+{
+  const int aLevel = arg1F->getNodeLevel(a);
+  const int bLevel = arg2F->getNodeLevel(b);
+  const int resultLevel = ABS(topLevel(aLevel, bLevel));
+  const unsigned resultSize = unsigned(resF->getLevelSize(resultLevel));
+  const int dwnLevel = resF->downLevel(resultLevel);
+
+  MEDDLY_DCASSERT(!resF->isExtensibleLevel(resultLevel));
+
+  unpacked_node* C = unpacked_node::newFull(resF, resultLevel, resultSize);
+
+  unpacked_node *A = (aLevel < resultLevel)
+    ? unpacked_node::newRedundant(arg1F, resultLevel, a, true)
+    : unpacked_node::newFromNode(arg1F, a, true)
+  ;
+  unpacked_node *B = (bLevel < resultLevel)
+    ? unpacked_node::newRedundant(arg2F, resultLevel, b, true)
+    : unpacked_node::newFromNode(arg2F, b, true)
+  ;
+
+  const bool ext = resF->isExtensibleLevel(dwnLevel);
+  for (unsigned j=0; j<resultSize; j++) {
+    C->d_ref(j) = ext
+      ? compute_r(int(j), dwnLevel, A->d(j), B->d(j))
+      : compute_r_k(int(j), dwnLevel, A->d(j), B->d(j));
+  }
+
+  unpacked_node::recycle(B);
+  unpacked_node::recycle(A);
+
+  return resF->createReducedNode(-1, C);
+}
+
+template <class OP, bool COMMUTES>
+MEDDLY::node_handle
+MEDDLY::binary_mxd_kernel<OP, COMMUTES>::compute_r_k(int in, int k,
+  node_handle a, node_handle b)
+{
+  MEDDLY_DCASSERT(k<0);
+  MEDDLY_DCASSERT(!resF->isExtensibleLevel(k));
+
+  const int aLevel = arg1F->getNodeLevel(a);
+  const int bLevel = arg2F->getNodeLevel(b);
+  const unsigned resultSize = unsigned(resF->getLevelSize(k));
+
+  unpacked_node* C = unpacked_node::newFull(resF, k, resultSize);
+
+  unpacked_node *A = unpacked_node::useUnpackedNode();
+  unpacked_node *B = unpacked_node::useUnpackedNode();
+
+  if (aLevel == k) {
+    A->initFromNode(arg1F, a, true);
+  } else if (arg1F->isFullyReduced()) {
+    A->initRedundant(arg1F, k, a, true);
+  } else {
+    A->initIdentity(arg1F, k, in, a, true);
+  }
+
+  if (bLevel == k) {
+    B->initFromNode(arg2F, b, true);
+  } else if (arg2F->isFullyReduced()) {
+    B->initRedundant(arg2F, k, b, true);
+  } else {
+    B->initIdentity(arg2F, k, in, b, true);
+  }
+  MEDDLY_DCASSERT(A->getSize() == resultSize);
+  MEDDLY_DCASSERT(B->getSize() == resultSize);
+
+  for (unsigned j=0; j<resultSize; j++) {
+    C->d_ref(j) = compute_k(A->d(j), B->d(j));
+  }
+
+  unpacked_node::recycle(B);
+  unpacked_node::recycle(A);
+
+  return resF->createReducedNode(in, C);
+}
+
+template <class OP, bool COMMUTES>
+MEDDLY::node_handle
+MEDDLY::binary_mxd_kernel<OP, COMMUTES>::compute_s(node_handle a, node_handle b)
+{
+  node_handle result = 0;
+  if (static_cast<OP*>(this)->terminals(a, b, result))
+    return result;
+
+  compute_table::entry_key* Key = findResult_k(a, b, result);
+  if (0==Key) return result;
+
+  if (resF->isExtensibleLevel(ABS(topLevel(arg1F->getNodeLevel(a), arg2F->getNodeLevel(b))))) {
+    result = compute_ext(a, b);
+    saveResult(Key, a, b, result);
+    return result;
+  }
+
+  // compute_ext and compute_r may start another loop on this stack
+  const unsigned base = stack.getDepth();
+  // key of a child computed outside the loop, if that throws
+  compute_table::entry_key* pending = 0;
+  try {
+    push_s(a, b, Key);
+    for (;;) {
+      frame& F = stack.top();
+      unpacked_node* A = F.A;
+      unpacked_node* B = F.B;
+      unpacked_node* C = F.C;
+      if (F.i < C->getSize()) {
+        const unsigned i = F.i++;
+        const node_handle ai = A->d(i);
+        const node_handle bi = B->d(i);
+        if (C->getLevel() > 0) {
+          // unprimed: row i is a primed node
+          const int dwnLevel = resF->downLevel(C->getLevel());
+          if (resF->isExtensibleLevel(dwnLevel)) {
+            C->d_ref(i) = compute_r(int(i), dwnLevel, ai, bi);
+          } else {
+            push_r_s(int(i), dwnLevel, ai, bi);
+          }
+          continue;
+        }
+        // primed: child i is an unprimed pair
+        if (static_cast<OP*>(this)->terminals(ai, bi, result)) {
+          C->d_ref(i) = result;
+          continue;
+        }
+        Key = findResult_k(ai, bi, result);
+        if (0==Key) {
+          C->d_ref(i) = result;
+          continue;
+        }
+        if (resF->isExtensibleLevel(ABS(topLevel(arg1F->getNodeLevel(ai), arg2F->getNodeLevel(bi))))) {
+          pending = Key;
+          result = compute_ext(ai, bi);
+          pending = 0;
+          saveResult(Key, ai, bi, result);
+          C->d_ref(i) = result;
+          continue;
+        }
+        push_s(ai, bi, Key);
+        continue;
+      }
+
+      // all children done
+      result = pop_s();
+      if (stack.getDepth() == base) return result;
+      frame& P = stack.top();
+      P.C->d_ref(P.i-1) = result;
+    }
+  }
+  catch (...) {
+    if (pending) CT0->recycle(pending);
+    stack.popTo(base, this);
+    throw;
+  }
+}
+
+template <class OP, bool COMMUTES>
+void MEDDLY::binary_mxd_kernel<OP, COMMUTES>::push_s(node_handle a,
+  node_handle b, compute_table::entry_key* key)
+{
+  const int aLevel = arg1F->getNodeLevel(a);
+  const int bLevel = arg2F->getNodeLevel(b);
+  const int resultLevel = ABS(topLevel(aLevel, bLevel));
+  const unsigned resultSize = unsigned(resF->getLevelSize(resultLevel));
+
+  frame* Fp;
+  try {
+    Fp = &stack.push();
+  }
+  catch (...) {
+    CT0->recycle(key);
+    throw;
+  }
+  frame& F = *Fp;
+  F.a = a;
+  F.b = b;
+  F.key = key;
+  F.i = 0;
+  F.A = F.B = F.C = 0;
+  F.in = -1;
+  F.A = (aLevel < resultLevel)
+    ? unpacked_node::newRedundant(arg1F, resultLevel, a, true)
+    : unpacked_node::newFromNode(arg1F, a, true)
+  ;
+  F.B = (bLevel < resultLevel)
+    ? unpacked_node::newRedundant(arg2F, resultLevel, b, true)
+    : unpacked_node::newFromNode(arg2F, b, true)
+  ;
+  F.C = unpacked_node::newFull(resF, resultLevel, resultSize);
+}
+
+template <class OP, bool COMMUTES>
+void MEDDLY::binary_mxd_kernel<OP, COMMUTES>::push_r_s(int in, int k,
+  node_handle a, node_handle b)
+{
+  MEDDLY_DCASSERT(k<0);
+  const unsigned resultSize = unsigned(resF->getLevelSize(k));
+
+  frame& F = stack.push();
+  F.a = a;
+  F.b = b;
+  F.key = 0;
+  F.i = 0;
+  F.in = in;
+  F.A = F.B = F.C = 0;
+  F.A = unpacked_node::useUnpackedNode();
+  F.B = unpacked_node::useUnpackedNode();
+
+  if (arg1F->getNodeLevel(a) == k) {
+    F.A->initFromNode(arg1F, a, true);
+  } else if (arg1F->isFullyReduced()) {
+    F.A->initRedundant(arg1F, k, a, true);
+  } else {
+    F.A->initIdentity(arg1F, k, in, a, true);
+  }
+
+  if (arg2F->getNodeLevel(b) == k) {
+    F.B->initFromNode(arg2F, b, true);
+  } else if (arg2F->isFullyReduced()) {
+    F.B->initRedundant(arg2F, k, b, true);
+  } else {
+    F.B->initIdentity(arg2F, k, in, b, true);
+  }
+  F.C = unpacked_node::newFull(resF, k, resultSize);
+}
+
+template <class OP, bool COMMUTES>
+MEDDLY::node_handle MEDDLY::binary_mxd_kernel<OP, COMMUTES>::pop_s()
+{
+  frame& F = stack.top();
+  unpacked_node* C = F.C;
+
+  unpacked_node::recycle(F.B);
+  unpacked_node::recycle(F.A);
+  F.A = F.B = F.C = 0;
+
+  // createReducedNode() releases C, even if it throws
+  const node_handle result = resF->createReducedNode(F.in, C);
+  if (F.key) saveResult(F.key, F.a, F.b, result);
+  stack.pop();
+  return result;
+}
+
+template <class OP, bool COMMUTES>
+void MEDDLY::binary_mxd_kernel<OP, COMMUTES>::discardFrame(frame &F)
+{
+  if (F.A) unpacked_node::recycle(F.A);
+  if (F.B) unpacked_node::recycle(F.B);
+  if (F.C) {
+    // children not computed yet are still 0
+    for (unsigned i=0; i<F.C->getSize(); i++) {
+      resF->unlinkNode(F.C->d(i));
+    }
+    unpacked_node::recycle(F.C);
+  }
+  if (F.key) CT0->recycle(F.key);
+}
+
 #endif
 
@@ -0,0 +1,547 @@
+
+/*
+    Meddly: Multi-terminal and Edge-valued Decision Diagram LibrarY.
+    Copyright (C) 2009, Iowa State University Research Foundation, Inc.
+
+    This library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../defines.h"
+#include "cofactor.h"
+
+namespace MEDDLY {
+  class cofactor_op;
+  class cof_opname;
+
+  class gen_cofactor_op;
+  class gen_cofactor_opname;
+};
+
+// ******************************************************************
+// *                                                                *
+// *                    cofactor_opname  methods                    *
+// *                                                                *
+// ******************************************************************
+
+MEDDLY::cofactor_opname::cofactor_opname(const char* n)
+ : specialized_opname(n)
+{
+}
+
+MEDDLY::cofactor_opname::~cofactor_opname()
+{
+}
+
+MEDDLY::cofactor_opname::cofactor_args
+::cofactor_args(forest* f, const int* v, const int* pv)
+{
+  F = f;
+  if (0==F || 0==v) throw error(error::MISCELLANEOUS, __FILE__, __LINE__);
+
+  if (F->getEdgeLabeling() != forest::MULTI_TERMINAL)
+    throw error(error::TYPE_MISMATCH, __FILE__, __LINE__);
+
+  if (!F->isFullyReduced() && !(F->isForRelations() && F->isIdentityReduced()))
+    throw error(error::NOT_IMPLEMENTED, __FILE__, __LINE__);
+
+  const domain* D = F->getDomain();
+  const int K = D->getNumVariables();
+  vals = new int[K+1];
+  pvals = new int[K+1];
+  vals[0] = pvals[0] = DONT_CARE;
+  for (int k=1; k<=K; k++) {
+    vals[k] = v[k];
+    pvals[k] = (pv && F->isForRelations()) ? pv[k] : DONT_CARE;
+  }
+  for (int k=1; k<=K; k++) {
+    const int bound = D->getVariableBound(k);
+    if (
+      (vals[k] != DONT_CARE && (vals[k] < 0 || vals[k] >= bound)) ||
+      (pvals[k] != DONT_CARE && (pvals[k] < 0 || pvals[k] >= bound))
+    ) {
+      delete[] vals;
+      delete[] pvals;
+      throw error(error::INVALID_ASSIGNMENT, __FILE__, __LINE__);
+    }
+  }
+}
+
+MEDDLY::cofactor_opname::cofactor_args::~cofactor_args()
+{
+  delete[] vals;
+  delete[] pvals;
+}
+
+// ******************************************************************
+// *                                                                *
+// *                       cofactor_op  class                       *
+// *                                                                *
+// ******************************************************************
+
+/** Cofactor with respect to an assignment of some variables.
+    At an assigned level, only the assigned child is followed,
+    and the result is built so it does not depend on the variable.
+    For relations, each level is an unprimed and primed pair,
+    and either or both may be assigned.
+*/
+class MEDDLY::cofactor_op : public specialized_operation {
+  public:
+    cofactor_op(const cofactor_opname* code,
+      cofactor_opname::cofactor_args* a);
+
+    virtual bool checkForestCompatibility() const;
+
+    virtual void compute(const dd_edge &a, dd_edge &c);
+
+  protected:
+    virtual ~cofactor_op();
+
+    /**
+        Recursive part.
+          @param  k   Highest level the argument may depend on.
+          @param  a   Argument.
+    */
+    node_handle compute_r(int k, node_handle a);
+
+  private:
+    /**
+        Fill in the children of row i of a relation node at level k.
+        The old contents of row are unlinked.
+    */
+    void fillRow(int k, const unpacked_node* A, unsigned i,
+      node_handle* row);
+
+    /// Fill ftop, for the current variable order.
+    void findAssignedLevels();
+
+    /// Value assigned to the variable at level k.
+    inline int valueAtLevel(int k) const {
+      return args->getValue(F->getVarByLevel(k));
+    }
+    /// Value assigned to the primed variable at level k.
+    inline int primedValueAtLevel(int k) const {
+      return args->getPrimedValue(F->getVarByLevel(k));
+    }
+
+    inline compute_table::entry_key*
+    findResult(int k, node_handle a, node_handle &c) {
+      compute_table::entry_key* CTsrch = CT0->useEntryKey(etype[0], 0);
+      MEDDLY_DCASSERT(CTsrch);
+      CTsrch->writeN(a);
+      CTsrch->writeI(k);
+      CT0->find(CTsrch, CTresult[0]);
+      if (!CTresult[0]) return CTsrch;
+      c = F->linkNode(CTresult[0].readN());
+      CT0->recycle(CTsrch);
+      return 0;
+    }
+    inline node_handle saveResult(compute_table::entry_key* Key,
+      node_handle c)
+    {
+      CTresult[0].reset();
+      CTresult[0].writeN(c);
+      CT0->addEntry(Key, CTresult[0]);
+      return c;
+    }
+
+  private:
+    cofactor_opname::cofactor_args* args;
+    expert_forest* F;
+    bool identity;
+    /// ftop[k]: highest level, at most k, with an assigned variable.
+    int* ftop;
+};
+
+MEDDLY::cofactor_op::cofactor_op(const cofactor_opname* code,
+  cofactor_opname::cofactor_args* a)
+: specialized_operation(code, 1)
+{
+  MEDDLY_DCASSERT(a);
+  args = a;
+  F = static_cast<expert_forest*>(a->getForest());
+  identity = F->isForRelations() && F->isIdentityReduced();
+
+  ftop = new int[F->getNumVariables()+1];
+  findAssignedLevels();
+
+  registerInForest(F);
+
+  compute_table::entry_type* et =
+    new compute_table::entry_type(code->getName(), "NI:N");
+  et->setForestForSlot(0, F);
+  et->setForestForSlot(3, F);
+  registerEntryType(0, et);
+  buildCTs();
+}
+
+MEDDLY::cofactor_op::~cofactor_op()
+{
+  delete[] ftop;
+  if (args->autoDestroy()) delete args;
+  unregisterInForest(F);
+}
+
+bool MEDDLY::cofactor_op::checkForestCompatibility() const
+{
+  return true;
+}
+
+void MEDDLY::cofactor_op::compute(const dd_edge &a, dd_edge &c)
+{
+  if (a.getForest() != F || c.getForest() != F)
+    throw error(error::FOREST_MISMATCH, __FILE__, __LINE__);
+
+  findAssignedLevels();
+  c.set( compute_r(F->getNumVariables(), a.getNode()) );
+}
+
+MEDDLY::node_handle MEDDLY::cofactor_op::compute_r(int k, node_handle a)
+{
+  // termination conditions
+  if (0==a) return 0;
+  if (0==ftop[k]) return F->linkNode(a);
+
+  //
+  // Determine the level to expand; see quantify_op.
+  //
+  const int aLevel = F->getNodeLevel(a);
+  if (identity) {
+    k = MAX(ABS(aLevel), ftop[k]);
+  } else {
+    if (0==aLevel) return F->linkNode(a);
+    k = ABS(aLevel);
+  }
+
+  // check the compute table
+  node_handle result = 0;
+  compute_table::entry_key* Key = findResult(k, a, result);
+  if (0==Key) return result;
+
+  const unsigned sz = unsigned(F->getLevelSize(k));
+  unpacked_node* A = isLevelAbove(k, aLevel)
+    ? unpacked_node::newRedundant(F, k, a, true)
+    : unpacked_node::newFromNode(F, a, true);
+
+  const int u = valueAtLevel(k);
+  if (!F->isForRelations()) {
+    if (u != DONT_CARE) {
+      result = compute_r(k-1, A->d(unsigned(u)));
+    } else {
+      unpacked_node* C = unpacked_node::newFull(F, k, sz);
+      for (unsigned i=0; i<sz; i++) {
+        C->d_ref(i) = compute_r(k-1, A->d(i));
+      }
+      result = F->createReducedNode(-1, C);
+    }
+  } else {
+    //
+    // Every row is built from the same source row if the unprimed
+    // variable is assigned; even so, each row is reduced separately,
+    // because identity reduction depends on the row.
+    //
+    node_handle* row = new node_handle[sz];
+    for (unsigned j=0; j<sz; j++) row[j] = 0;
+    unpacked_node* nb = unpacked_node::newFull(F, k, sz);
+    for (unsigned i=0; i<sz; i++) {
+      if (DONT_CARE == u) {
+        fillRow(k, A, i, row);
+      } else if (0==i) {
+        fillRow(k, A, unsigned(u), row);
+      }
+      unpacked_node* nbi = unpacked_node::newFull(F, -k, sz);
+      for (unsigned j=0; j<sz; j++) {
+        nbi->d_ref(j) = F->linkNode(row[j]);
+      }
+      nb->d_ref(i) = F->createReducedNode(int(i), nbi);
+    }
+    for (unsigned j=0; j<sz; j++) F->unlinkNode(row[j]);
+    delete[] row;
+    result = F->createReducedNode(-1, nb);
+  }
+
+  unpacked_node::recycle(A);
+  return saveResult(Key, result);
+}
+
+void MEDDLY::cofactor_op::fillRow(int k, const unpacked_node* A, unsigned i,
+  node_handle* row)
+{
+  const unsigned sz = unsigned(F->getLevelSize(k));
+  const int p = primedValueAtLevel(k);
+  unpacked_node* R = unpacked_node::newRow(F, k, A, i);
+  node_handle fixed = (p != DONT_CARE) ? compute_r(k-1, R->d(unsigned(p))) : 0;
+  for (unsigned j=0; j<sz; j++) {
+    F->unlinkNode(row[j]);
+    row[j] = (DONT_CARE == p) ? compute_r(k-1, R->d(j)) : F->linkNode(fixed);
+  }
+  F->unlinkNode(fixed);
+  unpacked_node::recycle(R);
+}
+
+void MEDDLY::cofactor_op::findAssignedLevels()
+{
+  // The values are given by variable, but we recurse by level
+  const int K = F->getNumVariables();
+  ftop[0] = 0;
+  for (int k=1; k<=K; k++) {
+    const bool fixed = (valueAtLevel(k) != DONT_CARE) ||
+                       (primedValueAtLevel(k) != DONT_CARE);
+    ftop[k] = fixed ? k : ftop[k-1];
+  }
+}
+
+// ******************************************************************
+// *                                                                *
+// *                       cof_opname   class                       *
+// *                                                                *
+// ******************************************************************
+
+class MEDDLY::cof_opname : public cofactor_opname {
+  public:
+    cof_opname();
+    virtual specialized_operation* buildOperation(arguments* a) const;
+};
+
+MEDDLY::cof_opname::cof_opname()
+ : cofactor_opname("Cofactor")
+{
+}
+
+MEDDLY::specialized_operation*
+MEDDLY::cof_opname::buildOperation(arguments* a) const
+{
+  cofactor_args* ca = dynamic_cast<cofactor_args*>(a);
+  if (0==ca) throw error(error::INVALID_ARGUMENT, __FILE__, __LINE__);
+
+  //
+  // No sanity checks needed here; we did them already when constructing a.
+  //
+
+  return new cofactor_op(this, ca);
+}
+
+// ******************************************************************
+// *                                                                *
+// *                     gen_cofactor_op  class                     *
+// *                                                                *
+// ******************************************************************
+
+/** Generalized cofactor of f with respect to a care set c.
+    At a level where c has a single nonzero child, that child is
+    followed and the level is dropped from the result.
+    Otherwise, values outside the care set get the result
+    for the first value inside the care set, which makes the
+    result node more likely to be redundant.
+    For restrict, if c is above f then c is replaced by the
+    union of its children, since f does not depend on that variable.
+*/
+class MEDDLY::gen_cofactor_op : public binary_operation {
+  public:
+    gen_cofactor_op(const binary_opname* opcode, expert_forest* arg1,
+      expert_forest* arg2, expert_forest* res, bool restr);
+
+    virtual void computeDDEdge(const dd_edge& a, const dd_edge& b, dd_edge &c);
+    virtual node_handle compute(node_handle a, node_handle b);
+
+  protected:
+    inline compute_table::entry_key*
+    findResult(node_handle a, node_handle b, node_handle &c)
+    {
+      compute_table::entry_key* CTsrch = CT0->useEntryKey(etype[0], 0);
+      MEDDLY_DCASSERT(CTsrch);
+      CTsrch->writeN(a);
+      CTsrch->writeN(b);
+      CT0->find(CTsrch, CTresult[0]);
+      if (!CTresult[0]) return CTsrch;
+      c = resF->linkNode(CTresult[0].readN());
+      CT0->recycle(CTsrch);
+      return 0;
+    }
+    inline node_handle saveResult(compute_table::entry_key* Key,
+      node_handle c)
+    {
+      CTresult[0].reset();
+      CTresult[0].writeN(c);
+      CT0->addEntry(Key, CTresult[0]);
+      return c;
+    }
+
+  private:
+    /// Union of the care sets, for restrict.
+    binary_operation* unionOp;
+    bool isRestrict;
+};
+
+MEDDLY::gen_cofactor_op::gen_cofactor_op(const binary_opname* oc,
+  expert_forest* a1, expert_forest* a2, expert_forest* res, bool restr)
+: binary_operation(oc, 1, a1, a2, res)
+{
+  isRestrict = restr;
+  unionOp = restr ? getOperation(UNION, a2, a2, a2) : 0;
+
+  compute_table::entry_type* et = new compute_table::entry_type(oc->getName(), "NN:N");
+  et->setForestForSlot(0, a1);
+  et->setForestForSlot(1, a2);
+  et->setForestForSlot(3, res);
+  registerEntryType(0, et);
+  buildCTs();
+}
+
+void MEDDLY::gen_cofactor_op
+::computeDDEdge(const dd_edge &a, const dd_edge &b, dd_edge &c)
+{
+  c.set( compute(a.getNode(), b.getNode()) );
+}
+
+MEDDLY::node_handle MEDDLY::gen_cofactor_op::compute(node_handle f,
+  node_handle c)
+{
+  // termination conditions
+  if (0==c) return 0;
+  if (arg2F->isTerminalNode(c) || arg1F->isTerminalNode(f)) {
+    return resF->linkNode(f);
+  }
+  if (arg1F == arg2F && f == c) {
+    return resF->handleForValue(true);
+  }
+
+  // check the compute table
+  node_handle result = 0;
+  compute_table::entry_key* Key = findResult(f, c, result);
+  if (0==Key) return result;
+
+  const int fLevel = arg1F->getNodeLevel(f);
+  const int cLevel = arg2F->getNodeLevel(c);
+
+  if (isRestrict && isLevelAbove(cLevel, fLevel)) {
+    //
+    // f does not depend on this variable, so neither should c
+    //
+    unpacked_node* C = unpacked_node::newFromNode(arg2F, c, false);
+    dd_edge proj(arg2F), t(arg2F);
+    for (unsigned z=0; z<C->getNNZs(); z++) {
+      t.set(arg2F->linkNode(C->d(z)));
+      unionOp->compute(proj, t, proj);
+    }
+    unpacked_node::recycle(C);
+    result = compute(f, proj.getNode());
+    return saveResult(Key, result);
+  }
+
+  const int k = isLevelAbove(cLevel, fLevel) ? cLevel : fLevel;
+  const unsigned sz = unsigned(resF->getLevelSize(k));
+  unpacked_node* A = isLevelAbove(k, fLevel)
+    ? unpacked_node::newRedundant(arg1F, k, f, true)
+    : unpacked_node::newFromNode(arg1F, f, true);
+  unpacked_node* C = isLevelAbove(k, cLevel)
+    ? unpacked_node::newRedundant(arg2F, k, c, true)
+    : unpacked_node::newFromNode(arg2F, c, true);
+
+  unsigned first = sz;
+  unsigned care = 0;
+  for (unsigned i=0; i<sz; i++) {
+    if (0==C->d(i)) continue;
+    if (0==care) first = i;
+    care++;
+  }
+  MEDDLY_DCASSERT(care);
+
+  if (1==care) {
+    result = compute(A->d(first), C->d(first));
+  } else {
+    unpacked_node* nb = unpacked_node::newFull(resF, k, sz);
+    for (unsigned i=0; i<sz; i++) {
+      nb->d_ref(i) = C->d(i) ? compute(A->d(i), C->d(i)) : 0;
+    }
+    for (unsigned i=0; i<sz; i++) {
+      if (0==C->d(i)) nb->d_ref(i) = resF->linkNode(nb->d(first));
+    }
+    result = resF->createReducedNode(-1, nb);
+  }
+
+  unpacked_node::recycle(A);
+  unpacked_node::recycle(C);
+  return saveResult(Key, result);
+}
+
+// ******************************************************************
+// *                                                                *
+// *                   gen_cofactor_opname  class                   *
+// *                                                                *
+// ******************************************************************
+
+class MEDDLY::gen_cofactor_opname : public binary_opname {
+    bool isRestrict;
+  public:
+    gen_cofactor_opname(bool restr);
+    virtual binary_operation* buildOperation(expert_forest* a1,
+      expert_forest* a2, expert_forest* r) const;
+};
+
+MEDDLY::gen_cofactor_opname::gen_cofactor_opname(bool restr)
+ : binary_opname(restr ? "Restrict" : "Constrain")
+{
+  isRestrict = restr;
+}
+
+MEDDLY::binary_operation*
+MEDDLY::gen_cofactor_opname::buildOperation(expert_forest* a1,
+  expert_forest* a2, expert_forest* r) const
+{
+  if (0==a1 || 0==a2 || 0==r) return 0;
+
+  if (
+    (a1->getDomain() != r->getDomain()) ||
+    (a2->getDomain() != r->getDomain())
+  )
+    throw error(error::DOMAIN_MISMATCH, __FILE__, __LINE__);
+
+  if (a1 != r)
+    throw error(error::FOREST_MISMATCH, __FILE__, __LINE__);
+
+  if (
+    (a1->isForRelations() != a2->isForRelations()) ||
+    (a2->getRangeType() != forest::BOOLEAN) ||
+    (a1->getEdgeLabeling() != forest::MULTI_TERMINAL) ||
+    (a2->getEdgeLabeling() != forest::MULTI_TERMINAL)
+  )
+    throw error(error::TYPE_MISMATCH, __FILE__, __LINE__);
+
+  if (!a1->isFullyReduced() || !a2->isFullyReduced())
+    throw error(error::NOT_IMPLEMENTED, __FILE__, __LINE__);
+
+  return new gen_cofactor_op(this, a1, a2, r, isRestrict);
+}
+
+// ******************************************************************
+// *                                                                *
+// *                           Front  end                           *
+// *                                                                *
+// ******************************************************************
+
+MEDDLY::cofactor_opname* MEDDLY::initCofactor()
+{
+  return new cof_opname;
+}
+
+MEDDLY::binary_opname* MEDDLY::initializeRestrict()
+{
+  return new gen_cofactor_opname(true);
+}
+
+MEDDLY::binary_opname* MEDDLY::initializeConstrain()
+{
+  return new gen_cofactor_opname(false);
+}
+
@@ -40,32 +40,28 @@ namespace MEDDLY {
 namespace MEDDLY {
 
 template <typename T>
-class equal_mdd : public generic_binary_mdd {
+class equal_mdd : public binary_mdd_kernel<equal_mdd<T>, true> {
   public:
     equal_mdd(const binary_opname* opcode, expert_forest* arg1,
       expert_forest* arg2, expert_forest* res)
-      : generic_binary_mdd(opcode, arg1, arg2, res)
-      {
-        operationCommutes();
-      }
+      : binary_mdd_kernel<equal_mdd<T>, true>(opcode, arg1, arg2, res) { }
 
-  protected:
-    virtual bool checkTerminals(node_handle a, node_handle b, node_handle& c);
+    bool terminals(node_handle a, node_handle b, node_handle& c);
 };
 
 template <typename T>
-bool equal_mdd<T>
-::checkTerminals(node_handle a, node_handle b, node_handle& c)
+inline bool equal_mdd<T>
+::terminals(node_handle a, node_handle b, node_handle& c)
 {
-  if (a == b && arg1F == arg2F) {
-    c = resF->handleForValue(true);
+  if (a == b && this->arg1F == this->arg2F) {
+    c = this->resF->handleForValue(true);
     return true;
   }
-  if (arg1F->isTerminalNode(a) && arg2F->isTerminalNode(b)) {
+  if (this->arg1F->isTerminalNode(a) && this->arg2F->isTerminalNode(b)) {
     T av, bv;
-    arg1F->getValueFromHandle(a, av);
-    arg2F->getValueFromHandle(b, bv);
-    c = resF->handleForValue( av == bv );
+    this->arg1F->getValueFromHandle(a, av);
+    this->arg2F->getValueFromHandle(b, bv);
+    c = this->resF->handleForValue( av == bv );
     return true;
   }
   return false;
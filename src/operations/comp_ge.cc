@@ -38,25 +38,24 @@ namespace MEDDLY {
 namespace MEDDLY {
 
 template <typename T>
-class moreequal_mdd : public generic_binary_mdd {
+class moreequal_mdd : public binary_mdd_kernel<moreequal_mdd<T>, false> {
   public:
     moreequal_mdd(const binary_opname* opcode, expert_forest* arg1,
       expert_forest* arg2, expert_forest* res) 
-      : generic_binary_mdd(opcode, arg1, arg2, res) { }
+      : binary_mdd_kernel<moreequal_mdd<T>, false>(opcode, arg1, arg2, res) { }
 
-  protected:
-    virtual bool checkTerminals(node_handle a, node_handle b, node_handle& c);
+    bool terminals(node_handle a, node_handle b, node_handle& c);
 };
 
 template <typename T>
-bool moreequal_mdd<T>
-::checkTerminals(node_handle a, node_handle b, node_handle& c)
+inline bool moreequal_mdd<T>
+::terminals(node_handle a, node_handle b, node_handle& c)
 {
-  if (arg1F->isTerminalNode(a) && arg2F->isTerminalNode(b)) {
+  if (this->arg1F->isTerminalNode(a) && this->arg2F->isTerminalNode(b)) {
     T av, bv;
-    arg1F->getValueFromHandle(a, av);
-    arg2F->getValueFromHandle(b, bv);
-    c = resF->handleForValue( av >= bv );
+    this->arg1F->getValueFromHandle(a, av);
+    this->arg2F->getValueFromHandle(b, bv);
+    c = this->resF->handleForValue( av >= bv );
     return true;
   }
   return false;
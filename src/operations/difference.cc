@@ -37,23 +37,22 @@ namespace MEDDLY {
 // *                                                                *
 // ******************************************************************
 
-class MEDDLY::diffr_mdd : public generic_binary_mdd {
+class MEDDLY::diffr_mdd : public binary_mdd_kernel<diffr_mdd, false> {
   public:
     diffr_mdd(const binary_opname* opcode, expert_forest* arg1,
       expert_forest* arg2, expert_forest* res);
 
-  protected:
-    virtual bool checkTerminals(node_handle a, node_handle b, node_handle& c);
+    bool terminals(node_handle a, node_handle b, node_handle& c);
 };
 
 MEDDLY::diffr_mdd::diffr_mdd(const binary_opname* opcode, 
   expert_forest* arg1, expert_forest* arg2, expert_forest* res)
-  : generic_binary_mdd(opcode, arg1, arg2, res)
+  : binary_mdd_kernel<diffr_mdd, false>(opcode, arg1, arg2, res)
 {
   //  difference does NOT commute
 }
 
-bool MEDDLY::diffr_mdd::checkTerminals(node_handle a, node_handle b, node_handle& c)
+inline bool MEDDLY::diffr_mdd::terminals(node_handle a, node_handle b, node_handle& c)
 {
   if (a == 0 || b == -1) {
     c = 0;
@@ -90,23 +89,22 @@ bool MEDDLY::diffr_mdd::checkTerminals(node_handle a, node_handle b, node_handle
 // *                                                                *
 // ******************************************************************
 
-class MEDDLY::diffr_mxd : public generic_binary_mxd {
+class MEDDLY::diffr_mxd : public binary_mxd_kernel<diffr_mxd, false> {
   public:
     diffr_mxd(const binary_opname* opcode, expert_forest* arg1,
       expert_forest* arg2, expert_forest* res);
 
-  protected:
-    virtual bool checkTerminals(node_handle a, node_handle b, node_handle& c);
+    bool terminals(node_handle a, node_handle b, node_handle& c);
 };
 
 MEDDLY::diffr_mxd::diffr_mxd(const binary_opname* opcode, 
   expert_forest* arg1, expert_forest* arg2, expert_forest* res)
-  : generic_binary_mxd(opcode, arg1, arg2, res)
+  : binary_mxd_kernel<diffr_mxd, false>(opcode, arg1, arg2, res)
 {
   //  difference does NOT commute
 }
 
-bool MEDDLY::diffr_mxd::checkTerminals(node_handle a, node_handle b, node_handle& c)
+inline bool MEDDLY::diffr_mxd::terminals(node_handle a, node_handle b, node_handle& c)
 {
   if (a == 0) {
     c = 0;
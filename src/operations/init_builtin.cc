@@ -65,6 +65,12 @@
 
 #include "constrained.h"
 #include "transitive_closure.h"
+#include "quantify.h"
+#include "cofactor.h"
+#include "predicates.h"
+#include "rename.h"
+#include "trace.h"
+#include "nary.h"
 
 #include "mpz_object.h"
 
@@ -80,6 +86,8 @@ namespace MEDDLY {
   const unary_opname* CONVERT_TO_INDEX_SET = 0;
   const unary_opname* CYCLE = 0;
   const unary_opname* SELECT = 0;
+  const unary_opname* TRANSITIVE_CLOSURE_SQUARE = 0;
+  const unary_opname* TRANSITIVE_CLOSURE_SAT = 0;
 
   // binary operation "codes"
 
@@ -87,6 +95,10 @@ namespace MEDDLY {
   const binary_opname* INTERSECTION = 0;
   const binary_opname* DIFFERENCE = 0;
   const binary_opname* CROSS = 0;
+  const binary_opname* RESTRICT = 0;
+  const binary_opname* CONSTRAIN = 0;
+  const binary_opname* SUBSET = 0;
+  const binary_opname* DISJOINT = 0;
 
   const binary_opname* MINIMUM = 0;
   const binary_opname* MAXIMUM = 0;
@@ -128,6 +140,8 @@ namespace MEDDLY {
 
   const satpregen_opname* SATURATION_FORWARD = 0;
   const satpregen_opname* SATURATION_BACKWARD = 0;
+  const satpregen_opname* BFS_FORWARD = 0;
+  const satpregen_opname* CHAINED_BFS_FORWARD = 0;
   const satotf_opname* SATURATION_OTF_FORWARD = 0;
   const satimpl_opname* SATURATION_IMPL_FORWARD = 0;
 
@@ -136,6 +150,20 @@ namespace MEDDLY {
   const constrained_opname* CONSTRAINED_FORWARD_DFS = 0;
   const constrained_opname* CONSTRAINED_BACKWARD_DFS = 0;
   const constrained_opname* TRANSITIVE_CLOSURE_DFS = 0;
+
+  // quantification operation "codes"
+  const quantify_opname* EXISTS = 0;
+  const quantify_opname* FORALL = 0;
+  const quantify_opname* AND_EXISTS = 0;
+  const cofactor_opname* COFACTOR = 0;
+  const rename_opname* RENAME = 0;
+  const trace_opname* SHORTEST_TRACE = 0;
+
+  // n-ary operation "codes"
+  const nary_opname* NARY_UNION = 0;
+  const nary_opname* NARY_INTERSECTION = 0;
+  const nary_opname* NARY_PLUS = 0;
+  const nary_opname* NARY_MAXIMUM = 0;
 };
 
 
@@ -164,11 +192,17 @@ void MEDDLY::builtin_initializer::setup()
   initP(MEDDLY::CONVERT_TO_INDEX_SET, MDD2INDEX,  initializeMDD2INDEX()     );
   initP(MEDDLY::CYCLE,                CYCLE,      initializeCycle()         );
   initP(MEDDLY::SELECT,               SELECT,     initializeSelect()        );
+  initP(MEDDLY::TRANSITIVE_CLOSURE_SQUARE, TC_SQUARE, initTransitiveClosureSquare() );
+  initP(MEDDLY::TRANSITIVE_CLOSURE_SAT,    TC_SAT,    initTransitiveClosureSat()    );
 
   initP(MEDDLY::UNION,                UNION,      initializeUnion()         );
   initP(MEDDLY::INTERSECTION,         INTERSECT,  initializeIntersection()  );
   initP(MEDDLY::DIFFERENCE,           DIFFERENCE, initializeDifference()    );
   initP(MEDDLY::CROSS,                CROSS,      initializeCross()         );
+  initP(MEDDLY::RESTRICT,             RESTRICT,   initializeRestrict()      );
+  initP(MEDDLY::CONSTRAIN,            CONSTRAIN,  initializeConstrain()     );
+  initP(MEDDLY::SUBSET,               SUBSET,     initializeSubset()        );
+  initP(MEDDLY::DISJOINT,             DISJOINT,   initializeDisjoint()      );
 
   initP(MEDDLY::MAXIMUM,              MAX,        initializeMaximum()       );
   initP(MEDDLY::MINIMUM,              MIN,        initializeMinimum()       );
@@ -206,6 +240,8 @@ void MEDDLY::builtin_initializer::setup()
 
   initP(MEDDLY::SATURATION_FORWARD,   SATURATION_FORWARD,   initSaturationForward()   );
   initP(MEDDLY::SATURATION_BACKWARD,  SATURATION_BACKWARD,  initSaturationBackward()  );
+  initP(MEDDLY::BFS_FORWARD,          BFS_FORWARD,          initBFSForward()          );
+  initP(MEDDLY::CHAINED_BFS_FORWARD,  CHAINED_BFS_FORWARD,  initChainedBFSForward()   );
   initP(MEDDLY::SATURATION_OTF_FORWARD,   SATURATION_OTF_FORWARD,   initOtfSaturationForward()  );
   initP(MEDDLY::SATURATION_IMPL_FORWARD, SATURATION_IMPL_FORWARD, initImplSaturationForward()  );
   initP(MEDDLY::CONSTRAINED_BACKWARD_BFS,   CONSTRAINED_BACKWARD_BFS,   initConstrainedBFSBackward()  );
@@ -213,6 +249,18 @@ void MEDDLY::builtin_initializer::setup()
   initP(MEDDLY::CONSTRAINED_BACKWARD_DFS,   CONSTRAINED_BACKWARD_DFS,   initConstrainedDFSBackward()  );
   initP(MEDDLY::TRANSITIVE_CLOSURE_DFS,   TRANSITIVE_CLOSURE_DFS,   initTransitiveClosureDFS()  );
 
+  initP(MEDDLY::EXISTS,               EXISTS,       initExists()            );
+  initP(MEDDLY::FORALL,               FORALL,       initForall()            );
+  initP(MEDDLY::AND_EXISTS,           AND_EXISTS,   initAndExists()         );
+  initP(MEDDLY::COFACTOR,             COFACTOR,     initCofactor()          );
+  initP(MEDDLY::RENAME,               RENAME,       initRename()            );
+  initP(MEDDLY::SHORTEST_TRACE,       SHORTEST_TRACE, initShortestTrace()   );
+
+  initP(MEDDLY::NARY_UNION,           NARY_UNION,         initNaryUnion()         );
+  initP(MEDDLY::NARY_INTERSECTION,    NARY_INTERSECTION,  initNaryIntersection()  );
+  initP(MEDDLY::NARY_PLUS,            NARY_PLUS,          initNaryPlus()          );
+  initP(MEDDLY::NARY_MAXIMUM,         NARY_MAXIMUM,       initNaryMaximum()       );
+
 #ifdef HAVE_LIBGMP
   mpz_object::initBuffer();
 #endif
@@ -236,11 +284,17 @@ void MEDDLY::builtin_initializer::cleanup()
   cleanPair(MINRANGE,       MEDDLY::MIN_RANGE);
   cleanPair(MDD2INDEX,      MEDDLY::CONVERT_TO_INDEX_SET);
   cleanPair(CYCLE,          MEDDLY::CYCLE);
+  cleanPair(TC_SQUARE,      MEDDLY::TRANSITIVE_CLOSURE_SQUARE);
+  cleanPair(TC_SAT,         MEDDLY::TRANSITIVE_CLOSURE_SAT);
 
   cleanPair(UNION,          MEDDLY::UNION);
   cleanPair(INTERSECT,      MEDDLY::INTERSECTION);
   cleanPair(DIFFERENCE,     MEDDLY::DIFFERENCE);
   cleanPair(CROSS,          MEDDLY::CROSS);
+  cleanPair(RESTRICT,       MEDDLY::RESTRICT);
+  cleanPair(CONSTRAIN,      MEDDLY::CONSTRAIN);
+  cleanPair(SUBSET,         MEDDLY::SUBSET);
+  cleanPair(DISJOINT,       MEDDLY::DISJOINT);
 
   cleanPair(MAX,            MEDDLY::MAXIMUM);
   cleanPair(MIN,            MEDDLY::MINIMUM);
@@ -269,10 +323,24 @@ void MEDDLY::builtin_initializer::cleanup()
   cleanPair(BACKWARD_BFS,   MEDDLY::REVERSE_REACHABLE_BFS);
 
   cleanPair(SATURATION_BACKWARD,      MEDDLY::SATURATION_BACKWARD );
+  cleanPair(BFS_FORWARD,              MEDDLY::BFS_FORWARD         );
+  cleanPair(CHAINED_BFS_FORWARD,      MEDDLY::CHAINED_BFS_FORWARD );
   cleanPair(SATURATION_FORWARD,       MEDDLY::SATURATION_FORWARD  );
   cleanPair(SATURATION_OTF_FORWARD,   MEDDLY::SATURATION_OTF_FORWARD  );
   cleanPair(SATURATION_IMPL_FORWARD,   MEDDLY::SATURATION_IMPL_FORWARD  );
 
+  cleanPair(EXISTS,         MEDDLY::EXISTS);
+  cleanPair(FORALL,         MEDDLY::FORALL);
+  cleanPair(AND_EXISTS,     MEDDLY::AND_EXISTS);
+  cleanPair(COFACTOR,       MEDDLY::COFACTOR);
+  cleanPair(RENAME,         MEDDLY::RENAME);
+  cleanPair(SHORTEST_TRACE, MEDDLY::SHORTEST_TRACE);
+
+  cleanPair(NARY_UNION,         MEDDLY::NARY_UNION);
+  cleanPair(NARY_INTERSECTION,  MEDDLY::NARY_INTERSECTION);
+  cleanPair(NARY_PLUS,          MEDDLY::NARY_PLUS);
+  cleanPair(NARY_MAXIMUM,       MEDDLY::NARY_MAXIMUM);
+
   cleanPair(EXPLVECT_MATR_MULT, MEDDLY::EXPLVECT_MATR_MULT);
   cleanPair(MATR_EXPLVECT_MULT, MEDDLY::MATR_EXPLVECT_MULT);
 
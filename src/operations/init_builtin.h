@@ -30,11 +30,17 @@ class MEDDLY::builtin_initializer : public initializer_list {
   unary_opname* MDD2INDEX;
   unary_opname* CYCLE;
   unary_opname* SELECT;
+  unary_opname* TC_SQUARE;
+  unary_opname* TC_SAT;
 
   binary_opname* UNION;
   binary_opname* INTERSECT;
   binary_opname* DIFFERENCE;
   binary_opname* CROSS;
+  binary_opname* RESTRICT;
+  binary_opname* CONSTRAIN;
+  binary_opname* SUBSET;
+  binary_opname* DISJOINT;
 
   binary_opname* MIN;
   binary_opname* MAX;
@@ -72,6 +78,8 @@ class MEDDLY::builtin_initializer : public initializer_list {
 
   satpregen_opname* SATURATION_FORWARD;
   satpregen_opname* SATURATION_BACKWARD;
+  satpregen_opname* BFS_FORWARD;
+  satpregen_opname* CHAINED_BFS_FORWARD;
   satotf_opname* SATURATION_OTF_FORWARD;
   satimpl_opname* SATURATION_IMPL_FORWARD;
 
@@ -80,6 +88,18 @@ class MEDDLY::builtin_initializer : public initializer_list {
   constrained_opname* CONSTRAINED_BACKWARD_DFS;
   constrained_opname* TRANSITIVE_CLOSURE_DFS;
 
+  quantify_opname* EXISTS;
+  quantify_opname* FORALL;
+  quantify_opname* AND_EXISTS;
+  cofactor_opname* COFACTOR;
+  rename_opname* RENAME;
+  trace_opname* SHORTEST_TRACE;
+
+  nary_opname* NARY_UNION;
+  nary_opname* NARY_INTERSECTION;
+  nary_opname* NARY_PLUS;
+  nary_opname* NARY_MAXIMUM;
+
 public:
   builtin_initializer(initializer_list *p);
 protected:
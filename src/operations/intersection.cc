@@ -39,23 +39,21 @@ namespace MEDDLY {
 // *                                                                *
 // ******************************************************************
 
-class MEDDLY::inter_mdd : public generic_binary_mdd {
+class MEDDLY::inter_mdd : public binary_mdd_kernel<inter_mdd, true> {
   public:
     inter_mdd(const binary_opname* opcode, expert_forest* arg1,
       expert_forest* arg2, expert_forest* res);
 
-  protected:
-    virtual bool checkTerminals(node_handle a, node_handle b, node_handle& c);
+    bool terminals(node_handle a, node_handle b, node_handle& c);
 };
 
 MEDDLY::inter_mdd::inter_mdd(const binary_opname* opcode, 
   expert_forest* arg1, expert_forest* arg2, expert_forest* res)
-  : generic_binary_mdd(opcode, arg1, arg2, res)
+  : binary_mdd_kernel<inter_mdd, true>(opcode, arg1, arg2, res)
 {
-  operationCommutes();
 }
 
-bool MEDDLY::inter_mdd::checkTerminals(node_handle a, node_handle b, node_handle& c)
+inline bool MEDDLY::inter_mdd::terminals(node_handle a, node_handle b, node_handle& c)
 {
   if (a == 0 || b == 0) {
     c = 0;
@@ -100,24 +98,24 @@ bool MEDDLY::inter_mdd::checkTerminals(node_handle a, node_handle b, node_handle
 // *                                                                *
 // ******************************************************************
 
-class MEDDLY::inter_mxd : public generic_binary_mxd {
+class MEDDLY::inter_mxd : public binary_mxd_kernel<inter_mxd, true> {
   public:
     inter_mxd(const binary_opname* opcode, expert_forest* arg1,
       expert_forest* arg2, expert_forest* res);
 
+    bool terminals(node_handle a, node_handle b, node_handle& c);
+
   protected:
-    virtual bool checkTerminals(node_handle a, node_handle b, node_handle& c);
     virtual MEDDLY::node_handle compute_ext(node_handle a, node_handle b);
 };
 
 MEDDLY::inter_mxd::inter_mxd(const binary_opname* opcode, 
   expert_forest* arg1, expert_forest* arg2, expert_forest* res)
-  : generic_binary_mxd(opcode, arg1, arg2, res)
+  : binary_mxd_kernel<inter_mxd, true>(opcode, arg1, arg2, res)
 {
-  operationCommutes();
 }
 
-bool MEDDLY::inter_mxd::checkTerminals(node_handle a, node_handle b, node_handle& c)
+inline bool MEDDLY::inter_mxd::terminals(node_handle a, node_handle b, node_handle& c)
 {
   if (a == 0 || b == 0) {
     c = 0;
@@ -40,23 +40,21 @@ namespace MEDDLY {
 // *                                                                *
 // ******************************************************************
 
-class MEDDLY::maximum_mdd : public generic_binary_mdd {
+class MEDDLY::maximum_mdd : public binary_mdd_kernel<maximum_mdd, true> {
   public:
     maximum_mdd(const binary_opname* opcode, expert_forest* arg1,
       expert_forest* arg2, expert_forest* res);
 
-  protected:
-    virtual bool checkTerminals(node_handle a, node_handle b, node_handle& c);
+    bool terminals(node_handle a, node_handle b, node_handle& c);
 };
 
 MEDDLY::maximum_mdd::maximum_mdd(const binary_opname* opcode, 
   expert_forest* arg1, expert_forest* arg2, expert_forest* res)
-  : generic_binary_mdd(opcode, arg1, arg2, res)
+  : binary_mdd_kernel<maximum_mdd, true>(opcode, arg1, arg2, res)
 {
-  operationCommutes();
 }
 
-bool MEDDLY::maximum_mdd::checkTerminals(node_handle a, node_handle b, node_handle& c)
+inline bool MEDDLY::maximum_mdd::terminals(node_handle a, node_handle b, node_handle& c)
 {
   if (arg1F->isTerminalNode(a) && arg2F->isTerminalNode(b)) {
     if (resF->getRangeType() == forest::INTEGER) {
@@ -83,23 +81,21 @@ bool MEDDLY::maximum_mdd::checkTerminals(node_handle a, node_handle b, node_hand
 // *                                                                *
 // ******************************************************************
 
-class MEDDLY::maximum_mxd : public generic_binary_mxd {
+class MEDDLY::maximum_mxd : public binary_mxd_kernel<maximum_mxd, true> {
   public:
     maximum_mxd(const binary_opname* opcode, expert_forest* arg1,
       expert_forest* arg2, expert_forest* res);
 
-  protected:
-    virtual bool checkTerminals(node_handle a, node_handle b, node_handle& c);
+    bool terminals(node_handle a, node_handle b, node_handle& c);
 };
 
 MEDDLY::maximum_mxd::maximum_mxd(const binary_opname* opcode, 
   expert_forest* arg1, expert_forest* arg2, expert_forest* res)
-  : generic_binary_mxd(opcode, arg1, arg2, res)
+  : binary_mxd_kernel<maximum_mxd, true>(opcode, arg1, arg2, res)
 {
-  operationCommutes();
 }
 
-bool MEDDLY::maximum_mxd::checkTerminals(node_handle a, node_handle b, node_handle& c)
+inline bool MEDDLY::maximum_mxd::terminals(node_handle a, node_handle b, node_handle& c)
 {
   if (arg1F->isTerminalNode(a) && arg2F->isTerminalNode(b)) {
     if (resF->getRangeType() == forest::INTEGER) {
@@ -175,23 +171,21 @@ MEDDLY::maximum_opname::buildOperation(expert_forest* a1, expert_forest* a2,
 // *                                                                *
 // ******************************************************************
 
-class MEDDLY::minimum_mdd : public generic_binary_mdd {
+class MEDDLY::minimum_mdd : public binary_mdd_kernel<minimum_mdd, true> {
   public:
     minimum_mdd(const binary_opname* opcode, expert_forest* arg1,
       expert_forest* arg2, expert_forest* res);
 
-  protected:
-    virtual bool checkTerminals(node_handle a, node_handle b, node_handle& c);
+    bool terminals(node_handle a, node_handle b, node_handle& c);
 };
 
 MEDDLY::minimum_mdd::minimum_mdd(const binary_opname* opcode, 
   expert_forest* arg1, expert_forest* arg2, expert_forest* res)
-  : generic_binary_mdd(opcode, arg1, arg2, res)
+  : binary_mdd_kernel<minimum_mdd, true>(opcode, arg1, arg2, res)
 {
-  operationCommutes();
 }
 
-bool MEDDLY::minimum_mdd::checkTerminals(node_handle a, node_handle b, node_handle& c)
+inline bool MEDDLY::minimum_mdd::terminals(node_handle a, node_handle b, node_handle& c)
 {
   if (arg1F->isTerminalNode(a) && arg2F->isTerminalNode(b)) {
     if (resF->getRangeType() == forest::INTEGER) {
@@ -218,23 +212,21 @@ bool MEDDLY::minimum_mdd::checkTerminals(node_handle a, node_handle b, node_hand
 // *                                                                *
 // ******************************************************************
 
-class MEDDLY::minimum_mxd : public generic_binary_mxd {
+class MEDDLY::minimum_mxd : public binary_mxd_kernel<minimum_mxd, true> {
   public:
     minimum_mxd(const binary_opname* opcode, expert_forest* arg1,
       expert_forest* arg2, expert_forest* res);
 
-  protected:
-    virtual bool checkTerminals(node_handle a, node_handle b, node_handle& c);
+    bool terminals(node_handle a, node_handle b, node_handle& c);
 };
 
 MEDDLY::minimum_mxd::minimum_mxd(const binary_opname* opcode, 
   expert_forest* arg1, expert_forest* arg2, expert_forest* res)
-  : generic_binary_mxd(opcode, arg1, arg2, res)
+  : binary_mxd_kernel<minimum_mxd, true>(opcode, arg1, arg2, res)
 {
-  operationCommutes();
 }
 
-bool MEDDLY::minimum_mxd::checkTerminals(node_handle a, node_handle b, node_handle& c)
+inline bool MEDDLY::minimum_mxd::terminals(node_handle a, node_handle b, node_handle& c)
 {
   if (arg1F->isTerminalNode(a) && arg2F->isTerminalNode(b)) {
     if (resF->getRangeType() == forest::INTEGER) {
@@ -30,6 +30,7 @@ namespace MEDDLY {
   class mm_mult_op;
 
   class mm_mult_mxd;
+  class mm_mult_bool;
 
   class mm_mult_opname;
 };
@@ -351,6 +352,134 @@ namespace MEDDLY {
 };
 
 
+// ******************************************************************
+// *                                                                *
+// *                        mm_mult_bool class                      *
+// *                                                                *
+// ******************************************************************
+
+/** Composition of two relations, stored as BOOLEAN identity-reduced MXDs.
+    C[m][n] = OR over i of A[m][i] AND B[i][n].
+    Skipped levels are read as identity patterns,
+    so unlike mm_mult_mxd, skipped primed levels are handled too.
+    Nodes may also be primed, below a redundant unprimed level.
+*/
+class MEDDLY::mm_mult_bool : public mm_mult_op {
+  public:
+    mm_mult_bool(const binary_opname* opcode, expert_forest* arg1,
+      expert_forest* arg2, expert_forest* res, binary_operation* acc);
+
+  protected:
+    virtual node_handle compute_rec(node_handle a, node_handle b);
+
+  private:
+    /// Reader for row i of a node whose unprimed level is k.
+    static unpacked_node* newRow(const expert_forest* f, int k,
+      const unpacked_node* u, unsigned i);
+};
+
+MEDDLY::mm_mult_bool::mm_mult_bool(const binary_opname* oc,
+  expert_forest* a1, expert_forest* a2, expert_forest* res,
+  binary_operation* acc)
+: mm_mult_op(oc, a1, a2, res, acc)
+{
+  MEDDLY_DCASSERT(a1->isIdentityReduced());
+  MEDDLY_DCASSERT(a2->isIdentityReduced());
+  MEDDLY_DCASSERT(res->isIdentityReduced());
+}
+
+MEDDLY::unpacked_node* MEDDLY::mm_mult_bool::newRow(const expert_forest* f,
+  int k, const unpacked_node* u, unsigned i)
+{
+  return isLevelAbove(-k, f->getNodeLevel(u->d(i)))
+    ? unpacked_node::newIdentity(f, -k, i, u->d(i), true)
+    : unpacked_node::newFromNode(f, u->d(i), true);
+}
+
+MEDDLY::node_handle MEDDLY::mm_mult_bool::compute_rec(node_handle a,
+  node_handle b)
+{
+  // termination conditions
+  if (a == 0 || b == 0) return 0;
+  if (arg1F->isTerminalNode(a) && arg2F->isTerminalNode(b)) {
+    // identity composed with identity
+    return resF->handleForValue(true);
+  }
+
+  // check the cache
+  node_handle result = 0;
+  compute_table::entry_key* Key = findResult(a, b, result);
+  if (0==Key) return result;
+
+  // Either node may be primed, if its unprimed level was redundant
+  const int aLevel = arg1F->getNodeLevel(a);
+  const int bLevel = arg2F->getNodeLevel(b);
+  const int rLevel = MAX(ABS(aLevel), ABS(bLevel));
+  const unsigned rSize = unsigned(resF->getLevelSize(rLevel));
+
+  // Readers; a skipped unprimed level is redundant, and then
+  // a skipped primed level is an identity pattern
+  unpacked_node* A = isLevelAbove(rLevel, aLevel)
+    ? unpacked_node::newRedundant(arg1F, rLevel, a, true)
+    : unpacked_node::newFromNode(arg1F, a, true);
+  unpacked_node* B = isLevelAbove(rLevel, bLevel)
+    ? unpacked_node::newRedundant(arg2F, rLevel, b, true)
+    : unpacked_node::newFromNode(arg2F, b, true);
+
+  unpacked_node** Bp = new unpacked_node*[rSize];
+  for (unsigned j = 0; j < rSize; j++) {
+    Bp[j] = (j < B->getSize() && B->d(j)) ? newRow(arg2F, rLevel, B, j) : 0;
+  }
+
+  dd_edge resultik(resF), temp(resF);
+
+  // For all i, j and k: r[i][k] |= compute_rec(a[i][j], b[j][k])
+  unpacked_node* nbr = unpacked_node::newFull(resF, rLevel, rSize);
+  for (unsigned i = 0; i < rSize; i++) {
+    if (i >= A->getSize() || 0 == A->d(i)) {
+      nbr->d_ref(i) = 0;
+      continue;
+    }
+    unpacked_node* Ap = newRow(arg1F, rLevel, A, i);
+    unpacked_node* nbri = unpacked_node::newFull(resF, -rLevel, rSize);
+    for (unsigned k = 0; k < rSize; k++) nbri->d_ref(k) = 0;
+
+    for (unsigned j = 0; j < Ap->getSize(); j++) {
+      if (0 == Ap->d(j) || j >= rSize || 0 == Bp[j]) continue;
+      for (unsigned k = 0; k < Bp[j]->getSize(); k++) {
+        if (0 == Bp[j]->d(k)) continue;
+        node_handle res = compute_rec(Ap->d(j), Bp[j]->d(k));
+        if (0 == res) continue;
+        if (0 == nbri->d(k)) {
+          nbri->d_ref(k) = res;
+          continue;
+        }
+        // Do the union
+        resultik.set(nbri->d(k));
+        temp.set(res);
+        accumulateOp->compute(resultik, temp, resultik);
+        nbri->set_d(k, resultik);
+      }
+    }
+    unpacked_node::recycle(Ap);
+    nbr->d_ref(i) = resF->createReducedNode(int(i), nbri);
+  }
+
+  for (unsigned j = 0; j < rSize; j++) {
+    if (Bp[j]) unpacked_node::recycle(Bp[j]);
+  }
+  delete[] Bp;
+  unpacked_node::recycle(B);
+  unpacked_node::recycle(A);
+
+  result = resF->createReducedNode(-1, nbr);
+#ifdef TRACE_ALL_OPS
+  printf("computed new mm_mult_bool(%d, %d) = %d\n", a, b, result);
+#endif
+  return saveResult(Key, a, b, result);
+}
+
+
 // ************************************************************************
 // *                                                                      *
 // *                                                                      *
@@ -393,9 +522,6 @@ MEDDLY::mm_mult_opname::buildOperation(expert_forest* a1, expert_forest* a2,
     throw error(error::DOMAIN_MISMATCH, __FILE__, __LINE__);
 
   if (
-    (a1->getRangeType() == forest::BOOLEAN) ||
-    (a2->getRangeType() == forest::BOOLEAN) ||
-    (r->getRangeType()  == forest::BOOLEAN) ||
     !a1->isForRelations()   ||
     !a2->isForRelations()   ||
     !r->isForRelations()    ||
@@ -405,6 +531,31 @@ MEDDLY::mm_mult_opname::buildOperation(expert_forest* a1, expert_forest* a2,
   )
     throw error(error::TYPE_MISMATCH, __FILE__, __LINE__);
 
+  //
+  // BOOLEAN relations: composition
+  //
+  if (
+    (a1->getRangeType() == forest::BOOLEAN) ||
+    (a2->getRangeType() == forest::BOOLEAN) ||
+    (r->getRangeType()  == forest::BOOLEAN)
+  ) {
+    if (
+      (a1->getRangeType() != forest::BOOLEAN) ||
+      (a2->getRangeType() != forest::BOOLEAN) ||
+      (r->getRangeType()  != forest::BOOLEAN)
+    )
+      throw error(error::TYPE_MISMATCH, __FILE__, __LINE__);
+
+    if (
+      !a1->isIdentityReduced() ||
+      !a2->isIdentityReduced() ||
+      !r->isIdentityReduced()
+    )
+      throw error(error::NOT_IMPLEMENTED, __FILE__, __LINE__);
+
+    return new mm_mult_bool(this, a1, a2, r, getOperation(UNION, r, r, r));
+  }
+
   binary_operation* acc = getOperation(PLUS, r, r, r);
 
   switch (r->getRangeType()) {
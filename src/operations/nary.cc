@@ -0,0 +1,473 @@
+
+/*
+    Meddly: Multi-terminal and Edge-valued Decision Diagram LibrarY.
+    Copyright (C) 2009, Iowa State University Research Foundation, Inc.
+
+    This library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "../defines.h"
+#include "nary.h"
+#include "../forests/mt.h"
+
+#include <algorithm>
+
+namespace MEDDLY {
+  class nary_op;
+  class nary_opname_impl;
+};
+
+// ******************************************************************
+// *                                                                *
+// *                      nary_opname  methods                      *
+// *                                                                *
+// ******************************************************************
+
+MEDDLY::nary_opname::nary_opname(const char* n)
+ : specialized_opname(n)
+{
+}
+
+MEDDLY::nary_opname::~nary_opname()
+{
+}
+
+MEDDLY::nary_opname::nary_args::nary_args(forest* f)
+{
+  F = f;
+  if (0==F) throw error(error::MISCELLANEOUS, __FILE__, __LINE__);
+}
+
+MEDDLY::nary_opname::nary_args::~nary_args()
+{
+}
+
+// ******************************************************************
+// *                                                                *
+// *                         nary_op  class                         *
+// *                                                                *
+// ******************************************************************
+
+/** N-ary union, intersection, plus and maximum.
+    All operands are expanded together at the topmost level among them,
+    so a chain of n binary operations becomes a single traversal and
+    no intermediate diagrams are built.
+    Before each step, the operand list is normalized: terminal operands
+    are folded together, neutral ones are dropped, absorbing ones end
+    the recursion, and the list is sorted (and duplicates removed, when
+    the operation is idempotent).  The normalized list is the CT key,
+    so permutations of the same operands share one entry.
+    A compute table entry holds only a few operands, so longer lists
+    are combined in chunks of at most maxKeyOps operands, and then
+    the results of the chunks are combined (all four operations are
+    associative and commutative).
+*/
+class MEDDLY::nary_op : public specialized_operation {
+  public:
+    enum kind {
+      UNION,
+      INTERSECTION,
+      PLUS,
+      MAXIMUM
+    };
+
+  public:
+    nary_op(const nary_opname* code, nary_opname::nary_args* a, kind k);
+
+    virtual bool checkForestCompatibility() const;
+
+    virtual void compute(const dd_edge* a, unsigned n, dd_edge &c);
+
+  protected:
+    virtual ~nary_op();
+
+    /**
+        Compute the operation on nodes a[0], ..., a[n-1].
+        The array may be modified.
+    */
+    node_handle compute(node_handle* a, unsigned n);
+
+    /**
+        Compute the operation on more than maxKeyOps normalized
+        operands, one chunk at a time.
+    */
+    node_handle computeChunks(node_handle* a, unsigned n);
+
+    /**
+        Normalize the operand list, in place.
+          @param  a   Operands.
+          @param  n   In: number of operands; out: number after normalizing.
+          @param  c   Output: the result, if we can determine it.
+          @return true, iff the result is known.
+    */
+    bool normalize(node_handle* a, unsigned &n, node_handle &c) const;
+
+  private:
+    /// Combine two terminal operands.
+    node_handle combineTerminals(node_handle a, node_handle b) const;
+
+    inline compute_table::entry_key*
+    findResult(const node_handle* a, unsigned n, node_handle &c) {
+      compute_table::entry_key* CTsrch = CT0->useEntryKey(etype[0], n);
+      MEDDLY_DCASSERT(CTsrch);
+      for (unsigned i=0; i<n; i++) CTsrch->writeN(a[i]);
+      CT0->find(CTsrch, CTresult[0]);
+      if (!CTresult[0]) return CTsrch;
+      c = F->linkNode(CTresult[0].readN());
+      CT0->recycle(CTsrch);
+      return 0;
+    }
+    inline node_handle saveResult(compute_table::entry_key* Key,
+      node_handle c)
+    {
+      CTresult[0].reset();
+      CTresult[0].writeN(c);
+      CT0->addEntry(Key, CTresult[0]);
+      return c;
+    }
+
+  private:
+    /// Most operands in one CT key; fits an entry with 64-bit handles.
+    static const unsigned maxKeyOps = 8;
+
+    nary_opname::nary_args* args;
+    expert_forest* F;
+    kind opkind;
+    /// Terminal for "true"; for boolean forests only.
+    node_handle one;
+    /// Skipped levels in relations mean identity, not redundant.
+    bool identity;
+};
+
+MEDDLY::nary_op::nary_op(const nary_opname* code, nary_opname::nary_args* a,
+  kind k) : specialized_operation(code, 1)
+{
+  MEDDLY_DCASSERT(a);
+  args = a;
+  F = static_cast<expert_forest*>(a->getForest());
+  opkind = k;
+  one = (F->getRangeType() == forest::BOOLEAN) ? F->handleForValue(true) : 0;
+  identity = F->isForRelations() && F->isIdentityReduced();
+
+  registerInForest(F);
+
+  compute_table::entry_type* et;
+  et = new compute_table::entry_type(code->getName(), ".N:N");
+  et->setForestForSlot(1, F);
+  et->setForestForSlot(3, F);
+  registerEntryType(0, et);
+
+  buildCTs();
+}
+
+MEDDLY::nary_op::~nary_op()
+{
+  if (args->autoDestroy()) delete args;
+  unregisterInForest(F);
+}
+
+bool MEDDLY::nary_op::checkForestCompatibility() const
+{
+  return true;
+}
+
+void MEDDLY::nary_op::compute(const dd_edge* a, unsigned n, dd_edge &c)
+{
+  if (0==n) throw error(error::WRONG_NUMBER, __FILE__, __LINE__);
+  if (0==a) throw error(error::INVALID_ARGUMENT, __FILE__, __LINE__);
+  if (c.getForest() != F)
+    throw error(error::FOREST_MISMATCH, __FILE__, __LINE__);
+
+  node_handle* ops = new node_handle[n];
+  for (unsigned i=0; i<n; i++) {
+    if (a[i].getForest() != F) {
+      delete[] ops;
+      throw error(error::FOREST_MISMATCH, __FILE__, __LINE__);
+    }
+    ops[i] = a[i].getNode();
+  }
+  node_handle cnode = compute(ops, n);
+  delete[] ops;
+
+  const int num_levels = F->getDomain()->getNumVariables();
+  if (F->isQuasiReduced() && cnode != F->getTransparentNode()
+    && F->getNodeLevel(cnode) < num_levels) {
+    node_handle temp = ((mt_forest*)F)->makeNodeAtLevel(num_levels, cnode);
+    F->unlinkNode(cnode);
+    cnode = temp;
+  }
+  c.set(cnode);
+}
+
+MEDDLY::node_handle MEDDLY::nary_op::compute(node_handle* a, unsigned n)
+{
+  node_handle result = 0;
+  if (normalize(a, n, result)) return result;
+  if (n > maxKeyOps) return computeChunks(a, n);
+
+  compute_table::entry_key* Key = findResult(a, n, result);
+  if (0==Key) return result;
+
+  //
+  // Expand every operand at the topmost unprimed level
+  //
+  int k = 0;
+  for (unsigned i=0; i<n; i++) {
+    k = MAX(k, ABS(F->getNodeLevel(a[i])));
+  }
+  MEDDLY_DCASSERT(k>0);
+  const unsigned sz = unsigned(F->getLevelSize(k));
+
+  unpacked_node** U = new unpacked_node*[n];
+  for (unsigned i=0; i<n; i++) {
+    // for relations, a primed node here has a redundant unprimed level
+    U[i] = (F->getNodeLevel(a[i]) == k)
+      ? unpacked_node::newFromNode(F, a[i], true)
+      : unpacked_node::newRedundant(F, k, a[i], true);
+  }
+  node_handle* b = new node_handle[n];
+  unpacked_node* C = unpacked_node::newFull(F, k, sz);
+
+  if (!F->isForRelations()) {
+    for (unsigned j=0; j<sz; j++) {
+      for (unsigned i=0; i<n; i++) b[i] = U[i]->d(j);
+      C->d_ref(j) = compute(b, n);
+    }
+
+    if (F->isQuasiReduced()) {
+      const int nextLevel = k - 1;
+      for (unsigned j=0; j<sz; j++) {
+        if (F->getNodeLevel(C->d(j)) < nextLevel) {
+          node_handle temp = ((mt_forest*)F)->makeNodeAtLevel(nextLevel, C->d(j));
+          F->unlinkNode(C->d(j));
+          C->d_ref(j) = temp;
+        }
+      }
+    }
+  } else {
+    unpacked_node** R = new unpacked_node*[n];
+    for (unsigned j=0; j<sz; j++) {
+      for (unsigned i=0; i<n; i++) R[i] = unpacked_node::newRow(F, k, U[i], j);
+      unpacked_node* Cp = unpacked_node::newFull(F, -k, sz);
+      for (unsigned jp=0; jp<sz; jp++) {
+        for (unsigned i=0; i<n; i++) b[i] = R[i]->d(jp);
+        Cp->d_ref(jp) = compute(b, n);
+      }
+      for (unsigned i=0; i<n; i++) unpacked_node::recycle(R[i]);
+      C->d_ref(j) = F->createReducedNode(int(j), Cp);
+    }
+    delete[] R;
+  }
+
+  for (unsigned i=0; i<n; i++) unpacked_node::recycle(U[i]);
+  delete[] U;
+  delete[] b;
+
+  result = F->createReducedNode(-1, C);
+  return saveResult(Key, result);
+}
+
+MEDDLY::node_handle MEDDLY::nary_op::computeChunks(node_handle* a, unsigned n)
+{
+  const unsigned m = (n + maxKeyOps - 1) / maxKeyOps;
+  node_handle* c = new node_handle[m];
+  node_handle* b = new node_handle[m];
+  for (unsigned i=0; i<m; i++) {
+    const unsigned first = i * maxKeyOps;
+    c[i] = compute(a + first, MIN(maxKeyOps, n - first));
+    b[i] = c[i];
+  }
+  // compute() reorders b, so unlink the chunk results from c
+  node_handle result = compute(b, m);
+  for (unsigned i=0; i<m; i++) F->unlinkNode(c[i]);
+  delete[] b;
+  delete[] c;
+  return result;
+}
+
+bool MEDDLY::nary_op::normalize(node_handle* a, unsigned &n,
+  node_handle &c) const
+{
+  //
+  // Fold terminals, and drop neutral operands.
+  // In identity reduced forests, a terminal is a diagonal, so
+  // "true" is neither absorbing for union nor neutral for intersection.
+  //
+  node_handle term = 0;
+  bool hasTerm = false;
+  unsigned m = 0;
+  for (unsigned i=0; i<n; i++) {
+    if (!F->isTerminalNode(a[i])) {
+      a[m++] = a[i];
+      continue;
+    }
+    switch (opkind) {
+      case UNION:
+        if (0==a[i]) continue;
+        if (!identity) {
+          c = one;
+          return true;
+        }
+        break;
+
+      case INTERSECTION:
+        if (0==a[i]) {
+          c = 0;
+          return true;
+        }
+        if (!identity) continue;
+        break;
+
+      default:
+        break;
+    }
+    term = hasTerm ? combineTerminals(term, a[i]) : a[i];
+    hasTerm = true;
+  }
+  if (hasTerm && !(PLUS == opkind && 0==term)) {
+    a[m++] = term;
+  }
+  n = m;
+
+  //
+  // Canonical order, for the CT key
+  //
+  std::sort(a, a+n);
+  if (PLUS != opkind) {
+    n = unsigned(std::unique(a, a+n) - a);
+  }
+
+  switch (n) {
+    case 0:
+      // only possible if every operand was neutral
+      MEDDLY_DCASSERT(MAXIMUM != opkind);
+      c = (INTERSECTION == opkind) ? one : 0;
+      return true;
+
+    case 1:
+      c = F->linkNode(a[0]);
+      return true;
+
+    default:
+      return false;
+  }
+}
+
+MEDDLY::node_handle
+MEDDLY::nary_op::combineTerminals(node_handle a, node_handle b) const
+{
+  switch (opkind) {
+    case UNION:
+    case INTERSECTION:
+      // both are "true"
+      MEDDLY_DCASSERT(a == b);
+      return a;
+
+    default:
+      break;
+  }
+  if (F->getRangeType() == forest::INTEGER) {
+    int av, bv;
+    F->getValueFromHandle(a, av);
+    F->getValueFromHandle(b, bv);
+    return F->handleForValue( (PLUS == opkind) ? av + bv : MAX(av, bv) );
+  }
+  MEDDLY_DCASSERT(F->getRangeType() == forest::REAL);
+  float av, bv;
+  F->getValueFromHandle(a, av);
+  F->getValueFromHandle(b, bv);
+  return F->handleForValue( (PLUS == opkind) ? av + bv : MAX(av, bv) );
+}
+
+// ******************************************************************
+// *                                                                *
+// *                    nary_opname_impl   class                    *
+// *                                                                *
+// ******************************************************************
+
+class MEDDLY::nary_opname_impl : public nary_opname {
+  public:
+    nary_opname_impl(const char* n, nary_op::kind k);
+    virtual specialized_operation* buildOperation(arguments* a) const;
+  private:
+    nary_op::kind opkind;
+};
+
+MEDDLY::nary_opname_impl::nary_opname_impl(const char* n, nary_op::kind k)
+ : nary_opname(n)
+{
+  opkind = k;
+}
+
+MEDDLY::specialized_operation*
+MEDDLY::nary_opname_impl::buildOperation(arguments* a) const
+{
+  nary_args* na = dynamic_cast<nary_args*>(a);
+  if (0==na) throw error(error::INVALID_ARGUMENT, __FILE__, __LINE__);
+
+  const forest* f = na->getForest();
+
+  if (f->getEdgeLabeling() != forest::MULTI_TERMINAL)
+    throw error(error::TYPE_MISMATCH, __FILE__, __LINE__);
+
+  switch (opkind) {
+    case nary_op::UNION:
+    case nary_op::INTERSECTION:
+      if (f->getRangeType() != forest::BOOLEAN)
+        throw error(error::TYPE_MISMATCH, __FILE__, __LINE__);
+      break;
+
+    default:
+      if (f->getRangeType() == forest::BOOLEAN)
+        throw error(error::TYPE_MISMATCH, __FILE__, __LINE__);
+  }
+
+  if (f->isForRelations()) {
+    if (!f->isFullyReduced() && !f->isIdentityReduced())
+      throw error(error::NOT_IMPLEMENTED, __FILE__, __LINE__);
+  } else {
+    if (!f->isFullyReduced() && !f->isQuasiReduced())
+      throw error(error::NOT_IMPLEMENTED, __FILE__, __LINE__);
+  }
+
+  return new nary_op(this, na, opkind);
+}
+
+// ******************************************************************
+// *                                                                *
+// *                           Front  end                           *
+// *                                                                *
+// ******************************************************************
+
+MEDDLY::nary_opname* MEDDLY::initNaryUnion()
+{
+  return new nary_opname_impl("N-ary union", nary_op::UNION);
+}
+
+MEDDLY::nary_opname* MEDDLY::initNaryIntersection()
+{
+  return new nary_opname_impl("N-ary intersection", nary_op::INTERSECTION);
+}
+
+MEDDLY::nary_opname* MEDDLY::initNaryPlus()
+{
+  return new nary_opname_impl("N-ary plus", nary_op::PLUS);
+}
+
+MEDDLY::nary_opname* MEDDLY::initNaryMaximum()
+{
+  return new nary_opname_impl("N-ary maximum", nary_op::MAXIMUM);
+}
+
@@ -0,0 +1,39 @@
+
+/*
+    Meddly: Multi-terminal and Edge-valued Decision Diagram LibrarY.
+    Copyright (C) 2009, Iowa State University Research Foundation, Inc.
+
+    This library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published 
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef NARY_H
+#define NARY_H
+
+namespace MEDDLY {
+  class nary_opname;
+
+  /// Set up a nary_opname for the "n-ary union" operation.
+  nary_opname* initNaryUnion();
+
+  /// Set up a nary_opname for the "n-ary intersection" operation.
+  nary_opname* initNaryIntersection();
+
+  /// Set up a nary_opname for the "n-ary plus" operation.
+  nary_opname* initNaryPlus();
+
+  /// Set up a nary_opname for the "n-ary maximum" operation.
+  nary_opname* initNaryMaximum();
+}
+
+#endif
@@ -0,0 +1,383 @@
+
+/*
+    Meddly: Multi-terminal and Edge-valued Decision Diagram LibrarY.
+    Copyright (C) 2009, Iowa State University Research Foundation, Inc.
+
+    This library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include "../defines.h"
+#include "predicates.h"
+
+namespace MEDDLY {
+  class set_predicate;
+  class subset_pred;
+  class disjoint_pred;
+
+  class predicate_opname;
+};
+
+// ******************************************************************
+// *                                                                *
+// *                      set_predicate  class                      *
+// *                                                                *
+// ******************************************************************
+
+/** Abstract base class: a predicate on two sets (or relations).
+
+    Both predicates here hold for a pair of nodes exactly when
+    they hold for every pair of children, so the recursion
+    stops at the first pair of children that fails.
+    No nodes are built; results are cached as integers.
+    There is no result forest.
+*/
+class MEDDLY::set_predicate : public binary_operation {
+  public:
+    set_predicate(const binary_opname* code, expert_forest* arg1,
+      expert_forest* arg2);
+
+    virtual bool checkForestCompatibility() const;
+
+    virtual void computeDDEdge(const dd_edge &a, const dd_edge &b,
+      dd_edge &c);
+    virtual void compute(const dd_edge &a, const dd_edge &b, bool &c);
+
+  protected:
+    /// Decide the terminal cases; returns true iff c was set.
+    virtual bool terminals(node_handle a, node_handle b, bool &c) const = 0;
+
+    /// Recursive part, for unprimed levels.
+    bool compute_r(node_handle a, node_handle b);
+
+    /// Recursive part, for row in of primed level k.
+    bool compute_pr(unsigned in, int k, node_handle a, node_handle b);
+
+    inline compute_table::entry_key*
+    findResult(node_handle a, node_handle b, bool &c)
+    {
+      compute_table::entry_key* CTsrch = CT0->useEntryKey(etype[0], 0);
+      MEDDLY_DCASSERT(CTsrch);
+      if (can_commute && a > b) {
+        CTsrch->writeN(b);
+        CTsrch->writeN(a);
+      } else {
+        CTsrch->writeN(a);
+        CTsrch->writeN(b);
+      }
+      CT0->find(CTsrch, CTresult[0]);
+      if (!CTresult[0]) return CTsrch;
+      c = CTresult[0].readI();
+      CT0->recycle(CTsrch);
+      return 0;
+    }
+    inline bool saveResult(compute_table::entry_key* Key, bool c)
+    {
+      CTresult[0].reset();
+      CTresult[0].writeI(c ? 1 : 0);
+      CT0->addEntry(Key, CTresult[0]);
+      return c;
+    }
+
+  private:
+    /** Child i of reader X, including the extensible tail.
+          @param  skipped   If true, X is a redundant reader for
+                            node x, which covers every index.
+    */
+    static inline node_handle child(const unpacked_node* X, bool skipped,
+      node_handle x, unsigned i)
+    {
+      if (i < X->getSize()) return X->d(i);
+      if (skipped) return x;
+      return X->isExtensible() ? X->ext_d() : 0;
+    }
+
+    /// Check every pair of children of A and B.
+    bool checkChildren(const unpacked_node* A, bool askip, node_handle a,
+      const unpacked_node* B, bool bskip, node_handle b, int k);
+};
+
+MEDDLY::set_predicate::set_predicate(const binary_opname* code,
+  expert_forest* arg1, expert_forest* arg2)
+  : binary_operation(code, 1, arg1, arg2, 0)
+{
+  compute_table::entry_type* et = new compute_table::entry_type(code->getName(), "NN:I");
+  et->setForestForSlot(0, arg1);
+  et->setForestForSlot(1, arg2);
+  registerEntryType(0, et);
+  buildCTs();
+}
+
+bool MEDDLY::set_predicate::checkForestCompatibility() const
+{
+  auto o1 = arg1F->variableOrder();
+  auto o2 = arg2F->variableOrder();
+  return o1->is_compatible_with(*o2);
+}
+
+void MEDDLY::set_predicate::computeDDEdge(const dd_edge &a, const dd_edge &b,
+  dd_edge &c)
+{
+  throw error(error::TYPE_MISMATCH, __FILE__, __LINE__);
+}
+
+void MEDDLY::set_predicate::compute(const dd_edge &a, const dd_edge &b,
+  bool &c)
+{
+  if (!checkForestCompatibility()) {
+    throw error(error::INVALID_OPERATION, __FILE__, __LINE__);
+  }
+  c = compute_r(a.getNode(), b.getNode());
+}
+
+bool MEDDLY::set_predicate::compute_r(node_handle a, node_handle b)
+{
+  bool c;
+  if (terminals(a, b, c)) return c;
+
+  compute_table::entry_key* Key = findResult(a, b, c);
+  if (0==Key) return c;
+
+  const int aLevel = arg1F->getNodeLevel(a);
+  const int bLevel = arg2F->getNodeLevel(b);
+  const int k = ABS(topLevel(aLevel, bLevel));
+
+  // a skipped unprimed level is redundant, in either reduction
+  const bool askip = (aLevel != k);
+  const bool bskip = (bLevel != k);
+  unpacked_node* A = askip
+    ? unpacked_node::newRedundant(arg1F, k, a, true)
+    : unpacked_node::newFromNode(arg1F, a, true);
+  unpacked_node* B = bskip
+    ? unpacked_node::newRedundant(arg2F, k, b, true)
+    : unpacked_node::newFromNode(arg2F, b, true);
+
+  c = checkChildren(A, askip, a, B, bskip, b, arg1F->isForRelations() ? -k : 0);
+
+  unpacked_node::recycle(B);
+  unpacked_node::recycle(A);
+
+  return saveResult(Key, c);
+}
+
+bool MEDDLY::set_predicate::compute_pr(unsigned in, int k, node_handle a,
+  node_handle b)
+{
+  MEDDLY_DCASSERT(k<0);
+
+  // Primed levels are not cached: with identity reduction,
+  // a skipped primed level depends on the row.
+  const int aLevel = arg1F->getNodeLevel(a);
+  const int bLevel = arg2F->getNodeLevel(b);
+
+  unpacked_node* A = unpacked_node::useUnpackedNode();
+  unpacked_node* B = unpacked_node::useUnpackedNode();
+  bool askip = false;
+  bool bskip = false;
+
+  if (aLevel == k) {
+    A->initFromNode(arg1F, a, true);
+  } else if (arg1F->isFullyReduced()) {
+    A->initRedundant(arg1F, k, a, true);
+    askip = true;
+  } else {
+    // initIdentity leaves the extensible flag alone
+    A->initIdentity(arg1F, k, in, a, true);
+    A->markAsNotExtensible();
+  }
+
+  if (bLevel == k) {
+    B->initFromNode(arg2F, b, true);
+  } else if (arg2F->isFullyReduced()) {
+    B->initRedundant(arg2F, k, b, true);
+    bskip = true;
+  } else {
+    B->initIdentity(arg2F, k, in, b, true);
+    B->markAsNotExtensible();
+  }
+
+  bool c = checkChildren(A, askip, a, B, bskip, b, 0);
+
+  unpacked_node::recycle(B);
+  unpacked_node::recycle(A);
+
+  return c;
+}
+
+bool MEDDLY::set_predicate::checkChildren(
+  const unpacked_node* A, bool askip, node_handle a,
+  const unpacked_node* B, bool bskip, node_handle b, int k)
+{
+  unsigned size = MAX(A->getSize(), B->getSize());
+  // one more index, for the pair of extensible tails
+  if (A->isExtensible() || B->isExtensible()) size++;
+
+  for (unsigned i=0; i<size; i++) {
+    const node_handle ai = child(A, askip, a, i);
+    const node_handle bi = child(B, bskip, b, i);
+    // equal neighboring pairs were checked already, except for
+    // relations, where the row matters
+    if (k==0 && i && ai == child(A, askip, a, i-1) && bi == child(B, bskip, b, i-1))
+      continue;
+    const bool ok = k ? compute_pr(i, k, ai, bi) : compute_r(ai, bi);
+    if (!ok) return false;
+  }
+  return true;
+}
+
+// ******************************************************************
+// *                                                                *
+// *                       subset_pred  class                       *
+// *                                                                *
+// ******************************************************************
+
+/// Is a a subset of b?
+class MEDDLY::subset_pred : public set_predicate {
+  public:
+    subset_pred(const binary_opname* code, expert_forest* arg1,
+      expert_forest* arg2)
+      : set_predicate(code, arg1, arg2) { }
+
+  protected:
+    virtual bool terminals(node_handle a, node_handle b, bool &c) const;
+};
+
+bool MEDDLY::subset_pred::terminals(node_handle a, node_handle b, bool &c) const
+{
+  if (0==a || (a==b && arg1F==arg2F) || (a==-1 && b==-1)) {
+    c = true;
+    return true;
+  }
+  if (0==b) {
+    c = false;
+    return true;
+  }
+  // with identity reduction, -1 above the bottom is not "everything"
+  if (-1==b && arg2F->isFullyReduced()) {
+    c = true;
+    return true;
+  }
+  return false;
+}
+
+// ******************************************************************
+// *                                                                *
+// *                      disjoint_pred  class                      *
+// *                                                                *
+// ******************************************************************
+
+/// Is the intersection of a and b empty?
+class MEDDLY::disjoint_pred : public set_predicate {
+  public:
+    disjoint_pred(const binary_opname* code, expert_forest* arg1,
+      expert_forest* arg2)
+      : set_predicate(code, arg1, arg2)
+    {
+      operationCommutes();
+    }
+
+  protected:
+    virtual bool terminals(node_handle a, node_handle b, bool &c) const;
+};
+
+bool MEDDLY::disjoint_pred::terminals(node_handle a, node_handle b, bool &c) const
+{
+  if (0==a || 0==b) {
+    c = true;
+    return true;
+  }
+  if ((a==b && arg1F==arg2F) || (a==-1 && b==-1)) {
+    c = false;
+    return true;
+  }
+  if ((-1==a && arg1F->isFullyReduced()) || (-1==b && arg2F->isFullyReduced())) {
+    c = false;
+    return true;
+  }
+  return false;
+}
+
+// ******************************************************************
+// *                                                                *
+// *                     predicate_opname class                     *
+// *                                                                *
+// ******************************************************************
+
+class MEDDLY::predicate_opname : public binary_opname {
+    bool isSubset;
+  public:
+    predicate_opname(bool subset);
+    virtual binary_operation* buildOperation(expert_forest* a1,
+      expert_forest* a2, expert_forest* r) const;
+};
+
+MEDDLY::predicate_opname::predicate_opname(bool subset)
+ : binary_opname(subset ? "Subset" : "Disjoint")
+{
+  isSubset = subset;
+}
+
+MEDDLY::binary_operation*
+MEDDLY::predicate_opname::buildOperation(expert_forest* a1,
+  expert_forest* a2, expert_forest* r) const
+{
+  if (0==a1 || 0==a2) return 0;
+
+  // the result is a bool, not a diagram
+  if (r)
+    throw error(error::TYPE_MISMATCH, __FILE__, __LINE__);
+
+  if (a1->getDomain() != a2->getDomain())
+    throw error(error::DOMAIN_MISMATCH, __FILE__, __LINE__);
+
+  if (
+    (a1->isForRelations() != a2->isForRelations()) ||
+    (a1->getRangeType() != forest::BOOLEAN) ||
+    (a2->getRangeType() != forest::BOOLEAN) ||
+    (a1->getEdgeLabeling() != forest::MULTI_TERMINAL) ||
+    (a2->getEdgeLabeling() != forest::MULTI_TERMINAL)
+  )
+    throw error(error::TYPE_MISMATCH, __FILE__, __LINE__);
+
+  // terminal -1 above the bottom must mean the same in both
+  if (
+    (a1->isFullyReduced() != a2->isFullyReduced()) ||
+    (a1->isIdentityReduced() != a2->isIdentityReduced())
+  )
+    throw error(error::NOT_IMPLEMENTED, __FILE__, __LINE__);
+
+  if (isSubset)
+    return new subset_pred(this, a1, a2);
+  else
+    return new disjoint_pred(this, a1, a2);
+}
+
+// ******************************************************************
+// *                                                                *
+// *                           Front  end                           *
+// *                                                                *
+// ******************************************************************
+
+MEDDLY::binary_opname* MEDDLY::initializeSubset()
+{
+  return new predicate_opname(true);
+}
+
+MEDDLY::binary_opname* MEDDLY::initializeDisjoint()
+{
+  return new predicate_opname(false);
+}
+
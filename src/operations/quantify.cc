@@ -0,0 +1,511 @@
+
+/*
+    Meddly: Multi-terminal and Edge-valued Decision Diagram LibrarY.
+    Copyright (C) 2009, Iowa State University Research Foundation, Inc.
+
+    This library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../defines.h"
+#include "quantify.h"
+
+namespace MEDDLY {
+  class quantify_op;
+  class quant_opname;
+};
+
+// ******************************************************************
+// *                                                                *
+// *                    quantify_opname  methods                    *
+// *                                                                *
+// ******************************************************************
+
+MEDDLY::quantify_opname::quantify_opname(const char* n)
+ : specialized_opname(n)
+{
+}
+
+MEDDLY::quantify_opname::~quantify_opname()
+{
+}
+
+MEDDLY::quantify_opname::quantify_args
+::quantify_args(forest* f, const bool* v, const bool* pv)
+{
+  F = f;
+  if (0==F || 0==v) throw error(error::MISCELLANEOUS, __FILE__, __LINE__);
+
+  if (
+    (F->getRangeType() != forest::BOOLEAN) ||
+    (F->getEdgeLabeling() != forest::MULTI_TERMINAL)
+  )
+    throw error(error::TYPE_MISMATCH, __FILE__, __LINE__);
+
+  if (!F->isFullyReduced() && !(F->isForRelations() && F->isIdentityReduced()))
+    throw error(error::NOT_IMPLEMENTED, __FILE__, __LINE__);
+
+  const int K = F->getDomain()->getNumVariables();
+  vars = new bool[K+1];
+  pvars = new bool[K+1];
+  vars[0] = pvars[0] = false;
+  for (int k=1; k<=K; k++) {
+    vars[k] = v[k];
+    pvars[k] = (pv && F->isForRelations()) ? pv[k] : false;
+  }
+}
+
+MEDDLY::quantify_opname::quantify_args::~quantify_args()
+{
+  delete[] vars;
+  delete[] pvars;
+}
+
+// ******************************************************************
+// *                                                                *
+// *                       quantify_op  class                       *
+// *                                                                *
+// ******************************************************************
+
+/** Quantification, and quantification of a conjunction.
+    Levels are processed top down; at a quantified level,
+    the results for the children are combined with UNION (exists)
+    or INTERSECTION (forall), otherwise a node is built as usual.
+    For relations, each level is an unprimed and primed pair,
+    and either or both may be quantified.
+
+    For AND_EXISTS, the children are the pairs of children of both
+    arguments, so the conjunction is never built above the lowest
+    quantified level.
+*/
+class MEDDLY::quantify_op : public specialized_operation {
+  public:
+    quantify_op(const quantify_opname* code,
+      quantify_opname::quantify_args* a, bool ex, bool conj);
+
+    virtual bool checkForestCompatibility() const;
+
+    virtual void compute(const dd_edge &a, dd_edge &c);
+    virtual void compute(const dd_edge &a, const dd_edge &b, dd_edge &c);
+
+  protected:
+    virtual ~quantify_op();
+
+    /**
+        Recursive part.
+          @param  k   Highest level the arguments may depend on.
+          @param  a   First argument.
+          @param  b   Second argument; equal to a if not conjoining.
+    */
+    node_handle compute_r(int k, node_handle a, node_handle b);
+
+  private:
+    /// Build the result for level k of a set; C holds the children.
+    node_handle combineSet(int k, unpacked_node* C);
+    /// Build the result for level k of a relation; C holds the rows.
+    node_handle combineRel(int k, unpacked_node** C);
+
+    /// Fill qtop, for the current variable order.
+    void findQuantifiedLevels();
+
+    /// Is the variable at level k quantified?
+    inline bool quantifiesLevel(int k) const {
+      return args->isQuantified(F->getVarByLevel(k));
+    }
+    /// Is the primed variable at level k quantified?
+    inline bool quantifiesPrimedLevel(int k) const {
+      return args->isPrimedQuantified(F->getVarByLevel(k));
+    }
+
+    /// Primed node at level -k with every child equal to v, for row i.
+    node_handle makeRow(int k, unsigned i, unsigned sz, node_handle v);
+
+    /// acc = acc op n; the reference to n is consumed.
+    inline void accumulate(dd_edge &acc, bool &first, node_handle n) {
+      if (first) {
+        acc.set(n);
+        first = false;
+        return;
+      }
+      dd_edge t(F);
+      t.set(n);
+      accOp->compute(acc, t, acc);
+    }
+
+    /// Can acc still change?
+    inline bool isFinal(const dd_edge &acc) const {
+      if (exists) {
+        // for identity reduced relations, terminal one is not "all"
+        return (!identity) && (acc.getNode() == one);
+      }
+      return 0==acc.getNode();
+    }
+
+    inline compute_table::entry_key*
+    findResult(int k, node_handle a, node_handle b, node_handle &c) {
+      compute_table::entry_key* CTsrch = CT0->useEntryKey(etype[0], 0);
+      MEDDLY_DCASSERT(CTsrch);
+      CTsrch->writeN(a);
+      if (conjoin) CTsrch->writeN(b);
+      CTsrch->writeI(k);
+      CT0->find(CTsrch, CTresult[0]);
+      if (!CTresult[0]) return CTsrch;
+      c = F->linkNode(CTresult[0].readN());
+      CT0->recycle(CTsrch);
+      return 0;
+    }
+    inline node_handle saveResult(compute_table::entry_key* Key,
+      node_handle c)
+    {
+      CTresult[0].reset();
+      CTresult[0].writeN(c);
+      CT0->addEntry(Key, CTresult[0]);
+      return c;
+    }
+
+  private:
+    quantify_opname::quantify_args* args;
+    expert_forest* F;
+    /// Combines the children at a quantified level.
+    binary_operation* accOp;
+    /// Conjunction, below the lowest quantified level.
+    binary_operation* andOp;
+    bool exists;
+    bool conjoin;
+    bool identity;
+    node_handle one;
+    /// qtop[k]: highest level, at most k, with a quantified variable.
+    int* qtop;
+};
+
+MEDDLY::quantify_op::quantify_op(const quantify_opname* code,
+  quantify_opname::quantify_args* a, bool ex, bool conj)
+: specialized_operation(code, 1)
+{
+  MEDDLY_DCASSERT(a);
+  args = a;
+  F = static_cast<expert_forest*>(a->getForest());
+  exists = ex;
+  conjoin = conj;
+  identity = F->isForRelations() && F->isIdentityReduced();
+  one = F->handleForValue(true);
+  accOp = 0;
+  andOp = 0;
+
+  qtop = new int[F->getNumVariables()+1];
+  findQuantifiedLevels();
+
+  registerInForest(F);
+
+  compute_table::entry_type* et;
+  if (conjoin) {
+    et = new compute_table::entry_type(code->getName(), "NNI:N");
+    et->setForestForSlot(0, F);
+    et->setForestForSlot(1, F);
+    et->setForestForSlot(4, F);
+  } else {
+    et = new compute_table::entry_type(code->getName(), "NI:N");
+    et->setForestForSlot(0, F);
+    et->setForestForSlot(3, F);
+  }
+  registerEntryType(0, et);
+  buildCTs();
+}
+
+MEDDLY::quantify_op::~quantify_op()
+{
+  delete[] qtop;
+  if (args->autoDestroy()) delete args;
+  unregisterInForest(F);
+}
+
+bool MEDDLY::quantify_op::checkForestCompatibility() const
+{
+  return true;
+}
+
+void MEDDLY::quantify_op::compute(const dd_edge &a, dd_edge &c)
+{
+  if (conjoin) throw error(error::WRONG_NUMBER, __FILE__, __LINE__);
+  if (a.getForest() != F || c.getForest() != F)
+    throw error(error::FOREST_MISMATCH, __FILE__, __LINE__);
+
+  accOp = getOperation(exists ? UNION : INTERSECTION, F, F, F);
+  andOp = getOperation(INTERSECTION, F, F, F);
+  findQuantifiedLevels();
+
+  node_handle an = a.getNode();
+  c.set( compute_r(F->getNumVariables(), an, an) );
+}
+
+void MEDDLY::quantify_op
+::compute(const dd_edge &a, const dd_edge &b, dd_edge &c)
+{
+  if (!conjoin) throw error(error::WRONG_NUMBER, __FILE__, __LINE__);
+  if (a.getForest() != F || b.getForest() != F || c.getForest() != F)
+    throw error(error::FOREST_MISMATCH, __FILE__, __LINE__);
+
+  accOp = getOperation(exists ? UNION : INTERSECTION, F, F, F);
+  andOp = getOperation(INTERSECTION, F, F, F);
+  findQuantifiedLevels();
+
+  c.set( compute_r(F->getNumVariables(), a.getNode(), b.getNode()) );
+}
+
+MEDDLY::node_handle
+MEDDLY::quantify_op::compute_r(int k, node_handle a, node_handle b)
+{
+  // termination conditions
+  if (0==a || 0==b) return 0;
+  if (!identity) {
+    // conjunction with "true"
+    if (one == a) a = b;
+    if (one == b) b = a;
+  }
+  if (a > b) SWAP(a, b);
+
+  if (0==qtop[k]) {
+    // nothing left to quantify
+    if (a == b) return F->linkNode(a);
+    dd_edge A(F), B(F);
+    A.set(F->linkNode(a));
+    B.set(F->linkNode(b));
+    andOp->compute(A, B, A);
+    return F->linkNode(A.getNode());
+  }
+
+  //
+  // Determine the level to expand.
+  // Levels above both arguments are redundant, which do not
+  // change under quantification, or (for identity reduced relations)
+  // identity patterns, which do if they are quantified.
+  //
+  const int aLevel = F->getNodeLevel(a);
+  const int bLevel = F->getNodeLevel(b);
+  const int top = MAX(ABS(aLevel), ABS(bLevel));
+  if (identity) {
+    k = MAX(top, qtop[k]);
+  } else {
+    if (0==top) return F->linkNode(a);
+    k = top;
+  }
+
+  // check the compute table
+  node_handle result = 0;
+  compute_table::entry_key* Key = findResult(k, a, b, result);
+  if (0==Key) return result;
+
+  const unsigned sz = unsigned(F->getLevelSize(k));
+  unpacked_node* A = isLevelAbove(k, aLevel)
+    ? unpacked_node::newRedundant(F, k, a, true)
+    : unpacked_node::newFromNode(F, a, true);
+  unpacked_node* B = 0;
+  if (a != b) {
+    B = isLevelAbove(k, bLevel)
+      ? unpacked_node::newRedundant(F, k, b, true)
+      : unpacked_node::newFromNode(F, b, true);
+  }
+
+  if (!F->isForRelations()) {
+    if (quantifiesLevel(k)) {
+      //
+      // Combine children as we go, and stop early if we can.
+      //
+      dd_edge acc(F);
+      bool first = true;
+      for (unsigned i=0; i<sz; i++) {
+        node_handle ai = A->d(i);
+        node_handle bi = B ? B->d(i) : ai;
+        accumulate(acc, first, compute_r(k-1, ai, bi));
+        if (isFinal(acc)) break;
+      }
+      result = F->linkNode(acc.getNode());
+    } else {
+      unpacked_node* C = unpacked_node::newFull(F, k, sz);
+      for (unsigned i=0; i<sz; i++) {
+        node_handle ai = A->d(i);
+        node_handle bi = B ? B->d(i) : ai;
+        C->d_ref(i) = compute_r(k-1, ai, bi);
+      }
+      result = combineSet(k, C);
+    }
+  } else {
+    unpacked_node** C = new unpacked_node*[sz];
+    for (unsigned i=0; i<sz; i++) {
+      unpacked_node* Ai = unpacked_node::newRow(F, k, A, i);
+      unpacked_node* Bi = B ? unpacked_node::newRow(F, k, B, i) : 0;
+      C[i] = unpacked_node::newFull(F, -k, sz);
+      for (unsigned j=0; j<sz; j++) {
+        node_handle aij = Ai->d(j);
+        node_handle bij = Bi ? Bi->d(j) : aij;
+        C[i]->d_ref(j) = compute_r(k-1, aij, bij);
+      }
+      unpacked_node::recycle(Ai);
+      if (Bi) unpacked_node::recycle(Bi);
+    }
+    result = combineRel(k, C);
+    delete[] C;
+  }
+
+  unpacked_node::recycle(A);
+  if (B) unpacked_node::recycle(B);
+
+  return saveResult(Key, result);
+}
+
+MEDDLY::node_handle
+MEDDLY::quantify_op::combineSet(int k, unpacked_node* C)
+{
+  MEDDLY_DCASSERT(!quantifiesLevel(k));
+  return F->createReducedNode(-1, C);
+}
+
+MEDDLY::node_handle
+MEDDLY::quantify_op::combineRel(int k, unpacked_node** C)
+{
+  const unsigned sz = unsigned(F->getLevelSize(k));
+  const bool qu = quantifiesLevel(k);
+  const bool qp = quantifiesPrimedLevel(k);
+  unpacked_node* nb = unpacked_node::newFull(F, k, sz);
+
+  if (qu && qp) {
+    //
+    // Everything at this level is combined
+    //
+    dd_edge acc(F);
+    bool first = true;
+    for (unsigned i=0; i<sz; i++) {
+      for (unsigned j=0; j<sz; j++) {
+        accumulate(acc, first, C[i]->d(j));
+      }
+      unpacked_node::recycle(C[i]);
+    }
+    for (unsigned i=0; i<sz; i++) {
+      nb->d_ref(i) = makeRow(k, i, sz, acc.getNode());
+    }
+  } else if (qp) {
+    //
+    // Combine each row
+    //
+    for (unsigned i=0; i<sz; i++) {
+      dd_edge acc(F);
+      bool first = true;
+      for (unsigned j=0; j<sz; j++) {
+        accumulate(acc, first, C[i]->d(j));
+      }
+      unpacked_node::recycle(C[i]);
+      nb->d_ref(i) = makeRow(k, i, sz, acc.getNode());
+    }
+  } else if (qu) {
+    //
+    // Combine each column; every row is the same
+    //
+    dd_edge* col = new dd_edge[sz];
+    for (unsigned j=0; j<sz; j++) {
+      col[j].setForest(F);
+      bool first = true;
+      for (unsigned i=0; i<sz; i++) {
+        accumulate(col[j], first, C[i]->d(j));
+      }
+    }
+    for (unsigned i=0; i<sz; i++) {
+      for (unsigned j=0; j<sz; j++) {
+        C[i]->d_ref(j) = F->linkNode(col[j].getNode());
+      }
+      nb->d_ref(i) = F->createReducedNode(int(i), C[i]);
+    }
+    delete[] col;
+  } else {
+    for (unsigned i=0; i<sz; i++) {
+      nb->d_ref(i) = F->createReducedNode(int(i), C[i]);
+    }
+  }
+
+  return F->createReducedNode(-1, nb);
+}
+
+void MEDDLY::quantify_op::findQuantifiedLevels()
+{
+  // The variables are given by index, but we recurse by level
+  const int K = F->getNumVariables();
+  qtop[0] = 0;
+  for (int k=1; k<=K; k++) {
+    qtop[k] = (quantifiesLevel(k) || quantifiesPrimedLevel(k)) ? k : qtop[k-1];
+  }
+}
+
+MEDDLY::node_handle
+MEDDLY::quantify_op::makeRow(int k, unsigned i, unsigned sz, node_handle v)
+{
+  unpacked_node* nb = unpacked_node::newFull(F, -k, sz);
+  for (unsigned j=0; j<sz; j++) {
+    nb->d_ref(j) = F->linkNode(v);
+  }
+  return F->createReducedNode(int(i), nb);
+}
+
+// ******************************************************************
+// *                                                                *
+// *                       quant_opname class                       *
+// *                                                                *
+// ******************************************************************
+
+class MEDDLY::quant_opname : public quantify_opname {
+    bool exists;
+    bool conjoin;
+  public:
+    quant_opname(const char* n, bool ex, bool conj);
+    virtual specialized_operation* buildOperation(arguments* a) const;
+};
+
+MEDDLY::quant_opname::quant_opname(const char* n, bool ex, bool conj)
+ : quantify_opname(n)
+{
+  exists = ex;
+  conjoin = conj;
+}
+
+MEDDLY::specialized_operation*
+MEDDLY::quant_opname::buildOperation(arguments* a) const
+{
+  quantify_args* qa = dynamic_cast<quantify_args*>(a);
+  if (0==qa) throw error(error::INVALID_ARGUMENT, __FILE__, __LINE__);
+
+  //
+  // No sanity checks needed here; we did them already when constructing a.
+  //
+
+  return new quantify_op(this, qa, exists, conjoin);
+}
+
+// ******************************************************************
+// *                                                                *
+// *                           Front  end                           *
+// *                                                                *
+// ******************************************************************
+
+MEDDLY::quantify_opname* MEDDLY::initExists()
+{
+  return new quant_opname("Exists", true, false);
+}
+
+MEDDLY::quantify_opname* MEDDLY::initForall()
+{
+  return new quant_opname("Forall", false, false);
+}
+
+MEDDLY::quantify_opname* MEDDLY::initAndExists()
+{
+  return new quant_opname("AndExists", true, true);
+}
+
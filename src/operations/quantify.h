@@ -0,0 +1,36 @@
+
+/*
+    Meddly: Multi-terminal and Edge-valued Decision Diagram LibrarY.
+    Copyright (C) 2009, Iowa State University Research Foundation, Inc.
+
+    This library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published 
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef QUANTIFY_H
+#define QUANTIFY_H
+
+namespace MEDDLY {
+  class quantify_opname;
+
+  /// Set up a quantify_opname for existential quantification.
+  quantify_opname* initExists();
+
+  /// Set up a quantify_opname for universal quantification.
+  quantify_opname* initForall();
+
+  /// Set up a quantify_opname for existential quantification of AND.
+  quantify_opname* initAndExists();
+}
+
+#endif
@@ -39,6 +39,29 @@ namespace MEDDLY {
 
   class forwd_bfs_opname;
   class bckwd_bfs_opname;
+
+  class pregen_bfs;
+  class pregen_bfs_opname;
+};
+
+// ******************************************************************
+// *                                                                *
+// *                            helpers                             *
+// *                                                                *
+// ******************************************************************
+
+namespace MEDDLY {
+  /// Report the size of the frontier to the logger of f, if any.
+  inline void logFrontier(expert_forest* f, long iter, const dd_edge &front)
+  {
+    forest::logger* L = f->getLogger();
+    if (0==L) return;
+    double card;
+    getOperation(CARDINALITY, front, REAL)->compute(front, card);
+    char buffer[80];
+    snprintf(buffer, sizeof(buffer), "BFS iteration %ld: frontier %.0f", iter, card);
+    L->newPhase(f, buffer);
+  }
 };
 
 // ******************************************************************
@@ -69,9 +92,22 @@ class MEDDLY::common_bfs : public binary_operation {
       imageOp = iop;
     }
 
+    /// Set for sets only; then each iteration images the frontier.
+    inline void setDifferenceOp(binary_operation* dop)
+    {
+      MEDDLY_DCASSERT(dop);
+      MEDDLY_DCASSERT(0==differenceOp);
+      differenceOp = dop;
+    }
+
+  private:
+    /// Image only the states that are new in each iteration.
+    void iterateFrontier(const dd_edge& init, const dd_edge& R, dd_edge &c);
+
   private:
     binary_operation* unionOp;
     binary_operation* imageOp;
+    binary_operation* differenceOp;
 
 };
 
@@ -82,6 +118,7 @@ MEDDLY::common_bfs::common_bfs(const binary_opname* oc, expert_forest* a1,
 {
   unionOp = 0;
   imageOp = 0;
+  differenceOp = 0;
 }
 
 void MEDDLY::common_bfs::computeDDEdge(const dd_edge &init, const dd_edge &R, dd_edge &reachableStates)
@@ -89,6 +126,11 @@ void MEDDLY::common_bfs::computeDDEdge(const dd_edge &init, const dd_edge &R, dd
   MEDDLY_DCASSERT(unionOp);
   MEDDLY_DCASSERT(imageOp);
 
+  if (differenceOp && arg1F == resF) {
+    iterateFrontier(init, R, reachableStates);
+    return;
+  }
+
   reachableStates = init;
   dd_edge prevReachable(resF);
   dd_edge front(resF);
@@ -135,6 +177,23 @@ void MEDDLY::common_bfs::computeDDEdge(const dd_edge &init, const dd_edge &R, dd
 
 }
 
+void MEDDLY::common_bfs::iterateFrontier(const dd_edge &init, const dd_edge &R,
+  dd_edge &reachableStates)
+{
+  reachableStates = init;
+  dd_edge front(init);
+  dd_edge img(resF);
+  long iters = 0;
+  // fixed point once nothing new is found
+  while (front.getNode()) {
+    iters++;
+    logFrontier(resF, iters, front);
+    imageOp->computeDDEdge(front, R, img);
+    differenceOp->computeDDEdge(img, reachableStates, front);
+    unionOp->computeDDEdge(reachableStates, front, reachableStates);
+  }
+}
+
 // ******************************************************************
 // *                                                                *
 // *                       forwd_bfs_mt class                       *
@@ -152,6 +211,7 @@ MEDDLY::forwd_bfs_mt::forwd_bfs_mt(const binary_opname* oc, expert_forest* a1,
 {
   if (res->getRangeType() == forest::BOOLEAN) {
     setUnionOp( getOperation(UNION, res, res, res) );
+    setDifferenceOp( getOperation(DIFFERENCE, res, res, res) );
   } else {
     setUnionOp( getOperation(MAXIMUM, res, res, res) );
   }
@@ -177,6 +237,7 @@ MEDDLY::bckwd_bfs_mt::bckwd_bfs_mt(const binary_opname* oc, expert_forest* a1,
 {
   if (res->getRangeType() == forest::BOOLEAN) {
     setUnionOp( getOperation(UNION, res, res, res) );
+    setDifferenceOp( getOperation(DIFFERENCE, res, res, res) );
   } else {
     setUnionOp( getOperation(MAXIMUM, res, res, res) );
   }
@@ -458,6 +519,157 @@ MEDDLY::bckwd_bfs_opname::buildOperation(expert_forest* a1, expert_forest* a2,
   }
 }
 
+// ******************************************************************
+// *                                                                *
+// *                       pregen_bfs  class                        *
+// *                                                                *
+// ******************************************************************
+
+/** Breadth-first search over a partitioned relation.
+
+    Each iteration images only the frontier, one partition at a
+    time, bottom level first.  With chaining, states found by one
+    partition are added to the frontier for the partitions that
+    follow it in the same iteration.
+    Sets only; no compute table of our own.
+*/
+class MEDDLY::pregen_bfs : public specialized_operation {
+  public:
+    pregen_bfs(const satpregen_opname* opcode,
+      satpregen_opname::pregen_relation* rel, bool chaining);
+    virtual ~pregen_bfs();
+
+    virtual bool checkForestCompatibility() const;
+    virtual void compute(const dd_edge& a, dd_edge &c);
+
+  private:
+    satpregen_opname::pregen_relation* rel;
+    bool chaining;
+
+    expert_forest* arg1F;
+    expert_forest* arg2F;
+    expert_forest* resF;
+};
+
+MEDDLY::pregen_bfs::pregen_bfs(const satpregen_opname* opcode,
+  satpregen_opname::pregen_relation* relation, bool ch)
+: specialized_operation(opcode, 0)
+{
+  rel = relation;
+  chaining = ch;
+  arg1F = static_cast<expert_forest*>(rel->getInForest());
+  arg2F = static_cast<expert_forest*>(rel->getRelForest());
+  resF = static_cast<expert_forest*>(rel->getOutForest());
+
+  registerInForest(arg1F);
+  registerInForest(arg2F);
+  registerInForest(resF);
+}
+
+MEDDLY::pregen_bfs::~pregen_bfs()
+{
+  if (rel->autoDestroy()) delete rel;
+  unregisterInForest(arg1F);
+  unregisterInForest(arg2F);
+  unregisterInForest(resF);
+}
+
+bool MEDDLY::pregen_bfs::checkForestCompatibility() const
+{
+  auto o1 = arg1F->variableOrder();
+  auto o2 = arg2F->variableOrder();
+  auto o3 = resF->variableOrder();
+  return o1->is_compatible_with(*o2)
+    && o1->is_compatible_with(*o3);
+}
+
+void MEDDLY::pregen_bfs::compute(const dd_edge &a, dd_edge &c)
+{
+  if (a.getForest() != arg1F)
+    throw error(error::FOREST_MISMATCH, __FILE__, __LINE__);
+  if (!checkForestCompatibility())
+    throw error(error::INVALID_OPERATION, __FILE__, __LINE__);
+
+  binary_operation* imageOp = getOperation(POST_IMAGE, resF, arg2F, resF);
+  binary_operation* unionOp = getOperation(UNION, resF, resF, resF);
+  binary_operation* differenceOp = getOperation(DIFFERENCE, resF, resF, resF);
+  MEDDLY_DCASSERT(imageOp);
+  MEDDLY_DCASSERT(unionOp);
+  MEDDLY_DCASSERT(differenceOp);
+
+  if (!rel->isFinalized()) rel->finalize();
+
+  dd_edge reachable(resF);
+  if (arg1F == resF) {
+    reachable = a;
+  } else {
+    getOperation(COPY, a, reachable)->compute(a, reachable);
+  }
+
+  const int K = arg2F->getDomain()->getNumVariables();
+  dd_edge front(reachable);
+  dd_edge next(resF);
+  dd_edge img(resF);
+  dd_edge found(resF);
+  long iters = 0;
+  // fixed point once nothing new is found
+  while (front.getNode()) {
+    iters++;
+    logFrontier(resF, iters, front);
+    next.set(0);
+    for (int k=1; k<=K; k++) {
+      const dd_edge* events = rel->arrayForLevel(k);
+      const unsigned n = rel->lengthForLevel(k);
+      for (unsigned e=0; e<n; e++) {
+        if (0==events[e].getNode()) continue;
+        imageOp->computeDDEdge(front, events[e], img);
+        differenceOp->computeDDEdge(img, reachable, found);
+        if (0==found.getNode()) continue;
+        unionOp->computeDDEdge(reachable, found, reachable);
+        unionOp->computeDDEdge(next, found, next);
+        if (chaining) {
+          unionOp->computeDDEdge(front, found, front);
+        }
+      }
+    }
+    front = next;
+  }
+
+  c = reachable;
+}
+
+// ******************************************************************
+// *                                                                *
+// *                    pregen_bfs_opname  class                    *
+// *                                                                *
+// ******************************************************************
+
+class MEDDLY::pregen_bfs_opname : public satpregen_opname {
+    bool chaining;
+  public:
+    pregen_bfs_opname(bool ch);
+    virtual specialized_operation* buildOperation(arguments* a) const;
+};
+
+MEDDLY::pregen_bfs_opname::pregen_bfs_opname(bool ch)
+ : satpregen_opname(ch ? "ChainedBFSFwd" : "BFSFwd")
+{
+  chaining = ch;
+}
+
+MEDDLY::specialized_operation*
+MEDDLY::pregen_bfs_opname::buildOperation(arguments* a) const
+{
+  pregen_relation* rel = dynamic_cast<pregen_relation*>(a);
+  if (0==rel) throw error(error::INVALID_ARGUMENT, __FILE__, __LINE__);
+
+  // the image and difference operations need sets
+  if (rel->getOutForest()->getRangeType() != forest::BOOLEAN)
+    throw error(error::TYPE_MISMATCH, __FILE__, __LINE__);
+
+  return new pregen_bfs(this, rel, chaining);
+}
+
 // ******************************************************************
 // *                                                                *
 // *                           Front  end                           *
@@ -474,3 +686,13 @@ MEDDLY::binary_opname* MEDDLY::initializeBackwardBFS()
   return new bckwd_bfs_opname;
 }
 
+MEDDLY::satpregen_opname* MEDDLY::initBFSForward()
+{
+  return new pregen_bfs_opname(false);
+}
+
+MEDDLY::satpregen_opname* MEDDLY::initChainedBFSForward()
+{
+  return new pregen_bfs_opname(true);
+}
+
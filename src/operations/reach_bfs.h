@@ -22,12 +22,19 @@
 
 namespace MEDDLY {
   class binary_opname;
+  class satpregen_opname;
 
   /// Set up a binary_opname for the "reachable bfs" operation.
   binary_opname* initializeForwardBFS();
 
   /// Set up a binary_opname for the "reverse reachable bfs" operation.
   binary_opname* initializeBackwardBFS();
+
+  /// Set up a satpregen_opname for frontier-based forward BFS.
+  satpregen_opname* initBFSForward();
+
+  /// Same, but chaining the partitions within each iteration.
+  satpregen_opname* initChainedBFSForward();
 }
 
 #endif
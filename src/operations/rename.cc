@@ -0,0 +1,458 @@
+
+/*
+    Meddly: Multi-terminal and Edge-valued Decision Diagram LibrarY.
+    Copyright (C) 2009, Iowa State University Research Foundation, Inc.
+
+    This library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../defines.h"
+#include "rename.h"
+
+namespace MEDDLY {
+  class rename_op;
+  class ren_opname;
+};
+
+// ******************************************************************
+// *                                                                *
+// *                     rename_opname  methods                     *
+// *                                                                *
+// ******************************************************************
+
+MEDDLY::rename_opname::rename_opname(const char* n)
+ : specialized_opname(n)
+{
+}
+
+MEDDLY::rename_opname::~rename_opname()
+{
+}
+
+MEDDLY::rename_opname::rename_args
+::rename_args(forest* inf, forest* outf, const int* m, bool tr)
+{
+  inF = inf;
+  outF = outf;
+  transpose = tr;
+  if (0==inF || 0==outF || 0==m) throw error(error::MISCELLANEOUS, __FILE__, __LINE__);
+
+  // Check forest types
+  if (
+    (inF->isForRelations() != outF->isForRelations()) ||
+    (inF->getRangeType() != outF->getRangeType())     ||
+    (inF->getEdgeLabeling() != forest::MULTI_TERMINAL) ||
+    (outF->getEdgeLabeling() != forest::MULTI_TERMINAL) ||
+    (transpose && !inF->isForRelations())
+  )
+    throw error(error::TYPE_MISMATCH, __FILE__, __LINE__);
+
+  // Check reductions; skipped levels must mean the same in both
+  const bool inIdent = inF->isForRelations() && inF->isIdentityReduced();
+  const bool outIdent = outF->isForRelations() && outF->isIdentityReduced();
+  if (
+    (inIdent != outIdent) ||
+    (!inIdent && !(inF->isFullyReduced() && outF->isFullyReduced()))
+  )
+    throw error(error::NOT_IMPLEMENTED, __FILE__, __LINE__);
+
+  // Check the map; bounds are by variable, the map is by level
+  const domain* inD = inF->getDomain();
+  const domain* outD = outF->getDomain();
+  const expert_forest* inEF = static_cast<expert_forest*>(inF);
+  const expert_forest* outEF = static_cast<expert_forest*>(outF);
+  const int K = inD->getNumVariables();
+  if (outD->getNumVariables() != K)
+    throw error(error::DOMAIN_MISMATCH, __FILE__, __LINE__);
+
+  map = new int[K+1];
+  map[0] = 0;
+  bool* used = new bool[K+1];
+  for (int k=0; k<=K; k++) used[k] = false;
+  bool ok = true;
+  for (int k=1; k<=K; k++) {
+    map[k] = m[k];
+    if (0==map[k]) continue;
+    if (map[k] < 0 || map[k] > K || used[map[k]]) {
+      ok = false;
+      break;
+    }
+    used[map[k]] = true;
+    if (inD->getVariableBound(inEF->getVarByLevel(k)) !=
+        outD->getVariableBound(outEF->getVarByLevel(map[k])))
+    {
+      ok = false;
+      break;
+    }
+  }
+  delete[] used;
+  if (!ok) {
+    delete[] map;
+    throw error(error::INVALID_ASSIGNMENT, __FILE__, __LINE__);
+  }
+}
+
+MEDDLY::rename_opname::rename_args::~rename_args()
+{
+  delete[] map;
+}
+
+bool MEDDLY::rename_opname::rename_args::preservesOrder() const
+{
+  if (transpose) return false;
+  const int K = inF->getDomain()->getNumVariables();
+  int last = 0;
+  for (int k=1; k<=K; k++) {
+    if (0==map[k]) continue;
+    if (map[k] < last) return false;
+    last = map[k];
+  }
+  return true;
+}
+
+// ******************************************************************
+// *                                                                *
+// *                        rename_op  class                        *
+// *                                                                *
+// ******************************************************************
+
+/** Renaming.
+    If the map preserves the variable order (over the levels it maps),
+    every node is simply rebuilt at its new level.
+    Otherwise, the result for a node at level k is the sum, over the
+    values i of the variable (and j for primed), of the renamed child
+    with the new variable map[k] inserted and set to i (and j).
+    Levels skipped in the argument are also skipped in the result;
+    for both reductions they keep their meaning (redundant, or identity)
+    under renaming.
+*/
+class MEDDLY::rename_op : public specialized_operation {
+  public:
+    rename_op(const rename_opname* code, rename_opname::rename_args* a);
+
+    virtual bool checkForestCompatibility() const;
+
+    virtual void compute(const dd_edge &a, dd_edge &c);
+
+  protected:
+    virtual ~rename_op();
+
+    /// Order preserving maps: relabel the levels of a.
+    node_handle relabel(node_handle a);
+
+    /// General maps.
+    node_handle rename(node_handle a);
+
+    /**
+        Insert variable m into g, with value i (and primed value j,
+        for relations).  Variable m must be unused in g.
+    */
+    node_handle insert(node_handle g, int m, unsigned i, unsigned j);
+
+  private:
+    inline compute_table::entry_key*
+    findRenameResult(node_handle a, node_handle &c) {
+      compute_table::entry_key* CTsrch = CT0->useEntryKey(etype[0], 0);
+      MEDDLY_DCASSERT(CTsrch);
+      CTsrch->writeN(a);
+      CT0->find(CTsrch, CTresult[0]);
+      if (!CTresult[0]) return CTsrch;
+      c = resF->linkNode(CTresult[0].readN());
+      CT0->recycle(CTsrch);
+      return 0;
+    }
+    inline compute_table::entry_key*
+    findInsertResult(node_handle g, int m, unsigned i, unsigned j,
+      node_handle &c)
+    {
+      compute_table::entry_key* CTsrch = CT1->useEntryKey(etype[1], 0);
+      MEDDLY_DCASSERT(CTsrch);
+      CTsrch->writeN(g);
+      CTsrch->writeI(m);
+      CTsrch->writeI(int(i));
+      CTsrch->writeI(int(j));
+      CT1->find(CTsrch, CTresult[1]);
+      if (!CTresult[1]) return CTsrch;
+      c = resF->linkNode(CTresult[1].readN());
+      CT1->recycle(CTsrch);
+      return 0;
+    }
+    inline node_handle saveResult(compute_table* CT, unsigned slot,
+      compute_table::entry_key* Key, node_handle c)
+    {
+      CTresult[slot].reset();
+      CTresult[slot].writeN(c);
+      CT->addEntry(Key, CTresult[slot]);
+      return c;
+    }
+
+  private:
+    rename_opname::rename_args* args;
+    expert_forest* argF;
+    expert_forest* resF;
+    compute_table* CT1;
+    /// Adds the disjoint terms of a general renaming.
+    binary_operation* sumOp;
+    bool relabelOnly;
+    /// Does the map leave some levels out?
+    bool partial;
+};
+
+MEDDLY::rename_op::rename_op(const rename_opname* code,
+  rename_opname::rename_args* a)
+: specialized_operation(code, 2)
+{
+  MEDDLY_DCASSERT(a);
+  args = a;
+  argF = static_cast<expert_forest*>(a->getInForest());
+  resF = static_cast<expert_forest*>(a->getOutForest());
+  relabelOnly = a->preservesOrder();
+  partial = false;
+  for (int k=argF->getNumVariables(); k; k--) {
+    if (0==a->getMap(k)) partial = true;
+  }
+  sumOp = 0;
+
+  registerInForest(argF);
+  registerInForest(resF);
+
+  compute_table::entry_type* et;
+  et = new compute_table::entry_type(code->getName(), "N:N");
+  et->setForestForSlot(0, argF);
+  et->setForestForSlot(2, resF);
+  registerEntryType(0, et);
+
+  et = new compute_table::entry_type(code->getName(), "NIII:N");
+  et->setForestForSlot(0, resF);
+  et->setForestForSlot(5, resF);
+  registerEntryType(1, et);
+
+  buildCTs();
+  CT1 = CT[1];
+}
+
+MEDDLY::rename_op::~rename_op()
+{
+  if (args->autoDestroy()) delete args;
+  unregisterInForest(argF);
+  unregisterInForest(resF);
+}
+
+bool MEDDLY::rename_op::checkForestCompatibility() const
+{
+  return true;
+}
+
+void MEDDLY::rename_op::compute(const dd_edge &a, dd_edge &c)
+{
+  if (a.getForest() != argF || c.getForest() != resF)
+    throw error(error::FOREST_MISMATCH, __FILE__, __LINE__);
+
+  if (partial) {
+    // a must not depend on the levels left out
+    node_handle root = a.getNode();
+    node_handle* list = argF->markNodesInSubgraph(&root, 1, false);
+    bool ok = true;
+    for (int i=0; list && list[i]; i++) {
+      if (0==args->getMap(ABS(argF->getNodeLevel(list[i])))) ok = false;
+    }
+    free(list);
+    if (!ok) throw error(error::INVALID_ASSIGNMENT, __FILE__, __LINE__);
+  }
+
+  if (relabelOnly) {
+    c.set( relabel(a.getNode()) );
+    return;
+  }
+  sumOp = getOperation(
+    (resF->getRangeType() == forest::BOOLEAN) ? UNION : PLUS,
+    resF, resF, resF
+  );
+  c.set( rename(a.getNode()) );
+}
+
+MEDDLY::node_handle MEDDLY::rename_op::relabel(node_handle a)
+{
+  // terminals are encoded the same way in both forests
+  if (argF->isTerminalNode(a)) return a;
+
+  node_handle result = 0;
+  compute_table::entry_key* Key = findRenameResult(a, result);
+  if (0==Key) return result;
+
+  const int aLevel = argF->getNodeLevel(a);
+  const int m = args->getMap(ABS(aLevel));
+  unpacked_node* A = unpacked_node::newFromNode(argF, a, false);
+  unpacked_node* nb = unpacked_node::newSparse(resF,
+    (aLevel < 0) ? -m : m, A->getNNZs());
+  for (unsigned z=0; z<A->getNNZs(); z++) {
+    nb->i_ref(z) = A->i(z);
+    nb->d_ref(z) = relabel(A->d(z));
+  }
+  unpacked_node::recycle(A);
+
+  // same structure as before, so there is nothing to reduce
+  result = resF->createReducedNode(-1, nb);
+  return saveResult(CT0, 0, Key, result);
+}
+
+MEDDLY::node_handle MEDDLY::rename_op::rename(node_handle a)
+{
+  if (argF->isTerminalNode(a)) return a;
+
+  node_handle result = 0;
+  compute_table::entry_key* Key = findRenameResult(a, result);
+  if (0==Key) return result;
+
+  const int aLevel = argF->getNodeLevel(a);
+  const int k = ABS(aLevel);
+  const int m = args->getMap(k);
+  const unsigned sz = unsigned(argF->getLevelSize(k));
+
+  dd_edge acc(resF), t(resF);
+  if (!argF->isForRelations()) {
+    unpacked_node* A = unpacked_node::newFromNode(argF, a, false);
+    for (unsigned z=0; z<A->getNNZs(); z++) {
+      node_handle g = rename(A->d(z));
+      t.set( insert(g, m, A->i(z), 0) );
+      resF->unlinkNode(g);
+      sumOp->compute(acc, t, acc);
+    }
+    unpacked_node::recycle(A);
+  } else {
+    // a primed node here has a redundant unprimed level above it
+    unpacked_node* A = isLevelAbove(k, aLevel)
+      ? unpacked_node::newRedundant(argF, k, a, true)
+      : unpacked_node::newFromNode(argF, a, true);
+    for (unsigned i=0; i<sz; i++) {
+      unpacked_node* R = unpacked_node::newRow(argF, k, A, i);
+      for (unsigned j=0; j<sz; j++) {
+        if (0==R->d(j)) continue;
+        node_handle g = rename(R->d(j));
+        if (args->isTranspose()) {
+          t.set( insert(g, m, j, i) );
+        } else {
+          t.set( insert(g, m, i, j) );
+        }
+        resF->unlinkNode(g);
+        sumOp->compute(acc, t, acc);
+      }
+      unpacked_node::recycle(R);
+    }
+    unpacked_node::recycle(A);
+  }
+
+  result = resF->linkNode(acc.getNode());
+  return saveResult(CT0, 0, Key, result);
+}
+
+MEDDLY::node_handle MEDDLY::rename_op::insert(node_handle g, int m,
+  unsigned i, unsigned j)
+{
+  if (0==g) return 0;
+
+  const int gLevel = resF->getNodeLevel(g);
+
+  if (isLevelAbove(m, gLevel)) {
+    //
+    // Build the new variable directly above g
+    //
+    if (!resF->isForRelations()) {
+      unpacked_node* nb = unpacked_node::newSparse(resF, m, 1);
+      nb->i_ref(0) = i;
+      nb->d_ref(0) = resF->linkNode(g);
+      return resF->createReducedNode(-1, nb);
+    }
+    unpacked_node* nbp = unpacked_node::newSparse(resF, -m, 1);
+    nbp->i_ref(0) = j;
+    nbp->d_ref(0) = resF->linkNode(g);
+    unpacked_node* nb = unpacked_node::newSparse(resF, m, 1);
+    nb->i_ref(0) = i;
+    nb->d_ref(0) = resF->createReducedNode(int(i), nbp);
+    return resF->createReducedNode(-1, nb);
+  }
+  MEDDLY_DCASSERT(ABS(gLevel) > m);
+
+  node_handle result = 0;
+  compute_table::entry_key* Key = findInsertResult(g, m, i, j, result);
+  if (0==Key) return result;
+
+  const int k = ABS(gLevel);
+  const unsigned gsz = unsigned(resF->getLevelSize(k));
+  unpacked_node* G = isLevelAbove(k, gLevel)
+    ? unpacked_node::newRedundant(resF, k, g, true)
+    : unpacked_node::newFromNode(resF, g, true);
+  unpacked_node* nb = unpacked_node::newFull(resF, k, gsz);
+  if (!resF->isForRelations()) {
+    for (unsigned r=0; r<gsz; r++) {
+      nb->d_ref(r) = insert(G->d(r), m, i, j);
+    }
+  } else {
+    for (unsigned r=0; r<gsz; r++) {
+      unpacked_node* R = unpacked_node::newRow(resF, k, G, r);
+      unpacked_node* nbr = unpacked_node::newFull(resF, -k, gsz);
+      for (unsigned c=0; c<gsz; c++) {
+        nbr->d_ref(c) = insert(R->d(c), m, i, j);
+      }
+      unpacked_node::recycle(R);
+      nb->d_ref(r) = resF->createReducedNode(int(r), nbr);
+    }
+  }
+  unpacked_node::recycle(G);
+
+  result = resF->createReducedNode(-1, nb);
+  return saveResult(CT1, 1, Key, result);
+}
+
+// ******************************************************************
+// *                                                                *
+// *                       ren_opname   class                       *
+// *                                                                *
+// ******************************************************************
+
+class MEDDLY::ren_opname : public rename_opname {
+  public:
+    ren_opname();
+    virtual specialized_operation* buildOperation(arguments* a) const;
+};
+
+MEDDLY::ren_opname::ren_opname()
+ : rename_opname("Rename")
+{
+}
+
+MEDDLY::specialized_operation*
+MEDDLY::ren_opname::buildOperation(arguments* a) const
+{
+  rename_args* ra = dynamic_cast<rename_args*>(a);
+  if (0==ra) throw error(error::INVALID_ARGUMENT, __FILE__, __LINE__);
+
+  //
+  // No sanity checks needed here; we did them already when constructing a.
+  //
+
+  return new rename_op(this, ra);
+}
+
+// ******************************************************************
+// *                                                                *
+// *                           Front  end                           *
+// *                                                                *
+// ******************************************************************
+
+MEDDLY::rename_opname* MEDDLY::initRename()
+{
+  return new ren_opname;
+}
+
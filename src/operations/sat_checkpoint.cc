@@ -0,0 +1,205 @@
+
+/*
+    Meddly: Multi-terminal and Edge-valued Decision Diagram LibrarY.
+    Copyright (C) 2009, Iowa State University Research Foundation, Inc.
+
+    This library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../defines.h"
+#include "sat_checkpoint.h"
+
+#include <cstdio>
+
+// #define DEBUG_CHECKPOINT
+
+// ******************************************************************
+// *                                                                *
+// *                     sat_checkpoint methods                     *
+// *                                                                *
+// ******************************************************************
+
+MEDDLY::sat_checkpoint
+::sat_checkpoint(expert_forest* f, const char* fn, long seconds)
+{
+  MEDDLY_DCASSERT(f);
+  MEDDLY_DCASSERT(fn);
+  F = f;
+  K = f->getNumVariables();
+  filename = strdup(fn);
+  interval = seconds;
+  last_write = time(0);
+  polls = 0;
+  frames = new frame[K+2];
+  for (int k=0; k<=K+1; k++) {
+    frames[k].nb = 0;
+    frames[k].orig = 0;
+    frames[k].slot = 0;
+  }
+  lowest = K+1;
+}
+
+MEDDLY::sat_checkpoint::~sat_checkpoint()
+{
+  free(filename);
+  delete[] frames;
+}
+
+void MEDDLY::sat_checkpoint::write()
+{
+  //
+  // Write to a temporary file, and then replace the old checkpoint,
+  // so that a crash while writing does not lose the previous one.
+  //
+  size_t len = strlen(filename);
+  char* tmpname = new char[len+5];
+  strcpy(tmpname, filename);
+  strcpy(tmpname+len, ".tmp");
+
+  FILE* outf = fopen(tmpname, "w");
+  if (0==outf) {
+    delete[] tmpname;
+    throw error(error::COULDNT_WRITE, __FILE__, __LINE__);
+  }
+  FILE_output s(outf);
+
+  s << "satckpt " << K << "\n";
+
+  //
+  // Confirmed local states, if any
+  //
+  if (hasLocalStates()) {
+    s << "confirmed\n";
+    for (int k=1; k<=K; k++) {
+      int size = F->getLevelSize(k);
+      if (size < 0) size = -size;
+      int n = 0;
+      for (int i=0; i<size; i++) {
+        if (isConfirmed(k, i)) n++;
+      }
+      s << k << " " << n;
+      for (int i=0; i<size; i++) {
+        if (isConfirmed(k, i)) s << " " << i;
+      }
+      s << "\n";
+    }
+    s << "demrifnoc\n";
+  }
+
+  //
+  // Current set of states; all nodes are written in one block
+  //
+  dd_edge S(F);
+  S.set(buildPartialSet());
+  F->writeEdges(s, &S, 1);
+
+  s << "tpkctas\n";
+  s.flush();
+  bool ok = (0==ferror(outf));
+  fclose(outf);
+  if (ok) ok = (0==rename(tmpname, filename));
+  delete[] tmpname;
+  if (!ok) throw error(error::COULDNT_WRITE, __FILE__, __LINE__);
+
+#ifdef DEBUG_CHECKPOINT
+  fprintf(stderr, "Wrote checkpoint %s\n", filename);
+#endif
+}
+
+void MEDDLY::sat_checkpoint::read(const char* fn, dd_edge &S)
+{
+  FILE* inf = fopen(fn, "r");
+  if (0==inf) throw error(error::INVALID_FILE, __FILE__, __LINE__);
+  FILE_input s(inf);
+
+  try {
+    s.stripWS();
+    s.consumeKeyword("satckpt");
+    s.stripWS();
+    if (s.get_integer() != K) throw error(error::INVALID_FILE, __FILE__, __LINE__);
+
+    s.stripWS();
+    int c = s.get_char();
+    s.unget(char(c));
+    if ('c' == c) {
+      s.consumeKeyword("confirmed");
+      for (int k=1; k<=K; k++) {
+        s.stripWS();
+        if (s.get_integer() != k) throw error(error::INVALID_FILE, __FILE__, __LINE__);
+        s.stripWS();
+        long n = s.get_integer();
+        for (; n>0; n--) {
+          s.stripWS();
+          confirm(k, int(s.get_integer()));
+        }
+      }
+      s.stripWS();
+      s.consumeKeyword("demrifnoc");
+    }
+
+    S.setForest(F);
+    F->readEdges(s, &S, 1);
+
+    s.stripWS();
+    s.consumeKeyword("tpkctas");
+  }
+  catch (error& e) {
+    fclose(inf);
+    throw e;
+  }
+  fclose(inf);
+}
+
+bool MEDDLY::sat_checkpoint::hasLocalStates() const
+{
+  return false;
+}
+
+bool MEDDLY::sat_checkpoint::isConfirmed(int k, int i) const
+{
+  return true;
+}
+
+void MEDDLY::sat_checkpoint::confirm(int k, int i)
+{
+}
+
+MEDDLY::node_handle MEDDLY::sat_checkpoint::buildPartialSet()
+{
+  node_handle below = 0;
+  bool have_below = false;
+  for (int k=lowest; k<=K; k++) {
+    const frame &fr = frames[k];
+    MEDDLY_DCASSERT(fr.nb);
+    const unsigned size = fr.nb->getSize();
+    unpacked_node* nb = unpacked_node::newFull(F, k, size);
+    for (unsigned i=0; i<size; i++) {
+      if (fr.orig && i == fr.slot && have_below) {
+        nb->d_ref(i) = below;
+        continue;
+      }
+      node_handle d;
+      if (0==fr.orig || i < fr.slot) {
+        d = fr.nb->d(i);
+      } else {
+        d = (i < fr.orig->getSize()) ? fr.orig->d(i) : 0;
+      }
+      nb->d_ref(i) = F->linkNode(d);
+    }
+    below = F->createReducedNode(-1, nb);
+    have_below = true;
+  }
+  return below;
+}
+
@@ -0,0 +1,146 @@
+
+/*
+    Meddly: Multi-terminal and Edge-valued Decision Diagram LibrarY.
+    Copyright (C) 2009, Iowa State University Research Foundation, Inc.
+
+    This library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SAT_CHECKPOINT_H
+#define SAT_CHECKPOINT_H
+
+#include <ctime>
+
+namespace MEDDLY {
+  class sat_checkpoint;
+};
+
+/**
+    Checkpoints for the saturation operations.
+
+    The saturation recursion reports the nodes it is building, one frame
+    per level, from the top level down.  While the frame at level k
+    is still saturating its children, its children before the current
+    slot are saturated, and the others are the original ones;
+    once it fires events, all its children are (partially) saturated.
+    Putting the frames back together, bottom up, gives a set S with
+        initial states <= S <= reachable states,
+    so saturation restarted from S reaches the same fixed point.
+
+    A checkpoint file contains the confirmed local states
+    (if the relation has any) and the set S.
+    Derived classes provide access to the confirmed local states.
+*/
+class MEDDLY::sat_checkpoint {
+  public:
+    sat_checkpoint(expert_forest* f, const char* filename, long seconds);
+    virtual ~sat_checkpoint();
+
+    /**
+        Start a frame for node nb at level k.
+          @param  orig    Reader for the original node.
+          @return true    if the frame is part of the saturated set,
+                          and is tracked; the caller must call
+                          leave() before nb is destroyed.
+    */
+    inline bool enter(int k, unpacked_node* nb, unpacked_node* orig) {
+      MEDDLY_CHECK_RANGE(1, k, K+1);
+      if (frames[k].nb) return false;
+      if (k < K) {
+        if (0==frames[k+1].nb || 0==frames[k+1].orig) return false;
+      } else {
+        if (lowest <= K) return false;
+      }
+      frames[k].nb = nb;
+      frames[k].orig = orig;
+      frames[k].slot = 0;
+      lowest = k;
+      return true;
+    }
+
+    /// Children before slot i are now saturated.
+    inline void advance(int k, unsigned i) {
+      MEDDLY_DCASSERT(frames[k].nb);
+      frames[k].slot = i;
+    }
+
+    /// Frame at level k is done with its children and the original node.
+    inline void fire(int k) {
+      MEDDLY_DCASSERT(frames[k].nb);
+      frames[k].orig = 0;
+    }
+
+    /// Frame at level k is done.
+    inline void leave(int k) {
+      MEDDLY_DCASSERT(lowest == k);
+      frames[k].nb = 0;
+      frames[k].orig = 0;
+      lowest = k+1;
+    }
+
+    /**
+        A safe point; write a checkpoint if it is time.
+        The clock is checked every 1024 safe points,
+        unless the interval is zero.
+    */
+    inline void poll() {
+      if (lowest > K) return;
+      if (interval > 0) {
+        if (++polls < 1024) return;
+        polls = 0;
+      }
+      if (time(0) - last_write < interval) return;
+      write();
+      last_write = time(0);
+    }
+
+    /// Write a checkpoint now.
+    void write();
+
+    /**
+        Read a checkpoint file.
+        The confirmed local states are restored, using confirm(),
+        and the saved set of states is returned in S.
+    */
+    void read(const char* filename, dd_edge &S);
+
+  protected:
+    virtual bool hasLocalStates() const;
+    virtual bool isConfirmed(int k, int i) const;
+    virtual void confirm(int k, int i);
+
+  private:
+    /// Rebuild the set of states from the frames.
+    node_handle buildPartialSet();
+
+    struct frame {
+      unpacked_node* nb;
+      unpacked_node* orig;
+      unsigned slot;
+    };
+
+    expert_forest* F;
+    int K;
+    char* filename;
+    long interval;
+    time_t last_write;
+    unsigned polls;
+    /// Frames, by level; frames[k].nb == 0 if there is none.
+    frame* frames;
+    /// Lowest level with a frame, or K+1.
+    int lowest;
+};
+
+#endif
+
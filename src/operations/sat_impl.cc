@@ -19,6 +19,7 @@
 
 #include "../defines.h"
 #include "sat_impl.h"
+#include "sat_checkpoint.h"
 #include <typeinfo> // for "bad_cast" exception
 #include <set>
 #include <map>
@@ -34,6 +35,8 @@ namespace MEDDLY {
   
   class common_impl_dfs_by_events_mt;
   class forwd_impl_dfs_by_events_mt;
+
+  class impl_checkpoint;
 };
 
 // #define DEBUG_INITIAL
@@ -110,10 +113,195 @@ MEDDLY::relation_node::setTokenUpdateAtIndex(long i,long val)
   MEDDLY_DCASSERT(i<getPieceSize());
   token_update[i] = val;
 }
+
+bool
+MEDDLY::relation_node::isAffine(long &delta, long &lower, long &upper) const
+{
+  return false;
+}
+
+// ******************************************************************
+
+inline size_t affineSignature(int level, rel_node_handle down, 
+  long delta, long lower, long upper)
+{
+  size_t h = size_t(level);
+  h = h * 31 + size_t(down);
+  h = h * 31 + size_t(delta);
+  h = h * 31 + size_t(lower);
+  h = h * 31 + size_t(upper);
+  return h;
+}
+
+MEDDLY::affine_relation_node::affine_relation_node(int lvl, 
+  rel_node_handle d, long dlt, long lo, long up)
+: relation_node(affineSignature(lvl, d, dlt, lo, up), lvl, d)
+{
+  delta = dlt;
+  lower = lo;
+  upper = up;
+}
+
+MEDDLY::affine_relation_node::~affine_relation_node()
+{
+}
+
+long MEDDLY::affine_relation_node::nextOf(long i)
+{
+  if (i>=getPieceSize()) expandTokenUpdate(i);
+  if (getTokenUpdate()[i]==NOT_KNOWN) {
+    bool enabled = (i >= lower) && (upper < 0 || i <= upper) && (i + delta >= 0);
+    setTokenUpdateAtIndex(i, enabled ? i + delta : OUT_OF_BOUNDS);
+  }
+  return getTokenUpdate()[i];
+}
+
+bool
+MEDDLY::affine_relation_node::equals(const relation_node* n) const
+{
+  long d, lo, up;
+  if (!n->isAffine(d, lo, up)) return false;
+  return relation_node::equals(n) && (d == delta) && (lo == lower) && (up == upper);
+}
+
+bool
+MEDDLY::affine_relation_node::isAffine(long &d, long &lo, long &up) const
+{
+  d = delta;
+  lo = lower;
+  up = upper;
+  return true;
+}
+// ******************************************************************
+// *                                                                *
+// *                  relation_node_pool  methods                   *
+// *                                                                *
+// ******************************************************************
+
+MEDDLY::relation_node_pool::relation_node_pool()
+{
+  free_list = 0;
+  num_nodes = 0;
+  pool_links = 1;
+  table_size = 1024;
+  table = new relation_node*[table_size];
+  for (size_t i = 0; i < table_size; i++) table[i] = 0;
+
+  // handle 0 is the null node
+  nodes.push_back(0);
+  refs.push_back(0);
+
+  // handle 1 is the terminal node, with a permanent reference
+  relation_node* Terminal = new relation_node(0, 0, TERMINAL_NODE);
+  Terminal->setID(TERMINAL_NODE);
+  nodes.push_back(Terminal);
+  refs.push_back(1);
+  Terminal->hash_chain = 0;
+  table[0] = Terminal;
+  num_nodes = 1;
+  MEDDLY_DCASSERT(nodes.size() == TERMINAL_NODE+1);
+}
+
+MEDDLY::relation_node_pool::~relation_node_pool()
+{
+  MEDDLY_DCASSERT(0==pool_links);
+  for (size_t h = 0; h < nodes.size(); h++) delete nodes[h];
+  delete[] table;
+}
+
+rel_node_handle
+MEDDLY::relation_node_pool::isUniqueNode(const relation_node* n) const
+{
+  for (relation_node* p = table[n->getSignature() % table_size]; p; p = p->hash_chain) {
+    if (p->equals(n)) return p->getID();
+  }
+  return 0;
+}
+
+rel_node_handle
+MEDDLY::relation_node_pool::registerNode(relation_node* n)
+{
+  MEDDLY_DCASSERT(n);
+  rel_node_handle h = isUniqueNode(n);
+  if (h) {
+    delete n;
+    refs[h]++;
+    return h;
+  }
+
+  if (0==nodeExists(n->getDown()))
+    throw error(error::INVALID_ARGUMENT, __FILE__, __LINE__);
+  linkNode(n->getDown());
+
+  if (free_list) {
+    h = free_list;
+    free_list = rel_node_handle(refs[h]);
+  } else {
+    h = rel_node_handle(nodes.size());
+    nodes.push_back(0);
+    refs.push_back(0);
+  }
+  nodes[h] = n;
+  refs[h] = 1;
+  n->setID(h);
+
+  size_t b = n->getSignature() % table_size;
+  n->hash_chain = table[b];
+  table[b] = n;
+  num_nodes++;
+  if (size_t(num_nodes) > 2*table_size) expandTable();
+  return h;
+}
+
+void
+MEDDLY::relation_node_pool::unlinkNode(rel_node_handle h)
+{
+  // Walk down the chain, while we drop last references.
+  while (h) {
+    MEDDLY_DCASSERT(nodeExists(h));
+    MEDDLY_DCASSERT(refs[h] > 0);
+    if (--refs[h]) return;
+
+    relation_node* n = nodes[h];
+    relation_node** pp = table + (n->getSignature() % table_size);
+    while (*pp != n) pp = &((*pp)->hash_chain);
+    *pp = n->hash_chain;
+
+    rel_node_handle down = n->getDown();
+    delete n;
+    nodes[h] = 0;
+    refs[h] = free_list;
+    free_list = h;
+    num_nodes--;
+    h = down;
+  }
+}
+
+void
+MEDDLY::relation_node_pool::expandTable()
+{
+  size_t new_size = 2*table_size;
+  relation_node** new_table = new relation_node*[new_size];
+  for (size_t i = 0; i < new_size; i++) new_table[i] = 0;
+  for (size_t i = 0; i < table_size; i++) {
+    while (table[i]) {
+      relation_node* n = table[i];
+      table[i] = n->hash_chain;
+      size_t b = n->getSignature() % new_size;
+      n->hash_chain = new_table[b];
+      new_table[b] = n;
+    }
+  }
+  delete[] table;
+  table = new_table;
+  table_size = new_size;
+}
+
 // ******************************************************************
 
 MEDDLY::satimpl_opname::implicit_relation::implicit_relation(forest* inmdd, forest* relmxd,
-                                                             forest* outmdd)
+                                                             forest* outmdd,
+                                                             relation_node_pool* pool)
 : insetF(static_cast<expert_forest*>(inmdd)), outsetF(static_cast<expert_forest*>(outmdd)), mixRelF(static_cast<expert_forest*>(relmxd))
 {
   
@@ -167,13 +355,14 @@ MEDDLY::satimpl_opname::implicit_relation::implicit_relation(forest* inmdd, fore
 
   
   
-  //create the terminal node
-  relation_node *Terminal = new relation_node(0,0,TERMINAL_NODE);
-  //mixRelF->createRelationNode(Terminal);
-  Terminal->setID(TERMINAL_NODE);
-  std::pair<rel_node_handle, relation_node*> TerminalNode(TERMINAL_NODE,Terminal);
-  impl_unique.insert(TerminalNode);
-  last_in_node_array = TERMINAL_NODE;
+  // the pool holds the terminal node
+  if (pool) {
+    node_pool = pool;
+    node_pool->linkPool();
+  } else {
+    // private; our link is the one it was created with
+    node_pool = new relation_node_pool;
+  }
   
 }
 
@@ -279,32 +468,24 @@ void MEDDLY::satimpl_opname::implicit_relation::setConfirmedStates(const dd_edge
 
 MEDDLY::satimpl_opname::implicit_relation::~implicit_relation()
 {
-  last_in_node_array = 0;
-  impl_unique.clear();
-  
-  for(int i = 0; i <=num_levels; i++) {delete[] event_list[i]; delete[] confirmed[i];}
-  delete[] event_list;
-  delete[] event_added;
-  delete[] event_list_alloc;
+  for (size_t i = 0; i < registered.size(); i++) node_pool->unlinkNode(registered[i]);
+  if (node_pool->unlinkPool()) delete node_pool;
+  
+  // these were malloc'd; level 0 is unused
+  for(int i = 1; i <=num_levels; i++) {free(event_list[i]); free(confirmed[i]);}
+  free(event_list);
+  free(event_added);
+  free(event_list_alloc);
   delete[] confirmed;
-  delete[] confirm_states;
-  delete[] confirmed_array_size;
+  free(confirm_states);
+  free(confirmed_array_size);
 }
 
 
 rel_node_handle
 MEDDLY::satimpl_opname::implicit_relation::isUniqueNode(relation_node* n)
 {
-  bool is_unique_node = true;
-  std::unordered_map<rel_node_handle, relation_node*>::iterator it = impl_unique.begin();
-  while(it != impl_unique.end())
-    {
-    is_unique_node = !((it->second)->equals(n));
-    if(is_unique_node==false)
-      return (it->second)->getID();
-    ++it;
-    }
-  return 0;
+  return node_pool->isUniqueNode(n);
 }
 
 rel_node_handle
@@ -322,25 +503,10 @@ MEDDLY::satimpl_opname::implicit_relation::registerNode(bool is_event_top, relat
                    ( downLevel == 0 ) );
 #endif
 
-  rel_node_handle n_ID = isUniqueNode(n);
-  
-  if(n_ID==0) // Add new node
-   {
-    n_ID  = last_in_node_array + 1;
-    std::pair<rel_node_handle, relation_node*> add_node(n_ID,n);
-    impl_unique.insert(add_node);
-    if(impl_unique.find(n_ID) != impl_unique.end())
-    {
-      last_in_node_array = n_ID;
-      n->setID(n_ID);
-    }
-    //mixRelF->createRelationNode(n);
-  }
-  else //Delete the node
-    {
-     delete n;
-    }
-  
+  // n may be destroyed here, if the pool already has it
+  rel_node_handle n_ID = node_pool->registerNode(n);
+  registered.push_back(n_ID);
+
   if(is_event_top)
     {
     resizeEventArray(nLevel);
@@ -587,6 +753,31 @@ MEDDLY::satimpl_opname::implicit_relation::isUnionPossible(int level, long i, re
     return true;
 }
 
+// ******************************************************************
+// *                                                                *
+// *                     impl_checkpoint  class                     *
+// *                                                                *
+// ******************************************************************
+
+/** Checkpoints, including the confirmed local states of the relation.
+ */
+class MEDDLY::impl_checkpoint : public sat_checkpoint {
+  satimpl_opname::implicit_relation* rel;
+public:
+  impl_checkpoint(satimpl_opname::implicit_relation* r, const char* fn, long sec)
+    : sat_checkpoint(r->getOutForest(), fn, sec), rel(r) { }
+protected:
+  virtual bool hasLocalStates() const {
+    return true;
+  }
+  virtual bool isConfirmed(int k, int i) const {
+    return rel->isConfirmedState(k, i);
+  }
+  virtual void confirm(int k, int i) {
+    rel->setConfirmedStates(k, i);
+  }
+};
+
 // ******************************************************************
 // *                                                                *
 // *               saturation_impl_by_events_opname  class               *
@@ -625,10 +816,13 @@ const MEDDLY::saturation_impl_by_events_opname* MEDDLY::saturation_impl_by_event
 
 class MEDDLY::saturation_impl_by_events_op : public unary_operation {
   common_impl_dfs_by_events_mt* parent;
+  sat_checkpoint* ckpt;
 public:
   saturation_impl_by_events_op(common_impl_dfs_by_events_mt* p,
                                expert_forest* argF, expert_forest* resF);
   virtual ~saturation_impl_by_events_op();
+
+  inline void useCheckpoint(sat_checkpoint* c) { ckpt = c; }
   
   node_handle saturate(node_handle mdd);
   node_handle saturate(node_handle mdd, int level);
@@ -683,6 +877,8 @@ public:
   virtual ~common_impl_dfs_by_events_mt();
   
   virtual void compute(const dd_edge& a, dd_edge &c);
+  virtual void enableCheckpoints(const char* filename, long seconds);
+  virtual void resume(const char* filename, dd_edge &c);
   virtual bool isReachable(const dd_edge& a, const dd_edge& constraint);
   virtual void saturateHelper(unpacked_node& mdd) = 0;
   // for detecting reachable state in constraint
@@ -724,6 +920,9 @@ protected:
   expert_forest* arg1F;
   expert_forest* arg2F;
   expert_forest* resF;
+
+  // If not null, where and when to write checkpoints
+  sat_checkpoint* ckpt;
   
 protected:
   class indexq {
@@ -843,6 +1042,11 @@ protected:
   virtual void saturateHelper(unpacked_node& mdd);
   node_handle recFire(node_handle mdd, rel_node_handle mxd);
   MEDDLY::node_handle recFireSet(node_handle mdd, std::vector<rel_node_handle> mxd);
+  /// recFire for an affine piece: shift the children of A into nb.
+  void recFireAffine(unpacked_node* A, unpacked_node* nb, 
+      rel_node_handle down, long delta, long lower, long upper);
+  /// Confirm local state j of nb's level, and enlarge nb if needed.
+  void confirmColumn(unpacked_node* nb, long j);
 
   // for reachable state in constraint detection
   bool saturateHelper(
@@ -872,7 +1076,7 @@ void MEDDLY::forwd_impl_dfs_by_events_mt::saturateHelper(unpacked_node& nb)
   
   // Initialize mxd readers, note we might skip the unprimed level
   const int level = nb.getLevel();
-  node_handle* events = rel->arrayForLevel(level);
+  rel_node_handle* events = rel->arrayForLevel(level);
   relation_node** Ru = new relation_node*[nEventsAtThisLevel];
   for (int ei = 0; ei < nEventsAtThisLevel; ei++) {
     Ru[ei] = rel->nodeExists(events[ei]);
@@ -896,6 +1100,7 @@ void MEDDLY::forwd_impl_dfs_by_events_mt::saturateHelper(unpacked_node& nb)
   
   // explore indexes
   while (!queue->isEmpty()) {
+    if (ckpt) ckpt->poll();
     int i = queue->remove();
     
     MEDDLY_DCASSERT(nb.d(i));
@@ -1098,6 +1303,10 @@ MEDDLY::node_handle MEDDLY::forwd_impl_dfs_by_events_mt::recFire(
     // Need to process this level in the MXD.
     MEDDLY_DCASSERT(mxdLevel >= mddLevel);
     
+    long delta, lower, upper;
+    if (relNode->isAffine(delta, lower, upper)) {
+      recFireAffine(A, nb, relNode->getDown(), delta, lower, upper);
+    } else {
     // Initialize mxd readers, note we might skip the unprimed level
     
     // loop over mxd "rows"
@@ -1139,7 +1348,7 @@ MEDDLY::node_handle MEDDLY::forwd_impl_dfs_by_events_mt::recFire(
           nb->set_d(j, nbdj);
           
         } // for i
-
+    } // not affine
     
   } // else
   
@@ -1170,6 +1379,64 @@ MEDDLY::node_handle MEDDLY::forwd_impl_dfs_by_events_mt::recFire(
   return saveResult(Key, mdd, mxd, result);
 }
 
+void MEDDLY::forwd_impl_dfs_by_events_mt::recFireAffine(unpacked_node* A,
+  unpacked_node* nb, rel_node_handle down, long delta, long lower, long upper)
+{
+  //
+  // Row i goes to column i + delta.  Different rows give different
+  // columns, and nb starts empty, so there is nothing to union.
+  //
+  long ilo = MAX(lower, -delta);
+  if (ilo < 0) ilo = 0;
+  long ihi = A->getSize()-1;
+  if (upper >= 0 && upper < ihi) ihi = upper;
+  while (ihi >= ilo && 0==A->d(ihi)) ihi--;
+  if (ilo > ihi) return;
+
+  if (TERMINAL_NODE == down && arg1F == resF) {
+    //
+    // Bottom of the event: the new states are
+    // the children of A, shifted as one block.
+    //
+    confirmColumn(nb, ihi + delta);
+    MEDDLY_DCASSERT(ihi + delta < nb->getSize());
+    memcpy(&nb->d_ref(ilo + delta), &A->d_ref(ilo), 
+      (ihi - ilo + 1) * sizeof(node_handle));
+    for (long j = ilo + delta; j <= ihi + delta; j++) {
+      if (0==nb->d(j)) continue;
+      resF->linkNode(nb->d(j));
+      confirmColumn(nb, j);
+    }
+    return;
+  }
+
+  for (long i = ilo; i <= ihi; i++) {
+    if (0==A->d(i)) continue;
+    node_handle newstates = recFire(A->d(i), down);
+    if (0==newstates) continue;
+    const long j = i + delta;
+    confirmColumn(nb, j);
+    MEDDLY_DCASSERT(0==nb->d(j));
+    nb->d_ref(j) = newstates;
+  }
+}
+
+
+void MEDDLY::forwd_impl_dfs_by_events_mt::confirmColumn(unpacked_node* nb, long j)
+{
+  const int level = nb->getLevel();
+  if (rel->isConfirmedState(level, j)) return;
+  rel->setConfirmedStates(level, j);
+  if (j >= nb->getSize()) {
+    expert_domain* dm = static_cast<expert_domain*>(resF->useDomain());
+    int new_var_bound = resF->isExtensibleLevel(level)? -(j+1): (j+1);
+    dm->enlargeVariableBound(level, false, new_var_bound);
+    int oldSize = nb->getSize();
+    nb->resize(j+1);
+    while(oldSize < nb->getSize()) { nb->d_ref(oldSize++) = 0; }
+  }
+}
+
 // ******************************************************************
 // *                                                                *
 // *             common_impl_dfs_by_events_mt  methods              *
@@ -1186,6 +1453,7 @@ MEDDLY::common_impl_dfs_by_events_mt::common_impl_dfs_by_events_mt(
   mxdDifference = 0;
   freeqs = 0;
   freebufs = 0;
+  ckpt = 0;
   rel = relation;
   arg1F = static_cast<expert_forest*>(rel->getInForest());
   //arg2F = static_cast<expert_forest*>(rel->getInForest());
@@ -1203,6 +1471,7 @@ MEDDLY::common_impl_dfs_by_events_mt::common_impl_dfs_by_events_mt(
 
 MEDDLY::common_impl_dfs_by_events_mt::~common_impl_dfs_by_events_mt()
 {
+  delete ckpt;
   if (rel->autoDestroy()) delete rel;
   unregisterInForest(arg1F);
   //unregisterInForest(arg2F);
@@ -1278,6 +1547,7 @@ void MEDDLY::common_impl_dfs_by_events_mt
    }*/
   
   saturation_impl_by_events_op* so = new saturation_impl_by_events_op(this, arg1F, resF);
+  so->useCheckpoint(ckpt);
   node_handle cnode = so->saturate(a.getNode());
   c.set(cnode);
   // Cleanup
@@ -1294,6 +1564,22 @@ void MEDDLY::common_impl_dfs_by_events_mt
   delete so;
 }
 
+void MEDDLY::common_impl_dfs_by_events_mt
+::enableCheckpoints(const char* filename, long seconds)
+{
+  delete ckpt;
+  ckpt = filename ? new impl_checkpoint(rel, filename, seconds) : 0;
+}
+
+void MEDDLY::common_impl_dfs_by_events_mt
+::resume(const char* filename, dd_edge &c)
+{
+  impl_checkpoint reader(rel, filename, 0);
+  dd_edge a(resF);
+  reader.read(filename, a);
+  compute(a, c);
+}
+
 // ******************************************************************
 // *       common_impl_dfs_by_events_mt::indexq  methods                 *
 // ******************************************************************
@@ -1379,6 +1665,7 @@ MEDDLY::saturation_impl_by_events_op
 : unary_operation(saturation_impl_by_events_opname::getInstance(), 1, argF, resF)
 {
   parent = p;
+  ckpt = 0;
 
   const char* name = saturation_impl_by_events_opname::getInstance()->getName();
   compute_table::entry_type* et;
@@ -1448,14 +1735,20 @@ MEDDLY::saturation_impl_by_events_op::saturate(node_handle mdd, int k)
     mddDptrs->initFromNode(argF, mdd, true);
   }
   
+  const bool tracked = ckpt && ckpt->enter(k, nb, mddDptrs);
+
   // Do computation
   for (int i=0; i<sz; i++) {
     nb->d_ref(i) = mddDptrs->d(i) ? saturate(mddDptrs->d(i), k-1) : 0;
+    if (tracked) ckpt->advance(k, unsigned(i+1));
+    if (ckpt) ckpt->poll();
     }
+  if (tracked) ckpt->fire(k);
   
   // Cleanup
   unpacked_node::recycle(mddDptrs);
   parent->saturateHelper(*nb);
+  if (tracked) ckpt->leave(k);
   n = resF->createReducedNode(-1, nb);
   
   // save in compute table
@@ -1742,7 +2035,7 @@ bool MEDDLY::forwd_impl_dfs_by_events_mt::saturateHelper(
   const node_handle cons_ext_d = consDptrs->isExtensible() ? consDptrs->ext_d() : 0;
 
   // Initialize mxd readers, note we might skip the unprimed level
-  node_handle* events = rel->arrayForLevel(level);
+  rel_node_handle* events = rel->arrayForLevel(level);
   relation_node** Ru = new relation_node*[nEventsAtThisLevel];
   for (int ei = 0; ei < nEventsAtThisLevel; ei++) {
     Ru[ei] = rel->nodeExists(events[ei]);
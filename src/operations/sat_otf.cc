@@ -19,6 +19,7 @@
 
 #include "../defines.h"
 #include "sat_otf.h"
+#include "sat_checkpoint.h"
 #include <typeinfo> // for "bad_cast" exception
 #include <set>
 
@@ -30,6 +31,8 @@ namespace MEDDLY {
   class forwd_otf_dfs_by_events_mt;
   class bckwd_otf_dfs_by_events_mt;
 
+  class otf_checkpoint;
+
   class fb_otf_saturation_opname;
 };
 
@@ -52,7 +55,7 @@ MEDDLY::satotf_opname::~satotf_opname()
 // ============================================================
 
 MEDDLY::satotf_opname::subevent::subevent(forest* f, int* v, int nv, bool firing)
-: vars(0), num_vars(nv), root(dd_edge(f)), top(0),
+: vars(0), num_vars(nv), root(dd_edge(f)), delta(dd_edge(f)), top(0),
   f(static_cast<expert_forest*>(f)), is_firing(firing)
 {
   MEDDLY_DCASSERT(f != 0);
@@ -76,6 +79,8 @@ MEDDLY::satotf_opname::subevent::subevent(forest* f, int* v, int nv, bool firing
     }
   }
 
+  minterm_arena = 0;
+  minterm_width = this->f->getNumVariables() + 1;
   unpminterms = pminterms = 0;
   num_minterms = size_minterms = 0;
 }
@@ -83,24 +88,19 @@ MEDDLY::satotf_opname::subevent::subevent(forest* f, int* v, int nv, bool firing
 MEDDLY::satotf_opname::subevent::~subevent()
 {
   if (vars) delete [] vars;
-  for (int i=0; i<num_minterms; i++) {
-    delete[] unpminterms[i];
-    delete[] pminterms[i];
-  }
+  free(minterm_arena);
   free(unpminterms);
   free(pminterms);
 }
 
 void MEDDLY::satotf_opname::subevent::clearMinterms()
 {
-  for (int i=0; i<num_minterms; i++) {
-    delete[] unpminterms[i];
-    delete[] pminterms[i];
-  }
+  free(minterm_arena);
   free(unpminterms);
   free(pminterms);
+  minterm_arena = 0;
   unpminterms = pminterms = 0;
-  num_minterms = 0;
+  num_minterms = size_minterms = 0;
 }
 
 
@@ -121,28 +121,30 @@ bool MEDDLY::satotf_opname::subevent::addMinterm(const int* from, const int* to)
   */
 
   if (num_minterms >= size_minterms) {
-    int old_size = size_minterms;
-    size_minterms = (0==size_minterms)? 8: MIN(2*size_minterms, 256 + size_minterms);
-    unpminterms = (int**) realloc(unpminterms, unsigned(size_minterms) * sizeof(int**));
-    pminterms = (int**) realloc(pminterms, unsigned(size_minterms) * sizeof(int**));
-    if (0==unpminterms || 0==pminterms) return false; // malloc or realloc failed
-    for (int i=old_size; i<size_minterms; i++) {
-      unpminterms[i] = 0;
-      pminterms[i] = 0;
+    int new_size = (0==size_minterms)? 8: MIN(2*size_minterms, 256 + size_minterms);
+    int** new_unp = (int**) realloc(unpminterms, unsigned(new_size) * sizeof(int*));
+    if (new_unp) unpminterms = new_unp;
+    int** new_p = (int**) realloc(pminterms, unsigned(new_size) * sizeof(int*));
+    if (new_p) pminterms = new_p;
+    if (0==new_unp || 0==new_p) return false; // realloc failed
+    size_t width = size_t(2 * minterm_width);
+    int* new_arena = (int*) realloc(minterm_arena, 
+      unsigned(new_size) * width * sizeof(int));
+    if (0==new_arena) return false; // realloc failed
+    minterm_arena = new_arena;
+    size_minterms = new_size;
+    // The arena may have moved; re-point every row.
+    for (int i=0; i<size_minterms; i++) {
+      unpminterms[i] = minterm_arena + size_t(i) * width;
+      pminterms[i] = unpminterms[i] + minterm_width;
     }
   }
-  if (0==unpminterms[num_minterms]) {
-    unpminterms[num_minterms] = new int[f->getNumVariables() + 1];
-    MEDDLY_DCASSERT(0==pminterms[num_minterms]);
-    pminterms[num_minterms] = new int[f->getNumVariables() + 1];
-  }
-  // out << "Added minterm: [";
-  for (int i = f->getNumVariables(); i >= 0; i--) {
-    unpminterms[num_minterms][i] = from[i];
-    pminterms[num_minterms][i] = to[i];
-    // out << unpminterms[num_minterms][i] << " -> " << pminterms[num_minterms][i] << " , ";
+  int* unp = unpminterms[num_minterms];
+  int* p = pminterms[num_minterms];
+  for (int i = minterm_width - 1; i >= 0; i--) {
+    unp[i] = from[i];
+    p[i] = to[i];
   }
-  // out << "]\n";
   expert_domain* d = static_cast<expert_domain*>(f->useDomain());
   for (int i = num_vars - 1; i >= 0; i--) {
     int level = vars[i];
@@ -159,29 +161,17 @@ bool MEDDLY::satotf_opname::subevent::addMinterm(const int* from, const int* to)
 }
 
 void MEDDLY::satotf_opname::subevent::buildRoot() {
-  if (0 == num_minterms) return;
-  /*
-  ostream_output out(std::cout);
-  out << "Building subevent from " << num_minterms << " minterms\n";
-  for (int i = 0; i < num_minterms; i++) {
-    out << "minterm[" << i << "]: [ ";
-    for (int j = f->getNumVariables(); j >= 0; j--) {
-      out << unpminterms[i][j] << " -> " << pminterms[i][j] << ", ";
-    }
-    out << " ]\n";
-  }
-  */
-  if (usesExtensibleVariables()) {
-    dd_edge sum(root);
-    f->createEdge(unpminterms, pminterms, num_minterms, sum);
-    num_minterms = 0;
-    root += sum;
-  } else {
-    f->createEdge(unpminterms, pminterms, num_minterms, root);
+  if (0 == num_minterms) {
+    delta.set(0);
+    return;
   }
-  // out << "Equivalent event: " << root.getNode() << "\n";
-  // out << "Result: ";
-  // root.show(out, 2);
+  //
+  // Build only the pending minterms, and add them to the root.
+  // Minterms already in the root are never rebuilt.
+  //
+  f->createEdge(unpminterms, pminterms, num_minterms, delta);
+  num_minterms = 0;
+  root += delta;
 }
 
 
@@ -198,11 +188,7 @@ void MEDDLY::satotf_opname::subevent::showInfo(output& out) const {
 }
 
 long MEDDLY::satotf_opname::subevent::mintermMemoryUsage() const {
-  long n_minterms = 0L;
-  for (int i = 0; i < size_minterms; i++) {
-    if (unpminterms[i] != 0) n_minterms++;
-  }
-  return long(n_minterms * 2) * long(f->getDomain()->getNumVariables()) * long(sizeof(int));
+  return long(size_minterms) * 2L * long(minterm_width) * long(sizeof(int));
 }
 
 // ============================================================
@@ -276,6 +262,7 @@ MEDDLY::satotf_opname::event::event(subevent** p, int np)
     *curr++ = *it++;
   }
 
+  built_roots = 0;
   root = dd_edge(f);
   event_mask = dd_edge(f);
   event_mask_from_minterm = 0;
@@ -287,6 +274,7 @@ MEDDLY::satotf_opname::event::~event()
 {
   for (int i=0; i<num_subevents; i++) delete subevents[i];
   delete[] subevents;
+  delete[] built_roots;
   delete[] vars;
   delete[] firing_vars;
   delete[] event_mask_from_minterm;
@@ -322,6 +310,14 @@ void MEDDLY::satotf_opname::event::buildEventMask()
 }
 
 
+void MEDDLY::satotf_opname::event::conjunctSubevents(dd_edge &e, int skip) const
+{
+  for (int i = 0; i < num_subevents; i++) {
+    if (i != skip) e *= subevents[i]->getRoot();
+  }
+}
+
+
 bool MEDDLY::satotf_opname::event::rebuild()
 {
   MEDDLY_DCASSERT(num_subevents > 0);
@@ -329,35 +325,50 @@ bool MEDDLY::satotf_opname::event::rebuild()
   if (!needs_rebuilding) return false;
   needs_rebuilding = false;
 
-  // An event is a conjunction of sub-events (or sub-functions).
+  //
+  // The event can be updated incrementally if every subevent root
+  // is still the one we used last time, before adding its new minterms;
+  // otherwise, someone changed a root behind our back and we start over.
+  // Extensible variables change the meaning of the event mask,
+  // so they always get a full rebuild.
+  //
+  bool incremental = (built_roots != 0);
   for (int i = 0; i < num_subevents; i++) {
+    if (incremental) {
+      incremental = 
+        !subevents[i]->usesExtensibleVariables() &&
+        (subevents[i]->getRoot() == built_roots[i]);
+    }
     subevents[i]->buildRoot();
   }
   buildEventMask();
 
-  dd_edge e(event_mask);
-  for (int i = 0; i < num_subevents; i++) {
-    e *= subevents[i]->getRoot();
-  }
-
-  /*
-  if (e.getNode() == 0) {
-    ostream_output out(std::cout);
-    f->useDomain()->showInfo(out);
-    out << "subevent: " << event_mask.getNode() << "\n";
-    event_mask.show(out, 2);
-    for (int i = 0; i < num_subevents; i++) {
-    out << "subevent: " << subevents[i]->getRoot().getNode() << "\n";
-    subevents[i]->getRoot().show(out, 2);
+  dd_edge e(root);
+  if (incremental) {
+    //
+    // An event is a conjunction of sub-events (or sub-functions).
+    // With old roots R_i and new minterms D_i, the new event is
+    //    mask * prod_i (R_i + D_i)
+    //      = old event + sum_j (mask * D_j * prod_{i != j} (R_i + D_i)),
+    // and every term of the sum is bounded by the (small) D_j.
+    //
+    for (int j = 0; j < num_subevents; j++) {
+      if (0 == subevents[j]->getDelta().getNode()) continue;
+      dd_edge term(subevents[j]->getDelta());
+      term *= event_mask;
+      conjunctSubevents(term, j);
+      e += term;
     }
+  } else {
+    // An event is a conjunction of sub-events (or sub-functions).
+    e = event_mask;
+    conjunctSubevents(e, -1);
+    if (0 == built_roots) built_roots = new dd_edge[num_subevents];
   }
-  ostream_output out(std::cout);
   for (int i = 0; i < num_subevents; i++) {
-  out << "subevent: " << subevents[i]->getRoot().getNode() << "\n";
-  subevents[i]->getRoot().show(out, 2);
+    built_roots[i] = subevents[i]->getRoot();
   }
-  e.show(out, 2);
-  */
+
   if (e == root) return false;
   root = e;
   return true;
@@ -765,7 +776,10 @@ double MEDDLY::satotf_opname::otf_relation::getArcCount(
   }
 
   dd_edge confirmed_local_states_mask = mask * confirmed_local_states;
-  MEDDLY::apply(MEDDLY::CROSS, confirmed_local_states_mask, confirmed_local_states_mask, mxd_mask);
+  // not apply(): we are inside an operation
+  getOperation(CROSS, confirmed_local_states_mask, confirmed_local_states_mask,
+    mxd_mask)->compute(confirmed_local_states_mask, confirmed_local_states_mask,
+    mxd_mask);
 
   if (count_duplicates) {
     for (int k = 1; k < num_levels; k++) {
@@ -901,6 +915,31 @@ MEDDLY::node_handle MEDDLY::satotf_opname::otf_relation::getBoundedMxd(
 
 */
 
+// ******************************************************************
+// *                                                                *
+// *                      otf_checkpoint  class                     *
+// *                                                                *
+// ******************************************************************
+
+/** Checkpoints, including the confirmed local states of the relation.
+*/
+class MEDDLY::otf_checkpoint : public sat_checkpoint {
+    satotf_opname::otf_relation* rel;
+  public:
+    otf_checkpoint(satotf_opname::otf_relation* r, const char* fn, long sec)
+      : sat_checkpoint(r->getOutForest(), fn, sec), rel(r) { }
+  protected:
+    virtual bool hasLocalStates() const {
+      return true;
+    }
+    virtual bool isConfirmed(int k, int i) const {
+      return rel->isConfirmed(k, i);
+    }
+    virtual void confirm(int k, int i) {
+      rel->confirm(k, i);
+    }
+};
+
 // ******************************************************************
 // *                                                                *
 // *                    otfsat_by_events_opname  class              *
@@ -939,11 +978,14 @@ const MEDDLY::otfsat_by_events_opname* MEDDLY::otfsat_by_events_opname::getInsta
 
 class MEDDLY::otfsat_by_events_op : public unary_operation {
     common_otf_dfs_by_events_mt* parent;
+    sat_checkpoint* ckpt;
   public:
     otfsat_by_events_op(common_otf_dfs_by_events_mt* p,
       expert_forest* argF, expert_forest* resF);
     virtual ~otfsat_by_events_op();
 
+    inline void useCheckpoint(sat_checkpoint* c) { ckpt = c; }
+
     void saturate(const dd_edge& in, dd_edge& out);
     // node_handle saturate(node_handle mdd);
     node_handle saturate(node_handle mdd, int level);
@@ -985,6 +1027,8 @@ class MEDDLY::common_otf_dfs_by_events_mt : public specialized_operation {
     virtual ~common_otf_dfs_by_events_mt();
 
     virtual void compute(const dd_edge& a, dd_edge &c);
+    virtual void enableCheckpoints(const char* filename, long seconds);
+    virtual void resume(const char* filename, dd_edge &c);
     virtual void saturateHelper(unpacked_node& mdd) = 0;
 
   protected:
@@ -1021,6 +1065,9 @@ class MEDDLY::common_otf_dfs_by_events_mt : public specialized_operation {
     expert_forest* arg2F;
     expert_forest* resF;
 
+    // If not null, where and when to write checkpoints
+    sat_checkpoint* ckpt;
+
   protected:
     class indexq {
         static const int NULPTR = -1;
@@ -1136,6 +1183,7 @@ MEDDLY::otfsat_by_events_op
   : unary_operation(otfsat_by_events_opname::getInstance(), 1, argF, resF)
 {
   parent = p;
+  ckpt = 0;
 
   const char* name = otfsat_by_events_opname::getInstance()->getName();
   compute_table::entry_type* et;
@@ -1205,15 +1253,21 @@ MEDDLY::otfsat_by_events_op::saturate(node_handle mdd, int k)
     mddDptrs->initFromNode(argF, mdd, true);
   }
 
+  const bool tracked = ckpt && ckpt->enter(k, nb, mddDptrs);
+
   // Do computation
   for (unsigned i=0; i<sz; i++) {
     nb->d_ref(i) = mddDptrs->d(i) ? saturate(mddDptrs->d(i), k-1) : 0;
+    if (tracked) ckpt->advance(k, i+1);
+    if (ckpt) ckpt->poll();
   }
+  if (tracked) ckpt->fire(k);
 
   // Cleanup
   unpacked_node::recycle(mddDptrs);
 
   parent->saturateHelper(*nb);
+  if (tracked) ckpt->leave(k);
   n = resF->createReducedNode(-1, nb);
 
   // save in compute table
@@ -1243,6 +1297,7 @@ MEDDLY::common_otf_dfs_by_events_mt::common_otf_dfs_by_events_mt(
   mxdDifference = 0;
   freeqs = 0;
   freebufs = 0;
+  ckpt = 0;
   rel = relation;
   arg1F = static_cast<expert_forest*>(rel->getInForest());
   arg2F = static_cast<expert_forest*>(rel->getRelForest());
@@ -1262,6 +1317,7 @@ MEDDLY::common_otf_dfs_by_events_mt::common_otf_dfs_by_events_mt(
 
 MEDDLY::common_otf_dfs_by_events_mt::~common_otf_dfs_by_events_mt()
 {
+  delete ckpt;
   if (rel->autoDestroy()) delete rel;
   unregisterInForest(arg1F);
   unregisterInForest(arg2F);
@@ -1292,6 +1348,7 @@ void MEDDLY::common_otf_dfs_by_events_mt
 
   // Execute saturation operation
   otfsat_by_events_op* so = new otfsat_by_events_op(this, arg1F, resF);
+  so->useCheckpoint(ckpt);
   so->saturate(a, c);
 
   // Cleanup
@@ -1308,6 +1365,23 @@ void MEDDLY::common_otf_dfs_by_events_mt
   delete so;
 }
 
+void MEDDLY::common_otf_dfs_by_events_mt
+::enableCheckpoints(const char* filename, long seconds)
+{
+  delete ckpt;
+  ckpt = filename ? new otf_checkpoint(rel, filename, seconds) : 0;
+}
+
+void MEDDLY::common_otf_dfs_by_events_mt
+::resume(const char* filename, dd_edge &c)
+{
+  // Restores the confirmed local states, which rebuilds the events
+  otf_checkpoint reader(rel, filename, 0);
+  dd_edge a(resF);
+  reader.read(filename, a);
+  compute(a, c);
+}
+
 // ******************************************************************
 // *       common_otf_dfs_by_events_mt::indexq  methods                 *
 // ******************************************************************
@@ -1424,6 +1498,7 @@ void MEDDLY::forwd_otf_dfs_by_events_mt::saturateHelper(unpacked_node& nb)
 
   // explore indexes
   while (!queue->isEmpty()) {
+    if (ckpt) ckpt->poll();
     const unsigned i = unsigned(queue->remove());
 
     MEDDLY_DCASSERT(nb.d(i));
@@ -1443,7 +1518,7 @@ void MEDDLY::forwd_otf_dfs_by_events_mt::saturateHelper(unpacked_node& nb)
           if (0==Ru[ei]) {
             Ru[ei] = unpacked_node::useUnpackedNode();
           }
-          const int eventLevel = mxd.getNode();
+          const int eventLevel = mxd.getLevel();
           if (ABS(eventLevel) < level || eventLevel < 0) {
             // Takes care of two situations:
             // - skipped unprimed level (due to Fully Reduced)
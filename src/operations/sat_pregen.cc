@@ -19,8 +19,15 @@
 
 #include "../defines.h"
 #include "sat_pregen.h"
+#include "sat_checkpoint.h"
+#include "apply_base.h"
 #include <typeinfo> // for "bad_cast" exception
 
+#ifdef MEDDLY_THREADS
+#include <thread>
+#include <vector>
+#endif
+
 #define DEBUG_FINALIZE
 // #define DEBUG_FINALIZE_SPLIT
 // #define DEBUG_EVENT_MASK
@@ -38,6 +45,92 @@ namespace MEDDLY {
 } // Namespace MEDDLY
 
 
+// ******************************************************************
+// *                                                                *
+// *                        helper functions                        *
+// *                                                                *
+// ******************************************************************
+
+namespace MEDDLY {
+
+  /*
+      Combine items[0..n-1] with a commutative, associative operation,
+      as a balanced binary tree: pairs, then pairs of pairs, and so on.
+      Compared to a left-to-right accumulation, this keeps the
+      intermediate diagrams (and the compute table entries for them)
+      small, and every operand takes part in only log(n) operations.
+      The items array is destroyed.
+  */
+  static void reduceBalanced(binary_operation* op, dd_edge* items, unsigned n,
+    dd_edge &result)
+  {
+    MEDDLY_DCASSERT(op);
+    if (0==n) {
+      result.set(0);
+      return;
+    }
+    for (unsigned stride = 1; stride < n; stride *= 2) {
+      for (unsigned i = 0; i+stride < n; i += 2*stride) {
+        op->compute(items[i], items[i+stride], items[i]);
+        items[i+stride].set(0);
+      }
+    }
+    result = items[0];
+  }
+
+  // Diagonal entries [from, to) of relation node p, whose top is level k
+  // or below; see collectDiagonal().
+  static void collectDiagonalRange(const expert_forest* f, int k,
+    node_handle p, int from, int to, node_handle* diag)
+  {
+    const bool skipped = isLevelAbove(k, f->getNodeLevel(p));
+    for (int i = from; i < to; i++) {
+      const node_handle d = skipped ? p : f->getDownPtr(p, i);
+      if (isLevelAbove(-k, f->getNodeLevel(d))) {
+        diag[i] = d;    // identity at the primed level
+      } else {
+        diag[i] = f->getDownPtr(d, i);
+      }
+    }
+  }
+
+  /*
+      Collect the diagonal i -> i of relation node p at level k,
+      one linked edge per local state, in diag[0..size-1].
+      Only getDownPtr() is used to read the forest, so when built with
+      MEDDLY_THREADS the rows are split across policies::split_threads
+      threads.
+  */
+  static void collectDiagonal(expert_forest* f, int k, node_handle p,
+    dd_edge* diag, int size)
+  {
+    node_handle* d = new node_handle[size];
+#ifdef MEDDLY_THREADS
+    const int nt = MIN(int(f->getPolicies().split_threads), size);
+    if (nt > 1) {
+      std::vector<std::thread> workers;
+      const int per = (size + nt - 1) / nt;
+      for (int from = 0; from < size; from += per) {
+        workers.push_back(std::thread(collectDiagonalRange, f, k, p,
+          from, MIN(from + per, size), d));
+      }
+      for (unsigned t = 0; t < workers.size(); t++) {
+        workers[t].join();
+      }
+    } else
+#endif
+    collectDiagonalRange(f, k, p, 0, size, d);
+
+    for (int i = 0; i < size; i++) {
+      diag[i].setForest(f);
+      diag[i].set( f->linkNode(d[i]) );
+    }
+    delete[] d;
+  }
+
+} // Namespace MEDDLY
+
+
 
 // ******************************************************************
 // *                                                                *
@@ -170,6 +263,60 @@ MEDDLY::satpregen_opname::pregen_relation
   }
 }
 
+void
+MEDDLY::satpregen_opname::pregen_relation
+::addToRelation(const dd_edge* r, unsigned n)
+{
+  MEDDLY_DCASSERT(mxdF);
+
+  if (level_index) {
+    // relation is "by events"; nothing to combine
+    for (unsigned i=0; i<n; i++) addToRelation(r[i]);
+    return;
+  }
+
+  //
+  // Relation is "by levels".
+  // Bucket the relations by level, combine each bucket as a balanced
+  // tree, and add the result to the level only once.
+  //
+  for (unsigned i=0; i<n; i++) {
+    if (r[i].getForest() != mxdF)  throw error(error::FOREST_MISMATCH, __FILE__, __LINE__);
+  }
+
+  binary_operation* mxdUnion = getOperation(UNION, mxdF, mxdF, mxdF);
+  MEDDLY_DCASSERT(mxdUnion);
+
+  //
+  // Counting sort by level: bucket k is bucket[start[k]..start[k+1]-1].
+  //
+  unsigned* start = new unsigned[K+2];
+  for (unsigned k=0; k<=K+1; k++) start[k] = 0;
+  for (unsigned i=0; i<n; i++) {
+    start[ABS(r[i].getLevel())+1]++;
+  }
+  for (unsigned k=1; k<=K+1; k++) start[k] += start[k-1];
+
+  dd_edge* bucket = new dd_edge[n];
+  unsigned* fill = new unsigned[K+1];
+  for (unsigned k=0; k<=K; k++) fill[k] = start[k];
+  for (unsigned i=0; i<n; i++) {
+    bucket[fill[ABS(r[i].getLevel())]++] = r[i];
+  }
+  delete[] fill;
+
+  // Level 0 holds the constants; they are ignored, as in addToRelation().
+  for (unsigned k=1; k<=K; k++) {
+    const unsigned b = start[k+1] - start[k];
+    if (0==b) continue;
+    dd_edge sum(mxdF);
+    reduceBalanced(mxdUnion, bucket + start[k], b, sum);
+    events[k] += sum;
+  }
+  delete[] bucket;
+  delete[] start;
+}
+
 
 void
 MEDDLY::satpregen_opname::pregen_relation
@@ -215,36 +362,14 @@ MEDDLY::satpregen_opname::pregen_relation
 
     MEDDLY_DCASSERT(ABS(events[k].getLevel() <= k));
 
-    // Initialize unpacked nodes
-    unpacked_node* Mu = (isLevelAbove(k, events[k].getLevel())) 
-      ?   unpacked_node::newRedundant(mxdF, k, events[k].getNode(), true)
-      :   unpacked_node::newFromNode(mxdF, events[k].getNode(), true)
-    ;
-
-    unpacked_node* Mp = unpacked_node::useUnpackedNode();
+    // Read "rows", and collect the diagonal
+    const int size = mxdF->getLevelSize(k);
+    dd_edge* diag = new dd_edge[size];
+    collectDiagonal(mxdF, k, events[k].getNode(), diag, size);
 
-    // Read "rows"
-    for (unsigned i = 0; i < Mu->getSize(); i++) {
-      // Initialize column reader
-      if (isLevelAbove(-k, mxdF->getNodeLevel(Mu->d(i)))) {
-        Mp->initIdentity(mxdF, -k, i, Mu->d(i), true);
-      } else {
-        Mp->initFromNode(mxdF, Mu->d(i), true);
-      }
-
-      // Intersect along the diagonal
-      if (0==i) {
-        maxDiag.set( mxdF->linkNode(Mp->d(i)) );
-      } else {
-        dd_edge mpd(mxdF);
-        mpd.set( mxdF->linkNode(Mp->d(i)) );
-        mxdIntersection->compute(maxDiag, mpd, maxDiag);
-      }
-    } // for i
-
-    // Cleanup
-    unpacked_node::recycle(Mp);
-    unpacked_node::recycle(Mu);
+    // Intersect along the diagonal
+    reduceBalanced(mxdIntersection, diag, unsigned(size), maxDiag);
+    delete[] diag;
 
     if (0 == maxDiag.getNode()) {
 #ifdef DEBUG_FINALIZE_SPLIT
@@ -324,11 +449,11 @@ MEDDLY::satpregen_opname::pregen_relation
   MEDDLY_DCASSERT(mxdUnion);
 
   dd_edge u(mxdF);
+  reduceBalanced(mxdUnion, events+1, K, u);
   for (unsigned k=1; k<=K; k++) {
-    u += events[k];
     events[k].set(0);
   }
-  events[u.getLevel()] = u;
+  events[ABS(u.getLevel())] = u;
 }
 
 
@@ -481,15 +606,19 @@ const MEDDLY::saturation_by_events_opname* MEDDLY::saturation_by_events_opname::
 
 class MEDDLY::saturation_by_events_op : public unary_operation {
     common_dfs_by_events_mt* parent;
+    sat_checkpoint* ckpt;
   public:
     saturation_by_events_op(common_dfs_by_events_mt* p,
       expert_forest* argF, expert_forest* resF);
     virtual ~saturation_by_events_op();
 
+    inline void useCheckpoint(sat_checkpoint* c) { ckpt = c; }
+
     void saturate(const dd_edge& in, dd_edge& out);
     node_handle saturate(node_handle mdd, int level);
 
-  protected:
+    // Compute table access; public for the frame-driven version
+    // in common_dfs_by_events_mt::saturate_s().
     inline compute_table::entry_key* 
     findSaturateResult(node_handle a, int level, node_handle& b) {
       compute_table::entry_key* CTsrch = CT0->useEntryKey(etype[0], 0);
@@ -510,6 +639,9 @@ class MEDDLY::saturation_by_events_op : public unary_operation {
       CT0->addEntry(Key, CTresult[0]);
       return b;
     }
+    inline void discardSaturateKey(compute_table::entry_key* Key) {
+      CT0->recycle(Key);
+    }
 };
 
 
@@ -526,7 +658,23 @@ class MEDDLY::common_dfs_by_events_mt : public specialized_operation {
     virtual ~common_dfs_by_events_mt();
 
     virtual void compute(const dd_edge& a, dd_edge &c);
-    virtual void saturateHelper(unpacked_node& mdd) = 0;
+    virtual void enableCheckpoints(const char* filename, long seconds);
+    virtual void resume(const char* filename, dd_edge &c);
+    /**
+        Fire the events of nb's level until nb is saturated;
+        for the recursive saturation_by_events_op::saturate().
+        Directions that provide saturate_s() never need it.
+    */
+    virtual void saturateHelper(unpacked_node& mdd);
+
+    /**
+        saturation_by_events_op::saturate(mdd, k), driven by a stack
+        of frames instead of native recursion.
+        Returns false if there is no such version for this direction,
+        and the recursive one must be used.
+    */
+    virtual bool saturate_s(saturation_by_events_op* so, node_handle mdd,
+      int k, node_handle &result);
 
   protected:
     inline compute_table::entry_key* 
@@ -562,6 +710,9 @@ class MEDDLY::common_dfs_by_events_mt : public specialized_operation {
     expert_forest* arg2F;
     expert_forest* resF;
 
+    // If not null, where and when to write checkpoints
+    sat_checkpoint* ckpt;
+
   protected:
     class indexq {
         static const int NULPTR = -1;
@@ -677,6 +828,7 @@ MEDDLY::saturation_by_events_op
   : unary_operation(saturation_by_events_opname::getInstance(), 1, argF, resF)
 {
   parent = p;
+  ckpt = 0;
 
   const char* name = saturation_by_events_opname::getInstance()->getName();
   compute_table::entry_type* et;
@@ -702,6 +854,11 @@ MEDDLY::saturation_by_events_op::~saturation_by_events_op()
 
 void MEDDLY::saturation_by_events_op::saturate(const dd_edge& in, dd_edge& out)
 {
+  node_handle n;
+  if (parent->saturate_s(this, in.getNode(), argF->getNumVariables(), n)) {
+    out.set(n);
+    return;
+  }
   out.set( saturate(in.getNode(), argF->getNumVariables()) );
 }
 
@@ -737,15 +894,21 @@ MEDDLY::saturation_by_events_op::saturate(node_handle mdd, int k)
     mddDptrs->initFromNode(argF, mdd, true);
   }
 
+  const bool tracked = ckpt && ckpt->enter(k, nb, mddDptrs);
+
   // Do computation
   for (unsigned i=0; i<sz; i++) {
     nb->d_ref(i) = mddDptrs->d(i) ? saturate(mddDptrs->d(i), k-1) : 0;
+    if (tracked) ckpt->advance(k, i+1);
+    if (ckpt) ckpt->poll();
   }
+  if (tracked) ckpt->fire(k);
 
   // Cleanup
   unpacked_node::recycle(mddDptrs);
 
   parent->saturateHelper(*nb);
+  if (tracked) ckpt->leave(k);
   n = resF->createReducedNode(-1, nb);
 
   // save in compute table
@@ -775,6 +938,7 @@ MEDDLY::common_dfs_by_events_mt::common_dfs_by_events_mt(
   mxdDifference = 0;
   freeqs = 0;
   freebufs = 0;
+  ckpt = 0;
   rel = relation;
   arg1F = static_cast<expert_forest*>(rel->getInForest());
   arg2F = static_cast<expert_forest*>(rel->getRelForest());
@@ -794,6 +958,7 @@ MEDDLY::common_dfs_by_events_mt::common_dfs_by_events_mt(
 
 MEDDLY::common_dfs_by_events_mt::~common_dfs_by_events_mt()
 {
+  delete ckpt;
   if (rel->autoDestroy()) delete rel;
   unregisterInForest(arg1F);
   unregisterInForest(arg2F);
@@ -830,6 +995,7 @@ void MEDDLY::common_dfs_by_events_mt
     printf("done.\n");
   }
   saturation_by_events_op* so = new saturation_by_events_op(this, arg1F, resF);
+  so->useCheckpoint(ckpt);
   so->saturate(a, c);
 
   // Cleanup
@@ -846,6 +1012,33 @@ void MEDDLY::common_dfs_by_events_mt
   delete so;
 }
 
+void MEDDLY::common_dfs_by_events_mt::saturateHelper(unpacked_node&)
+{
+  throw error(error::NOT_IMPLEMENTED, __FILE__, __LINE__);
+}
+
+bool MEDDLY::common_dfs_by_events_mt::saturate_s(saturation_by_events_op*,
+  node_handle, int, node_handle &)
+{
+  return false;
+}
+
+void MEDDLY::common_dfs_by_events_mt
+::enableCheckpoints(const char* filename, long seconds)
+{
+  delete ckpt;
+  ckpt = filename ? new sat_checkpoint(resF, filename, seconds) : 0;
+}
+
+void MEDDLY::common_dfs_by_events_mt
+::resume(const char* filename, dd_edge &c)
+{
+  sat_checkpoint reader(resF, filename, 0);
+  dd_edge a(resF);
+  reader.read(filename, a);
+  compute(a, c);
+}
+
 // ******************************************************************
 // *       common_dfs_by_events_mt::indexq  methods                 *
 // ******************************************************************
@@ -905,9 +1098,87 @@ class MEDDLY::forwd_dfs_by_events_mt : public common_dfs_by_events_mt {
   public:
     forwd_dfs_by_events_mt(const satpregen_opname* opcode,
     satpregen_opname::pregen_relation* rel);
+
+  // ------------------------------------------------------------
+  // saturate(), recFire() and saturateHelper(), driven by frames.
+  public:
+    virtual bool saturate_s(saturation_by_events_op* so, node_handle mdd,
+      int k, node_handle &result);
+
   protected:
-    virtual void saturateHelper(unpacked_node& mdd);
-    node_handle recFire(node_handle mdd, node_handle mxd);
+    /// One saturate() or recFire() call.
+    struct frame {
+      /// recFire() if set, otherwise saturate().
+      bool fire;
+      /// Set once the children are done and saturateHelper() started.
+      bool helping;
+      node_handle mdd;
+      /// recFire() only.
+      node_handle mxd;
+      /// saturate() only.
+      int k;
+      compute_table::entry_key* key;
+      /// Node being built.
+      unpacked_node* nb;
+      /// mdd reader.
+      unpacked_node* A;
+      /// recFire(): mxd readers; Ru is null for skipped mxd levels.
+      unpacked_node* Ru;
+      unpacked_node* Rp;
+      /// Next child, or next row of Ru.
+      unsigned i;
+      /// Current row, its next column and number of columns in Rp.
+      unsigned row;
+      unsigned jz;
+      unsigned ncols;
+      /// Index of nb that receives the pending child result.
+      unsigned j;
+      /// saturate() only: is nb tracked by the checkpoint?
+      bool tracked;
+
+      // saturateHelper() state
+
+      unsigned nEvents;
+      unpacked_node** Hu;
+      unpacked_node* Hp;
+      indexq* queue;
+      /// Index being explored, next event for it, next column of Hp
+      /// and number of columns in Hp.
+      unsigned hi;
+      unsigned ei;
+      unsigned hjz;
+      unsigned hcols;
+    };
+
+  public:
+    /// Release what a frame holds, after an exception.
+    void discardFrame(frame &F);
+
+  protected:
+    /// Result of saturate(mdd, k) in r if known; otherwise push a frame.
+    bool callSaturate(node_handle mdd, int k, node_handle &r);
+    /// Result of recFire(mdd, mxd) in r if known; otherwise push a frame.
+    bool callFire(node_handle mdd, node_handle mxd, node_handle &r);
+
+    /// Work on frame F until it needs a child (returns true, and
+    /// F is no longer valid) or its node is complete.
+    bool advanceSaturate(frame &F);
+    bool advanceFire(frame &F);
+    bool advanceHelper(frame &F);
+
+    void startHelper(frame &F);
+    /// Give result r of the pending child to the top frame.
+    void deliver(node_handle r);
+    /// Add states r to nb[j], in the recFire() loop.
+    void addStates(unpacked_node* nb, unsigned j, node_handle r);
+    /// Add states r to nb[j], in the saturateHelper() loop.
+    void helperUpdate(frame &F, unsigned j, node_handle r);
+    /// Child F.j of a saturate() frame is done; checkpoint safe point.
+    void saturated(frame &F);
+
+  private:
+    frame_stack<frame> stack;
+    saturation_by_events_op* satop;
 };
 
 MEDDLY::forwd_dfs_by_events_mt::forwd_dfs_by_events_mt(
@@ -915,219 +1186,417 @@ MEDDLY::forwd_dfs_by_events_mt::forwd_dfs_by_events_mt(
   satpregen_opname::pregen_relation* rel)
   : common_dfs_by_events_mt(opcode, rel)
 {
+  satop = 0;
 }
 
 
-void MEDDLY::forwd_dfs_by_events_mt::saturateHelper(unpacked_node& nb)
-{
-  unsigned nEventsAtThisLevel = rel->lengthForLevel(nb.getLevel());
-  if (0 == nEventsAtThisLevel) return;
-
-  // Initialize mxd readers, note we might skip the unprimed level
-  dd_edge* events = rel->arrayForLevel(nb.getLevel());
-  unpacked_node** Ru = new unpacked_node*[nEventsAtThisLevel];
-  for (unsigned ei = 0; ei < nEventsAtThisLevel; ei++) {
-    Ru[ei] = unpacked_node::useUnpackedNode();
-    int eventLevel = events[ei].getLevel();
-    MEDDLY_DCASSERT(ABS(eventLevel) == nb.getLevel());
-    if (eventLevel<0) {
-      Ru[ei]->initRedundant(arg2F, nb.getLevel(), events[ei].getNode(), true);
-    } else {
-      Ru[ei]->initFromNode(arg2F, events[ei].getNode(), true);
-    }
-  }
-  unpacked_node* Rp = unpacked_node::useUnpackedNode();
-
-  dd_edge nbdj(resF), newst(resF);
-
-  // indexes to explore
-  indexq* queue = useIndexQueue(nb.getSize());
-  for (unsigned i = 0; i < nb.getSize(); i++) {
-    if (nb.d(i)) queue->add(i);
-  }
-
-  // explore indexes
-  while (!queue->isEmpty()) {
-    unsigned i = queue->remove();
-
-    MEDDLY_DCASSERT(nb.d(i));
-
-    for (int ei = 0; ei < nEventsAtThisLevel; ei++) {
-      if (0 == Ru[ei]->d(i)) continue;  // row i of the event ei is empty
+// ******************************************************************
+// *       forwd_dfs_by_events_mt explicit-stack methods            *
+// ******************************************************************
 
-      // grab column (TBD: build these ahead of time?)
-      int dlevel = arg2F->getNodeLevel(Ru[ei]->d(i));
+/*
+    Forward saturation is written once, driven by a stack of frames:
+    every call to saturate() (as in saturation_by_events_op), recFire()
+    or the firing loop of saturateHelper() that would recurse pushes a
+    frame instead, and the result is given to the frame below when the
+    frame is popped.  It is used with or without setExplicitStack(),
+    and reports its saturate() frames to the checkpoint, if any.
+    The frame array is kept between calls.
+*/
 
-      if (dlevel == -nb.getLevel()) {
-        Rp->initFromNode(arg2F, Ru[ei]->d(i), false);
+bool MEDDLY::forwd_dfs_by_events_mt::saturate_s(saturation_by_events_op* so,
+  node_handle mdd, int k, node_handle &result)
+{
+  satop = so;
+  const unsigned base = stack.getDepth();
+  try {
+    if (callSaturate(mdd, k, result)) return true;
+    for (;;) {
+      frame& F = stack.top();
+      if (F.fire ? advanceFire(F) : advanceSaturate(F)) continue;
+
+      // node is complete
+      if (F.tracked) ckpt->leave(F.k);
+      F.tracked = false;
+      unpacked_node* nb = F.nb;
+      F.nb = 0;
+      result = resF->createReducedNode(-1, nb);
+      if (F.fire) {
+        saveResult(F.key, F.mdd, F.mxd, result);
       } else {
-        Rp->initIdentity(arg2F, -nb.getLevel(), i, Ru[ei]->d(i), false);
+        satop->saveSaturateResult(F.key, F.mdd, result);
       }
+      F.key = 0;
+      stack.pop();
+      if (stack.getDepth() == base) return true;
+      deliver(result);
+    }
+  }
+  catch (...) {
+    stack.popTo(base, this);
+    throw;
+  }
+}
 
-      for (unsigned jz=0; jz<Rp->getNNZs(); jz++) {
-        unsigned j = Rp->i(jz);
-        if (-1==nb.d(j)) continue;  // nothing can be added to this set
-
-        node_handle rec = recFire(nb.d(i), Rp->d(jz));
-
-        if (rec == 0) continue;
-        if (rec == nb.d(j)) { 
-          resF->unlinkNode(rec); 
-          continue; 
-        }
-
-        bool updated = true;
-
-        if (0 == nb.d(j)) {
-          nb.d_ref(j) = rec;
-        }
-        else if (rec == -1) {
-          resF->unlinkNode(nb.d(j));
-          nb.d_ref(j) = -1;
-        }
-        else {
-          nbdj.set(nb.d(j));  // clobber
-          newst.set(rec);     // clobber
-          mddUnion->compute(nbdj, newst, nbdj);
-          updated = (nbdj.getNode() != nb.d(j));
-          nb.set_d(j, nbdj);
-        }
-
-        if (updated) queue->add(j);
-      } // for j
-    } // for all events, ei
-  } // while there are indexes to explore
+bool MEDDLY::forwd_dfs_by_events_mt::callSaturate(node_handle mdd, int k,
+  node_handle &r)
+{
+  if (arg1F->isTerminalNode(mdd)) {
+    r = mdd;
+    return true;
+  }
+  compute_table::entry_key* Key = satop->findSaturateResult(mdd, k, r);
+  if (0==Key) return true;
 
-  // cleanup
-  unpacked_node::recycle(Rp);
-  for (int ei = 0; ei < nEventsAtThisLevel; ei++) unpacked_node::recycle(Ru[ei]);
-  delete[] Ru;
-  recycle(queue);
+  frame* Fp;
+  try {
+    Fp = &stack.push();
+  }
+  catch (...) {
+    satop->discardSaturateKey(Key);
+    throw;
+  }
+  frame& F = *Fp;
+  F.fire = false;
+  F.helping = false;
+  F.mdd = mdd;
+  F.mxd = 0;
+  F.k = k;
+  F.key = Key;
+  F.nb = F.A = F.Ru = F.Rp = F.Hp = 0;
+  F.Hu = 0;
+  F.queue = 0;
+  F.nEvents = 0;
+  F.i = 0;
+
+  F.tracked = false;
+
+  F.nb = unpacked_node::newFull(resF, k, unsigned(arg1F->getLevelSize(k)));
+  F.A = unpacked_node::useUnpackedNode();
+  if (arg1F->getNodeLevel(mdd) < k) {
+    F.A->initRedundant(arg1F, k, mdd, true);
+  } else {
+    F.A->initFromNode(arg1F, mdd, true);
+  }
+  F.tracked = ckpt && ckpt->enter(k, F.nb, F.A);
+  return false;
 }
 
-
-// Same as post-image, except we saturate before reducing.
-MEDDLY::node_handle MEDDLY::forwd_dfs_by_events_mt::recFire(
-  node_handle mdd, node_handle mxd)
+bool MEDDLY::forwd_dfs_by_events_mt::callFire(node_handle mdd, node_handle mxd,
+  node_handle &r)
 {
   // termination conditions
-  if (mxd == 0 || mdd == 0) return 0;
+  r = 0;
+  if (mxd == 0 || mdd == 0) return true;
   if (arg2F->isTerminalNode(mxd)) {
     if (arg1F->isTerminalNode(mdd)) {
-      return resF->handleForValue(1);
+      r = resF->handleForValue(1);
+      return true;
     }
     // mxd is identity
-    if (arg1F == resF)
-      return resF->linkNode(mdd);
+    if (arg1F == resF) {
+      r = resF->linkNode(mdd);
+      return true;
+    }
   }
 
   // check the cache
-  node_handle result = 0;
-  compute_table::entry_key* Key = findResult(mdd, mxd, result);
-  if (0==Key) return result;
+  compute_table::entry_key* Key = findResult(mdd, mxd, r);
+  if (0==Key) return true;
 
-#ifdef TRACE_RECFIRE
-  printf("computing recFire(%d, %d)\n", mdd, mxd);
-  printf("  node %3d ", mdd);
-  arg1F->showNode(stdout, mdd, 1);
-  printf("\n  node %3d ", mxd);
-  arg2F->showNode(stdout, mxd, 1);
-  printf("\n");
-#endif
+  frame* Fp;
+  try {
+    Fp = &stack.push();
+  }
+  catch (...) {
+    CT0->recycle(Key);
+    throw;
+  }
+  frame& F = *Fp;
+  F.fire = true;
+  F.helping = false;
+  F.mdd = mdd;
+  F.mxd = mxd;
+  F.k = 0;
+  F.key = Key;
+  F.nb = F.A = F.Ru = F.Rp = F.Hp = 0;
+  F.Hu = 0;
+  F.queue = 0;
+  F.nEvents = 0;
+  F.i = 0;
+  F.jz = F.ncols = 0;
+  F.tracked = false;
 
-  // check if mxd and mdd are at the same level
   const int mddLevel = arg1F->getNodeLevel(mdd);
   const int mxdLevel = arg2F->getNodeLevel(mxd);
   const int rLevel = MAX(ABS(mxdLevel), mddLevel);
-  const unsigned rSize = unsigned(resF->getLevelSize(rLevel));
-  unpacked_node* nb = unpacked_node::newFull(resF, rLevel, rSize);
-
-  dd_edge nbdj(resF), newst(resF);
+  F.nb = unpacked_node::newFull(resF, rLevel, unsigned(resF->getLevelSize(rLevel)));
 
-  // Initialize mdd reader
-  unpacked_node *A = unpacked_node::useUnpackedNode();
+  F.A = unpacked_node::useUnpackedNode();
   if (mddLevel < rLevel) {
-    A->initRedundant(arg1F, rLevel, mdd, true);
+    F.A->initRedundant(arg1F, rLevel, mdd, true);
   } else {
-    A->initFromNode(arg1F, mdd, true);
+    F.A->initFromNode(arg1F, mdd, true);
   }
 
-  if (mddLevel > ABS(mxdLevel)) {
-    //
-    // Skipped levels in the MXD,
-    // that's an important special case that we can handle quickly.
+  if (mddLevel <= ABS(mxdLevel)) {
+    // Need to process this level in the MXD.
+    F.Ru = unpacked_node::useUnpackedNode();
+    F.Rp = unpacked_node::useUnpackedNode();
+    if (mxdLevel < 0) {
+      F.Ru->initRedundant(arg2F, rLevel, mxd, false);
+    } else {
+      F.Ru->initFromNode(arg2F, mxd, false);
+    }
+  }
+  return false;
+}
 
-    for (unsigned i=0; i<rSize; i++) {
-      nb->d_ref(i) = recFire(A->d(i), mxd);
+bool MEDDLY::forwd_dfs_by_events_mt::advanceSaturate(frame &F)
+{
+  if (!F.helping) {
+    while (F.i < F.nb->getSize()) {
+      const unsigned i = F.i++;
+      F.j = i;
+      if (F.A->d(i)) {
+        node_handle r;
+        if (!callSaturate(F.A->d(i), F.k-1, r)) return true;
+        F.nb->d_ref(i) = r;
+      }
+      saturated(F);
     }
+    if (F.tracked) ckpt->fire(F.k);
+    unpacked_node::recycle(F.A);
+    F.A = 0;
+    startHelper(F);
+  }
+  return advanceHelper(F);
+}
 
-  } else {
-    // 
-    // Need to process this level in the MXD.
-    MEDDLY_DCASSERT(ABS(mxdLevel) >= mddLevel);
+bool MEDDLY::forwd_dfs_by_events_mt::advanceFire(frame &F)
+{
+  if (!F.helping) {
+    node_handle r;
+    if (0==F.Ru) {
+      // Skipped levels in the MXD
+      while (F.i < F.nb->getSize()) {
+        const unsigned i = F.i++;
+        F.j = i;
+        if (!callFire(F.A->d(i), F.mxd, r)) return true;
+        F.nb->d_ref(i) = r;
+      }
+    } else {
+      for (;;) {
+        // loop over mxd "columns"
+        if (F.jz < F.ncols) {
+          const unsigned jz = F.jz++;
+          F.j = F.Rp->i(jz);
+          if (!callFire(F.A->d(F.row), F.Rp->d(jz), r)) return true;
+          addStates(F.nb, F.j, r);
+          continue;
+        }
+        // loop over mxd "rows"
+        if (F.i >= F.Ru->getNNZs()) break;
+        const unsigned iz = F.i++;
+        const unsigned i = F.Ru->i(iz);
+        if (0==F.A->d(i)) continue;
+        if (isLevelAbove(-F.nb->getLevel(), arg2F->getNodeLevel(F.Ru->d(iz)))) {
+          F.Rp->initIdentity(arg2F, F.nb->getLevel(), i, F.Ru->d(iz), false);
+        } else {
+          F.Rp->initFromNode(arg2F, F.Ru->d(iz), false);
+        }
+        F.row = i;
+        F.jz = 0;
+        F.ncols = F.Rp->getNNZs();
+      }
+      unpacked_node::recycle(F.Rp);
+      unpacked_node::recycle(F.Ru);
+      F.Rp = F.Ru = 0;
+    }
+    unpacked_node::recycle(F.A);
+    F.A = 0;
+    startHelper(F);
+  }
+  return advanceHelper(F);
+}
 
-    // Initialize mxd readers, note we might skip the unprimed level
-    unpacked_node *Ru = unpacked_node::useUnpackedNode();
-    unpacked_node *Rp = unpacked_node::useUnpackedNode();
-    if (mxdLevel < 0) {
-      Ru->initRedundant(arg2F, rLevel, mxd, false);
+void MEDDLY::forwd_dfs_by_events_mt::startHelper(frame &F)
+{
+  F.helping = true;
+  const int level = F.nb->getLevel();
+  F.nEvents = rel->lengthForLevel(level);
+  if (0 == F.nEvents) return;
+
+  // Initialize mxd readers, note we might skip the unprimed level
+  dd_edge* events = rel->arrayForLevel(level);
+  F.Hu = new unpacked_node*[F.nEvents];
+  for (unsigned ei = 0; ei < F.nEvents; ei++) F.Hu[ei] = 0;
+  for (unsigned ei = 0; ei < F.nEvents; ei++) {
+    F.Hu[ei] = unpacked_node::useUnpackedNode();
+    if (events[ei].getLevel() < 0) {
+      F.Hu[ei]->initRedundant(arg2F, level, events[ei].getNode(), true);
     } else {
-      Ru->initFromNode(arg2F, mxd, false);
+      F.Hu[ei]->initFromNode(arg2F, events[ei].getNode(), true);
     }
+  }
+  F.Hp = unpacked_node::useUnpackedNode();
 
-    // loop over mxd "rows"
-    for (unsigned iz=0; iz<Ru->getNNZs(); iz++) {
-      unsigned i = Ru->i(iz);
-      if (0==A->d(i))   continue; 
-      if (isLevelAbove(-rLevel, arg2F->getNodeLevel(Ru->d(iz)))) {
-        Rp->initIdentity(arg2F, rLevel, i, Ru->d(iz), false);
+  // indexes to explore
+  F.queue = useIndexQueue(F.nb->getSize());
+  for (unsigned i = 0; i < F.nb->getSize(); i++) {
+    if (F.nb->d(i)) F.queue->add(i);
+  }
+  F.ei = F.nEvents;
+  F.hjz = F.hcols = 0;
+}
+
+bool MEDDLY::forwd_dfs_by_events_mt::advanceHelper(frame &F)
+{
+  if (0 == F.nEvents) return false;
+  unpacked_node* nb = F.nb;
+  const int level = nb->getLevel();
+
+  for (;;) {
+    if (F.hjz < F.hcols) {
+      const unsigned jz = F.hjz++;
+      const unsigned j = F.Hp->i(jz);
+      if (-1==nb->d(j)) continue;  // nothing can be added to this set
+      node_handle rec;
+      F.j = j;
+      if (!callFire(nb->d(F.hi), F.Hp->d(jz), rec)) return true;
+      helperUpdate(F, j, rec);
+      continue;
+    }
+    if (F.ei < F.nEvents) {
+      const unsigned ei = F.ei++;
+      const node_handle row = F.Hu[ei]->d(F.hi);
+      if (0 == row) continue;  // row i of the event ei is empty
+      if (arg2F->getNodeLevel(row) == -level) {
+        F.Hp->initFromNode(arg2F, row, false);
       } else {
-        Rp->initFromNode(arg2F, Ru->d(iz), false);
+        F.Hp->initIdentity(arg2F, -level, F.hi, row, false);
       }
+      F.hjz = 0;
+      F.hcols = F.Hp->getNNZs();
+      continue;
+    }
+    if (F.queue->isEmpty()) break;
+    if (ckpt) ckpt->poll();
+    F.hi = F.queue->remove();
+    MEDDLY_DCASSERT(nb->d(F.hi));
+    F.ei = 0;
+    F.hjz = F.hcols = 0;
+  }
 
-      // loop over mxd "columns"
-      for (unsigned jz=0; jz<Rp->getNNZs(); jz++) {
-        unsigned j = Rp->i(jz);
-        // ok, there is an i->j "edge".
-        // determine new states to be added (recursively)
-        // and add them
-        node_handle newstates = recFire(A->d(i), Rp->d(jz));
-        if (0==newstates) continue;
-        if (0==nb->d(j)) {
-          nb->d_ref(j) = newstates;
-          continue;
-        }
-        // there's new states and existing states; union them.
-        nbdj.set(nb->d(j));
-        newst.set(newstates);
-        mddUnion->compute(nbdj, newst, nbdj);
-        nb->set_d(j, nbdj);
-      } // for j
-  
-    } // for i
+  // cleanup
+  unpacked_node::recycle(F.Hp);
+  for (unsigned ei = 0; ei < F.nEvents; ei++) unpacked_node::recycle(F.Hu[ei]);
+  delete[] F.Hu;
+  recycle(F.queue);
+  F.Hp = 0;
+  F.Hu = 0;
+  F.queue = 0;
+  F.nEvents = 0;
+  return false;
+}
 
-    unpacked_node::recycle(Rp);
-    unpacked_node::recycle(Ru);
-  } // else
+void MEDDLY::forwd_dfs_by_events_mt::deliver(node_handle r)
+{
+  frame& P = stack.top();
+  if (P.helping) {
+    helperUpdate(P, P.j, r);
+  } else if (P.fire && P.Ru) {
+    addStates(P.nb, P.j, r);
+  } else {
+    P.nb->d_ref(P.j) = r;
+    if (!P.fire) saturated(P);
+  }
+}
 
-  // cleanup mdd reader
-  unpacked_node::recycle(A);
+void MEDDLY::forwd_dfs_by_events_mt::saturated(frame &F)
+{
+  if (F.tracked) ckpt->advance(F.k, F.j+1);
+  if (ckpt) ckpt->poll();
+}
 
-  saturateHelper(*nb);
-  result = resF->createReducedNode(-1, nb);
-#ifdef TRACE_ALL_OPS
-  printf("computed recfire(%d, %d) = %d\n", mdd, mxd, result);
-#endif
-#ifdef TRACE_RECFIRE
-  printf("computed recfire(%d, %d) = %d\n", mdd, mxd, result);
-  printf("  node %3d ", result);
-  resF->showNode(stdout, result, 1);
-  printf("\n");
-#endif
-  return saveResult(Key, mdd, mxd, result); 
+void MEDDLY::forwd_dfs_by_events_mt::addStates(unpacked_node* nb, unsigned j,
+  node_handle r)
+{
+  if (0==r) return;
+  if (0==nb->d(j)) {
+    nb->d_ref(j) = r;
+    return;
+  }
+  // there's new states and existing states; union them.
+  dd_edge nbdj(resF), newst(resF);
+  nbdj.set(nb->d(j));
+  newst.set(r);
+  mddUnion->compute(nbdj, newst, nbdj);
+  nb->set_d(j, nbdj);
 }
 
+void MEDDLY::forwd_dfs_by_events_mt::helperUpdate(frame &F, unsigned j,
+  node_handle rec)
+{
+  unpacked_node* nb = F.nb;
+  if (rec == 0) return;
+  if (rec == nb->d(j)) {
+    resF->unlinkNode(rec);
+    return;
+  }
+
+  bool updated = true;
 
+  if (0 == nb->d(j)) {
+    nb->d_ref(j) = rec;
+  }
+  else if (rec == -1) {
+    resF->unlinkNode(nb->d(j));
+    nb->d_ref(j) = -1;
+  }
+  else {
+    dd_edge nbdj(resF), newst(resF);
+    nbdj.set(nb->d(j));
+    newst.set(rec);
+    mddUnion->compute(nbdj, newst, nbdj);
+    updated = (nbdj.getNode() != nb->d(j));
+    nb->set_d(j, nbdj);
+  }
+
+  if (updated) F.queue->add(j);
+}
+
+void MEDDLY::forwd_dfs_by_events_mt::discardFrame(frame &F)
+{
+  if (F.tracked) ckpt->leave(F.k);
+  if (F.A) unpacked_node::recycle(F.A);
+  if (F.Ru) unpacked_node::recycle(F.Ru);
+  if (F.Rp) unpacked_node::recycle(F.Rp);
+  if (F.Hp) unpacked_node::recycle(F.Hp);
+  if (F.Hu) {
+    for (unsigned ei = 0; ei < F.nEvents; ei++) {
+      if (F.Hu[ei]) unpacked_node::recycle(F.Hu[ei]);
+    }
+    delete[] F.Hu;
+  }
+  if (F.queue) {
+    while (!F.queue->isEmpty()) F.queue->remove();
+    recycle(F.queue);
+  }
+  if (F.nb) {
+    for (unsigned i=0; i<F.nb->getSize(); i++) {
+      resF->unlinkNode(F.nb->d(i));
+    }
+    unpacked_node::recycle(F.nb);
+  }
+  if (F.key) {
+    if (F.fire) {
+      CT0->recycle(F.key);
+    } else {
+      satop->discardSaturateKey(F.key);
+    }
+  }
+}
 
 
 // ******************************************************************
@@ -1181,6 +1650,7 @@ void MEDDLY::bckwd_dfs_by_events_mt::saturateHelper(unpacked_node& nb)
 
   // explore 
   while (repeat) {
+    if (ckpt) ckpt->poll();
     // "advance" the explore list
     for (unsigned i=0; i<nb.getSize(); i++) if (expl->data[i]) expl->data[i]--;
     repeat = false;
@@ -0,0 +1,512 @@
+
+/*
+    Meddly: Multi-terminal and Edge-valued Decision Diagram LibrarY.
+    Copyright (C) 2009, Iowa State University Research Foundation, Inc.
+
+    This library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../defines.h"
+#include "trace.h"
+
+#include <unordered_map>
+
+namespace MEDDLY {
+  class shortest_trace_op;
+  class strace_opname;
+};
+
+// ******************************************************************
+// *                                                                *
+// *                      trace_opname methods                      *
+// *                                                                *
+// ******************************************************************
+
+MEDDLY::trace_opname::trace_opname(const char* n)
+ : specialized_opname(n)
+{
+}
+
+MEDDLY::trace_opname::~trace_opname()
+{
+}
+
+MEDDLY::trace_opname::trace_args
+::trace_args(const dd_edge &d, const dd_edge* e, unsigned n)
+ : dist(d)
+{
+  forest* distF = dist.getForest();
+  if (0==distF || 0==e || 0==n) throw error(error::MISCELLANEOUS, __FILE__, __LINE__);
+
+  if (
+    distF->isForRelations() ||
+    (distF->getRangeType() != forest::INTEGER) ||
+    (distF->getEdgeLabeling() != forest::EVPLUS)
+  )
+    throw error(error::TYPE_MISMATCH, __FILE__, __LINE__);
+
+  for (unsigned i=0; i<n; i++) {
+    forest* ef = e[i].getForest();
+    if (0==ef) throw error(error::MISCELLANEOUS, __FILE__, __LINE__);
+    if (ef->getDomain() != distF->getDomain())
+      throw error(error::DOMAIN_MISMATCH, __FILE__, __LINE__);
+    if (
+      !ef->isForRelations() ||
+      (ef->getRangeType() != forest::BOOLEAN) ||
+      (ef->getEdgeLabeling() != forest::MULTI_TERMINAL)
+    )
+      throw error(error::TYPE_MISMATCH, __FILE__, __LINE__);
+    if (ef->isQuasiReduced())
+      throw error(error::NOT_IMPLEMENTED, __FILE__, __LINE__);
+  }
+
+  events = new dd_edge[n];
+  for (unsigned i=0; i<n; i++) events[i] = e[i];
+  num_events = n;
+}
+
+MEDDLY::trace_opname::trace_args::~trace_args()
+{
+  delete[] events;
+}
+
+MEDDLY::trace_opname::trace::trace()
+{
+  num_states = 0;
+  num_vars = 0;
+}
+
+void MEDDLY::trace_opname::trace::clear()
+{
+  states.clear();
+  events.clear();
+  num_states = 0;
+}
+
+void MEDDLY::trace_opname::trace::start(const int* state, int nv)
+{
+  clear();
+  num_vars = nv;
+  states.assign(state, state+nv+1);
+  num_states = 1;
+}
+
+void MEDDLY::trace_opname::trace::addPredecessor(const int* state,
+  unsigned event)
+{
+  MEDDLY_DCASSERT(num_states);
+  states.insert(states.end(), state, state+num_vars+1);
+  events.push_back(event);
+  num_states++;
+}
+
+// ******************************************************************
+// *                                                                *
+// *                    shortest_trace_op  class                    *
+// *                                                                *
+// ******************************************************************
+
+/** Shortest trace to a target set.
+
+    First, the target state with the smallest distance is found,
+    by a search over pairs of (distance, target) nodes.
+    Then, for each step back, every event is searched for a
+    predecessor of the current state with the smallest distance,
+    over pairs of (distance, event) nodes.  The column of the
+    event is fixed by the current state at every level, so the
+    search never builds a pre-image.
+
+    Both searches are memoized in a scratch table owned by the
+    operation, not in the compute table: the predecessor search
+    depends on the current state, so its results are dead as soon
+    as the step ends, and the table is cleared then.  Likewise the
+    target results are cleared once the target state is picked.
+*/
+class MEDDLY::shortest_trace_op : public specialized_operation {
+  public:
+    shortest_trace_op(const trace_opname* code, trace_opname::trace_args* a);
+
+    virtual bool checkForestCompatibility() const;
+
+    virtual void compute(const dd_edge &target, trace_opname::trace &res);
+
+  protected:
+    virtual ~shortest_trace_op();
+
+    /// Key of the scratch table: distance node d, and node x of forest f.
+    struct memo_key {
+      const expert_forest* f;
+      node_handle d;
+      node_handle x;
+      inline bool operator==(const memo_key &k) const {
+        return f == k.f && d == k.d && x == k.x;
+      }
+    };
+    struct memo_hash {
+      inline size_t operator()(const memo_key &k) const {
+        return (size_t(k.d) * 2654435761u) ^ size_t(k.x)
+          ^ (size_t(k.f) >> 4);
+      }
+    };
+
+    inline bool findResult(const expert_forest* f, node_handle d,
+      node_handle x, long &m) const
+    {
+      const memo_key k = { f, d, x };
+      auto it = memo.find(k);
+      if (memo.end() == it) return false;
+      m = it->second;
+      return true;
+    }
+    inline long saveResult(const expert_forest* f, node_handle d,
+      node_handle x, long m)
+    {
+      const memo_key k = { f, d, x };
+      memo[k] = m;
+      return m;
+    }
+
+    /// Smallest distance (below node d) of a state in target node t.
+    long minInTarget(node_handle d, node_handle t);
+
+    /// Smallest distance (below node d) of a state that event node r
+    /// takes to the current state.
+    long minPredecessor(node_handle d, node_handle r);
+
+    /// Set curr to a state that gives minInTarget(d, t).
+    void pickTarget(node_handle d, node_handle t);
+
+    /// Set pred to a state that gives minPredecessor(d, r).
+    void pickPredecessor(node_handle d, node_handle r);
+
+    /// Distance reader at level k, for a node at level k or below.
+    inline unpacked_node* readDist(int k, node_handle d) const {
+      return (distF->getNodeLevel(d) == k)
+        ? unpacked_node::newFromNode(distF, d, true)
+        : unpacked_node::newRedundant(distF, k, 0L, d, true);
+    }
+
+    /// Row i, column j of the primed level -k, below row node p.
+    inline node_handle primedChild(int k, unsigned i, node_handle p,
+      unsigned j) const
+    {
+      if (relF->getNodeLevel(p) == -k) return relF->getDownPtr(p, int(j));
+      if (relF->isIdentityReduced()) return (i==j) ? p : 0;
+      return p;
+    }
+
+    /// Child i of an event reader at unprimed level k.
+    static inline node_handle row(const unpacked_node* R, unsigned i) {
+      return (i < R->getSize()) ? R->d(i) : 0;
+    }
+
+  private:
+    trace_opname::trace_args* args;
+    expert_forest* distF;
+    expert_forest* tgtF;
+    expert_forest* relF;
+    /// Results of the current search; see the class comment.
+    std::unordered_map<memo_key, long, memo_hash> memo;
+    int num_vars;
+    /// Current state, indexed by variable.
+    int* curr;
+    /// Predecessor of the current state.
+    int* pred;
+};
+
+MEDDLY::shortest_trace_op::shortest_trace_op(const trace_opname* code,
+  trace_opname::trace_args* a)
+: specialized_operation(code, 0)
+{
+  MEDDLY_DCASSERT(a);
+  args = a;
+  distF = static_cast<expert_forest*>(a->getDistances().getForest());
+  tgtF = 0;
+  relF = 0;
+  num_vars = distF->getDomain()->getNumVariables();
+  curr = new int[num_vars+1];
+  pred = new int[num_vars+1];
+  curr[0] = pred[0] = 0;
+
+  registerInForest(distF);
+  for (unsigned i=0; i<args->getNumEvents(); i++) {
+    registerInForest(static_cast<expert_forest*>(args->getEvent(i).getForest()));
+  }
+}
+
+MEDDLY::shortest_trace_op::~shortest_trace_op()
+{
+  unregisterInForest(distF);
+  for (unsigned i=0; i<args->getNumEvents(); i++) {
+    unregisterInForest(static_cast<expert_forest*>(args->getEvent(i).getForest()));
+  }
+  delete[] pred;
+  delete[] curr;
+  if (args->autoDestroy()) delete args;
+}
+
+bool MEDDLY::shortest_trace_op::checkForestCompatibility() const
+{
+  auto o = distF->variableOrder();
+  for (unsigned i=0; i<args->getNumEvents(); i++) {
+    const expert_forest* ef =
+      static_cast<const expert_forest*>(args->getEvent(i).getForest());
+    if (!o->is_compatible_with(*ef->variableOrder())) return false;
+  }
+  return true;
+}
+
+void MEDDLY::shortest_trace_op::compute(const dd_edge &target,
+  trace_opname::trace &res)
+{
+  tgtF = static_cast<expert_forest*>(target.getForest());
+  if (0==tgtF) throw error(error::MISCELLANEOUS, __FILE__, __LINE__);
+  if (tgtF->getDomain() != distF->getDomain())
+    throw error(error::DOMAIN_MISMATCH, __FILE__, __LINE__);
+  if (
+    tgtF->isForRelations() ||
+    (tgtF->getRangeType() != forest::BOOLEAN) ||
+    (tgtF->getEdgeLabeling() != forest::MULTI_TERMINAL)
+  )
+    throw error(error::TYPE_MISMATCH, __FILE__, __LINE__);
+  if (!distF->variableOrder()->is_compatible_with(*tgtF->variableOrder()))
+    throw error(error::INVALID_OPERATION, __FILE__, __LINE__);
+
+  if (!checkForestCompatibility())
+    throw error(error::INVALID_OPERATION, __FILE__, __LINE__);
+
+  res.clear();
+
+  const dd_edge &dist = args->getDistances();
+  const node_handle d = dist.getNode();
+  long root_ev;
+  dist.getEdgeValue(root_ev);
+
+  memo.clear();
+  const long best = minInTarget(d, target.getNode());
+  if (Inf<long>() == best) {
+    // no target state is reachable
+    memo.clear();
+    return;
+  }
+  pickTarget(d, target.getNode());
+  memo.clear();
+  res.start(curr, num_vars);
+
+  //
+  // Walk back, one event at a time
+  //
+  long D = root_ev + best;
+  while (D > 0) {
+    long step = Inf<long>();
+    unsigned event = 0;
+    for (unsigned e=0; e<args->getNumEvents(); e++) {
+      relF = static_cast<expert_forest*>(args->getEvent(e).getForest());
+      const long v = minPredecessor(d, args->getEvent(e).getNode());
+      if (v < step) {
+        step = v;
+        event = e;
+      }
+    }
+    if (Inf<long>() == step || root_ev + step >= D) {
+      // the distances do not match the events
+      memo.clear();
+      throw error(error::INVALID_ARGUMENT, __FILE__, __LINE__);
+    }
+
+    relF = static_cast<expert_forest*>(args->getEvent(event).getForest());
+    pickPredecessor(d, args->getEvent(event).getNode());
+    res.addPredecessor(pred, event);
+    // the step's results depend on curr, which changes now
+    memo.clear();
+
+    int* tmp = curr;
+    curr = pred;
+    pred = tmp;
+    D = root_ev + step;
+  }
+}
+
+long MEDDLY::shortest_trace_op::minInTarget(node_handle d, node_handle t)
+{
+  if (0==d || 0==t) return Inf<long>();
+  const int tLevel = tgtF->getNodeLevel(t);
+  const int k = MAX(distF->getNodeLevel(d), tLevel);
+  if (0==k) return 0;
+
+  long m;
+  if (findResult(tgtF, d, t, m)) return m;
+
+  unpacked_node* D = readDist(k, d);
+  unpacked_node* T = (tLevel == k)
+    ? unpacked_node::newFromNode(tgtF, t, true)
+    : unpacked_node::newRedundant(tgtF, k, t, true);
+
+  m = Inf<long>();
+  const unsigned size = MIN(D->getSize(), T->getSize());
+  for (unsigned i=0; i<size; i++) {
+    if (0==D->d(i) || 0==T->d(i)) continue;
+    const long v = minInTarget(D->d(i), T->d(i));
+    if (Inf<long>() == v) continue;
+    m = MIN(m, D->ei(i) + v);
+  }
+
+  unpacked_node::recycle(T);
+  unpacked_node::recycle(D);
+  return saveResult(tgtF, d, t, m);
+}
+
+long MEDDLY::shortest_trace_op::minPredecessor(node_handle d, node_handle r)
+{
+  if (0==d || 0==r) return Inf<long>();
+  const int rLevel = relF->getNodeLevel(r);
+  const int k = MAX(distF->getNodeLevel(d), ABS(rLevel));
+  if (0==k) return 0;
+
+  long m;
+  if (findResult(relF, d, r, m)) return m;
+
+  unpacked_node* D = readDist(k, d);
+  // a skipped unprimed level is redundant, in either reduction
+  unpacked_node* R = (rLevel == k)
+    ? unpacked_node::newFromNode(relF, r, true)
+    : unpacked_node::newRedundant(relF, k, r, true);
+  const unsigned j = unsigned(curr[distF->getVarByLevel(k)]);
+
+  m = Inf<long>();
+  for (unsigned i=0; i<D->getSize(); i++) {
+    if (0==D->d(i)) continue;
+    const node_handle ri = row(R, i);
+    if (0==ri) continue;
+    const node_handle c = primedChild(k, i, ri, j);
+    if (0==c) continue;
+    const long v = minPredecessor(D->d(i), c);
+    if (Inf<long>() == v) continue;
+    m = MIN(m, D->ei(i) + v);
+  }
+
+  unpacked_node::recycle(R);
+  unpacked_node::recycle(D);
+  return saveResult(relF, d, r, m);
+}
+
+void MEDDLY::shortest_trace_op::pickTarget(node_handle d, node_handle t)
+{
+  for (int k=num_vars; k>0; k--) {
+    const int tLevel = tgtF->getNodeLevel(t);
+    unpacked_node* D = readDist(k, d);
+    unpacked_node* T = (tLevel == k)
+      ? unpacked_node::newFromNode(tgtF, t, true)
+      : unpacked_node::newRedundant(tgtF, k, t, true);
+
+    long m = Inf<long>();
+    unsigned best = 0;
+    const unsigned size = MIN(D->getSize(), T->getSize());
+    for (unsigned i=0; i<size; i++) {
+      if (0==D->d(i) || 0==T->d(i)) continue;
+      const long v = minInTarget(D->d(i), T->d(i));
+      if (Inf<long>() == v) continue;
+      if (D->ei(i) + v < m) {
+        m = D->ei(i) + v;
+        best = i;
+      }
+    }
+    MEDDLY_DCASSERT(m < Inf<long>());
+
+    curr[distF->getVarByLevel(k)] = int(best);
+    d = D->d(best);
+    t = T->d(best);
+    unpacked_node::recycle(T);
+    unpacked_node::recycle(D);
+  }
+}
+
+void MEDDLY::shortest_trace_op::pickPredecessor(node_handle d, node_handle r)
+{
+  for (int k=num_vars; k>0; k--) {
+    const int rLevel = relF->getNodeLevel(r);
+    unpacked_node* D = readDist(k, d);
+    unpacked_node* R = (rLevel == k)
+      ? unpacked_node::newFromNode(relF, r, true)
+      : unpacked_node::newRedundant(relF, k, r, true);
+    const unsigned j = unsigned(curr[distF->getVarByLevel(k)]);
+
+    long m = Inf<long>();
+    unsigned best = 0;
+    node_handle bestc = 0;
+    for (unsigned i=0; i<D->getSize(); i++) {
+      if (0==D->d(i)) continue;
+      const node_handle ri = row(R, i);
+      if (0==ri) continue;
+      const node_handle c = primedChild(k, i, ri, j);
+      if (0==c) continue;
+      const long v = minPredecessor(D->d(i), c);
+      if (Inf<long>() == v) continue;
+      if (D->ei(i) + v < m) {
+        m = D->ei(i) + v;
+        best = i;
+        bestc = c;
+      }
+    }
+    MEDDLY_DCASSERT(m < Inf<long>());
+
+    pred[distF->getVarByLevel(k)] = int(best);
+    d = D->d(best);
+    r = bestc;
+    unpacked_node::recycle(R);
+    unpacked_node::recycle(D);
+  }
+}
+
+// ******************************************************************
+// *                                                                *
+// *                      strace_opname  class                      *
+// *                                                                *
+// ******************************************************************
+
+class MEDDLY::strace_opname : public trace_opname {
+  public:
+    strace_opname();
+    virtual specialized_operation* buildOperation(arguments* a) const;
+};
+
+MEDDLY::strace_opname::strace_opname()
+ : trace_opname("ShortestTrace")
+{
+}
+
+MEDDLY::specialized_operation*
+MEDDLY::strace_opname::buildOperation(arguments* a) const
+{
+  trace_args* ta = dynamic_cast<trace_args*>(a);
+  if (0==ta) throw error(error::INVALID_ARGUMENT, __FILE__, __LINE__);
+
+  //
+  // Forest types were checked when constructing ta.
+  //
+
+  return new shortest_trace_op(this, ta);
+}
+
+// ******************************************************************
+// *                                                                *
+// *                           Front  end                           *
+// *                                                                *
+// ******************************************************************
+
+MEDDLY::trace_opname* MEDDLY::initShortestTrace()
+{
+  return new strace_opname;
+}
+
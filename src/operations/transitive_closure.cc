@@ -267,57 +267,7 @@ void MEDDLY::transitive_closure_dfs::splitMxd(const dd_edge& mxd)
   MEDDLY_DCASSERT(splits == nullptr);
 
   splits = new dd_edge[transF->getNumVariables() + 1];
-
-  dd_edge root(mxd), maxDiag, Rpdi;
-  maxDiag.setForest(transF);
-  Rpdi.setForest(transF);
-
-  // Build from top down
-  for (int level = transF->getNumVariables(); level > 0; level--) {
-    splits[level].setForest(transF);
-    if (root.getNode() == 0) {
-      // common and easy special case
-      continue;
-    }
-
-    int mxdLevel = root.getLevel(); // transF->getNodeLevel(mxd);
-    MEDDLY_DCASSERT(ABS(mxdLevel) <= level);
-
-    // Initialize readers
-    unpacked_node* Ru = isLevelAbove(level, mxdLevel)
-      ? unpacked_node::newRedundant(transF, level, root.getNode(), true)
-      : unpacked_node::newFromNode(transF, root.getNode(), true);
-
-    bool first = true;
-
-    // Read "rows"
-    for (int i = 0; i < Ru->getSize(); i++) {
-      // Initialize column reader
-      int mxdPLevel = transF->getNodeLevel(Ru->d(i));
-      unpacked_node* Rp = isLevelAbove(-level, mxdPLevel)
-        ? unpacked_node::newIdentity(transF, -level, i, Ru->d(i), true)
-        : unpacked_node::newFromNode(transF, Ru->d(i), true);
-
-      // Intersect along the diagonal
-      if (first) {
-        maxDiag.set( transF->linkNode(Rp->d(i)) );
-        first = false;
-      } else {
-        Rpdi.set( transF->linkNode(Rp->d(i)) );
-        mxdIntersectionOp->compute(maxDiag, Rpdi, maxDiag);
-      }
-
-      // cleanup
-      unpacked_node::recycle(Rp);
-    } // for i
-
-    // maxDiag is what we can split from here
-    mxdDifferenceOp->compute(root, maxDiag, splits[level]);
-    root = maxDiag;
-
-    // Cleanup
-    unpacked_node::recycle(Ru);
-  } // for level
+  splitByTopLevel(transF, mxdIntersectionOp, mxdDifferenceOp, mxd, splits);
 
 #ifdef DEBUG_SPLIT
   printf("After splitting monolithic event in msat\n");
@@ -891,6 +841,196 @@ void MEDDLY::transitive_closure_evplus::saturate(int aev, node_handle a, int bev
   saveResult(key, aev, a, bev, b, level, cev, c);
 }
 
+// ******************************************************************
+// *                                                                *
+// *                        helper functions                        *
+// *                                                                *
+// ******************************************************************
+
+void MEDDLY::splitByTopLevel(expert_forest* transF, binary_operation* mxdIntersectionOp,
+  binary_operation* mxdDifferenceOp, const dd_edge& mxd, dd_edge* splits)
+{
+  MEDDLY_DCASSERT(transF);
+  MEDDLY_DCASSERT(splits);
+
+  dd_edge root(mxd), maxDiag, Rpdi;
+  maxDiag.setForest(transF);
+  Rpdi.setForest(transF);
+
+  // Build from top down
+  for (int level = transF->getNumVariables(); level > 0; level--) {
+    splits[level].setForest(transF);
+    if (root.getNode() == 0) {
+      // common and easy special case
+      continue;
+    }
+
+    int mxdLevel = root.getLevel(); // transF->getNodeLevel(mxd);
+    MEDDLY_DCASSERT(ABS(mxdLevel) <= level);
+
+    // Initialize readers
+    unpacked_node* Ru = isLevelAbove(level, mxdLevel)
+      ? unpacked_node::newRedundant(transF, level, root.getNode(), true)
+      : unpacked_node::newFromNode(transF, root.getNode(), true);
+
+    bool first = true;
+
+    // Read "rows"
+    for (int i = 0; i < Ru->getSize(); i++) {
+      // Initialize column reader
+      int mxdPLevel = transF->getNodeLevel(Ru->d(i));
+      unpacked_node* Rp = isLevelAbove(-level, mxdPLevel)
+        ? unpacked_node::newIdentity(transF, -level, i, Ru->d(i), true)
+        : unpacked_node::newFromNode(transF, Ru->d(i), true);
+
+      // Intersect along the diagonal
+      if (first) {
+        maxDiag.set( transF->linkNode(Rp->d(i)) );
+        first = false;
+      } else {
+        Rpdi.set( transF->linkNode(Rp->d(i)) );
+        mxdIntersectionOp->compute(maxDiag, Rpdi, maxDiag);
+      }
+
+      // cleanup
+      unpacked_node::recycle(Rp);
+    } // for i
+
+    // maxDiag is what we can split from here
+    mxdDifferenceOp->compute(root, maxDiag, splits[level]);
+    root = maxDiag;
+
+    // Cleanup
+    unpacked_node::recycle(Ru);
+  } // for level
+
+  // What is left is either empty or the identity
+  splits[0] = root;
+}
+
+// ******************************************************************
+// *                                                                *
+// *                        relation_closure                        *
+// *                                                                *
+// ******************************************************************
+
+MEDDLY::relation_closure::relation_closure(const unary_opname* code,
+  expert_forest* arg, expert_forest* res)
+  : unary_operation(code, 0, arg, res)
+{
+  composeOp = getOperation(MM_MULTIPLY, resF, resF, resF);
+  unionOp = getOperation(UNION, resF, resF, resF);
+}
+
+void MEDDLY::relation_closure::square(dd_edge& c)
+{
+  dd_edge c2(resF);
+  for (;;) {
+    composeOp->compute(c, c, c2);
+    unionOp->compute(c, c2, c2);
+    if (c2 == c) break;
+    c = c2;
+  }
+}
+
+// ******************************************************************
+// *                                                                *
+// *                    relation_closure_square                     *
+// *                                                                *
+// ******************************************************************
+
+MEDDLY::relation_closure_square::relation_closure_square(const unary_opname* code,
+  expert_forest* arg, expert_forest* res)
+  : relation_closure(code, arg, res)
+{
+}
+
+void MEDDLY::relation_closure_square::computeDDEdge(const dd_edge &arg, dd_edge &res)
+{
+  dd_edge c(arg);
+  square(c);
+  res = c;
+}
+
+// ******************************************************************
+// *                                                                *
+// *                      relation_closure_sat                      *
+// *                                                                *
+// ******************************************************************
+
+MEDDLY::relation_closure_sat::relation_closure_sat(const unary_opname* code,
+  expert_forest* arg, expert_forest* res)
+  : relation_closure(code, arg, res)
+{
+  mxdIntersectionOp = getOperation(INTERSECTION, resF, resF, resF);
+  mxdDifferenceOp = getOperation(DIFFERENCE, resF, resF, resF);
+}
+
+void MEDDLY::relation_closure_sat::computeDDEdge(const dd_edge &arg, dd_edge &res)
+{
+  const int K = resF->getNumVariables();
+  dd_edge* splits = new dd_edge[K + 1];
+  splitByTopLevel(resF, mxdIntersectionOp, mxdDifferenceOp, arg, splits);
+
+  //
+  // Bottom up: c is the closure of the parts below level k,
+  // and does not change anything above.  With S the part at level k,
+  //   (c + S)+ = c + (c* S c*)+,  where c* = c + identity,
+  // and every path through S starts and ends at level k,
+  // so only the new part is squared, and that touches levels <= k.
+  //
+  dd_edge c(splits[0]);
+  dd_edge t(resF), cs(resF);
+  for (int k = 1; k <= K; k++) {
+    if (0 == splits[k].getNode()) continue;
+    // t = c* S c*
+    composeOp->compute(c, splits[k], cs);
+    unionOp->compute(splits[k], cs, t);
+    composeOp->compute(t, c, cs);
+    unionOp->compute(t, cs, t);
+    square(t);
+    unionOp->compute(c, t, c);
+  }
+  delete[] splits;
+  res = c;
+}
+
+// ******************************************************************
+// *                                                                *
+// *                    relation_closure_opname                     *
+// *                                                                *
+// ******************************************************************
+
+MEDDLY::relation_closure_opname::relation_closure_opname(bool sat)
+ : unary_opname(sat ? "Transitive Closure (saturation)" : "Transitive Closure (squaring)")
+{
+  saturate = sat;
+}
+
+MEDDLY::unary_operation*
+MEDDLY::relation_closure_opname::buildOperation(expert_forest* arg, expert_forest* res) const
+{
+  if (0==arg || 0==res) return 0;
+
+  if (arg->getDomain() != res->getDomain())
+    throw error(error::DOMAIN_MISMATCH, __FILE__, __LINE__);
+
+  if (arg != res)
+    throw error(error::FOREST_MISMATCH, __FILE__, __LINE__);
+
+  if (!res->isForRelations() ||
+      res->getRangeType() != forest::BOOLEAN ||
+      res->getEdgeLabeling() != forest::MULTI_TERMINAL)
+    throw error(error::TYPE_MISMATCH, __FILE__, __LINE__);
+
+  // splitByTopLevel and MM_MULTIPLY need identity-reduced relations
+  if (!res->isIdentityReduced())
+    throw error(error::NOT_IMPLEMENTED, __FILE__, __LINE__);
+
+  if (saturate) return new relation_closure_sat(this, arg, res);
+  return new relation_closure_square(this, arg, res);
+}
+
 // ******************************************************************
 // *                                                                *
 // *                           Front  end                           *
@@ -901,3 +1041,13 @@ MEDDLY::constrained_opname* MEDDLY::initTransitiveClosureDFS()
 {
   return new transitive_closure_dfs_opname();
 }
+
+MEDDLY::unary_opname* MEDDLY::initTransitiveClosureSquare()
+{
+  return new relation_closure_opname(false);
+}
+
+MEDDLY::unary_opname* MEDDLY::initTransitiveClosureSat()
+{
+  return new relation_closure_opname(true);
+}
@@ -35,7 +35,27 @@ namespace MEDDLY {
 
   class transitive_closure_evplus;
 
+  class relation_closure;
+  class relation_closure_square;
+  class relation_closure_sat;
+  class relation_closure_opname;
+
   constrained_opname* initTransitiveClosureDFS();
+  unary_opname* initTransitiveClosureSquare();
+  unary_opname* initTransitiveClosureSat();
+
+  /** Partition a relation based on "top level".
+      On return, splits[k] holds the transitions whose top level is k,
+      for k from 1 to the number of variables,
+      and splits[0] holds the identity part (if any).
+        @param  F       Forest for the relation.
+        @param  inter   Intersection operation for F.
+        @param  diff    Difference operation for F.
+        @param  mxd     The relation.
+        @param  splits  Array of dimension #variables + 1.
+  */
+  void splitByTopLevel(expert_forest* F, binary_operation* inter,
+    binary_operation* diff, const dd_edge& mxd, dd_edge* splits);
 }
 
 class MEDDLY::common_transitive_closure: public specialized_operation
@@ -163,4 +183,49 @@ public:
   void saturate(int aev, node_handle a, int bev, node_handle b, int level, long& cev, node_handle& c);
 };
 
+/** Common base for transitive closure of BOOLEAN relations.
+    The compositions are done with MM_MULTIPLY, so all closure
+    operations on the same forest share its compute table.
+*/
+class MEDDLY::relation_closure: public unary_operation
+{
+protected:
+  binary_operation* composeOp;
+  binary_operation* unionOp;
+
+  /// Close c by iterative squaring: c = c + c*c until c stops changing.
+  void square(dd_edge& c);
+
+public:
+  relation_closure(const unary_opname* code, expert_forest* arg, expert_forest* res);
+};
+
+class MEDDLY::relation_closure_square: public relation_closure
+{
+public:
+  relation_closure_square(const unary_opname* code, expert_forest* arg, expert_forest* res);
+
+  virtual void computeDDEdge(const dd_edge &arg, dd_edge &res);
+};
+
+class MEDDLY::relation_closure_sat: public relation_closure
+{
+protected:
+  binary_operation* mxdIntersectionOp;
+  binary_operation* mxdDifferenceOp;
+
+public:
+  relation_closure_sat(const unary_opname* code, expert_forest* arg, expert_forest* res);
+
+  virtual void computeDDEdge(const dd_edge &arg, dd_edge &res);
+};
+
+class MEDDLY::relation_closure_opname : public unary_opname {
+  bool saturate;
+public:
+  relation_closure_opname(bool sat);
+
+  virtual unary_operation* buildOperation(expert_forest* arg, expert_forest* res) const;
+};
+
 #endif
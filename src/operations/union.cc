@@ -40,23 +40,21 @@ namespace MEDDLY {
 // *                                                                *
 // ******************************************************************
 
-class MEDDLY::union_mdd : public generic_binary_mdd {
+class MEDDLY::union_mdd : public binary_mdd_kernel<union_mdd, true> {
   public:
     union_mdd(const binary_opname* opcode, expert_forest* arg1,
       expert_forest* arg2, expert_forest* res);
 
-  protected:
-    virtual bool checkTerminals(node_handle a, node_handle b, node_handle& c);
+    bool terminals(node_handle a, node_handle b, node_handle& c);
 };
 
 MEDDLY::union_mdd::union_mdd(const binary_opname* opcode, 
   expert_forest* arg1, expert_forest* arg2, expert_forest* res)
-  : generic_binary_mdd(opcode, arg1, arg2, res)
+  : binary_mdd_kernel<union_mdd, true>(opcode, arg1, arg2, res)
 {
-  operationCommutes();
 }
 
-bool MEDDLY::union_mdd::checkTerminals(node_handle a, node_handle b, node_handle& c)
+inline bool MEDDLY::union_mdd::terminals(node_handle a, node_handle b, node_handle& c)
 {
   if (a < 0 || b < 0) {
     c = resF->handleForValue(true);
@@ -98,24 +96,24 @@ bool MEDDLY::union_mdd::checkTerminals(node_handle a, node_handle b, node_handle
 // *                                                                *
 // ******************************************************************
 
-class MEDDLY::union_mxd : public generic_binary_mxd {
+class MEDDLY::union_mxd : public binary_mxd_kernel<union_mxd, true> {
   public:
     union_mxd(const binary_opname* opcode, expert_forest* arg1,
       expert_forest* arg2, expert_forest* res);
 
+    bool terminals(node_handle a, node_handle b, node_handle& c);
+
   protected:
-    virtual bool checkTerminals(node_handle a, node_handle b, node_handle& c);
     virtual MEDDLY::node_handle compute_ext(node_handle a, node_handle b);
 };
 
 MEDDLY::union_mxd::union_mxd(const binary_opname* opcode, 
   expert_forest* arg1, expert_forest* arg2, expert_forest* res)
-  : generic_binary_mxd(opcode, arg1, arg2, res)
+  : binary_mxd_kernel<union_mxd, true>(opcode, arg1, arg2, res)
 {
-  operationCommutes();
 }
 
-bool MEDDLY::union_mxd::checkTerminals(node_handle a, node_handle b, node_handle& c)
+inline bool MEDDLY::union_mxd::terminals(node_handle a, node_handle b, node_handle& c)
 {
   if (a < 0 && b < 0) {
     c = resF->handleForValue(true);
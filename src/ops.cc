@@ -164,21 +164,21 @@ MEDDLY::operation::operation(const opname* n, unsigned et_slots)
     oplist_index = free_list;
     free_list = op_holes[free_list];
   } else {
-    oplist_index = ++list_size;
+    if (0==list_size) {
+      // Never use slot 0
+      list_size++;
+    }
     if (list_size >= list_alloc) {
       unsigned nla = list_alloc + 256;
       op_list = (operation**) realloc(op_list, nla * sizeof(void*));
       op_holes = (unsigned*) realloc(op_holes, nla * sizeof(unsigned));
       if (0==op_list || 0==op_holes) throw error(error::INSUFFICIENT_MEMORY, __FILE__, __LINE__);
-      list_alloc = nla;
-      for (unsigned i=list_size; i<list_alloc; i++) {
+      // Clear every new slot, including slot 0 the first time
+      for (unsigned i=list_alloc; i<nla; i++) {
         op_list[i] = 0;
         op_holes[i] = 0;
       }
-    }
-    if (0==list_size) {
-      // Never use slot 0
-      list_size++;
+      list_alloc = nla;
     }
     oplist_index = list_size;
     list_size++;
@@ -497,6 +497,12 @@ MEDDLY::binary_operation::~binary_operation()
   unregisterInForest(resF);
 }
 
+void MEDDLY::binary_operation::compute(const dd_edge &ar1, const dd_edge &ar2,
+  bool &res)
+{
+  throw error(error::TYPE_MISMATCH, __FILE__, __LINE__);
+}
+
 #ifdef KEEP_LL_COMPUTES
 
 MEDDLY::node_handle 
@@ -573,8 +579,31 @@ void MEDDLY::specialized_operation::compute(double* y, const double* x)
   throw error(error::TYPE_MISMATCH, __FILE__, __LINE__);
 }
 
+void MEDDLY::specialized_operation::enableCheckpoints(const char* filename,
+  long seconds)
+{
+  throw error(error::NOT_IMPLEMENTED, __FILE__, __LINE__);
+}
+
+void MEDDLY::specialized_operation::resume(const char* filename, dd_edge &res)
+{
+  throw error(error::NOT_IMPLEMENTED, __FILE__, __LINE__);
+}
+
 void MEDDLY::specialized_operation::compute(const dd_edge &ar1,
   const dd_edge &ar2, const dd_edge &ar3, dd_edge &res)
 {
   throw error(error::TYPE_MISMATCH);
 }
+
+void MEDDLY::specialized_operation::compute(const dd_edge* args, unsigned n,
+  dd_edge &res)
+{
+  throw error(error::TYPE_MISMATCH);
+}
+
+void MEDDLY::specialized_operation::compute(const dd_edge &arg,
+  trace_opname::trace &res)
+{
+  throw error(error::TYPE_MISMATCH, __FILE__, __LINE__);
+}
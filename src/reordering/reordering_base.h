@@ -3,6 +3,11 @@
 #define REORDERING_BASE_H
 
 #include "../meddly_expert.h"
+#include "../unique_table.h"
+
+#include <set>
+#include <unordered_map>
+#include <vector>
 
 namespace MEDDLY{
 
@@ -15,6 +20,17 @@ protected:
   const unique_table* get_unique_table(expert_forest* forest) const;
   int getInCount(expert_forest* forest, node_handle p) const;
 
+  // Estimate the change in the number of nodes at the two levels
+  // if the variables at level and level+1 were swapped.
+  // Only the unique-table entries of the two levels are scanned;
+  // the forest is not changed.
+  // For MDD forests this is the change in the number of live nodes:
+  // every node above that depends on the lower variable is split into
+  // its distinct cofactors, and nodes below that are referenced only
+  // by those nodes are freed.
+  // For relation forests it is a heuristic.
+  long estimate_swap_memory_cost(expert_forest* forest, int level) const;
+
 public:
   virtual void reorderVariables(expert_forest* forest, const int* level2var) = 0;
 };
@@ -29,6 +45,84 @@ inline int reordering_base::getInCount(expert_forest* forest, node_handle p) con
   return forest->getNodeInCount(p);
 }
 
+inline long reordering_base::estimate_swap_memory_cost(expert_forest* forest, int level) const
+{
+  int lvar = forest->getVarByLevel(level);
+  int hvar = forest->getVarByLevel(level+1);
+  int lsize = forest->getVariableSize(lvar);
+  const unique_table* unique = get_unique_table(forest);
+
+  int hnum = unique->getNumEntries(hvar);
+  if (hnum == 0) {
+    return 0;
+  }
+  node_handle* hnodes = new node_handle[hnum];
+  unique->getItems(hvar, hnodes, hnum);
+
+  // Nodes for the upper variable after the swap, by their children:
+  // the independent ones are kept, the others are cofactors.
+  std::set<std::vector<node_handle>> lower;
+  int kept = 0;
+  // References from the upper level into the lower level
+  std::unordered_map<node_handle, int> refs;
+  for (int i = 0; i < hnum; i++) {
+    unpacked_node* nr = unpacked_node::useUnpackedNode();
+    nr->initFromNode(forest, hnodes[i], true);
+    int hsize = nr->getSize();
+
+    bool depends = false;
+    for (int j = 0; j < hsize; j++) {
+      node_handle d = nr->d(j);
+      if (!forest->isTerminalNode(d) && forest->getVarByLevel(ABS(forest->getNodeLevel(d))) == lvar) {
+        refs[d]++;
+        depends = true;
+      }
+    }
+
+    std::vector<node_handle> column(hsize);
+    if (!depends) {
+      for (int j = 0; j < hsize; j++) {
+        column[j] = nr->d(j);
+      }
+      lower.insert(column);
+      kept++;
+    }
+    else {
+      // One cofactor per value of the lower variable;
+      // redundant cofactors do not need a node.
+      for (int k = 0; k < lsize; k++) {
+        bool redundant = true;
+        for (int j = 0; j < hsize; j++) {
+          node_handle d = nr->d(j);
+          if (!forest->isTerminalNode(d) && forest->getVarByLevel(ABS(forest->getNodeLevel(d))) == lvar) {
+            d = forest->getDownPtr(d, k);
+          }
+          column[j] = d;
+          if (column[j] != column[0]) {
+            redundant = false;
+          }
+        }
+        if (!redundant || !forest->isFullyReduced()) {
+          lower.insert(column);
+        }
+      }
+    }
+    unpacked_node::recycle(nr);
+  }
+  delete[] hnodes;
+
+  long freed = 0;
+  for (auto it = refs.begin(); it != refs.end(); ++it) {
+    if (getInCount(forest, it->first) == it->second) {
+      freed++;
+    }
+  }
+
+  // Each dependent node becomes a node for the lower variable,
+  // so the count at the upper level is unchanged.
+  return long(lower.size()) - kept - freed;
+}
+
 }
 
 #endif
@@ -1048,7 +1048,7 @@ void MEDDLY::best_storage
     const node_handle* index = down + nnz;
     const node_handle* edge = slots_per_edge ? (index + nnz) : 0;
     const int ext_i = index[nnz-1];
-    const int ext_d = is_extensible? down[nnz-1]: tv;
+    const node_handle ext_d = is_extensible? down[nnz-1]: tv;
     const void* ext_ptr = is_extensible? (edge + (nnz-1)*slots_per_edge): 0;
     
     
@@ -1131,7 +1131,7 @@ void MEDDLY::best_storage
       if (unpacked_node::AS_STORED == st2 && is_extensible == nr.isExtensible()) {
         nr.shrinkFull(size);
       } else {
-        const int ext_d = is_extensible? down[size-1]: tv;
+        const node_handle ext_d = is_extensible? down[size-1]: tv;
         const void* ext_ptr = is_extensible? (edge + (size-1)*slots_per_edge): 0;
         for (; i<unsigned(nr.getSize()); i++) {
           nr.d_ref(i) = ext_d;
@@ -1162,7 +1162,7 @@ void MEDDLY::best_storage
         MEDDLY_DCASSERT(is_extensible);
         MEDDLY_DCASSERT(!nr.isExtensible());
         const int ext_i = size-1;
-        const int ext_d = down[ext_i];
+        const node_handle ext_d = down[ext_i];
         const void* ext_ptr = (edge + (ext_i)*slots_per_edge);
         for (int i = ext_i + 1 ; z<nr.getNNZs(); z++, i++) {
           nr.i_ref(z) = i;
@@ -1849,6 +1849,8 @@ MEDDLY::node_address MEDDLY::best_storage
     MEDDLY_DCASSERT(nb.hasEdges());
     char* edge = (char*) (down + size); 
     int edge_bytes = bytesForSlots(slots_per_edge);
+    // Edge values are padded to whole slots; clear the padding
+    if (edge_bytes != int(nb.edgeBytes())) memset(edge, 0, size * edge_bytes);
     if (nb.isSparse()) {
       for (int i=0; i<size; i++) {
         getParent()->getTransparentEdge(down[i], edge + i * edge_bytes);
@@ -1857,12 +1859,18 @@ MEDDLY::node_address MEDDLY::best_storage
         int i = nb.i(z);
         MEDDLY_CHECK_RANGE(0, i, size);
         down[i] = nb.d(z);
-        memcpy(edge + i * edge_bytes, nb.eptr(z), edge_bytes);
+        memcpy(edge + i * edge_bytes, nb.eptr(z), nb.edgeBytes());
       }
     } else {
       for (int i=0; i<size; i++) down[i] = nb.d(i);
-      // kinda hacky
-      memcpy(edge, nb.eptr(0), size * edge_bytes);
+      if (edge_bytes == int(nb.edgeBytes())) {
+        // kinda hacky
+        memcpy(edge, nb.eptr(0), size * edge_bytes);
+      } else {
+        for (int z=0; z<size; z++) {
+          memcpy(edge + z * edge_bytes, nb.eptr(z), nb.edgeBytes());
+        }
+      }
     }
   } else {
     //
@@ -1969,13 +1977,21 @@ MEDDLY::node_address MEDDLY::best_storage
     MEDDLY_DCASSERT(nb.hasEdges());
     char* edge = (char*) (index + size); 
     int edge_bytes = bytesForSlots(slots_per_edge);
+    // Edge values are padded to whole slots; clear the padding
+    if (edge_bytes != int(nb.edgeBytes())) memset(edge, 0, size * edge_bytes);
     if (nb.isSparse()) {
       for (int z=0; z<size; z++) {
         down[z] = nb.d(z);
         index[z] = nb.i(z);
       }
-      // kinda hacky
-      memcpy(edge, nb.eptr(0), size * edge_bytes);
+      if (edge_bytes == int(nb.edgeBytes())) {
+        // kinda hacky
+        memcpy(edge, nb.eptr(0), size * edge_bytes);
+      } else {
+        for (int z=0; z<size; z++) {
+          memcpy(edge + z * edge_bytes, nb.eptr(z), nb.edgeBytes());
+        }
+      }
     } else {
       int z = 0;
       for (int i=0; i<nb.getSize(); i++) {
@@ -1983,7 +1999,7 @@ MEDDLY::node_address MEDDLY::best_storage
         MEDDLY_CHECK_RANGE(0, z, size);
         down[z] = nb.d(i);
         index[z] = i;
-        memcpy(edge + z * edge_bytes, nb.eptr(i), edge_bytes);
+        memcpy(edge + z * edge_bytes, nb.eptr(i), nb.edgeBytes());
         z++;
       }
       MEDDLY_DCASSERT(size == z);
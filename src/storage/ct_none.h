@@ -761,6 +761,11 @@ void MEDDLY::ct_none<MONOLITHIC, CHAINED>::addEntry(entry_key* key, const entry_
 
   size_t newsize = tableSize * 2;
   if (newsize > maxSize) newsize = maxSize;
+  // Near the memory budget, keep the table size; entries just chain
+  // (or get replaced) more often.
+  if (!memory_budget::allowsGrowth((newsize - tableSize) * sizeof(size_t))) {
+    newsize = tableSize;
+  }
 
   if (CHAINED) {
     if (newsize != tableSize) {
@@ -769,22 +774,24 @@ void MEDDLY::ct_none<MONOLITHIC, CHAINED>::addEntry(entry_key* key, const entry_
       //
     
       size_t* newt = (size_t*) realloc(table, newsize * sizeof(size_t));
-      if (0==newt) {
-        throw error(error::INSUFFICIENT_MEMORY, __FILE__, __LINE__);
-      }
-
-      for (size_t i=tableSize; i<newsize; i++) newt[i] = 0;
+      if (newt) {
+        for (size_t i=tableSize; i<newsize; i++) newt[i] = 0;
 
-      MEDDLY_DCASSERT(newsize > tableSize);
-      mstats.incMemUsed( (newsize - tableSize) * sizeof(size_t) );
-      mstats.incMemAlloc( (newsize - tableSize) * sizeof(size_t) );
+        MEDDLY_DCASSERT(newsize > tableSize);
+        mstats.incMemUsed( (newsize - tableSize) * sizeof(size_t) );
+        mstats.incMemAlloc( (newsize - tableSize) * sizeof(size_t) );
 
-      table = newt;
-      tableSize = newsize;
+        table = newt;
+        tableSize = newsize;
+      }
+      // otherwise, out of memory: keep the table we have
     }
 
     if (tableSize == maxSize) {
       tableExpand = std::numeric_limits<int>::max();
+    } else if (tableSize != newsize) {
+      // Could not grow; don't scan again until the chains are twice as long
+      tableExpand = 2 * MAX(perf.numEntries, 4*tableSize);
     } else {
       tableExpand = 4*tableSize;
     }
@@ -792,19 +799,23 @@ void MEDDLY::ct_none<MONOLITHIC, CHAINED>::addEntry(entry_key* key, const entry_
 
     listToTable(list);
   } else {  // not CHAINED
+    size_t* newt = 0;
     if (newsize != tableSize) {
+      newt = (size_t*) malloc(newsize * sizeof(size_t));
+    }
+    if (0==newt && tableSize != maxSize) {
+      // Could not grow (budget, or out of memory); entries will be
+      // replaced on collision, so stop scanning until we can shrink.
+      tableExpand = std::numeric_limits<int>::max();
+    }
+    if (newt) {
       //
       // Enlarge table
       //
       size_t* oldT = table;
       size_t oldSize = tableSize;
       tableSize = newsize;
-      table = (size_t*) malloc(newsize * sizeof(size_t));
-      if (0==table) {
-        table = oldT;
-        tableSize = oldSize;
-        throw error(error::INSUFFICIENT_MEMORY, __FILE__, __LINE__);
-      }
+      table = newt;
       for (size_t i=0; i<newsize; i++) table[i] = 0;
 
       mstats.incMemUsed(newsize * sizeof(size_t));
@@ -895,6 +906,8 @@ void MEDDLY::ct_none<MONOLITHIC, CHAINED>::removeStales()
       // Time to shrink table
       //
       size_t newsize = tableSize / 2;
+      // After a clear, go all the way down
+      while (newsize > 1024 && perf.numEntries < newsize/2) newsize /= 2;
       if (newsize < 1024) newsize = 1024;
       size_t* newt = (size_t*) realloc(table, newsize * sizeof(size_t));
       if (0==newt) {
@@ -930,6 +943,8 @@ void MEDDLY::ct_none<MONOLITHIC, CHAINED>::removeStales()
       // Time to shrink table
       //
       size_t newsize = tableSize / 2;
+      // After a clear, go all the way down
+      while (newsize > 1024 && perf.numEntries < newsize/8) newsize /= 2;
       if (newsize < 1024) newsize = 1024;
       if (newsize < tableSize) {
           size_t* oldT = table;
@@ -960,6 +975,27 @@ void MEDDLY::ct_none<MONOLITHIC, CHAINED>::removeStales()
       } // if different size
     }
   } // if CHAINED
+
+  // Growth may have been refused near the memory budget; allow it again
+  if (tableSize < maxSize) tableExpand = CHAINED ? 4*tableSize : tableSize/2;
+
+#ifdef INTEGRATED_MEMMAN
+  //
+  // Nothing left (e.g., after removeAll), so give back the entry memory
+  //
+  if (0==perf.numEntries && entriesAlloc > 1024) {
+    entry_item* ne = (entry_item*) realloc(entries, 1024 * sizeof(entry_item));
+    if (ne) {
+      mstats.decMemAlloc( (entriesAlloc - 1024) * sizeof(entry_item) );
+      entries = ne;
+      entriesAlloc = 1024;
+      entriesSize = 1;
+      for (unsigned i=0; i<=maxEntrySize; i++) {
+        freeList[i] = 0;
+      }
+    }
+  }
+#endif
     
 #ifdef DEBUG_REMOVESTALES
   fprintf(stdout, "Done removing CT stales (size %lu, entries %lu)\n", 
@@ -1435,10 +1471,17 @@ unsigned MEDDLY::ct_none<MONOLITHIC, CHAINED>
   for (unsigned i=0; i<klen; i++) {    // i initialized earlier
     const typeID t = et->getKeyType(i);
     switch (t) {
+        case NODE:
+                        if (sizeof(entry[i].N) == sizeof(entry[i].U)) {
+                          H.push(entry[i].U);
+                        } else {
+                          MEDDLY_DCASSERT(sizeof(entry[i].N) == sizeof(entry[i].L));
+                          unsigned* hack = (unsigned*) (& (entry[i].N));
+                          H.push(hack[0], hack[1]);
+                        }
+                        continue;
         case FLOAT:
                         MEDDLY_DCASSERT(sizeof(entry[i].F) == sizeof(entry[i].U));
-        case NODE:
-                        MEDDLY_DCASSERT(sizeof(entry[i].N) == sizeof(entry[i].U));
         case INTEGER:
                         MEDDLY_DCASSERT(sizeof(entry[i].I) == sizeof(entry[i].U));
                         H.push(entry[i].U);
@@ -1496,10 +1539,17 @@ unsigned MEDDLY::ct_none<MONOLITHIC, CHAINED>
   for (unsigned i=0; i<klen; i++) { 
     const typeID t = et->getKeyType(i);
     switch (t) {
+        case NODE:
+                        if (sizeof(entry[i].N) == sizeof(entry[i].U)) {
+                          H.push(entry[i].U);
+                        } else {
+                          MEDDLY_DCASSERT(sizeof(entry[i].N) == sizeof(entry[i].L));
+                          unsigned* hack = (unsigned*) (& (entry[i].N));
+                          H.push(hack[0], hack[1]);
+                        }
+                        continue;
         case FLOAT:
                         MEDDLY_DCASSERT(sizeof(entry[i].F) == sizeof(entry[i].U));
-        case NODE:
-                        MEDDLY_DCASSERT(sizeof(entry[i].N) == sizeof(entry[i].U));
         case INTEGER:
                         MEDDLY_DCASSERT(sizeof(entry[i].I) == sizeof(entry[i].U));
                         H.push(entry[i].U);
@@ -130,6 +130,19 @@ namespace MEDDLY {
       node_address newEntry(unsigned size);
 
 
+      /// Number of int slots used by a node handle in an entry.
+      static const unsigned node_slots = sizeof(node_handle) / sizeof(int);
+
+      static inline node_handle readNode(const int* p) {
+        node_handle n;
+        memcpy(&n, p, sizeof(node_handle));
+        return n;
+      }
+
+      static inline void writeNode(int* p, node_handle n) {
+        memcpy(p, &n, sizeof(node_handle));
+      }
+
       static inline unsigned raw_hash(const int* k, int length) {
         return hash_stream::raw_hash( (const unsigned*) k, length );
       }
@@ -286,8 +299,8 @@ namespace MEDDLY {
         for (unsigned i=0; i<res.dataLength(); i++) {
             typeID t = et->getResultType(i);
             switch (t) {
-              case NODE:    *respart = resdata[i].N;
-                            respart++;
+              case NODE:    writeNode(respart, resdata[i].N);
+                            respart += node_slots;
                             continue;
 
               case INTEGER: *respart = resdata[i].I;
@@ -390,7 +403,8 @@ namespace MEDDLY {
       /// Memory allocated for entries
       int entriesAlloc;
 
-      static const int maxEntrySize = 15;
+      /// In int slots; a node handle may take more than one.
+      static const int maxEntrySize = 15 * int(node_slots);
       static const int maxEntryBytes = sizeof(int) * maxEntrySize;
 
       /// freeList[i] is list of all unused i-sized entries.
@@ -691,8 +705,8 @@ void MEDDLY::ct_typebased<MONOLITHIC, CHAINED>
     typeID t = et->getKeyType(i);
     switch (t) {
       case NODE:
-                  temp_entry[tptr] = data[i].N;
-                  tptr++;
+                  writeNode(temp_entry+tptr, data[i].N);
+                  tptr += node_slots;
                   continue;
       case INTEGER:
                   temp_entry[tptr] = data[i].I;
@@ -732,7 +746,8 @@ void MEDDLY::ct_typebased<MONOLITHIC, CHAINED>
     for (unsigned i=0; i<key->getET()->getResultSize(); i++) {
       typeID t = et->getResultType(i);
       switch (t) {
-        case NODE:    res.writeN( *entry_result++ );
+        case NODE:    res.writeN( readNode(entry_result) );
+                      entry_result += node_slots;
                       continue;
 
         case INTEGER: res.writeI( *entry_result++ );
@@ -903,6 +918,11 @@ void MEDDLY::ct_typebased<MONOLITHIC, CHAINED>::addEntry(entry_key* key, const e
 
   size_t newsize = tableSize * 2;
   if (newsize > maxSize) newsize = maxSize;
+  // Near the memory budget, keep the table size; entries just chain
+  // (or get replaced) more often.
+  if (!memory_budget::allowsGrowth((newsize - tableSize) * sizeof(int))) {
+    newsize = tableSize;
+  }
 
   if (CHAINED) {
     if (newsize != tableSize) {
@@ -911,22 +931,24 @@ void MEDDLY::ct_typebased<MONOLITHIC, CHAINED>::addEntry(entry_key* key, const e
       //
     
       int* newt = (int*) realloc(table, newsize * sizeof(int));
-      if (0==newt) {
-        throw error(error::INSUFFICIENT_MEMORY, __FILE__, __LINE__);
-      }
-
-      for (unsigned i=tableSize; i<newsize; i++) newt[i] = 0;
+      if (newt) {
+        for (unsigned i=tableSize; i<newsize; i++) newt[i] = 0;
 
-      MEDDLY_DCASSERT(newsize > tableSize);
-      mstats.incMemUsed( (newsize - tableSize) * sizeof(int) );
-      mstats.incMemAlloc( (newsize - tableSize) * sizeof(int) );
+        MEDDLY_DCASSERT(newsize > tableSize);
+        mstats.incMemUsed( (newsize - tableSize) * sizeof(int) );
+        mstats.incMemAlloc( (newsize - tableSize) * sizeof(int) );
 
-      table = newt;
-      tableSize = newsize;
+        table = newt;
+        tableSize = newsize;
+      }
+      // otherwise, out of memory: keep the table we have
     }
 
     if (tableSize == maxSize) {
       tableExpand = std::numeric_limits<int>::max();
+    } else if (tableSize != newsize) {
+      // Could not grow; don't scan again until the chains are twice as long
+      tableExpand = 2 * MAX(unsigned(perf.numEntries), 4*tableSize);
     } else {
       tableExpand = 4*tableSize;
     }
@@ -934,19 +956,23 @@ void MEDDLY::ct_typebased<MONOLITHIC, CHAINED>::addEntry(entry_key* key, const e
 
     listToTable(list);
   } else {  // not CHAINED
+    int* newt = 0;
     if (newsize != tableSize) {
+      newt = (int*) malloc(newsize * sizeof(int));
+    }
+    if (0==newt && tableSize != maxSize) {
+      // Could not grow (budget, or out of memory); entries will be
+      // replaced on collision, so stop scanning until we can shrink.
+      tableExpand = std::numeric_limits<int>::max();
+    }
+    if (newt) {
       //
       // Enlarge table
       //
       int* oldT = table;
       unsigned oldSize = tableSize;
       tableSize = newsize;
-      table = (int*) malloc(newsize * sizeof(int));
-      if (0==table) {
-        table = oldT;
-        tableSize = oldSize;
-        throw error(error::INSUFFICIENT_MEMORY, __FILE__, __LINE__);
-      }
+      table = newt;
       for (unsigned i=0; i<newsize; i++) table[i] = 0;
 
       mstats.incMemUsed(newsize * sizeof(int));
@@ -988,7 +1014,7 @@ void MEDDLY::ct_typebased<MONOLITHIC, CHAINED>::updateEntry(entry_key* key, cons
   // decrement cache counters for old result,
   //
 
-  const unsigned slots_for_type[] = { 1, 1, 1, 2, 1, 2, 2 };
+  const unsigned slots_for_type[] = { 1, node_slots, 1, 2, 1, 2, 2 };
 
   MEDDLY_DCASSERT(1 == slots_for_type[ERROR]);
   MEDDLY_DCASSERT(1 == slots_for_type[INTEGER]);
@@ -1007,8 +1033,8 @@ void MEDDLY::ct_typebased<MONOLITHIC, CHAINED>::updateEntry(entry_key* key, cons
     MEDDLY_CHECK_RANGE(0, t, 7);
     if (f) {
       MEDDLY_DCASSERT(NODE == t);
-      f->uncacheNode( *ptr );
-      ptr++;
+      f->uncacheNode( readNode(ptr) );
+      ptr += node_slots;
     } else {
       MEDDLY_DCASSERT(NODE != t);
       ptr += slots_for_type[t];
@@ -1048,7 +1074,9 @@ void MEDDLY::ct_typebased<MONOLITHIC, CHAINED>::removeStales()
       //
       // Time to shrink table
       //
-      int newsize = tableSize / 2;
+      unsigned newsize = tableSize / 2;
+      // After a clear, go all the way down
+      while (newsize > 1024 && perf.numEntries < newsize/2) newsize /= 2;
       if (newsize < 1024) newsize = 1024;
       int* newt = (int*) realloc(table, newsize * sizeof(int));
       if (0==newt) {
@@ -1084,6 +1112,8 @@ void MEDDLY::ct_typebased<MONOLITHIC, CHAINED>::removeStales()
       // Time to shrink table
       //
       unsigned newsize = tableSize / 2;
+      // After a clear, go all the way down
+      while (newsize > 1024 && perf.numEntries < newsize/8) newsize /= 2;
       if (newsize < 1024) newsize = 1024;
       if (newsize < tableSize) {
           int* oldT = table;
@@ -1114,6 +1144,27 @@ void MEDDLY::ct_typebased<MONOLITHIC, CHAINED>::removeStales()
       } // if different size
     }
   } // if CHAINED
+
+  // Growth may have been refused near the memory budget; allow it again
+  if (tableSize < maxSize) tableExpand = CHAINED ? 4*tableSize : tableSize/2;
+
+#ifdef INTEGRATED_MEMMAN
+  //
+  // Nothing left (e.g., after removeAll), so give back the entry memory
+  //
+  if (0==perf.numEntries && entriesAlloc > 1024) {
+    int* ne = (int*) realloc(entries, 1024 * sizeof(int));
+    if (ne) {
+      mstats.decMemAlloc( (entriesAlloc - 1024) * sizeof(int) );
+      entries = ne;
+      entriesAlloc = 1024;
+      entriesSize = 1;
+      for (int i=0; i<=maxEntrySize; i++) {
+        freeList[i] = 0;
+      }
+    }
+  }
+#endif
     
 #ifdef DEBUG_REMOVESTALES
   fprintf(stdout, "Done removing CT stales (size %d, entries %lu)\n", 
@@ -1329,7 +1380,7 @@ void MEDDLY::ct_typebased<MONOLITHIC, CHAINED>
       const unsigned reps = (et->isRepeating()) ? unsigned(*entry++) : 0;
       const unsigned klen = et->getKeySize(reps);
 
-      const unsigned slots_for_type[] = { 1, 1, 1, 2, 1, 2, 2 };
+      const unsigned slots_for_type[] = { 1, node_slots, 1, 2, 1, 2, 2 };
 
       MEDDLY_DCASSERT(1 == slots_for_type[ERROR]);
       MEDDLY_DCASSERT(1 == slots_for_type[INTEGER]);
@@ -1348,11 +1399,12 @@ void MEDDLY::ct_typebased<MONOLITHIC, CHAINED>
         et->getKeyType(i, t, ef);
         MEDDLY_CHECK_RANGE(0, t, 7);
         if (f == ef) {
-          if (*entry>0) {
+          const node_handle n = readNode(entry);
+          if (n>0) {
 #ifdef DEBUG_VALIDATE_COUNTS
-            printf("\t%d++\n", *entry);
+            printf("\t%ld++\n", long(n));
 #endif
-            ++counts[ *entry ];
+            ++counts[ n ];
           }
         }
         entry += slots_for_type[t];
@@ -1367,11 +1419,12 @@ void MEDDLY::ct_typebased<MONOLITHIC, CHAINED>
         et->getResultType(i, t, ef);
         MEDDLY_CHECK_RANGE(0, t, 7);
         if (f == ef) {
-          if (*entry>0) {
+          const node_handle n = readNode(entry);
+          if (n>0) {
 #ifdef DEBUG_VALIDATE_COUNTS
-            printf("\t%d++\n", *entry);
+            printf("\t%ld++\n", long(n));
 #endif
-            ++counts[ *entry ];
+            ++counts[ n ];
           }
         }
         entry += slots_for_type[t];
@@ -1636,7 +1689,7 @@ bool MEDDLY::ct_typebased<MONOLITHIC, CHAINED>
   const unsigned klen = et->getKeySize(reps);
 
 
-  const unsigned slots_for_type[] = { 1, 1, 1, 2, 1, 2, 2 };
+  const unsigned slots_for_type[] = { 1, node_slots, 1, 2, 1, 2, 2 };
 
   MEDDLY_DCASSERT(1 == slots_for_type[ERROR]);
   MEDDLY_DCASSERT(1 == slots_for_type[INTEGER]);
@@ -1659,13 +1712,14 @@ bool MEDDLY::ct_typebased<MONOLITHIC, CHAINED>
       printf("\tchecking key item %u\n", i);
 #endif
       MEDDLY_DCASSERT(NODE == t);
-      if (MEDDLY::forest::ACTIVE != f->getNodeStatus(*entry)) {
+      const node_handle n = readNode(entry);
+      if (MEDDLY::forest::ACTIVE != f->getNodeStatus(n)) {
         return YES_stale();
       } else {
         // Indicate that this node is in some cache entry
-        if (mark) f->setCacheBit(*entry);
+        if (mark) f->setCacheBit(n);
       }
-      entry++;
+      entry += node_slots;
     } else {
 #ifdef DEBUG_ISSTALE
       printf("\tskipping key item %u, %u slots\n", i, slots_for_type[t]);
@@ -1689,12 +1743,13 @@ bool MEDDLY::ct_typebased<MONOLITHIC, CHAINED>
       printf("\tchecking result item %u\n", i);
 #endif
       MEDDLY_DCASSERT(NODE == t);
-      if (MEDDLY::forest::ACTIVE != f->getNodeStatus(*entry)) {
+      const node_handle n = readNode(entry);
+      if (MEDDLY::forest::ACTIVE != f->getNodeStatus(n)) {
         return YES_stale();
       } else {
-        if (mark) f->setCacheBit(*entry);
+        if (mark) f->setCacheBit(n);
       }
-      entry++;
+      entry += node_slots;
     } else {
 #ifdef DEBUG_ISSTALE
       printf("\tskipping result item %u, %u slots\n", i, slots_for_type[t]);
@@ -1716,7 +1771,7 @@ bool MEDDLY::ct_typebased<MONOLITHIC, CHAINED>
   MEDDLY_DCASSERT(et);
   MEDDLY_DCASSERT(result);
 
-  const unsigned slots_for_type[] = { 1, 1, 1, 2, 1, 2, 2 };
+  const unsigned slots_for_type[] = { 1, node_slots, 1, 2, 1, 2, 2 };
 
   MEDDLY_DCASSERT(1 == slots_for_type[ERROR]);
   MEDDLY_DCASSERT(1 == slots_for_type[INTEGER]);
@@ -1739,10 +1794,10 @@ bool MEDDLY::ct_typebased<MONOLITHIC, CHAINED>
       printf("\tchecking result item %u\n", i);
 #endif
       MEDDLY_DCASSERT(NODE == t);
-      if (MEDDLY::forest::DEAD == f->getNodeStatus(*result)) {
+      if (MEDDLY::forest::DEAD == f->getNodeStatus(readNode(result))) {
         return true;
       }
-      result++;
+      result += node_slots;
     } else {
 #ifdef DEBUG_ISDEAD
       printf("\tskipping result item %u, %u slots\n", i, slots_for_type[t]);
@@ -1800,7 +1855,7 @@ void MEDDLY::ct_typebased<MONOLITHIC, CHAINED>
   }
 
   /*
-  const unsigned slots_for_type[] = { 1, 1, 1, 2, 1, 2, 2 };
+  const unsigned slots_for_type[] = { 1, node_slots, 1, 2, 1, 2, 2 };
 
   MEDDLY_DCASSERT(1 == slots_for_type[ERROR]);
   MEDDLY_DCASSERT(1 == slots_for_type[INTEGER]);
@@ -1827,8 +1882,8 @@ void MEDDLY::ct_typebased<MONOLITHIC, CHAINED>
     switch (t) {
         case NODE:
                         MEDDLY_DCASSERT(f);
-                        f->uncacheNode( *ptr );
-                        ptr++;
+                        f->uncacheNode( readNode(ptr) );
+                        ptr += node_slots;
                         continue;
         case INTEGER:
         case FLOAT:
@@ -1872,8 +1927,8 @@ void MEDDLY::ct_typebased<MONOLITHIC, CHAINED>
     switch (t) {
         case NODE:
                         MEDDLY_DCASSERT(f);
-                        f->uncacheNode( *ptr );
-                        ptr++;
+                        f->uncacheNode( readNode(ptr) );
+                        ptr += node_slots;
                         continue;
 
         case INTEGER:
@@ -1947,9 +2002,9 @@ void MEDDLY::ct_typebased<MONOLITHIC, CHAINED>
       if (i) s << ", ";
       switch (et->getKeyType(i)) {
         case NODE:
-                        item.N = *ptr;
+                        item.N = readNode(ptr);
                         s.put(long(item.N));
-                        ptr++;
+                        ptr += node_slots;
                         break;
         case INTEGER:
                         item.I = *ptr;
@@ -1986,9 +2041,9 @@ void MEDDLY::ct_typebased<MONOLITHIC, CHAINED>
       if (i) s << ", ";
       switch (et->getResultType(i)) {
         case NODE:
-                        item.N = *ptr;
+                        item.N = readNode(ptr);
                         s.put(long(item.N));
-                        ptr++;
+                        ptr += node_slots;
                         break;
         case INTEGER:
                         item.I = *ptr;
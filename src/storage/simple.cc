@@ -122,6 +122,7 @@ class MEDDLY::simple_separated : public node_storage {
   // required interface
   public:
     virtual void collectGarbage(bool shrink);
+    virtual bool relocateNodes(const node_handle* order, long n);
     virtual void reportStats(output &s, const char* pad, unsigned flags) const;
 
     virtual node_address makeNode(node_handle p, const unpacked_node &nb, 
@@ -158,6 +159,11 @@ class MEDDLY::simple_separated : public node_storage {
   // --------------------------------------------------------
   // |  Misc. helpers.
   private:
+      /// MM->requestChunk(), but if that fails, reclaim memory
+      /// and try once more.
+      ///   @throws INSUFFICIENT_MEMORY if it fails again.
+      node_address requestChunk(size_t &slots);
+
       /// How many int slots would be required for a node with given size.
       ///   @param  sz      Number of downward pointers.
       ///   @param  sparse  True for sparse storage, otherwise full. 
@@ -169,6 +175,13 @@ class MEDDLY::simple_separated : public node_storage {
         MEDDLY_DCASSERT(MM);
         return (node_handle*) MM->getChunkAddress(addr);
       }
+      /// Total number of slots in a node's chunk, including padding.
+      inline size_t chunkSlots(const node_handle* chunk) const {
+        const unsigned int raw_size = getRawSize(chunk);
+        size_t slots = slotsForNode(getSize(raw_size), isSparse(raw_size));
+        if (chunk[slots-1] < 0) slots += (-chunk[slots-1]);
+        return slots;
+      }
       inline static unsigned int getRawSize(const node_handle* chunk) {
         return chunk[size_slot];
       }
@@ -238,6 +251,8 @@ class MEDDLY::simple_separated : public node_storage {
 
   private:
     memory_manager* MM;
+    /// Style of MM, to build a fresh manager when relocating nodes.
+    const memory_manager_style* MMst;
 
     //
     // Header indexes that are fixed
@@ -275,6 +290,7 @@ MEDDLY::simple_separated
 ::simple_separated(const char* n, expert_forest* f, const memory_manager_style* mst)
 : node_storage(n, f)
 {
+  MMst = mst;
   MM = mst->initManager(sizeof(node_handle), slotsForNode(0, false), f->changeMemStats());
 
   unhashed_start = header_slots;
@@ -293,7 +309,104 @@ MEDDLY::simple_separated::~simple_separated()
 
 void MEDDLY::simple_separated::collectGarbage(bool shrink)
 {
-  // TBD
+  //
+  // Copy every stored node, by handle, into fresh memory;
+  // this drops the holes, and gives the old memory back.
+  //
+  const expert_forest* f = getParent();
+  const node_handle last = f->getLastNode();
+  node_handle* order = (node_handle*) malloc((last+1) * sizeof(node_handle));
+  if (0==order) return;
+  long n = 0;
+  for (node_handle p=1; p<=last; p++) {
+    if (!f->isActiveNode(p)) continue;
+    if (0==getNodeAddress(p)) continue;
+    order[n++] = p;
+  }
+  // if this fails, nothing has changed
+  relocateNodes(order, n);
+  free(order);
+}
+
+MEDDLY::node_address MEDDLY::simple_separated::requestChunk(size_t &slots)
+{
+  const size_t slots_req = slots;
+  node_address addr = MM->requestChunk(slots);
+  if (addr) return addr;
+
+  //
+  // Out of memory, or over budget.  Reclaim what we can, and try again.
+  //
+  memory_budget::recover();
+  slots = slots_req;
+  addr = MM->requestChunk(slots);
+  if (0==addr) {
+    throw error(error::INSUFFICIENT_MEMORY, __FILE__, __LINE__);
+  }
+  return addr;
+}
+
+bool MEDDLY::simple_separated::relocateNodes(const node_handle* order, long n)
+{
+  memory_manager* newMM = MMst->initManager(sizeof(node_handle), 
+    slotsForNode(0, false), getParent()->changeMemStats());
+  if (0==newMM) return false;
+
+  node_address* newaddr = (node_address*) malloc(n * sizeof(node_address));
+  if (n && 0==newaddr) {
+    delete newMM;
+    return false;
+  }
+
+  //
+  // Copy the nodes, in order, into the new memory.
+  // Padding is dropped.
+  //
+  for (long i=0; i<n; i++) {
+    const node_handle* chunk = getChunkAddress(
+      getNodeAddress(order[i])
+    );
+    MEDDLY_DCASSERT(chunk);
+    const unsigned int raw_size = getRawSize(chunk);
+    const size_t slots_req = slotsForNode(getSize(raw_size), isSparse(raw_size));
+    size_t slots_given = slots_req;
+    newaddr[i] = newMM->requestChunk(slots_given);
+    if (0==newaddr[i]) {
+      //
+      // Out of memory; undo
+      //
+      if (newMM->mustRecycleManually()) {
+        for (long j=0; j<i; j++) {
+          newMM->recycleChunk(newaddr[j], chunkSlots(
+            (node_handle*) newMM->getChunkAddress(newaddr[j])
+          ));
+        }
+      }
+      free(newaddr);
+      delete newMM;
+      return false;
+    }
+    MEDDLY_DCASSERT(slots_given >= slots_req);
+    node_handle* newchunk = (node_handle*) newMM->getChunkAddress(newaddr[i]);
+    memcpy(newchunk, chunk, (slots_req-1) * sizeof(node_handle));
+    newchunk[slots_req-1] = -long(slots_given - slots_req);
+    newchunk[slots_given-1] = order[i];
+  }
+
+  //
+  // Switch over
+  //
+  for (long i=0; i<n; i++) {
+    node_address old = getNodeAddress(order[i]);
+    if (MM->mustRecycleManually()) {
+      MM->recycleChunk(old, chunkSlots(getChunkAddress(old)));
+    }
+    moveNodeOffset(order[i], old, newaddr[i]);
+  }
+  free(newaddr);
+  delete MM;
+  MM = newMM;
+  return true;
 }
 
 void MEDDLY::simple_separated::reportStats(output &s, const char* pad, 
@@ -709,7 +822,7 @@ void MEDDLY::simple_separated
     const node_handle* index = down + nnz;
     const node_handle* edge = slots_per_edge ? (index + nnz) : 0;
     const int ext_i = index[nnz-1];
-    const int ext_d = is_extensible? down[nnz-1]: tv;
+    const node_handle ext_d = is_extensible? down[nnz-1]: tv;
     const void* ext_ptr = is_extensible? (edge + (nnz-1)*slots_per_edge): 0;
 
     if (nr.isFull()) {
@@ -792,7 +905,7 @@ void MEDDLY::simple_separated
       if (unpacked_node::AS_STORED == st2 && is_extensible == nr.isExtensible()) {
         nr.shrinkFull(size);
       } else {
-        const int ext_d = is_extensible? down[size-1]: tv;
+        const node_handle ext_d = is_extensible? down[size-1]: tv;
         const void* ext_ptr = is_extensible? (edge + (size-1)*slots_per_edge): 0;
         for (; i<unsigned(nr.getSize()); i++) {
           nr.d_ref(i) = ext_d;
@@ -823,7 +936,7 @@ void MEDDLY::simple_separated
         MEDDLY_DCASSERT(is_extensible);
         MEDDLY_DCASSERT(!nr.isExtensible());
         const int ext_i = size-1;
-        const int ext_d = down[ext_i];
+        const node_handle ext_d = down[ext_i];
         const void* ext_ptr = (edge + (ext_i)*slots_per_edge);
         for (int i = ext_i + 1 ; z<nr.getNNZs(); z++, i++) {
           nr.i_ref(z) = i;
@@ -1404,10 +1517,7 @@ MEDDLY::node_address MEDDLY::simple_separated
   size_t slots_req = slotsForNode(size, false);
   MEDDLY_DCASSERT(slots_req > 0);
   size_t slots_given = slots_req;
-  node_address addr = MM->requestChunk(slots_given);
-  if (0==addr) {
-    throw error(error::INSUFFICIENT_MEMORY, __FILE__, __LINE__);
-  }
+  node_address addr = requestChunk(slots_given);
   MEDDLY_DCASSERT(slots_given >= slots_req);
 
   node_handle* chunk = getChunkAddress(addr);
@@ -1442,6 +1552,8 @@ MEDDLY::node_address MEDDLY::simple_separated
       MEDDLY_DCASSERT(nb.hasEdges());
       char* edge = (char*) (down + size); 
       int edge_bytes = bytesForSlots(slots_per_edge);
+      // Edge values are padded to whole slots; clear the padding
+      if (edge_bytes != int(nb.edgeBytes())) memset(edge, 0, size * edge_bytes);
       if (nb.isSparse()) {
         for (int i=0; i<size; i++) {
           getParent()->getTransparentEdge(down[i], edge + i * edge_bytes);
@@ -1450,12 +1562,18 @@ MEDDLY::node_address MEDDLY::simple_separated
           int i = nb.i(z);
           MEDDLY_CHECK_RANGE(0, i, size);
           down[i] = nb.d(z);
-          memcpy(edge + i * edge_bytes, nb.eptr(z), edge_bytes);
+          memcpy(edge + i * edge_bytes, nb.eptr(z), nb.edgeBytes());
         }
       } else {
         for (int i=0; i<size; i++) down[i] = nb.d(i);
-        // kinda hacky
-        memcpy(edge, nb.eptr(0), size * edge_bytes);
+        if (edge_bytes == int(nb.edgeBytes())) {
+          // kinda hacky
+          memcpy(edge, nb.eptr(0), size * edge_bytes);
+        } else {
+          for (int z=0; z<size; z++) {
+            memcpy(edge + z * edge_bytes, nb.eptr(z), nb.edgeBytes());
+          }
+        }
       }
   } else {
       //
@@ -1523,10 +1641,7 @@ MEDDLY::node_address MEDDLY::simple_separated
   size_t slots_req = slotsForNode(size, true);
   MEDDLY_DCASSERT(slots_req > 0);
   size_t slots_given = slots_req;
-  node_address addr = MM->requestChunk(slots_given);
-  if (0==addr) {
-    throw error(error::INSUFFICIENT_MEMORY, __FILE__, __LINE__);
-  }
+  node_address addr = requestChunk(slots_given);
   MEDDLY_DCASSERT(slots_given >= slots_req);
 
   node_handle* chunk = getChunkAddress(addr);
@@ -1563,13 +1678,21 @@ MEDDLY::node_address MEDDLY::simple_separated
       MEDDLY_DCASSERT(nb.hasEdges());
       char* edge = (char*) (index + size); 
       int edge_bytes = bytesForSlots(slots_per_edge);
+      // Edge values are padded to whole slots; clear the padding
+      if (edge_bytes != int(nb.edgeBytes())) memset(edge, 0, size * edge_bytes);
       if (nb.isSparse()) {
         for (int z=0; z<size; z++) {
           down[z] = nb.d(z);
           index[z] = nb.i(z);
         }
-        // kinda hacky
-        memcpy(edge, nb.eptr(0), size * edge_bytes);
+        if (edge_bytes == int(nb.edgeBytes())) {
+          // kinda hacky
+          memcpy(edge, nb.eptr(0), size * edge_bytes);
+        } else {
+          for (int z=0; z<size; z++) {
+            memcpy(edge + z * edge_bytes, nb.eptr(z), nb.edgeBytes());
+          }
+        }
       } else {
         int z = 0;
         for (int i=0; i<nb.getSize(); i++) {
@@ -1577,7 +1700,7 @@ MEDDLY::node_address MEDDLY::simple_separated
           MEDDLY_CHECK_RANGE(0, z, size);
           down[z] = nb.d(i);
           index[z] = i;
-          memcpy(edge + z * edge_bytes, nb.eptr(i), edge_bytes);
+          memcpy(edge + z * edge_bytes, nb.eptr(i), nb.edgeBytes());
           z++;
         }
         MEDDLY_DCASSERT(size == z);
@@ -167,7 +167,7 @@ void MEDDLY::unique_table::subtable::show(output &s) const
   for (unsigned i=0; i < size; i++) {
     if(table[i] != 0) {
       s << "[" << long(i) << "] : ";
-      for (int index = table[i]; index; index = parent->getNext(index)) {
+      for (node_handle index = table[i]; index; index = parent->getNext(index)) {
         s << index <<" ";
       }
       s.put("\n");
@@ -59,10 +59,10 @@ private:
 
             Class T must have the following methods:
               unsigned hash():    return the hash value for this item.
-              bool equals(int p): return true iff this item equals node p.
+              bool equals(node_handle p): return true iff this item equals node p.
      */
     template <typename T>
-    int find(const T &key) const;
+    node_handle find(const T &key) const;
 
     /** Add the item to the front of the list.
             Used when we KNOW that the item is not in the unique table already.
@@ -73,7 +73,7 @@ private:
           I.e., the exact key.
           Otherwise, return 0.
      */
-    int remove(unsigned hash, node_handle item);
+    node_handle remove(unsigned hash, node_handle item);
 
     /**
      * Remove all the items in the table and reset the state.
@@ -137,7 +137,7 @@ public:
 
         Class T must have the following methods:
           unsigned hash():    return the hash value for this item.
-          bool equals(int p): return true iff this item equals node p.
+          bool equals(node_handle p): return true iff this item equals node p.
    */
   template <typename T>
   node_handle find(const T &key, int var) const;
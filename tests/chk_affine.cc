@@ -0,0 +1,175 @@
+
+/*
+    Meddly: Multi-terminal and Edge-valued Decision Diagram LibrarY.
+    Copyright (C) 2009, Iowa State University Research Foundation, Inc.
+
+    This library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/*
+    Tests affine_relation_node in implicit saturation.
+    The Kanban model is built twice as an implicit relation:
+    once with user-derived relation nodes, as in the examples,
+    and once with affine pieces.  Saturation must give the
+    same reachability set, in the same forest, for both.
+*/
+
+#include <cstdlib>
+#include <cstdio>
+
+#include "../src/meddly.h"
+#include "../src/meddly_expert.h"
+
+// token_update values and the bottom handle, as in sat_impl.cc
+#define NOT_KNOWN     -2
+#define OUT_OF_BOUNDS -1
+#define TERMINAL_NODE 1
+
+const int PLACES = 16;
+const int TRANS = 16;
+
+const int kanban[TRANS][PLACES+1] = {
+  {0,-1,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0},     // Tin1
+  {0,0,-1,1,0,0,0,0,0,0,0,0,0,0,0,0,0},     // Tr1
+  {0,0,1,-1,0,0,0,0,0,0,0,0,0,0,0,0,0},     // Tb1
+  {0,0,-1,0,1,0,0,0,0,0,0,0,0,0,0,0,0},     // Tg1
+  {0,0,0,0,0,0,-1,1,0,0,0,0,0,0,0,0,0},     // Tr2
+  {0,0,0,0,0,0,1,-1,0,0,0,0,0,0,0,0,0},     // Tb2
+  {0,0,0,0,0,0,-1,0,1,0,0,0,0,0,0,0,0},     // Tg2
+  {0,1,0,0,-1,-1,1,0,0,-1,1,0,0,0,0,0,0},   // Ts1_23
+  {0,0,0,0,0,0,0,0,0,0,-1,1,0,0,0,0,0},     // Tr3
+  {0,0,0,0,0,0,0,0,0,0,1,-1,0,0,0,0,0},     // Tb3
+  {0,0,0,0,0,0,0,0,0,0,-1,0,1,0,0,0,0},     // Tg3
+  {0,0,0,0,0,1,0,0,-1,1,0,0,-1,-1,1,0,0},   // Ts23_4
+  {0,0,0,0,0,0,0,0,0,0,0,0,0,0,-1,1,0},     // Tr4
+  {0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,-1,0},     // Tb4
+  {0,0,0,0,0,0,0,0,0,0,0,0,0,1,0,0,-1},     // Tout4
+  {0,0,0,0,0,0,0,0,0,0,0,0,0,0,-1,0,1}      // Tg4
+};
+
+using namespace MEDDLY;
+
+/// A piece that adds delta tokens, written the way users do.
+class derived_node : public relation_node {
+    long delta;
+  public:
+    derived_node(int level, rel_node_handle down, long d)
+      : relation_node(size_t(level)*1000 + size_t(down)*10 + size_t(d+1),
+          level, down)
+    {
+      delta = d;
+    }
+    virtual long nextOf(long i) {
+      if (i>=getPieceSize()) expandTokenUpdate(i);
+      if (getTokenUpdate()[i]==NOT_KNOWN) {
+        long result = i+delta;
+        setTokenUpdateAtIndex(i, result>=0 ? result : OUT_OF_BOUNDS);
+      }
+      return getTokenUpdate()[i];
+    }
+    virtual bool equals(const relation_node* n) const {
+      const derived_node* dn = dynamic_cast<const derived_node*>(n);
+      return dn && relation_node::equals(n) && (dn->delta == delta);
+    }
+};
+
+/// Build the relation from the model, bottom up.
+void buildRelation(bool affine, satimpl_opname::implicit_relation* T)
+{
+  for (int e=0; e<TRANS; e++) {
+    int top = 0;
+    for (int p=1; p<=PLACES; p++) {
+      if (kanban[e][p]) top = p;
+    }
+    rel_node_handle below = TERMINAL_NODE;
+    for (int p=1; p<=PLACES; p++) {
+      const long delta = kanban[e][p];
+      if (0==delta) continue;
+      relation_node* n;
+      if (affine) {
+        n = new affine_relation_node(p, below, delta, delta<0 ? -delta : 0);
+      } else {
+        n = new derived_node(p, below, delta);
+      }
+      below = T->registerNode(p==top, n);
+    }
+  }
+}
+
+bool check(int N, long expected)
+{
+  printf("Kanban, N=%d\n", N);
+
+  int sizes[PLACES];
+  for (int i=0; i<PLACES; i++) sizes[i] = 2;
+  domain* d = createDomainBottomUp(sizes, PLACES);
+  forest::policies p(false);
+  p.setPessimistic();
+  forest* mdd = d->createForest(0, forest::BOOLEAN, forest::MULTI_TERMINAL, p);
+  forest* rel = d->createForest(0, forest::BOOLEAN, forest::MULTI_TERMINAL, p);
+
+  expert_domain* ed = static_cast<expert_domain*>(d);
+  ed->enlargeVariableBound(1, false, N+1);
+  ed->enlargeVariableBound(5, false, N+1);
+  ed->enlargeVariableBound(9, false, N+1);
+  ed->enlargeVariableBound(13, false, N+1);
+
+  int* initial = new int[PLACES+1];
+  for (int i=0; i<=PLACES; i++) initial[i] = 0;
+  initial[1] = initial[5] = initial[9] = initial[13] = N;
+  dd_edge first(mdd);
+  mdd->createEdge(&initial, 1, first);
+  delete[] initial;
+
+  dd_edge reachable[2] = { dd_edge(mdd), dd_edge(mdd) };
+  const char* name[2] = { "derived", "affine" };
+  bool ok = true;
+  for (int a=0; a<2; a++) {
+    satimpl_opname::implicit_relation* T
+      = new satimpl_opname::implicit_relation(mdd, rel, mdd);
+    buildRelation(a, T);
+    specialized_operation* sat = SATURATION_IMPL_FORWARD->buildOperation(T);
+    sat->compute(first, reachable[a]);
+    destroyOperation(sat);
+
+    double c;
+    apply(CARDINALITY, reachable[a], c);
+    printf("\t%-8s %g states\n", name[a], c);
+    if (expected && long(c) != expected) {
+      printf("\tWrong number of states, expected %ld\n", expected);
+      ok = false;
+    }
+  }
+  if (reachable[0] != reachable[1]) {
+    printf("\tReachability sets differ\n");
+    ok = false;
+  }
+  destroyDomain(d);
+  return ok;
+}
+
+int main()
+{
+  MEDDLY::initialize();
+
+  if (!check(1, 160)) return 1;
+  if (!check(3, 58400)) return 1;
+  if (!check(5, 2546432)) return 1;
+  if (!check(20, 0)) return 1;
+
+  MEDDLY::cleanup();
+  printf("Done\n");
+  return 0;
+}
@@ -0,0 +1,151 @@
+
+/*
+    Meddly: Multi-terminal and Edge-valued Decision Diagram LibrarY.
+    Copyright (C) 2009, Iowa State University Research Foundation, Inc.
+
+    This library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/*
+    Tests BFS_FORWARD and CHAINED_BFS_FORWARD.
+    On the Kanban model, with the relation partitioned by events
+    and by levels, both must give the same reachability set
+    as SATURATION_FORWARD and as REACHABLE_STATES_BFS.
+*/
+
+#include <cstdlib>
+#include <cstdio>
+
+#include "../src/meddly.h"
+#include "../src/meddly_expert.h"
+#include "simple_model.h"
+
+const char* kanban[] = {
+  "X-+..............",  // Tin1
+  "X.-+.............",  // Tr1
+  "X.+-.............",  // Tb1
+  "X.-.+............",  // Tg1
+  "X.....-+.........",  // Tr2
+  "X.....+-.........",  // Tb2
+  "X.....-.+........",  // Tg2
+  "X+..--+..-+......",  // Ts1_23
+  "X.........-+.....",  // Tr3
+  "X.........+-.....",  // Tb3
+  "X.........-.+....",  // Tg3
+  "X....+..-+..--+..",  // Ts23_4
+  "X.............-+.",  // Tr4
+  "X.............+-.",  // Tb4
+  "X............+..-",  // Tout4
+  "X.............-.+"   // Tg4
+};
+
+const int EVENTS = 16;
+const int VARS = 16;
+
+using namespace MEDDLY;
+
+/// Reachable states with a pregen operation, by events or by levels.
+void reach(const satpregen_opname* op, bool byEvents, forest* mdd,
+  forest* mxd, const dd_edge* events, const dd_edge &init, dd_edge &reachable)
+{
+  satpregen_opname::pregen_relation* ensf = byEvents
+    ? new satpregen_opname::pregen_relation(mdd, mxd, mdd, EVENTS)
+    : new satpregen_opname::pregen_relation(mdd, mxd, mdd);
+  for (int e=0; e<EVENTS; e++) {
+    ensf->addToRelation(events[e]);
+  }
+  ensf->finalize();
+  specialized_operation* sat = op->buildOperation(ensf);
+  sat->compute(init, reachable);
+  destroyOperation(sat);
+}
+
+bool check(int N, long expected)
+{
+  printf("Kanban, N=%d\n", N);
+
+  int sizes[VARS];
+  for (int i=0; i<VARS; i++) sizes[i] = N+1;
+  domain* d = createDomainBottomUp(sizes, VARS);
+  forest* mdd = d->createForest(0, forest::BOOLEAN, forest::MULTI_TERMINAL);
+  forest* mxd = d->createForest(1, forest::BOOLEAN, forest::MULTI_TERMINAL);
+
+  int* initial = new int[VARS+1];
+  for (int i=0; i<=VARS; i++) initial[i] = 0;
+  initial[1] = initial[5] = initial[9] = initial[13] = N;
+  dd_edge init(mdd);
+  mdd->createEdge(&initial, 1, init);
+  delete[] initial;
+
+  dd_edge events[EVENTS] = {
+    dd_edge(mxd), dd_edge(mxd), dd_edge(mxd), dd_edge(mxd),
+    dd_edge(mxd), dd_edge(mxd), dd_edge(mxd), dd_edge(mxd),
+    dd_edge(mxd), dd_edge(mxd), dd_edge(mxd), dd_edge(mxd),
+    dd_edge(mxd), dd_edge(mxd), dd_edge(mxd), dd_edge(mxd)
+  };
+  dd_edge nsf(mxd);
+  for (int e=0; e<EVENTS; e++) {
+    buildNextStateFunction(kanban+e, 1, mxd, events[e]);
+    apply(UNION, nsf, events[e], nsf);
+  }
+
+  dd_edge sat(mdd), bfs(mdd);
+  reach(SATURATION_FORWARD, true, mdd, mxd, events, init, sat);
+  apply(REACHABLE_STATES_BFS, init, nsf, bfs);
+  long c;
+  apply(CARDINALITY, sat, c);
+  printf("\tsaturation: %ld states\n", c);
+  bool ok = true;
+  if (c != expected) {
+    printf("\tWrong number of states, expected %ld\n", expected);
+    ok = false;
+  }
+  if (bfs != sat) {
+    printf("\tREACHABLE_STATES_BFS differs\n");
+    ok = false;
+  }
+
+  const satpregen_opname* ops[2] = { BFS_FORWARD, CHAINED_BFS_FORWARD };
+  const char* name[2] = { "BFS_FORWARD", "CHAINED_BFS_FORWARD" };
+  for (int o=0; o<2; o++) {
+    for (int byEvents=1; byEvents>=0; byEvents--) {
+      dd_edge r(mdd);
+      reach(ops[o], byEvents, mdd, mxd, events, init, r);
+      apply(CARDINALITY, r, c);
+      printf("\t%-20s by %-6s: %ld states\n", name[o],
+        byEvents ? "events" : "levels", c);
+      if (r != sat) {
+        printf("\tDiffers from saturation\n");
+        ok = false;
+      }
+    }
+  }
+
+  destroyDomain(d);
+  return ok;
+}
+
+int main()
+{
+  MEDDLY::initialize();
+
+  if (!check(1, 160)) return 1;
+  if (!check(2, 4600)) return 1;
+  if (!check(3, 58400)) return 1;
+
+  MEDDLY::cleanup();
+  printf("Done\n");
+  return 0;
+}
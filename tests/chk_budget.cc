@@ -0,0 +1,142 @@
+
+/*
+    Meddly: Multi-terminal and Edge-valued Decision Diagram LibrarY.
+    Copyright (C) 2009, Iowa State University Research Foundation, Inc.
+
+    This library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published 
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+    Tests the memory budget:
+    the Kanban reachability set is built again with a budget
+    below the memory used the first time,
+    and then with a budget that is much too small.
+*/
+
+#include <cstdlib>
+#include <cstdio>
+
+#include "../src/meddly.h"
+#include "../src/meddly_expert.h"
+#include "simple_model.h"
+
+const char* kanban[] = {
+  "X-+..............",  // Tin1
+  "X.-+.............",  // Tr1
+  "X.+-.............",  // Tb1
+  "X.-.+............",  // Tg1
+  "X.....-+.........",  // Tr2
+  "X.....+-.........",  // Tb2
+  "X.....-.+........",  // Tg2
+  "X+..--+..-+......",  // Ts1_23
+  "X.........-+.....",  // Tr3
+  "X.........+-.....",  // Tb3
+  "X.........-.+....",  // Tg3
+  "X....+..-+..--+..",  // Ts23_4
+  "X.............-+.",  // Tr4
+  "X.............+-.",  // Tb4
+  "X............+..-",  // Tout4
+  "X.............-.+"   // Tg4
+};
+
+const int N = 6;
+const long expected = 11261376;
+
+using namespace MEDDLY;
+
+/// Build the reachability set; returns the number of states.
+long buildReachset()
+{
+  int sizes[16];
+  for (int i=15; i>=0; i--) sizes[i] = N+1;
+  domain* d = createDomainBottomUp(sizes, 16);
+
+  int* initial = new int[17];
+  for (int i=16; i; i--) initial[i] = 0;
+  initial[1] = initial[5] = initial[9] = initial[13] = N;
+  forest* mdd = d->createForest(0, forest::BOOLEAN, forest::MULTI_TERMINAL);
+  dd_edge init_state(mdd);
+  mdd->createEdge(&initial, 1, init_state);
+  delete[] initial;
+
+  forest* mxd = d->createForest(1, forest::BOOLEAN, forest::MULTI_TERMINAL);
+  dd_edge nsf(mxd);
+  buildNextStateFunction(kanban, 16, mxd, nsf); 
+
+  //
+  // Breadth-first, one apply() per step, so the budget
+  // is checked between steps.
+  //
+  dd_edge reachable(init_state);
+  dd_edge front(init_state);
+  dd_edge next(mdd);
+  dd_edge empty(mdd);
+  while (!(front == empty)) {
+    apply(POST_IMAGE, front, nsf, next);
+    apply(DIFFERENCE, next, reachable, front);
+    apply(UNION, reachable, front, reachable);
+  }
+
+  long c;
+  apply(CARDINALITY, reachable, c);
+
+  destroyDomain(d);
+  return c;
+}
+
+int main()
+{
+  MEDDLY::initialize();
+
+  printf("No budget: ");
+  fflush(stdout);
+  long c = buildReachset();
+  size_t peak = memstats::getGlobalPeakMemAlloc();
+  printf("%ld states, peak memory %lu bytes\n", c, (unsigned long) peak);
+  if (c != expected) {
+    printf("Wrong number of states!\n");
+    return 1;
+  }
+
+  setMemoryBudget(peak / 2);
+  printf("Budget %lu bytes: ", (unsigned long) (peak / 2));
+  fflush(stdout);
+  c = buildReachset();
+  printf("%ld states\n", c);
+  if (c != expected) {
+    printf("Wrong number of states!\n");
+    return 1;
+  }
+
+  setMemoryBudget(peak / 100);
+  printf("Budget %lu bytes: ", (unsigned long) (peak / 100));
+  fflush(stdout);
+  try {
+    c = buildReachset();
+    printf("%ld states; expected to run out of memory!\n", c);
+    return 1;
+  }
+  catch (error e) {
+    if (e.getCode() != error::INSUFFICIENT_MEMORY) {
+      printf("unexpected error %s\n", e.getName());
+      return 1;
+    }
+    printf("out of memory, as expected\n");
+  }
+  setMemoryBudget(0);
+  MEDDLY::cleanup();
+
+  printf("Done\n");
+  return 0;
+}
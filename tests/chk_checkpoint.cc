@@ -0,0 +1,128 @@
+
+/*
+    Meddly: Multi-terminal and Edge-valued Decision Diagram LibrarY.
+    Copyright (C) 2011, Iowa State University Research Foundation, Inc.
+
+    This library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published 
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+    Tests checkpoints for saturation:
+    builds the Kanban reachability set while writing checkpoints,
+    then resumes from the last checkpoint and compares.
+*/
+
+#include <cstdlib>
+#include <cstdio>
+
+#include "../src/meddly.h"
+#include "../src/meddly_expert.h"
+#include "simple_model.h"
+
+const char* kanban[] = {
+  "X-+..............",  // Tin1
+  "X.-+.............",  // Tr1
+  "X.+-.............",  // Tb1
+  "X.-.+............",  // Tg1
+  "X.....-+.........",  // Tr2
+  "X.....+-.........",  // Tb2
+  "X.....-.+........",  // Tg2
+  "X+..--+..-+......",  // Ts1_23
+  "X.........-+.....",  // Tr3
+  "X.........+-.....",  // Tb3
+  "X.........-.+....",  // Tg3
+  "X....+..-+..--+..",  // Ts23_4
+  "X.............-+.",  // Tr4
+  "X.............+-.",  // Tb4
+  "X............+..-",  // Tout4
+  "X.............-.+"   // Tg4
+};
+
+const int N = 2;
+const long expected = 4600;
+const char* ckfile = "chk_checkpoint.ckpt";
+
+using namespace MEDDLY;
+
+specialized_operation* buildSaturation(forest* mdd, forest* mxd,
+  const dd_edge &nsf)
+{
+  // The relation is destroyed along with the operation
+  satpregen_opname::pregen_relation* ensf 
+    = new satpregen_opname::pregen_relation(mdd, mxd, mdd);
+  ensf->addToRelation(nsf);
+  ensf->finalize();
+  return SATURATION_FORWARD->buildOperation(ensf);
+}
+
+int main()
+{
+  MEDDLY::initialize();
+
+  int sizes[16];
+  for (int i=15; i>=0; i--) sizes[i] = N+1;
+  domain* d = createDomainBottomUp(sizes, 16);
+
+  int* initial = new int[17];
+  for (int i=16; i; i--) initial[i] = 0;
+  initial[1] = initial[5] = initial[9] = initial[13] = N;
+  forest* mdd = d->createForest(0, forest::BOOLEAN, forest::MULTI_TERMINAL);
+  dd_edge init_state(mdd);
+  mdd->createEdge(&initial, 1, init_state);
+  delete[] initial;
+
+  forest* mxd = d->createForest(1, forest::BOOLEAN, forest::MULTI_TERMINAL);
+  dd_edge nsf(mxd);
+  buildNextStateFunction(kanban, 16, mxd, nsf); 
+
+  remove(ckfile);
+
+  printf("Building reachability set with checkpoints\n");
+  specialized_operation* sat = buildSaturation(mdd, mxd, nsf);
+  sat->enableCheckpoints(ckfile, 0);
+  dd_edge reachable(mdd);
+  sat->compute(init_state, reachable);
+  destroyOperation(sat);
+
+  long c;
+  apply(CARDINALITY, reachable, c);
+  printf("%12ld states\n", c);
+  if (c != expected) {
+    printf("Wrong number of states!\n");
+    return 1;
+  }
+
+  FILE* ck = fopen(ckfile, "r");
+  if (0==ck) {
+    printf("No checkpoint written!\n");
+    return 1;
+  }
+  fclose(ck);
+
+  printf("Resuming from checkpoint\n");
+  sat = buildSaturation(mdd, mxd, nsf);
+  dd_edge resumed(mdd);
+  sat->resume(ckfile, resumed);
+  destroyOperation(sat);
+  remove(ckfile);
+
+  if (resumed != reachable) {
+    printf("Resumed reachability set differs!\n");
+    return 1;
+  }
+
+  MEDDLY::cleanup();
+  printf("Done\n");
+  return 0;
+}
@@ -0,0 +1,178 @@
+
+/*
+    Meddly: Multi-terminal and Edge-valued Decision Diagram LibrarY.
+    Copyright (C) 2009, Iowa State University Research Foundation, Inc.
+
+    This library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published 
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+    Tests the transitive closure operations on relations,
+    using a counter (a relation with a long diameter).
+*/
+
+#include <cstdlib>
+#include <cstdio>
+
+#include "../src/meddly.h"
+
+const int VARS = 4;
+const int BASE = 4;
+const int STATES = 256;   // BASE^VARS
+
+using namespace MEDDLY;
+
+void setDigits(int x, int* m)
+{
+  for (int k=1; k<=VARS; k++) {
+    m[k] = x % BASE;
+    x /= BASE;
+  }
+}
+
+/// Relation x -> x+d, for all x with x+d < STATES.
+void buildShift(forest* mxd, int d, dd_edge &e)
+{
+  int N = STATES - d;
+  int** from = new int*[N];
+  int** to = new int*[N];
+  for (int x=0; x<N; x++) {
+    from[x] = new int[VARS+1];
+    to[x] = new int[VARS+1];
+    setDigits(x, from[x]);
+    setDigits(x+d, to[x]);
+  }
+  mxd->createEdge(from, to, N, e);
+  for (int x=0; x<N; x++) {
+    delete[] from[x];
+    delete[] to[x];
+  }
+  delete[] from;
+  delete[] to;
+}
+
+/// Random relation with n pairs; also returns the size of its closure.
+void buildRandom(forest* mxd, int n, dd_edge &e, double &closed)
+{
+  static bool M[STATES][STATES];
+  for (int x=0; x<STATES; x++)
+    for (int y=0; y<STATES; y++)
+      M[x][y] = false;
+
+  int** from = new int*[n];
+  int** to = new int*[n];
+  for (int i=0; i<n; i++) {
+    int x = rand() % STATES;
+    int y = rand() % STATES;
+    M[x][y] = true;
+    from[i] = new int[VARS+1];
+    to[i] = new int[VARS+1];
+    setDigits(x, from[i]);
+    setDigits(y, to[i]);
+  }
+  mxd->createEdge(from, to, n, e);
+  for (int i=0; i<n; i++) {
+    delete[] from[i];
+    delete[] to[i];
+  }
+  delete[] from;
+  delete[] to;
+
+  // Warshall
+  for (int z=0; z<STATES; z++)
+    for (int x=0; x<STATES; x++) if (M[x][z])
+      for (int y=0; y<STATES; y++) if (M[z][y])
+        M[x][y] = true;
+  closed = 0;
+  for (int x=0; x<STATES; x++)
+    for (int y=0; y<STATES; y++)
+      if (M[x][y]) closed++;
+}
+
+bool checkClosure(const char* what, const dd_edge &R, double expected)
+{
+  dd_edge sq(R.getForest()), sat(R.getForest());
+  apply(TRANSITIVE_CLOSURE_SQUARE, R, sq);
+  apply(TRANSITIVE_CLOSURE_SAT, R, sat);
+
+  double csq, csat;
+  apply(CARDINALITY, sq, csq);
+  apply(CARDINALITY, sat, csat);
+  printf("%s: squaring %g pairs, saturation %g pairs\n", what, csq, csat);
+  if (csq != expected) {
+    printf("Wrong closure by squaring, expected %g pairs\n", expected);
+    return false;
+  }
+  if (sat != sq) {
+    printf("Closures differ!\n");
+    return false;
+  }
+  return true;
+}
+
+int main()
+{
+  MEDDLY::initialize();
+
+  int sizes[VARS];
+  for (int i=0; i<VARS; i++) sizes[i] = BASE;
+  domain* d = createDomainBottomUp(sizes, VARS);
+  forest* mxd = d->createForest(1, forest::BOOLEAN, forest::MULTI_TERMINAL);
+
+  dd_edge next(mxd), ident(mxd);
+  buildShift(mxd, 1, next);
+  buildShift(mxd, 0, ident);
+
+  // x < y
+  if (!checkClosure("x+1", next, STATES * (STATES-1) / 2)) return 1;
+
+  // x <= y
+  dd_edge both(next);
+  both += ident;
+  if (!checkClosure("x+1 or x", both, STATES * (STATES+1) / 2)) return 1;
+
+  // the identity is already closed
+  if (!checkClosure("x", ident, STATES)) return 1;
+
+  // random relations, with parts at every level
+  srand(12345);
+  for (int i=0; i<10; i++) {
+    dd_edge r(mxd);
+    double closed;
+    buildRandom(mxd, 20 + 30*i, r, closed);
+    if (!checkClosure("random", r, closed)) return 1;
+  }
+
+  // fully-reduced relations are not supported
+  forest::policies fp(true);
+  fp.setFullyReduced();
+  forest* fmxd = d->createForest(1, forest::BOOLEAN, forest::MULTI_TERMINAL, fp);
+  try {
+    dd_edge f(fmxd), c(fmxd);
+    apply(TRANSITIVE_CLOSURE_SAT, f, c);
+    printf("Fully-reduced relation was not rejected\n");
+    return 1;
+  }
+  catch (MEDDLY::error e) {
+    if (e.getCode() != error::NOT_IMPLEMENTED) {
+      printf("Unexpected error: %s\n", e.getName());
+      return 1;
+    }
+  }
+
+  destroyDomain(d);
+  MEDDLY::cleanup();
+  printf("Done\n");
+  return 0;
+}
@@ -0,0 +1,181 @@
+
+/*
+    Meddly: Multi-terminal and Edge-valued Decision Diagram LibrarY.
+    Copyright (C) 2009, Iowa State University Research Foundation, Inc.
+
+    This library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published 
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/*
+    Tests the cofactor, restrict and constrain operations,
+    on sets and relations, against results computed explicitly.
+    Cofactors are also checked with a non-default variable order.
+*/
+
+#include <cstdlib>
+#include <cstdio>
+
+#include "../src/meddly.h"
+#include "../src/meddly_expert.h"
+#include "small_domain.h"
+
+using namespace MEDDLY;
+
+/// Replace the digits of x that have a value in v.
+int assign(int x, const int* v)
+{
+  int y = 0;
+  int place = 1;
+  for (int k=1; k<=VARS; k++) {
+    y += place * ((v[k] == DONT_CARE) ? digit(x, k) : v[k]);
+    place *= BASE;
+  }
+  return y;
+}
+
+//
+// Explicit cofactor, for the current predicate and assignment
+//
+predicate cof_f;
+int cof_u[VARS+1];
+int cof_p[VARS+1];
+
+bool cofactored(int x, int y)
+{
+  return cof_f(assign(x, cof_u), assign(y, cof_p));
+}
+
+void setValues(const char* vals, int* v)
+{
+  v[0] = DONT_CARE;
+  for (int k=1; k<=VARS; k++) {
+    v[k] = ('-' == vals[k-1]) ? DONT_CARE : vals[k-1] - '0';
+  }
+}
+
+/**
+    Cofactor f and compare with the explicit result.
+    uvals and pvals give the values for variables 1, 2, 3,
+    with '-' for free variables.
+*/
+bool checkCofactor(forest* F, predicate f, const char* uvals,
+  const char* pvals)
+{
+  cof_f = f;
+  setValues(uvals, cof_u);
+  setValues(pvals, cof_p);
+
+  dd_edge a(F), c(F), expected(F);
+  build(F, f, a);
+  build(F, cofactored, expected);
+
+  specialized_operation* op = COFACTOR->buildOperation(
+    new cofactor_opname::cofactor_args(F, cof_u,
+      F->isForRelations() ? cof_p : 0)
+  );
+  op->compute(a, c);
+  destroyOperation(op);
+
+  double card;
+  apply(CARDINALITY, c, card);
+  printf("%s cofactor [%s] [%s]: %g\n",
+    F->isForRelations() ? "relation" : "set", uvals, pvals, card);
+  if (c != expected) {
+    printf("Mismatch with explicit cofactor\n");
+    return false;
+  }
+  return true;
+}
+
+/**
+    Restrict and constrain f to care set g; the results must
+    agree with f on g.
+*/
+bool checkCareSet(forest* F, predicate f, predicate g)
+{
+  dd_edge a(F), care(F), fc(F);
+  build(F, f, a);
+  build(F, g, care);
+  apply(INTERSECTION, a, care, fc);
+
+  const binary_opname* ops[] = { RESTRICT, CONSTRAIN };
+  for (int i=0; i<2; i++) {
+    dd_edge r(F), rc(F);
+    apply(ops[i], a, care, r);
+    apply(INTERSECTION, r, care, rc);
+    printf("%s %s: %d nodes, was %d\n",
+      F->isForRelations() ? "relation" : "set", ops[i]->getName(),
+      int(r.getNodeCount()), int(a.getNodeCount()));
+    if (rc != fc) {
+      printf("Result differs from the argument on the care set\n");
+      return false;
+    }
+  }
+  return true;
+}
+
+int main()
+{
+  MEDDLY::initialize();
+
+  int sizes[VARS];
+  for (int i=0; i<VARS; i++) sizes[i] = BASE;
+  domain* d = createDomainBottomUp(sizes, VARS);
+  forest* mdd = d->createForest(0, forest::BOOLEAN, forest::MULTI_TERMINAL);
+  forest* mxd = d->createForest(1, forest::BOOLEAN, forest::MULTI_TERMINAL);
+  forest::policies p(true);
+  p.setFullyReduced();
+  forest* fmxd = d->createForest(1, forest::BOOLEAN,
+    forest::MULTI_TERMINAL, p);
+
+  bool ok =
+    checkCofactor(mdd, small, "1--", "") &&
+    checkCofactor(mdd, evenSum, "-2-", "") &&
+    checkCofactor(mdd, middle, "0-2", "") &&
+    checkCofactor(mxd, increasing, "2--", "---") &&
+    checkCofactor(mxd, increasing, "---", "-1-") &&
+    checkCofactor(mxd, multiple, "-0-", "--2") &&
+    checkCofactor(fmxd, nearby, "1-0", "2--") &&
+
+    checkCareSet(mdd, evenSum, small) &&
+    checkCareSet(mdd, small, middle) &&
+    checkCareSet(mdd, middle, evenSum) &&
+    checkCareSet(fmxd, increasing, nearby) &&
+    checkCareSet(fmxd, multiple, increasing);
+
+  //
+  // Cofactors again, with variables not in level order;
+  // the values are still given by variable.
+  //
+  int level2var[VARS+1] = { 0, 3, 1, 2 };
+  static_cast<expert_forest*>(mdd)->reorderVariables(level2var);
+  static_cast<expert_forest*>(mxd)->reorderVariables(level2var);
+  static_cast<expert_forest*>(fmxd)->reorderVariables(level2var);
+  printf("Reordered forests:\n");
+
+  ok = ok &&
+    checkCofactor(mdd, small, "1--", "") &&
+    checkCofactor(mdd, small, "--0", "") &&
+    checkCofactor(mdd, middle, "0-2", "") &&
+    checkCofactor(mxd, increasing, "2--", "---") &&
+    checkCofactor(mxd, increasing, "---", "--1") &&
+    checkCofactor(fmxd, nearby, "1-0", "2--");
+
+  destroyDomain(d);
+  MEDDLY::cleanup();
+  if (!ok) return 1;
+  printf("Done\n");
+  return 0;
+}
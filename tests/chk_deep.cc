@@ -0,0 +1,240 @@
+
+/*
+    Meddly: Multi-terminal and Edge-valued Decision Diagram LibrarY.
+    Copyright (C) 2009, Iowa State University Research Foundation, Inc.
+
+    This library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/*
+    Tests the explicit-stack mode (setExplicitStack).
+    Saturation of the Kanban model must give the same set with and
+    without it.  Then, in a thread with a 1 MB stack, a union and a
+    saturation on a domain of 100000 variables must complete; with
+    native recursion, both would overflow that stack.
+*/
+
+#include <cstdlib>
+#include <cstdio>
+#include <pthread.h>
+
+#include "../src/meddly.h"
+#include "../src/meddly_expert.h"
+#include "simple_model.h"
+
+const char* kanban[] = {
+  "X-+..............",  // Tin1
+  "X.-+.............",  // Tr1
+  "X.+-.............",  // Tb1
+  "X.-.+............",  // Tg1
+  "X.....-+.........",  // Tr2
+  "X.....+-.........",  // Tb2
+  "X.....-.+........",  // Tg2
+  "X+..--+..-+......",  // Ts1_23
+  "X.........-+.....",  // Tr3
+  "X.........+-.....",  // Tb3
+  "X.........-.+....",  // Tg3
+  "X....+..-+..--+..",  // Ts23_4
+  "X.............-+.",  // Tr4
+  "X.............+-.",  // Tb4
+  "X............+..-",  // Tout4
+  "X.............-.+"   // Tg4
+};
+
+const int N = 3;
+const long expected = 58400;
+
+const int DEEP = 100000;
+const size_t STACK = 1024*1024;
+
+using namespace MEDDLY;
+
+void saturate(forest* mdd, forest* mxd, const dd_edge &nsf,
+  const dd_edge &init, dd_edge &reachable)
+{
+  satpregen_opname::pregen_relation* ensf
+    = new satpregen_opname::pregen_relation(mdd, mxd, mdd);
+  ensf->addToRelation(nsf);
+  ensf->finalize();
+  specialized_operation* sat = SATURATION_FORWARD->buildOperation(ensf);
+  sat->compute(init, reachable);
+  destroyOperation(sat);
+}
+
+bool checkKanban()
+{
+  int sizes[16];
+  for (int i=15; i>=0; i--) sizes[i] = N+1;
+  domain* d = createDomainBottomUp(sizes, 16);
+
+  int* initial = new int[17];
+  for (int i=16; i; i--) initial[i] = 0;
+  initial[1] = initial[5] = initial[9] = initial[13] = N;
+  forest* mdd = d->createForest(0, forest::BOOLEAN, forest::MULTI_TERMINAL);
+  dd_edge init_state(mdd);
+  mdd->createEdge(&initial, 1, init_state);
+  delete[] initial;
+
+  forest* mxd = d->createForest(1, forest::BOOLEAN, forest::MULTI_TERMINAL);
+  dd_edge nsf(mxd);
+  buildNextStateFunction(kanban, 16, mxd, nsf);
+
+  dd_edge recursive(mdd), loop(mdd);
+  setExplicitStack(false);
+  saturate(mdd, mxd, nsf, init_state, recursive);
+  setExplicitStack(true);
+  saturate(mdd, mxd, nsf, init_state, loop);
+  setExplicitStack(false);
+
+  long c;
+  apply(CARDINALITY, loop, c);
+  printf("\tKanban, N=%d: %ld states\n", N, c);
+  bool ok = true;
+  if (c != expected) {
+    printf("\tWrong number of states, expected %ld\n", expected);
+    ok = false;
+  }
+  if (loop != recursive) {
+    printf("\tSet differs from the recursive saturation\n");
+    ok = false;
+  }
+
+  destroyDomain(d);
+  return ok;
+}
+
+bool contains(forest* f, const dd_edge &e, const int* m)
+{
+  bool ans;
+  f->evaluate(e, m, ans);
+  return ans;
+}
+
+/*
+    Run in a thread with a small stack.
+    Everything here is linear in the number of variables.
+*/
+void* checkDeep(void* result)
+{
+  bool& ok = *static_cast<bool*>(result);
+  ok = true;
+
+  int* sizes = new int[DEEP];
+  for (int i=0; i<DEEP; i++) sizes[i] = 2;
+  domain* d = createDomainBottomUp(sizes, DEEP);
+  delete[] sizes;
+  forest* mdd = d->createForest(0, forest::BOOLEAN, forest::MULTI_TERMINAL);
+  forest* mxd = d->createForest(1, forest::BOOLEAN, forest::MULTI_TERMINAL);
+
+  int* m1 = new int[DEEP+1];
+  int* m2 = new int[DEEP+1];
+  int* m3 = new int[DEEP+1];
+
+  //
+  // Union of two minterms that differ in every variable
+  //
+  for (int k=1; k<=DEEP; k++) {
+    m1[k] = k%2;
+    m2[k] = 1-m1[k];
+  }
+  dd_edge a(mdd), b(mdd), c(mdd);
+  mdd->createEdge(&m1, 1, a);
+  mdd->createEdge(&m2, 1, b);
+  apply(UNION, a, b, c);
+  for (int k=1; k<=DEEP; k++) m3[k] = m1[k];
+  m3[DEEP/2] = m2[DEEP/2];
+  long nodes = c.getNodeCount();
+  printf("\tUnion of two minterms: %ld nodes\n", nodes);
+  if (nodes != 2*DEEP-1 || !contains(mdd, c, m1) || !contains(mdd, c, m2)
+      || contains(mdd, c, m3))
+  {
+    printf("\tWrong union\n");
+    ok = false;
+  }
+  a.clear();
+  b.clear();
+  c.clear();
+
+  //
+  // Saturation, from all zeroes, with events
+  //    x1: 0 -> 1
+  //    xN, x1: 0, 0 -> 1, 1
+  // recFire() for the second one goes through every level.
+  //
+  for (int k=1; k<=DEEP; k++) {
+    m1[k] = DONT_CARE;
+    m2[k] = DONT_CHANGE;
+  }
+  dd_edge e1(mxd), e2(mxd), nsf(mxd);
+  m1[1] = 0;
+  m2[1] = 1;
+  mxd->createEdge(&m1, &m2, 1, e1);
+  m1[DEEP] = 0;
+  m2[DEEP] = 1;
+  mxd->createEdge(&m1, &m2, 1, e2);
+  apply(UNION, e1, e2, nsf);
+
+  for (int k=1; k<=DEEP; k++) m3[k] = 0;
+  dd_edge init(mdd), reachable(mdd);
+  mdd->createEdge(&m3, 1, init);
+  saturate(mdd, mxd, nsf, init, reachable);
+
+  nodes = reachable.getNodeCount();
+  printf("\tSaturation: %ld nodes\n", nodes);
+  bool found[4];
+  for (int s=0; s<4; s++) {
+    m3[1] = s%2;
+    m3[DEEP] = s/2;
+    found[s] = contains(mdd, reachable, m3);
+  }
+  if (!found[0] || !found[1] || found[2] || !found[3]) {
+    printf("\tWrong reachable states\n");
+    ok = false;
+  }
+
+  delete[] m1;
+  delete[] m2;
+  delete[] m3;
+  destroyDomain(d);
+  return 0;
+}
+
+int main()
+{
+  MEDDLY::initialize();
+
+  printf("Saturation with and without an explicit stack\n");
+  if (!checkKanban()) return 1;
+
+  printf("Deep domain, %d variables, %lu byte stack\n", DEEP,
+    (unsigned long) STACK);
+  setExplicitStack(true);
+  pthread_attr_t attr;
+  pthread_attr_init(&attr);
+  pthread_attr_setstacksize(&attr, STACK);
+  pthread_t thread;
+  bool ok = false;
+  if (pthread_create(&thread, &attr, checkDeep, &ok)) {
+    printf("\tCouldn't start the thread\n");
+    return 1;
+  }
+  pthread_join(thread, 0);
+  pthread_attr_destroy(&attr);
+  if (!ok) return 1;
+
+  MEDDLY::cleanup();
+  printf("Done\n");
+  return 0;
+}
@@ -0,0 +1,224 @@
+
+/*
+    Meddly: Multi-terminal and Edge-valued Decision Diagram LibrarY.
+    Copyright (C) 2009, Iowa State University Research Foundation, Inc.
+
+    This library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/*
+    Tests compactMemory(node_layout), which moves every node
+    of a forest to fresh memory.
+    The Kanban reachability set, and its next-state function
+    restricted to reachable states, must have the same elements
+    after the move, and building them again must find the same nodes.
+    Then, with a memory budget that leaves room for only part of
+    the copy, the move must be undone and leave everything unchanged.
+*/
+
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+
+#include "../src/meddly.h"
+#include "../src/meddly_expert.h"
+#include "simple_model.h"
+
+const char* kanban[] = {
+  "X-+..............",  // Tin1
+  "X.-+.............",  // Tr1
+  "X.+-.............",  // Tb1
+  "X.-.+............",  // Tg1
+  "X.....-+.........",  // Tr2
+  "X.....+-.........",  // Tb2
+  "X.....-.+........",  // Tg2
+  "X+..--+..-+......",  // Ts1_23
+  "X.........-+.....",  // Tr3
+  "X.........+-.....",  // Tb3
+  "X.........-.+....",  // Tg3
+  "X....+..-+..--+..",  // Ts23_4
+  "X.............-+.",  // Tr4
+  "X.............+-.",  // Tb4
+  "X............+..-",  // Tout4
+  "X.............-.+"   // Tg4
+};
+
+const int N = 2;
+const int VARS = 16;
+const long expected = 4600;
+
+using namespace MEDDLY;
+
+/// Elements of a set or relation, as listed by an enumerator.
+struct elements {
+  int** from;
+  int** to;
+  long n;
+
+  elements(const dd_edge &e) {
+    n = 0;
+    for (enumerator i(e); i; ++i) n++;
+    from = new int*[n];
+    to = new int*[n];
+    long j = 0;
+    const bool rel = e.getForest()->isForRelations();
+    for (enumerator i(e); i; ++i, j++) {
+      from[j] = new int[VARS+1];
+      memcpy(from[j], i.getAssignments(), (VARS+1)*sizeof(int));
+      if (rel) {
+        to[j] = new int[VARS+1];
+        memcpy(to[j], i.getPrimedAssignments(), (VARS+1)*sizeof(int));
+      } else {
+        to[j] = 0;
+      }
+    }
+  }
+  ~elements() {
+    for (long j=0; j<n; j++) {
+      delete[] from[j];
+      delete[] to[j];
+    }
+    delete[] from;
+    delete[] to;
+  }
+  bool operator==(const elements &x) const {
+    if (n != x.n) return false;
+    for (long j=0; j<n; j++) {
+      if (memcmp(from[j], x.from[j], (VARS+1)*sizeof(int))) return false;
+      if (0==to[j]) continue;
+      if (memcmp(to[j], x.to[j], (VARS+1)*sizeof(int))) return false;
+    }
+    return true;
+  }
+  /// Build the set or relation again, from its elements.
+  void build(forest* f, dd_edge &e) const {
+    if (f->isForRelations()) {
+      f->createEdge(from, to, int(n), e);
+    } else {
+      f->createEdge(from, int(n), e);
+    }
+  }
+};
+
+/// Compare e with its elements before the move.
+bool same(const char* what, const dd_edge &e, const elements &before)
+{
+  elements after(e);
+  if (!(after == before)) {
+    printf("\t%s: elements changed\n", what);
+    return false;
+  }
+  dd_edge again(e.getForest());
+  after.build(e.getForest(), again);
+  if (again != e) {
+    printf("\t%s: building it again gives a different node\n", what);
+    return false;
+  }
+  double c;
+  apply(CARDINALITY, e, c);
+  if (long(c) != before.n) {
+    printf("\t%s: cardinality %g, expected %ld\n", what, c, before.n);
+    return false;
+  }
+  return true;
+}
+
+bool check(expert_forest::node_layout layout, const char* name)
+{
+  printf("Layout %s\n", name);
+
+  int sizes[VARS];
+  for (int i=VARS-1; i>=0; i--) sizes[i] = N+1;
+  domain* d = createDomainBottomUp(sizes, VARS);
+
+  int* initial = new int[VARS+1];
+  for (int i=VARS; i; i--) initial[i] = 0;
+  initial[1] = initial[5] = initial[9] = initial[13] = N;
+  forest* mdd = d->createForest(0, forest::BOOLEAN, forest::MULTI_TERMINAL);
+  dd_edge init_state(mdd);
+  mdd->createEdge(&initial, 1, init_state);
+  delete[] initial;
+
+  forest* mxd = d->createForest(1, forest::BOOLEAN, forest::MULTI_TERMINAL);
+  dd_edge nsf(mxd);
+  buildNextStateFunction(kanban, VARS, mxd, nsf);
+
+  dd_edge reachable(mdd);
+  apply(REACHABLE_STATES_DFS, init_state, nsf, reachable);
+
+  // next-state function, from and to reachable states
+  dd_edge rr(mxd), edges(mxd);
+  apply(CROSS, reachable, reachable, rr);
+  apply(INTERSECTION, nsf, rr, edges);
+  rr.clear();
+
+  elements states(reachable);
+  elements steps(edges);
+  printf("\t%ld states, %ld edges\n", states.n, steps.n);
+  if (states.n != expected) {
+    printf("\tWrong number of states, expected %ld\n", expected);
+    return false;
+  }
+
+  expert_forest* emdd = static_cast<expert_forest*>(mdd);
+  expert_forest* emxd = static_cast<expert_forest*>(mxd);
+
+  //
+  // Move the nodes
+  //
+  if (!emdd->compactMemory(layout) || !emxd->compactMemory(layout)) {
+    printf("\tcompactMemory failed\n");
+    return false;
+  }
+  if (!same("states", reachable, states)) return false;
+  if (!same("edges", edges, steps)) return false;
+  dd_edge nsf2(mxd);
+  buildNextStateFunction(kanban, VARS, mxd, nsf2);
+  if (nsf2 != nsf) {
+    printf("\tbuilding the next-state function again gives a different node\n");
+    return false;
+  }
+  nsf2.clear();
+  printf("\tmoved, unchanged\n");
+
+  //
+  // Room for only part of a copy of the nodes; must be undone
+  //
+  setMemoryBudget(memstats::getGlobalMemAlloc() + mxd->getCurrentMemoryUsed()/8);
+  bool moved = emxd->compactMemory(layout);
+  setMemoryBudget(0);
+  if (moved) {
+    printf("\tcompactMemory succeeded without room for the copy\n");
+    return false;
+  }
+  if (!same("states", reachable, states)) return false;
+  if (!same("edges", edges, steps)) return false;
+  printf("\tnot moved, unchanged\n");
+
+  destroyDomain(d);
+  return true;
+}
+
+int main()
+{
+  MEDDLY::initialize();
+
+  if (!check(expert_forest::DEPTH_FIRST, "DEPTH_FIRST")) return 1;
+  if (!check(expert_forest::LEVEL_MAJOR, "LEVEL_MAJOR")) return 1;
+
+  MEDDLY::cleanup();
+  printf("Done\n");
+  return 0;
+}
@@ -0,0 +1,218 @@
+
+/*
+    Meddly: Multi-terminal and Edge-valued Decision Diagram LibrarY.
+    Copyright (C) 2009, Iowa State University Research Foundation, Inc.
+
+    This library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published 
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/*
+    Tests the n-ary operations against chains of the
+    corresponding binary operations, on sets and relations.
+*/
+
+#include <cstdlib>
+#include <cstdio>
+
+#include "../src/meddly.h"
+#include "../src/meddly_expert.h"
+
+const int VARS = 3;
+const int BASE = 3;
+const int STATES = 27;   // BASE^VARS
+const int MAXOPS = 6;
+const unsigned MANYOPS = 120;
+
+using namespace MEDDLY;
+
+long seed = 123456789;
+
+/// Uniform in [0, n)
+int pick(int n)
+{
+  seed = (seed * 1103515245 + 12345) & 0x7fffffff;
+  return int((seed >> 8) % n);
+}
+
+void setDigits(int x, int* m)
+{
+  for (int k=1; k<=VARS; k++) {
+    m[k] = x % BASE;
+    x /= BASE;
+  }
+}
+
+/**
+    Build a random set or relation (or function, for integer forests),
+    with about one element in every "sparse",
+    or (if dense) all but about one element in every "sparse".
+*/
+void buildRandom(forest* F, int sparse, bool dense, dd_edge &e)
+{
+  int** from = new int*[STATES*STATES];
+  int** to = new int*[STATES*STATES];
+  long* vals = new long[STATES*STATES];
+  int N = 0;
+  const int ys = F->isForRelations() ? STATES : 1;
+  for (int x=0; x<STATES; x++) {
+    for (int y=0; y<ys; y++) {
+      if (dense == (0==pick(sparse))) continue;
+      from[N] = new int[VARS+1];
+      to[N] = new int[VARS+1];
+      setDigits(x, from[N]);
+      setDigits(y, to[N]);
+      vals[N] = 1+pick(9);
+      N++;
+    }
+  }
+  e.set(0);
+  if (N) {
+    const bool ints = (F->getRangeType() == forest::INTEGER);
+    if (F->isForRelations()) {
+      if (ints) F->createEdge(from, to, vals, N, e);
+      else      F->createEdge(from, to, N, e);
+    } else {
+      if (ints) F->createEdge(from, vals, N, e);
+      else      F->createEdge(from, N, e);
+    }
+  }
+  for (int i=0; i<N; i++) {
+    delete[] from[i];
+    delete[] to[i];
+  }
+  delete[] from;
+  delete[] to;
+  delete[] vals;
+}
+
+/**
+    Apply the n-ary operation to the first n operands, and compare
+    with a chain of binary operations.
+*/
+bool check(const nary_opname* nop, const binary_opname* bop, forest* F,
+  const dd_edge* ops, unsigned n, const char* what)
+{
+  dd_edge chain(ops[0]);
+  for (unsigned i=1; i<n; i++) {
+    apply(bop, chain, ops[i], chain);
+  }
+
+  dd_edge c(F);
+  specialized_operation* op =
+    nop->buildOperation(new nary_opname::nary_args(F));
+  op->compute(ops, n, c);
+  destroyOperation(op);
+
+  printf("%s %s of %u: %d nodes\n", what, nop->getName(), n,
+    int(c.getNodeCount()));
+  if (c != chain) {
+    printf("Mismatch with chain of %s\n", bop->getName());
+    return false;
+  }
+  return true;
+}
+
+/**
+    Check the operation on random operands in forest F,
+    including repeated and empty operands.
+*/
+bool checkForest(const nary_opname* nop, const binary_opname* bop,
+  forest* F, const char* what)
+{
+  // Intersections of sparse operands are almost always empty
+  const bool dense = (NARY_INTERSECTION == nop);
+  dd_edge ops[MAXOPS];
+  for (int i=0; i<MAXOPS; i++) {
+    ops[i].setForest(F);
+  }
+  for (int t=0; t<4; t++) {
+    for (int i=0; i<MAXOPS; i++) {
+      buildRandom(F, dense ? 12+pick(8) : 2+pick(4), dense, ops[i]);
+    }
+    if (t==2) ops[3] = ops[1];
+    if (t==3) ops[4].set(0);
+    for (unsigned n=1; n<=MAXOPS; n++) {
+      if (!check(nop, bop, F, ops, n, what)) return false;
+    }
+  }
+  return true;
+}
+
+/**
+    Check the operation on many sparse (or dense, for intersection)
+    random operands, more than fit in one compute table entry.
+*/
+bool checkMany(const nary_opname* nop, const binary_opname* bop,
+  forest* F, const char* what)
+{
+  const bool dense = (NARY_INTERSECTION == nop);
+  dd_edge* ops = new dd_edge[MANYOPS];
+  for (unsigned i=0; i<MANYOPS; i++) {
+    ops[i].setForest(F);
+    buildRandom(F, dense ? 2000 : 400, dense, ops[i]);
+  }
+  bool ok = check(nop, bop, F, ops, MANYOPS, what);
+  delete[] ops;
+  return ok;
+}
+
+int main()
+{
+  MEDDLY::initialize();
+
+  int sizes[VARS];
+  for (int i=0; i<VARS; i++) sizes[i] = BASE;
+  domain* d = createDomainBottomUp(sizes, VARS);
+
+  forest::policies sp(false);
+  sp.setFullyReduced();
+  forest* mdd = d->createForest(0, forest::BOOLEAN,
+    forest::MULTI_TERMINAL, sp);
+  forest* imdd = d->createForest(0, forest::INTEGER,
+    forest::MULTI_TERMINAL, sp);
+
+  forest::policies rp(true);
+  rp.setIdentityReduced();
+  forest* mxd = d->createForest(1, forest::BOOLEAN,
+    forest::MULTI_TERMINAL, rp);
+  forest* imxd = d->createForest(1, forest::INTEGER,
+    forest::MULTI_TERMINAL, rp);
+
+  bool ok =
+    checkForest(NARY_UNION, UNION, mdd, "MDD") &&
+    checkForest(NARY_INTERSECTION, INTERSECTION, mdd, "MDD") &&
+    checkForest(NARY_PLUS, PLUS, imdd, "integer MDD") &&
+    checkForest(NARY_MAXIMUM, MAXIMUM, imdd, "integer MDD") &&
+
+    checkForest(NARY_UNION, UNION, mxd, "MxD") &&
+    checkForest(NARY_INTERSECTION, INTERSECTION, mxd, "MxD") &&
+    checkForest(NARY_PLUS, PLUS, imxd, "integer MxD") &&
+    checkForest(NARY_MAXIMUM, MAXIMUM, imxd, "integer MxD") &&
+
+    checkMany(NARY_UNION, UNION, mdd, "MDD") &&
+    checkMany(NARY_INTERSECTION, INTERSECTION, mdd, "MDD") &&
+    checkMany(NARY_PLUS, PLUS, imdd, "integer MDD") &&
+    checkMany(NARY_MAXIMUM, MAXIMUM, imdd, "integer MDD") &&
+    checkMany(NARY_UNION, UNION, mxd, "MxD") &&
+    checkMany(NARY_INTERSECTION, INTERSECTION, mxd, "MxD") &&
+    checkMany(NARY_PLUS, PLUS, imxd, "integer MxD") &&
+    checkMany(NARY_MAXIMUM, MAXIMUM, imxd, "integer MxD");
+
+  destroyDomain(d);
+  MEDDLY::cleanup();
+  if (!ok) return 1;
+  printf("Done\n");
+  return 0;
+}
@@ -0,0 +1,227 @@
+/*
+    Meddly: Multi-terminal and Edge-valued Decision Diagram LibrarY.
+    Copyright (C) 2009, Iowa State University Research Foundation, Inc.
+
+    This library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/*
+    Tests SATURATION_OTF_FORWARD.
+    The Kanban model is given as on-the-fly events, with one firing
+    subevent per place touched by a transition, so the events are
+    rebuilt incrementally as local states get confirmed.
+    The reachability set must match SATURATION_FORWARD on the explicit
+    relation, and once every local state is confirmed, each event must
+    match the explicit next-state function of its transition.
+*/
+
+#include <cstdlib>
+#include <cstdio>
+
+#include "../src/meddly.h"
+#include "../src/meddly_expert.h"
+#include "simple_model.h"
+
+const char* kanban[] = {
+  "X-+..............",  // Tin1
+  "X.-+.............",  // Tr1
+  "X.+-.............",  // Tb1
+  "X.-.+............",  // Tg1
+  "X.....-+.........",  // Tr2
+  "X.....+-.........",  // Tb2
+  "X.....-.+........",  // Tg2
+  "X+..--+..-+......",  // Ts1_23
+  "X.........-+.....",  // Tr3
+  "X.........+-.....",  // Tb3
+  "X.........-.+....",  // Tg3
+  "X....+..-+..--+..",  // Ts23_4
+  "X.............-+.",  // Tr4
+  "X.............+-.",  // Tb4
+  "X............+..-",  // Tout4
+  "X.............-.+"   // Tg4
+};
+
+const int EVENTS = 16;
+const int VARS = 16;
+
+using namespace MEDDLY;
+
+long confirms;
+
+/*
+    Firing subevent for one place of a transition:
+    moves the place by delta, if the result is within [0, bound].
+    The other places of the transition are left to their own subevents.
+*/
+class place_subevent : public satotf_opname::subevent {
+  public:
+    place_subevent(forest* mxd, int v, const char* ev, int delta, int bound)
+    : satotf_opname::subevent(mxd, &v, 1, true)
+    {
+      var = v;
+      this->delta = delta;
+      this->bound = bound;
+      unp = new int[VARS+1];
+      p = new int[VARS+1];
+      for (int i=1; i<=VARS; i++) {
+        unp[i] = DONT_CARE;
+        p[i] = ('.' == ev[i]) ? DONT_CHANGE : DONT_CARE;
+      }
+    }
+    virtual ~place_subevent() {
+      delete[] unp;
+      delete[] p;
+    }
+    virtual void confirm(satotf_opname::otf_relation &rel, int v, int index) {
+      confirms++;
+      int next = index + delta;
+      if (next < 0 || next > bound) return;
+      unp[var] = index;
+      p[var] = next;
+      addMinterm(unp, p);
+    }
+  private:
+    int var;
+    int delta;
+    int bound;
+    int* unp;
+    int* p;
+};
+
+bool check(int N, long expected)
+{
+  printf("Kanban, N=%d\n", N);
+
+  int sizes[VARS];
+  for (int i=0; i<VARS; i++) sizes[i] = N+1;
+  domain* d = createDomainBottomUp(sizes, VARS);
+  forest* mdd = d->createForest(0, forest::BOOLEAN, forest::MULTI_TERMINAL);
+  forest* mxd = d->createForest(1, forest::BOOLEAN, forest::MULTI_TERMINAL);
+  // On-the-fly saturation needs a quasi-reduced set forest
+  forest::policies qp(false);
+  qp.setQuasiReduced();
+  forest* qmdd = d->createForest(0, forest::BOOLEAN, forest::MULTI_TERMINAL, qp);
+
+  int* initial = new int[VARS+1];
+  for (int i=0; i<=VARS; i++) initial[i] = 0;
+  initial[1] = initial[5] = initial[9] = initial[13] = N;
+  dd_edge init(mdd);
+  mdd->createEdge(&initial, 1, init);
+  dd_edge qinit(qmdd);
+  qmdd->createEdge(&initial, 1, qinit);
+  delete[] initial;
+
+  //
+  // Explicit relation and saturation
+  //
+  dd_edge explicitEvents[EVENTS] = {
+    dd_edge(mxd), dd_edge(mxd), dd_edge(mxd), dd_edge(mxd),
+    dd_edge(mxd), dd_edge(mxd), dd_edge(mxd), dd_edge(mxd),
+    dd_edge(mxd), dd_edge(mxd), dd_edge(mxd), dd_edge(mxd),
+    dd_edge(mxd), dd_edge(mxd), dd_edge(mxd), dd_edge(mxd)
+  };
+  satpregen_opname::pregen_relation* ensf
+    = new satpregen_opname::pregen_relation(mdd, mxd, mdd, EVENTS);
+  for (int e=0; e<EVENTS; e++) {
+    buildNextStateFunction(kanban+e, 1, mxd, explicitEvents[e]);
+    ensf->addToRelation(explicitEvents[e]);
+  }
+  ensf->finalize();
+  specialized_operation* sat = SATURATION_FORWARD->buildOperation(ensf);
+  dd_edge expl(mdd);
+  sat->compute(init, expl);
+  destroyOperation(sat);
+
+  //
+  // On-the-fly relation and saturation
+  //
+  satotf_opname::event* events[EVENTS];
+  for (int e=0; e<EVENTS; e++) {
+    satotf_opname::subevent* se[VARS];
+    int nse = 0;
+    for (int i=1; i<=VARS; i++) {
+      if ('.' == kanban[e][i]) continue;
+      se[nse++] = new place_subevent(mxd, i, kanban[e],
+        ('+' == kanban[e][i]) ? 1 : -1, N);
+    }
+    events[e] = new satotf_opname::event(se, nse);
+  }
+  satotf_opname::otf_relation* rel
+    = new satotf_opname::otf_relation(qmdd, mxd, qmdd, events, EVENTS);
+
+  confirms = 0;
+  rel->confirm(qinit);
+  long initialConfirms = confirms;
+  specialized_operation* otf = SATURATION_OTF_FORWARD->buildOperation(rel);
+  dd_edge qreach(qmdd);
+  otf->compute(qinit, qreach);
+  dd_edge reach(mdd);
+  apply(COPY, qreach, reach);
+
+  long c;
+  apply(CARDINALITY, reach, c);
+  printf("\ton the fly: %ld states, %ld local states confirmed during saturation\n",
+    c, confirms - initialConfirms);
+
+  bool ok = true;
+  if (c != expected) {
+    printf("\tWrong number of states, expected %ld\n", expected);
+    ok = false;
+  }
+  if (reach != expl) {
+    printf("\tDiffers from SATURATION_FORWARD\n");
+    ok = false;
+  }
+  if (confirms - initialConfirms < VARS) {
+    printf("\tExpected events to be rebuilt several times\n");
+    ok = false;
+  }
+
+  //
+  // Every local state is reachable in Kanban, so the incrementally
+  // rebuilt events must now equal the explicit ones.
+  //
+  for (int i=1; i<=VARS; i++) {
+    if (rel->getNumConfirmed(i) != N+1) {
+      printf("\tLevel %d has %d confirmed local states, expected %d\n",
+        i, rel->getNumConfirmed(i), N+1);
+      ok = false;
+    }
+  }
+  for (int e=0; e<EVENTS; e++) {
+    if (events[e]->getRoot() != explicitEvents[e]) {
+      printf("\tEvent %d differs from the explicit one\n", e);
+      ok = false;
+    }
+  }
+
+  destroyOperation(otf);
+  for (int e=0; e<EVENTS; e++) delete events[e];
+  destroyDomain(d);
+  return ok;
+}
+
+int main()
+{
+  MEDDLY::initialize();
+
+  if (!check(1, 160)) return 1;
+  if (!check(2, 4600)) return 1;
+  if (!check(3, 58400)) return 1;
+
+  MEDDLY::cleanup();
+  printf("Done\n");
+  return 0;
+}
@@ -0,0 +1,189 @@
+
+/*
+    Meddly: Multi-terminal and Edge-valued Decision Diagram LibrarY.
+    Copyright (C) 2009, Iowa State University Research Foundation, Inc.
+
+    This library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/*
+    Tests a relation_node_pool shared by two implicit relations.
+    The Kanban model is registered in both; the second must get
+    the same handles without adding nodes to the pool.
+    The first relation is destroyed before the second is used,
+    and the pool must survive it.  When both are gone, only the
+    terminal is left, and the pool is freed by its creator.
+*/
+
+#include <cstdlib>
+#include <cstdio>
+
+#include "../src/meddly.h"
+#include "../src/meddly_expert.h"
+
+// the bottom handle, as in sat_impl.cc
+#define TERMINAL_NODE 1
+
+const int PLACES = 16;
+const int TRANS = 16;
+
+const int kanban[TRANS][PLACES+1] = {
+  {0,-1,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0},     // Tin1
+  {0,0,-1,1,0,0,0,0,0,0,0,0,0,0,0,0,0},     // Tr1
+  {0,0,1,-1,0,0,0,0,0,0,0,0,0,0,0,0,0},     // Tb1
+  {0,0,-1,0,1,0,0,0,0,0,0,0,0,0,0,0,0},     // Tg1
+  {0,0,0,0,0,0,-1,1,0,0,0,0,0,0,0,0,0},     // Tr2
+  {0,0,0,0,0,0,1,-1,0,0,0,0,0,0,0,0,0},     // Tb2
+  {0,0,0,0,0,0,-1,0,1,0,0,0,0,0,0,0,0},     // Tg2
+  {0,1,0,0,-1,-1,1,0,0,-1,1,0,0,0,0,0,0},   // Ts1_23
+  {0,0,0,0,0,0,0,0,0,0,-1,1,0,0,0,0,0},     // Tr3
+  {0,0,0,0,0,0,0,0,0,0,1,-1,0,0,0,0,0},     // Tb3
+  {0,0,0,0,0,0,0,0,0,0,-1,0,1,0,0,0,0},     // Tg3
+  {0,0,0,0,0,1,0,0,-1,1,0,0,-1,-1,1,0,0},   // Ts23_4
+  {0,0,0,0,0,0,0,0,0,0,0,0,0,0,-1,1,0},     // Tr4
+  {0,0,0,0,0,0,0,0,0,0,0,0,0,0,1,-1,0},     // Tb4
+  {0,0,0,0,0,0,0,0,0,0,0,0,0,1,0,0,-1},     // Tout4
+  {0,0,0,0,0,0,0,0,0,0,0,0,0,0,-1,0,1}      // Tg4
+};
+
+const int N = 1;
+const long expected = 160;
+
+using namespace MEDDLY;
+
+/// Build the relation from the model, bottom up; keep the event tops.
+void buildRelation(satimpl_opname::implicit_relation* T, rel_node_handle* tops)
+{
+  for (int e=0; e<TRANS; e++) {
+    int top = 0;
+    for (int p=1; p<=PLACES; p++) {
+      if (kanban[e][p]) top = p;
+    }
+    rel_node_handle below = TERMINAL_NODE;
+    for (int p=1; p<=PLACES; p++) {
+      const long delta = kanban[e][p];
+      if (0==delta) continue;
+      relation_node* n
+        = new affine_relation_node(p, below, delta, delta<0 ? -delta : 0);
+      below = T->registerNode(p==top, n);
+    }
+    tops[e] = below;
+  }
+}
+
+long saturate(satimpl_opname::implicit_relation* T, const dd_edge &init,
+  dd_edge &reachable)
+{
+  specialized_operation* sat = SATURATION_IMPL_FORWARD->buildOperation(T);
+  sat->compute(init, reachable);
+  destroyOperation(sat);    // and T with it
+  double c;
+  apply(CARDINALITY, reachable, c);
+  return long(c);
+}
+
+int main()
+{
+  MEDDLY::initialize();
+
+  int sizes[PLACES];
+  for (int i=0; i<PLACES; i++) sizes[i] = 2;
+  domain* d = createDomainBottomUp(sizes, PLACES);
+  forest::policies p(false);
+  p.setPessimistic();
+  forest* mdd = d->createForest(0, forest::BOOLEAN, forest::MULTI_TERMINAL, p);
+  forest* rel = d->createForest(0, forest::BOOLEAN, forest::MULTI_TERMINAL, p);
+
+  expert_domain* ed = static_cast<expert_domain*>(d);
+  ed->enlargeVariableBound(1, false, N+1);
+  ed->enlargeVariableBound(5, false, N+1);
+  ed->enlargeVariableBound(9, false, N+1);
+  ed->enlargeVariableBound(13, false, N+1);
+
+  int* initial = new int[PLACES+1];
+  for (int i=0; i<=PLACES; i++) initial[i] = 0;
+  initial[1] = initial[5] = initial[9] = initial[13] = N;
+  dd_edge first(mdd);
+  mdd->createEdge(&initial, 1, first);
+  delete[] initial;
+
+  relation_node_pool* pool = new relation_node_pool;
+
+  //
+  // Register the model in two relations
+  //
+  rel_node_handle tops1[TRANS], tops2[TRANS];
+  satimpl_opname::implicit_relation* T1
+    = new satimpl_opname::implicit_relation(mdd, rel, mdd, pool);
+  buildRelation(T1, tops1);
+  const long nodes = pool->getNumNodes();
+  satimpl_opname::implicit_relation* T2
+    = new satimpl_opname::implicit_relation(mdd, rel, mdd, pool);
+  buildRelation(T2, tops2);
+  printf("Kanban, N=%d: %ld relation nodes in the pool\n", N, nodes);
+
+  if (pool->getNumNodes() != nodes) {
+    printf("\tSecond relation added nodes: %ld\n", pool->getNumNodes());
+    return 1;
+  }
+  for (int e=0; e<TRANS; e++) {
+    if (tops1[e] != tops2[e]) {
+      printf("\tEvent %d has handles %ld and %ld\n", e,
+        long(tops1[e]), long(tops2[e]));
+      return 1;
+    }
+  }
+
+  //
+  // Use and destroy the first, then the second
+  //
+  dd_edge reachable1(mdd), reachable2(mdd);
+  long c = saturate(T1, first, reachable1);
+  printf("\tfirst relation:  %ld states\n", c);
+  if (c != expected) {
+    printf("\tWrong number of states, expected %ld\n", expected);
+    return 1;
+  }
+  if (pool->getNumNodes() != nodes) {
+    printf("\tNodes freed with the first relation: %ld left\n",
+      pool->getNumNodes());
+    return 1;
+  }
+
+  c = saturate(T2, first, reachable2);
+  printf("\tsecond relation: %ld states\n", c);
+  if (reachable1 != reachable2) {
+    printf("\tReachability sets differ\n");
+    return 1;
+  }
+  if (pool->getNumNodes() != 1) {
+    printf("\tNodes left after both relations: %ld\n", pool->getNumNodes());
+    return 1;
+  }
+
+  //
+  // Our link is the last one
+  //
+  if (!pool->unlinkPool()) {
+    printf("\tPool still linked\n");
+    return 1;
+  }
+  delete pool;
+
+  destroyDomain(d);
+  MEDDLY::cleanup();
+  printf("Done\n");
+  return 0;
+}
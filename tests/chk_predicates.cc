@@ -0,0 +1,186 @@
+
+/*
+    Meddly: Multi-terminal and Edge-valued Decision Diagram LibrarY.
+    Copyright (C) 2009, Iowa State University Research Foundation, Inc.
+
+    This library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/*
+    Tests the SUBSET and DISJOINT predicates.
+    For every pair of a family of random sets (or relations),
+    SUBSET must agree with DIFFERENCE being empty, and DISJOINT
+    with INTERSECTION being empty.
+    Done for fully-reduced MDDs, fully-reduced and identity-reduced
+    MxDs, with both operands in one forest, and with the second
+    operand copied into another forest with the same reduction.
+*/
+
+#include <cstdlib>
+#include <cstdio>
+
+#include "../src/meddly.h"
+#include "../src/meddly_expert.h"
+
+const int VARS = 5;
+const int BASE = 3;
+const int RANDOM = 4;
+const int FAMILY = RANDOM+5;
+
+using namespace MEDDLY;
+
+long seed = 12345;
+
+int pick(int n)
+{
+  seed = (seed * 1103515245 + 12345) & 0x7fffffff;
+  return int((seed >> 8) % n);
+}
+
+/// A random set, or relation, from up to 2^size minterms.
+void randomEdge(forest* f, int size, dd_edge &e)
+{
+  const int n = 1 + pick(1 << size);
+  int** from = new int*[n];
+  int** to = new int*[n];
+  for (int i=0; i<n; i++) {
+    from[i] = new int[VARS+1];
+    to[i] = new int[VARS+1];
+    from[i][0] = to[i][0] = 0;
+    for (int k=1; k<=VARS; k++) {
+      from[i][k] = pick(3) ? pick(BASE) : DONT_CARE;
+      switch (pick(4)) {
+        case 0:   to[i][k] = DONT_CARE;     break;
+        case 1:   to[i][k] = DONT_CHANGE;   break;
+        default:  to[i][k] = pick(BASE);
+      }
+    }
+  }
+  if (f->isForRelations()) {
+    f->createEdge(from, to, n, e);
+  } else {
+    f->createEdge(from, n, e);
+  }
+  for (int i=0; i<n; i++) {
+    delete[] from[i];
+    delete[] to[i];
+  }
+  delete[] from;
+  delete[] to;
+}
+
+/// Random sets, and others built from them so that both answers occur.
+void buildFamily(forest* f, dd_edge* fam)
+{
+  for (int i=0; i<RANDOM; i++) {
+    randomEdge(f, 2+2*i, fam[i]);
+  }
+  apply(UNION, fam[0], fam[1], fam[RANDOM]);
+  apply(INTERSECTION, fam[2], fam[3], fam[RANDOM+1]);
+  apply(DIFFERENCE, fam[3], fam[1], fam[RANDOM+2]);
+  apply(DIFFERENCE, fam[1], fam[3], fam[RANDOM+3]);
+  // fam[RANDOM+4] stays empty
+}
+
+bool check(const char* name, forest* f1, forest* f2)
+{
+  printf("%s\n", name);
+  dd_edge fam[FAMILY] = {
+    dd_edge(f1), dd_edge(f1), dd_edge(f1), dd_edge(f1), dd_edge(f1),
+    dd_edge(f1), dd_edge(f1), dd_edge(f1), dd_edge(f1)
+  };
+  buildFamily(f1, fam);
+  dd_edge other[FAMILY] = {
+    dd_edge(f2), dd_edge(f2), dd_edge(f2), dd_edge(f2), dd_edge(f2),
+    dd_edge(f2), dd_edge(f2), dd_edge(f2), dd_edge(f2)
+  };
+  for (int i=0; i<FAMILY; i++) {
+    apply(COPY, fam[i], other[i]);
+  }
+
+  long subsets = 0, disjoint = 0;
+  for (int i=0; i<FAMILY; i++) {
+    for (int j=0; j<FAMILY; j++) {
+      dd_edge diff(f1), meet(f1);
+      apply(DIFFERENCE, fam[i], fam[j], diff);
+      apply(INTERSECTION, fam[i], fam[j], meet);
+      const bool sub = (0==diff.getNode());
+      const bool dis = (0==meet.getNode());
+      if (sub) subsets++;
+      if (dis) disjoint++;
+
+      bool s1, s2, s3, d1, d2, d3;
+      apply(SUBSET, fam[i], fam[j], s1);
+      apply(SUBSET, fam[i], other[j], s2);
+      apply(SUBSET, other[i], fam[j], s3);
+      apply(DISJOINT, fam[i], fam[j], d1);
+      apply(DISJOINT, fam[i], other[j], d2);
+      apply(DISJOINT, other[i], fam[j], d3);
+      if (s1 != sub || s2 != sub || s3 != sub) {
+        printf("\tSUBSET(%d, %d) gives %d %d %d, expected %d\n",
+          i, j, s1, s2, s3, sub);
+        return false;
+      }
+      if (d1 != dis || d2 != dis || d3 != dis) {
+        printf("\tDISJOINT(%d, %d) gives %d %d %d, expected %d\n",
+          i, j, d1, d2, d3, dis);
+        return false;
+      }
+    }
+  }
+  printf("\t%d pairs: %ld subsets, %ld disjoint\n", FAMILY*FAMILY,
+    subsets, disjoint);
+  // each family member is a subset of itself, and of the union
+  if (subsets <= FAMILY || disjoint <= 2*FAMILY-1) {
+    printf("\tToo few pairs where the predicates hold\n");
+    return false;
+  }
+  return true;
+}
+
+int main()
+{
+  MEDDLY::initialize();
+
+  int sizes[VARS];
+  for (int i=0; i<VARS; i++) sizes[i] = BASE;
+  domain* d = createDomainBottomUp(sizes, VARS);
+
+  forest::policies p(false);
+  p.setPessimistic();
+  forest* mdd1 = d->createForest(false, forest::BOOLEAN, forest::MULTI_TERMINAL);
+  forest* mdd2 = d->createForest(false, forest::BOOLEAN, forest::MULTI_TERMINAL, p);
+  if (!check("Fully-reduced MDDs", mdd1, mdd2)) return 1;
+
+  forest::policies r(true);
+  r.setFullyReduced();
+  r.setPessimistic();
+  forest* fmxd1 = d->createForest(true, forest::BOOLEAN, forest::MULTI_TERMINAL, r);
+  r.setOptimistic();
+  forest* fmxd2 = d->createForest(true, forest::BOOLEAN, forest::MULTI_TERMINAL, r);
+  if (!check("Fully-reduced MxDs", fmxd1, fmxd2)) return 1;
+
+  r.setIdentityReduced();
+  r.setPessimistic();
+  forest* imxd1 = d->createForest(true, forest::BOOLEAN, forest::MULTI_TERMINAL, r);
+  r.setOptimistic();
+  forest* imxd2 = d->createForest(true, forest::BOOLEAN, forest::MULTI_TERMINAL, r);
+  if (!check("Identity-reduced MxDs", imxd1, imxd2)) return 1;
+
+  destroyDomain(d);
+  MEDDLY::cleanup();
+  printf("Done\n");
+  return 0;
+}
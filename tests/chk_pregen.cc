@@ -0,0 +1,192 @@
+/*
+    Meddly: Multi-terminal and Edge-valued Decision Diagram LibrarY.
+    Copyright (C) 2009, Iowa State University Research Foundation, Inc.
+
+    This library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/*
+    Tests finalizing pregenerated relations "by levels".
+    On the Kanban model, for every splitting option, the relation built
+    by adding the events one at a time must be split into the same
+    diagrams, level by level, as the one built by adding all events
+    at once (bucketed by level and combined as a balanced tree), and as
+    the one split with several threads (when built with MEDDLY_THREADS).
+    All of them must give the reachability set of the relation by events.
+*/
+
+#include <cstdlib>
+#include <cstdio>
+
+#include "../src/meddly.h"
+#include "../src/meddly_expert.h"
+#include "simple_model.h"
+
+const char* kanban[] = {
+  "X-+..............",  // Tin1
+  "X.-+.............",  // Tr1
+  "X.+-.............",  // Tb1
+  "X.-.+............",  // Tg1
+  "X.....-+.........",  // Tr2
+  "X.....+-.........",  // Tb2
+  "X.....-.+........",  // Tg2
+  "X+..--+..-+......",  // Ts1_23
+  "X.........-+.....",  // Tr3
+  "X.........+-.....",  // Tb3
+  "X.........-.+....",  // Tg3
+  "X....+..-+..--+..",  // Ts23_4
+  "X.............-+.",  // Tr4
+  "X.............+-.",  // Tb4
+  "X............+..-",  // Tout4
+  "X.............-.+"   // Tg4
+};
+
+const int EVENTS = 16;
+const int VARS = 16;
+
+using namespace MEDDLY;
+
+typedef satpregen_opname::pregen_relation pregen;
+
+const pregen::splittingOption splits[] = {
+  pregen::None, pregen::SplitOnly, pregen::SplitSubtract,
+  pregen::SplitSubtractAll, pregen::MonolithicSplit
+};
+const char* splitName[] = {
+  "None", "SplitOnly", "SplitSubtract", "SplitSubtractAll", "MonolithicSplit"
+};
+const int SPLITS = 5;
+
+void buildEvents(forest* mxd, dd_edge* events)
+{
+  for (int e=0; e<EVENTS; e++) {
+    events[e].setForest(mxd);
+    buildNextStateFunction(kanban+e, 1, mxd, events[e]);
+  }
+}
+
+/// Relation by levels; events added one at a time, or all at once.
+pregen* byLevels(forest* mdd, forest* mxd, const dd_edge* events,
+  bool atOnce, pregen::splittingOption split)
+{
+  pregen* rel = new pregen(mdd, mxd, mdd);
+  if (atOnce) {
+    rel->addToRelation(events, EVENTS);
+  } else {
+    for (int e=0; e<EVENTS; e++) rel->addToRelation(events[e]);
+  }
+  rel->finalize(split);
+  return rel;
+}
+
+void saturate(pregen* rel, const dd_edge &init, dd_edge &reachable)
+{
+  specialized_operation* sat = SATURATION_FORWARD->buildOperation(rel);
+  sat->compute(init, reachable);
+  destroyOperation(sat);
+}
+
+/// Compare the diagrams of a and b level by level; b may use another forest.
+bool sameLevels(const pregen* a, const pregen* b, forest* mxd)
+{
+  for (int k=1; k<=VARS; k++) {
+    dd_edge* ea = a->arrayForLevel(k);
+    dd_edge* eb = b->arrayForLevel(k);
+    dd_edge x(mxd);
+    if (eb) apply(COPY, eb[0], x);
+    if ((0==ea) != (0==eb)) return false;
+    if (ea && ea[0] != x) return false;
+  }
+  return true;
+}
+
+int main()
+{
+  MEDDLY::initialize();
+
+  const int N = 2;
+  int sizes[VARS];
+  for (int i=0; i<VARS; i++) sizes[i] = N+1;
+  domain* d = createDomainBottomUp(sizes, VARS);
+  forest* mdd = d->createForest(0, forest::BOOLEAN, forest::MULTI_TERMINAL);
+  forest* mxd = d->createForest(1, forest::BOOLEAN, forest::MULTI_TERMINAL);
+  forest::policies tp(true);
+  tp.split_threads = 4;
+  forest* tmxd = d->createForest(1, forest::BOOLEAN, forest::MULTI_TERMINAL, tp);
+
+  int* initial = new int[VARS+1];
+  for (int i=0; i<=VARS; i++) initial[i] = 0;
+  initial[1] = initial[5] = initial[9] = initial[13] = N;
+  dd_edge init(mdd);
+  mdd->createEdge(&initial, 1, init);
+  delete[] initial;
+
+  dd_edge* events = new dd_edge[EVENTS];
+  dd_edge* tevents = new dd_edge[EVENTS];
+  buildEvents(mxd, events);
+  buildEvents(tmxd, tevents);
+
+  pregen* ensf = new pregen(mdd, mxd, mdd, EVENTS);
+  for (int e=0; e<EVENTS; e++) ensf->addToRelation(events[e]);
+  ensf->finalize();
+  dd_edge expected(mdd);
+  saturate(ensf, init, expected);
+  long c;
+  apply(CARDINALITY, expected, c);
+  printf("Kanban, N=%d: %ld states by events\n", N, c);
+  if (c != 4600) {
+    printf("\tWrong number of states, expected 4600\n");
+    return 1;
+  }
+
+  for (int s=0; s<SPLITS; s++) {
+    pregen* seq = byLevels(mdd, mxd, events, false, splits[s]);
+    pregen* bal = byLevels(mdd, mxd, events, true, splits[s]);
+    pregen* thr = byLevels(mdd, tmxd, tevents, true, splits[s]);
+
+    printf("\t%-16s: ", splitName[s]);
+    bool ok = true;
+    if (!sameLevels(seq, bal, mxd)) {
+      printf("balanced levels differ; ");
+      ok = false;
+    }
+    if (!sameLevels(seq, thr, mxd)) {
+      printf("threaded levels differ; ");
+      ok = false;
+    }
+
+    pregen* rels[3] = { seq, bal, thr };
+    for (int r=0; r<3; r++) {
+      dd_edge reach(mdd);
+      saturate(rels[r], init, reach);
+      if (reach != expected) {
+        printf("reachable states differ (%d); ", r);
+        ok = false;
+      }
+    }
+    if (!ok) {
+      printf("\n");
+      return 1;
+    }
+    printf("ok\n");
+  }
+
+  delete[] tevents;
+  delete[] events;
+  destroyDomain(d);
+  MEDDLY::cleanup();
+  printf("Done\n");
+  return 0;
+}
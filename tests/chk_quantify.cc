@@ -0,0 +1,172 @@
+
+/*
+    Meddly: Multi-terminal and Edge-valued Decision Diagram LibrarY.
+    Copyright (C) 2009, Iowa State University Research Foundation, Inc.
+
+    This library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published 
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/*
+    Tests the quantification operations, on sets and relations,
+    against quantification done explicitly,
+    in the default variable order and in another one.
+*/
+
+#include <cstdlib>
+#include <cstdio>
+
+#include "../src/meddly.h"
+#include "../src/meddly_expert.h"
+#include "small_domain.h"
+
+using namespace MEDDLY;
+
+/// Do x and x2 agree on the variables that are not quantified?
+bool agree(int x, int x2, const bool* q)
+{
+  for (int k=1; k<=VARS; k++) {
+    if (!q[k] && digit(x, k) != digit(x2, k)) return false;
+  }
+  return true;
+}
+
+//
+// Explicit quantification, for the current predicates and masks
+//
+predicate q_f;
+predicate q_g;
+bool q_exists;
+const bool* q_u;
+const bool* q_p;
+
+/// Explicit quantification of q_f and q_g, at (x, y).
+bool quantified(int x, int y)
+{
+  for (int x2=0; x2<STATES; x2++) {
+    if (!agree(x, x2, q_u)) continue;
+    for (int y2=0; y2<STATES; y2++) {
+      if (!agree(y, y2, q_p)) continue;
+      bool v = q_f(x2, y2) && q_g(x2, y2);
+      if (q_exists == v) return v;
+    }
+  }
+  return !q_exists;
+}
+
+bool always(int x, int y) { return true; }
+
+void setMask(const char* vars, bool* q)
+{
+  for (int k=0; k<=VARS; k++) q[k] = false;
+  for (; *vars; vars++) q[*vars - '0'] = true;
+}
+
+/**
+    Quantify f (and g, for AND_EXISTS) and compare with the
+    explicit result.  uvars and pvars list the quantified
+    unprimed and primed variables.
+*/
+bool check(forest* F, const quantify_opname* op, predicate f, predicate g,
+  const char* uvars, const char* pvars)
+{
+  bool none[VARS+1], u[VARS+1], p[VARS+1];
+  setMask("", none);
+  setMask(uvars, u);
+  setMask(pvars, p);
+
+  q_f = f;
+  q_g = g;
+  q_exists = (op != FORALL);
+  q_u = u;
+  q_p = p;
+
+  dd_edge a(F), b(F), c(F), expected(F);
+  build(F, f, a);
+  build(F, g, b);
+  build(F, quantified, expected);
+
+  specialized_operation* sop = op->buildOperation(
+    new quantify_opname::quantify_args(F, u, F->isForRelations() ? p : 0)
+  );
+  if (op == AND_EXISTS) {
+    sop->compute(a, b, c);
+  } else {
+    sop->compute(a, c);
+  }
+  destroyOperation(sop);
+
+  double card;
+  apply(CARDINALITY, c, card);
+  printf("%s %s {%s} {%s}: %g\n", F->isForRelations() ? "relation" : "set",
+    op->getName(), uvars, pvars, card);
+  if (c != expected) {
+    printf("Mismatch with explicit quantification\n");
+    return false;
+  }
+  return true;
+}
+
+int main()
+{
+  MEDDLY::initialize();
+
+  int sizes[VARS];
+  for (int i=0; i<VARS; i++) sizes[i] = BASE;
+  domain* d = createDomainBottomUp(sizes, VARS);
+  forest* mdd = d->createForest(0, forest::BOOLEAN, forest::MULTI_TERMINAL);
+  forest* mxd = d->createForest(1, forest::BOOLEAN, forest::MULTI_TERMINAL);
+
+  bool ok =
+    check(mdd, EXISTS, evenSum, always, "2", "") &&
+    check(mdd, EXISTS, small, always, "13", "") &&
+    check(mdd, FORALL, evenSum, always, "1", "") &&
+    check(mdd, FORALL, small, always, "12", "") &&
+    check(mdd, AND_EXISTS, evenSum, small, "1", "") &&
+    check(mdd, AND_EXISTS, evenSum, small, "123", "") &&
+
+    check(mxd, EXISTS, increasing, always, "1", "") &&
+    check(mxd, EXISTS, increasing, always, "", "23") &&
+    check(mxd, EXISTS, multiple, always, "2", "2") &&
+    check(mxd, FORALL, increasing, always, "2", "2") &&
+    check(mxd, FORALL, increasing, always, "", "1") &&
+    check(mxd, AND_EXISTS, increasing, multiple, "12", "3") &&
+    check(mxd, AND_EXISTS, increasing, multiple, "123", "");
+
+  //
+  // Same again, with variables not in level order;
+  // the quantified variables are still given by index.
+  //
+  int level2var[VARS+1] = { 0, 3, 1, 2 };
+  static_cast<expert_forest*>(mdd)->reorderVariables(level2var);
+  static_cast<expert_forest*>(mxd)->reorderVariables(level2var);
+  printf("Reordered forests:\n");
+
+  ok = ok &&
+    check(mdd, EXISTS, small, always, "1", "") &&
+    check(mdd, EXISTS, small, always, "3", "") &&
+    check(mdd, FORALL, small, always, "12", "") &&
+    check(mdd, AND_EXISTS, evenSum, small, "2", "") &&
+
+    check(mxd, EXISTS, increasing, always, "1", "") &&
+    check(mxd, EXISTS, increasing, always, "", "3") &&
+    check(mxd, FORALL, increasing, always, "2", "2") &&
+    check(mxd, AND_EXISTS, increasing, multiple, "1", "3");
+
+  destroyDomain(d);
+  MEDDLY::cleanup();
+  if (!ok) return 1;
+  printf("Done\n");
+  return 0;
+}
@@ -0,0 +1,141 @@
+/*
+    Meddly: Multi-terminal and Edge-valued Decision Diagram LibrarY.
+    Copyright (C) 2009, Iowa State University Research Foundation, Inc.
+
+    This library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/*
+    Tests global_rebuilder on several roots at once.
+    Sets over boolean variables (the states with exactly k ones, and
+    the palindromes) are rebuilt into a forest with the reversed
+    variable order, one root at a time, and then all in one batch with
+    tables so small that entries are evicted all the time.  Each root
+    of the batch must give the same node as its own rebuild.
+*/
+
+#include <cstdlib>
+#include <cstdio>
+
+#include "../src/meddly.h"
+#include "../src/meddly_expert.h"
+
+const int VARS = 12;
+const int STATES = 1 << VARS;
+const int ROOTS = VARS+2;
+
+using namespace MEDDLY;
+
+inline int bit(int x, int k)
+{
+  return (x >> (k-1)) & 1;
+}
+
+int ones(int x)
+{
+  int c = 0;
+  for (int k=1; k<=VARS; k++) c += bit(x, k);
+  return c;
+}
+
+bool palindrome(int x)
+{
+  for (int k=1; k<=VARS; k++) {
+    if (bit(x, k) != bit(x, VARS+1-k)) return false;
+  }
+  return true;
+}
+
+/// Build root r: the states with r ones, or the palindromes.
+void buildRoot(forest* f, int r, dd_edge &e)
+{
+  int** mt = new int*[STATES];
+  int n = 0;
+  for (int x=0; x<STATES; x++) {
+    if (r <= VARS ? ones(x) != r : !palindrome(x)) continue;
+    mt[n] = new int[VARS+1];
+    mt[n][0] = 0;
+    for (int k=1; k<=VARS; k++) mt[n][k] = bit(x, k);
+    n++;
+  }
+  f->createEdge(mt, n, e);
+  for (int i=0; i<n; i++) delete[] mt[i];
+  delete[] mt;
+}
+
+/// Rebuild all roots in one batch, and compare with single rebuilds.
+bool checkBatch(expert_forest* src, expert_forest* tgt, const dd_edge* roots,
+  const dd_edge* single, unsigned cache_size)
+{
+  dd_edge batch[ROOTS];
+  for (int i=0; i<ROOTS; i++) batch[i].setForest(tgt);
+  global_rebuilder gr(src, tgt, cache_size);
+  gr.rebuild(roots, batch, ROOTS);
+
+  printf("\tcache size %5u: ", cache_size);
+  for (int i=0; i<ROOTS; i++) {
+    if (batch[i] != single[i]) {
+      printf("root %d differs from its single rebuild\n", i);
+      return false;
+    }
+  }
+  printf("ok\n");
+  return true;
+}
+
+int main()
+{
+  MEDDLY::initialize();
+
+  int sizes[VARS];
+  for (int i=0; i<VARS; i++) sizes[i] = 2;
+  domain* d = createDomainBottomUp(sizes, VARS);
+  forest* mdd = d->createForest(0, forest::BOOLEAN, forest::MULTI_TERMINAL);
+  forest* rev = d->createForest(0, forest::BOOLEAN, forest::MULTI_TERMINAL);
+
+  int level2var[VARS+1];
+  level2var[0] = 0;
+  for (int k=1; k<=VARS; k++) level2var[k] = VARS+1-k;
+  expert_forest* src = static_cast<expert_forest*>(mdd);
+  expert_forest* tgt = static_cast<expert_forest*>(rev);
+  tgt->reorderVariables(level2var);
+
+  dd_edge roots[ROOTS];
+  dd_edge single[ROOTS];
+  printf("Rebuilding %d roots over %d variables\n", ROOTS, VARS);
+  for (int i=0; i<ROOTS; i++) {
+    roots[i].setForest(mdd);
+    buildRoot(mdd, i, roots[i]);
+
+    global_rebuilder gr(src, tgt);
+    single[i] = gr.rebuild(roots[i]);
+    long rc, sc;
+    apply(CARDINALITY, roots[i], rc);
+    apply(CARDINALITY, single[i], sc);
+    if (rc != sc) {
+      printf("\troot %d: %ld states rebuilt as %ld\n", i, rc, sc);
+      return 1;
+    }
+  }
+
+  if (!checkBatch(src, tgt, roots, single, 4)) return 1;
+  if (!checkBatch(src, tgt, roots, single, 16)) return 1;
+  if (!checkBatch(src, tgt, roots, single, 65536)) return 1;
+
+  destroyDomain(d);
+  MEDDLY::cleanup();
+  printf("Done\n");
+  return 0;
+}
@@ -0,0 +1,181 @@
+
+/*
+    Meddly: Multi-terminal and Edge-valued Decision Diagram LibrarY.
+    Copyright (C) 2009, Iowa State University Research Foundation, Inc.
+
+    This library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published 
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/*
+    Tests the rename operation, on sets and relations,
+    against renaming done explicitly.
+    Covers the order preserving maps, permutations, partial maps, and
+    (for relations) transposition, with fully reduced and
+    identity reduced forests.
+*/
+
+#include <cstdlib>
+#include <cstdio>
+
+#include "../src/meddly.h"
+#include "../src/meddly_expert.h"
+#include "small_domain.h"
+
+using namespace MEDDLY;
+
+/// Variable 2 unchanged, so identity patterns survive.
+bool keep2(int x, int y)
+{
+  return digit(x,2) == digit(y,2) && digit(x,1) <= digit(y,3);
+}
+/// Independent of variable 3, so it can be left out of the map.
+bool low(int x, int y)
+{
+  return digit(x,1) <= digit(x,2) && digit(y,1) >= digit(y,2);
+}
+
+//
+// Explicit renaming, for the current predicate and map
+//
+predicate ren_f;
+int ren_map[VARS+1];
+bool ren_transpose;
+
+/// Digits of x moved back from level map[k] to level k (or 0, if none).
+int unmap(int x)
+{
+  int y = 0;
+  int place = 1;
+  for (int k=1; k<=VARS; k++) {
+    if (ren_map[k]) y += place * digit(x, ren_map[k]);
+    place *= BASE;
+  }
+  return y;
+}
+
+bool renamed(int x, int y)
+{
+  if (ren_transpose) return ren_f(unmap(y), unmap(x));
+  return ren_f(unmap(x), unmap(y));
+}
+
+/**
+    Rename f from forest inF into forest outF, and compare with
+    the explicit result.  map gives map[1], map[2], map[3];
+    0 leaves a level out.
+*/
+bool check(forest* inF, forest* outF, predicate f, const char* map,
+  bool transpose)
+{
+  ren_f = f;
+  ren_map[0] = 0;
+  for (int k=1; k<=VARS; k++) ren_map[k] = map[k-1] - '0';
+  ren_transpose = transpose;
+
+  dd_edge a(inF), c(outF), expected(outF);
+  build(inF, f, a);
+  build(outF, renamed, expected);
+
+  rename_opname::rename_args* args =
+    new rename_opname::rename_args(inF, outF, ren_map, transpose);
+  const bool inorder = args->preservesOrder();
+  specialized_operation* op = RENAME->buildOperation(args);
+  op->compute(a, c);
+  destroyOperation(op);
+
+  double card;
+  apply(CARDINALITY, c, card);
+  printf("%s rename [%s]%s%s: %g\n",
+    inF->isForRelations() ? "relation" : "set", map,
+    transpose ? " transposed" : "", inorder ? " (relabel)" : "", card);
+  if (c != expected) {
+    printf("Mismatch with explicit renaming\n");
+    return false;
+  }
+  return true;
+}
+
+int main()
+{
+  MEDDLY::initialize();
+
+  int sizes[VARS];
+  for (int i=0; i<VARS; i++) sizes[i] = BASE;
+  domain* d = createDomainBottomUp(sizes, VARS);
+  domain* d2 = createDomainBottomUp(sizes, VARS);
+  forest* mdd = d->createForest(0, forest::BOOLEAN, forest::MULTI_TERMINAL);
+  forest* mdd2 = d2->createForest(0, forest::BOOLEAN, forest::MULTI_TERMINAL);
+  forest* mxd = d->createForest(1, forest::BOOLEAN, forest::MULTI_TERMINAL);
+  forest* mxd2 = d2->createForest(1, forest::BOOLEAN, forest::MULTI_TERMINAL);
+  forest::policies p(true);
+  p.setFullyReduced();
+  forest* fmxd = d->createForest(1, forest::BOOLEAN,
+    forest::MULTI_TERMINAL, p);
+
+  bool ok =
+    check(mdd, mdd2, small, "123", false) &&
+    check(mdd, mdd, small, "213", false) &&
+    check(mdd, mdd2, middle, "312", false) &&
+    check(mdd, mdd, middle, "321", false) &&
+
+    check(mxd, mxd2, increasing, "123", false) &&
+    check(mxd, mxd, increasing, "231", false) &&
+    check(mxd, mxd, keep2, "132", false) &&
+    check(mxd, mxd2, keep2, "123", true) &&
+    check(mxd, mxd, increasing, "321", true) &&
+    check(mxd, mxd, keep2, "312", true) &&
+
+    check(fmxd, fmxd, nearby, "123", false) &&
+    check(fmxd, fmxd, keep2, "213", false) &&
+    check(fmxd, fmxd, increasing, "123", true) &&
+    check(fmxd, fmxd, keep2, "231", true) &&
+
+    check(mdd, mdd2, low, "230", false) &&
+    check(mdd, mdd, low, "310", false) &&
+    check(fmxd, fmxd, low, "130", false) &&
+    check(fmxd, fmxd, low, "210", false) &&
+    check(fmxd, fmxd, low, "320", true);
+
+  //
+  // A partial map must cover every level the argument depends on
+  //
+  if (ok) {
+    int part[VARS+1] = { 0, 2, 3, 0 };
+    dd_edge a(mdd), c(mdd);
+    build(mdd, small, a);
+    specialized_operation* op = RENAME->buildOperation(
+      new rename_opname::rename_args(mdd, mdd, part)
+    );
+    try {
+      op->compute(a, c);
+      printf("set rename [230] of a function of variable 3 should fail\n");
+      ok = false;
+    }
+    catch (error e) {
+      if (e.getCode() != error::INVALID_ASSIGNMENT) {
+        printf("unexpected error %s\n", e.getName());
+        ok = false;
+      }
+    }
+    destroyOperation(op);
+  }
+
+  destroyDomain(d);
+  destroyDomain(d2);
+  MEDDLY::cleanup();
+  if (!ok) return 1;
+  printf("Done\n");
+  return 0;
+}
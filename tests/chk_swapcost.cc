@@ -0,0 +1,129 @@
+
+/*
+    Meddly: Multi-terminal and Edge-valued Decision Diagram LibrarY.
+    Copyright (C) 2009, Iowa State University Research Foundation, Inc.
+
+    This library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/*
+    Tests estimate_swap_memory_cost() of the reordering strategies
+    against the change in the number of nodes when the swap is done,
+    on random sets in fully-reduced MDD forests (swapAdjacentVariables
+    does not handle quasi-reduced forests).
+    The forests are pessimistic, so unreachable nodes are deleted
+    as soon as the swap disconnects them.
+*/
+
+#include <cstdlib>
+#include <cstdio>
+
+#include "../src/meddly.h"
+#include "../src/meddly_expert.h"
+#include "../src/reordering/reordering_base.h"
+
+const int VARS = 6;
+const int BASE = 3;
+const int ROOTS = 4;
+const int MINTERMS = 40;
+const int ROUNDS = 50;
+
+using namespace MEDDLY;
+
+/// Exposes the estimate.
+class probe : public reordering_base {
+  public:
+    using reordering_base::estimate_swap_memory_cost;
+    virtual void reorderVariables(expert_forest*, const int*) { }
+};
+
+long seed;
+
+int pick(int n)
+{
+  seed = (seed * 1103515245 + 12345) & 0x7fffffff;
+  return int((seed >> 8) % n);
+}
+
+void randomSet(forest* f, dd_edge &e)
+{
+  int** m = new int*[MINTERMS];
+  for (int i=0; i<MINTERMS; i++) {
+    m[i] = new int[VARS+1];
+    m[i][0] = 0;
+    for (int k=1; k<=VARS; k++) {
+      // some don't cares, so there are redundant nodes to remove
+      m[i][k] = pick(4) ? pick(BASE) : DONT_CARE;
+    }
+  }
+  f->createEdge(m, MINTERMS, e);
+  for (int i=0; i<MINTERMS; i++) delete[] m[i];
+  delete[] m;
+}
+
+bool check(long s)
+{
+  printf("Seed %ld\n", s);
+  seed = s;
+
+  int sizes[VARS];
+  for (int i=0; i<VARS; i++) sizes[i] = BASE;
+  domain* d = createDomainBottomUp(sizes, VARS);
+  forest::policies p(false);
+  p.setPessimistic();
+  forest* f = d->createForest(false, forest::BOOLEAN, forest::MULTI_TERMINAL, p);
+  expert_forest* ef = static_cast<expert_forest*>(f);
+
+  dd_edge* sets[ROOTS];
+  for (int r=0; r<ROOTS; r++) {
+    sets[r] = new dd_edge(f);
+    randomSet(f, *sets[r]);
+  }
+
+  probe P;
+  long swaps = 0;
+  bool ok = true;
+  for (int round=0; round<ROUNDS; round++) {
+    const int level = 1 + pick(VARS-1);
+    const long estimate = P.estimate_swap_memory_cost(ef, level);
+    const long before = f->getCurrentNumNodes();
+    ef->swapAdjacentVariables(level);
+    const long actual = f->getCurrentNumNodes() - before;
+    swaps++;
+    if (estimate != actual) {
+      printf("\tswap at level %d: estimate %ld, actual %ld\n",
+        level, estimate, actual);
+      ok = false;
+    }
+  }
+  printf("\t%ld swaps, now %ld nodes\n", swaps, f->getCurrentNumNodes());
+
+  for (int r=0; r<ROOTS; r++) delete sets[r];
+  destroyDomain(d);
+  return ok;
+}
+
+int main()
+{
+  MEDDLY::initialize();
+
+  if (!check(12345)) return 1;
+  if (!check(2718)) return 1;
+  if (!check(31415)) return 1;
+
+  MEDDLY::cleanup();
+  printf("Done\n");
+  return 0;
+}
@@ -0,0 +1,170 @@
+/*
+    Meddly: Multi-terminal and Edge-valued Decision Diagram LibrarY.
+    Copyright (C) 2009, Iowa State University Research Foundation, Inc.
+
+    This library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/*
+    Tests reordering variables with the cofactors of each swap gathered
+    by several threads (when built with MEDDLY_THREADS).
+    The reachability set and the next-state function of the Kanban
+    model are built in forests with one and with four swap threads,
+    and both are taken through the same sequence of variable orders,
+    ending with the default one.  After every reorder the two must be
+    the same diagram, and at the end they must match the diagrams
+    built again from scratch.
+    Relations are checked for identity-reduced and fully-reduced forests.
+*/
+
+#include <cstdlib>
+#include <cstdio>
+
+#include "../src/meddly.h"
+#include "../src/meddly_expert.h"
+#include "simple_model.h"
+
+const char* kanban[] = {
+  "X-+..............",  // Tin1
+  "X.-+.............",  // Tr1
+  "X.+-.............",  // Tb1
+  "X.-.+............",  // Tg1
+  "X.....-+.........",  // Tr2
+  "X.....+-.........",  // Tb2
+  "X.....-.+........",  // Tg2
+  "X+..--+..-+......",  // Ts1_23
+  "X.........-+.....",  // Tr3
+  "X.........+-.....",  // Tb3
+  "X.........-.+....",  // Tg3
+  "X....+..-+..--+..",  // Ts23_4
+  "X.............-+.",  // Tr4
+  "X.............+-.",  // Tb4
+  "X............+..-",  // Tout4
+  "X.............-.+"   // Tg4
+};
+
+const int N = 2;
+const int VARS = 16;
+const int ORDERS = 6;
+const unsigned THREADS = 4;
+
+using namespace MEDDLY;
+
+long seed = 7;
+
+int pick(int n)
+{
+  seed = (seed * 1103515245 + 12345) & 0x7fffffff;
+  return int((seed >> 8) % n);
+}
+
+/// Reachability set, or next-state function, of Kanban in f,
+/// which must be in the default variable order.
+void build(forest* f, dd_edge &e)
+{
+  domain* d = f->useDomain();
+  forest* mxd = d->createForest(1, forest::BOOLEAN, forest::MULTI_TERMINAL);
+  {
+    dd_edge nsf(mxd);
+    buildNextStateFunction(kanban, 16, mxd, nsf);
+    if (f->isForRelations()) {
+      apply(COPY, nsf, e);
+    } else {
+      int* initial = new int[VARS+1];
+      for (int i=0; i<=VARS; i++) initial[i] = 0;
+      initial[1] = initial[5] = initial[9] = initial[13] = N;
+      dd_edge init(f);
+      f->createEdge(&initial, 1, init);
+      delete[] initial;
+      apply(REACHABLE_STATES_DFS, init, nsf, e);
+    }
+  }
+  destroyForest(mxd);
+}
+
+bool check(domain* d, bool rel, const char* what, forest::policies p)
+{
+  printf("\t%-25s: ", what);
+
+  p.setSwapThreads(1);
+  expert_forest* one = static_cast<expert_forest*>(
+    d->createForest(rel, forest::BOOLEAN, forest::MULTI_TERMINAL, p));
+  p.setSwapThreads(THREADS);
+  expert_forest* many = static_cast<expert_forest*>(
+    d->createForest(rel, forest::BOOLEAN, forest::MULTI_TERMINAL, p));
+
+  dd_edge e1(one), e4(many);
+  build(one, e1);
+  build(many, e4);
+
+  int level2var[VARS+1];
+  one->getVariableOrder(level2var);
+  for (int r=0; r<=ORDERS; r++) {
+    if (r < ORDERS) {
+      for (int k=VARS; k>1; k--) {
+        int j = 1 + pick(k);
+        int t = level2var[k];
+        level2var[k] = level2var[j];
+        level2var[j] = t;
+      }
+    } else {
+      for (int k=0; k<=VARS; k++) level2var[k] = k;
+    }
+    one->reorderVariables(level2var);
+    many->reorderVariables(level2var);
+
+    dd_edge copy(one);
+    apply(COPY, e4, copy);
+    if (copy != e1) {
+      printf("differ after reorder %d\n", r);
+      return false;
+    }
+  }
+
+  dd_edge fresh(one);
+  build(one, fresh);
+  if (fresh != e1) {
+    printf("differs from the diagram built in the last order\n");
+    return false;
+  }
+  printf("%ld nodes, ok\n", one->getCurrentNumNodes());
+  return true;
+}
+
+int main()
+{
+  MEDDLY::initialize();
+
+  int sizes[VARS];
+  for (int i=0; i<VARS; i++) sizes[i] = N+1;
+  domain* d = createDomainBottomUp(sizes, VARS);
+
+  printf("Kanban, N=%d, %u swap threads against one\n", N, THREADS);
+
+  forest::policies sp(false);
+  forest::policies ip(true);
+  ip.setIdentityReduced();
+  forest::policies fp(true);
+  fp.setFullyReduced();
+
+  if (!check(d, false, "reachable states", sp)) return 1;
+  if (!check(d, true, "identity-reduced relation", ip)) return 1;
+  if (!check(d, true, "fully-reduced relation", fp)) return 1;
+
+  destroyDomain(d);
+  MEDDLY::cleanup();
+  printf("Done\n");
+  return 0;
+}
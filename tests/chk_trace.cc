@@ -0,0 +1,237 @@
+
+/*
+    Meddly: Multi-terminal and Edge-valued Decision Diagram LibrarY.
+    Copyright (C) 2009, Iowa State University Research Foundation, Inc.
+
+    This library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/*
+    Tests SHORTEST_TRACE.
+    The model has one counter per variable, each incremented by its
+    own event, and an event that sets counter 1 from 0 straight to
+    its largest value.  So the distance of a state from all zeroes
+    is the sum of its counters, except that counter 1 at its largest
+    value counts as 1.
+    The distances from REACHABLE_STATES_DFS must be those; then,
+    for several targets, the trace must be a path of events from
+    all zeroes, as long as the smallest distance in the target,
+    with the distance of every state equal to its position.
+*/
+
+#include <cstdlib>
+#include <cstdio>
+
+#include "../src/meddly.h"
+#include "../src/meddly_expert.h"
+
+const int VARS = 4;
+const int MAX = 4;      // counters go from 0 to MAX
+const int EVENTS = VARS+1;
+
+using namespace MEDDLY;
+
+/// Distance of state s from all zeroes.
+long distance(const int* s)
+{
+  long d = (MAX==s[1]) ? 1 : s[1];
+  for (int k=2; k<=VARS; k++) d += s[k];
+  return d;
+}
+
+/// Build event e; the last one is the jump.
+void buildEvent(forest* mxd, int e, dd_edge &ev)
+{
+  int** from = new int*[MAX];
+  int** to = new int*[MAX];
+  for (int v=0; v<MAX; v++) {
+    from[v] = new int[VARS+1];
+    to[v] = new int[VARS+1];
+    for (int k=0; k<=VARS; k++) {
+      from[v][k] = DONT_CARE;
+      to[v][k] = DONT_CHANGE;
+    }
+  }
+  int n;
+  if (e < VARS) {
+    // counter e+1: v -> v+1
+    for (int v=0; v<MAX; v++) {
+      from[v][e+1] = v;
+      to[v][e+1] = v+1;
+    }
+    n = MAX;
+  } else {
+    from[0][1] = 0;
+    to[0][1] = MAX;
+    n = 1;
+  }
+  mxd->createEdge(from, to, n, ev);
+  for (int v=0; v<MAX; v++) {
+    delete[] from[v];
+    delete[] to[v];
+  }
+  delete[] from;
+  delete[] to;
+}
+
+/// Advance s to the next state, in lexicographic order; false at the end.
+bool next(int* s)
+{
+  for (int k=1; k<=VARS; k++) {
+    if (s[k] < MAX) {
+      s[k]++;
+      return true;
+    }
+    s[k] = 0;
+  }
+  return false;
+}
+
+bool checkTrace(specialized_operation* op, forest* mdd, forest* evmdd,
+  forest* mxd, const dd_edge &dist, const dd_edge* events,
+  int** targets, int n)
+{
+  dd_edge target(mdd);
+  mdd->createEdge(targets, n, target);
+
+  long best = -1;
+  for (int i=0; i<n; i++) {
+    const long d = distance(targets[i]);
+    if (best < 0 || d < best) best = d;
+  }
+
+  trace_opname::trace t;
+  op->compute(target, t);
+  printf("\t%d target state(s), nearest at %ld: %u states on the trace\n",
+    n, best, t.getNumStates());
+  if (long(t.getNumStates()) != best+1) {
+    printf("\tWrong length\n");
+    return false;
+  }
+
+  for (unsigned i=0; i<t.getNumStates(); i++) {
+    const int* s = t.getState(i);
+    long d;
+    evmdd->evaluate(dist, s, d);
+    if (d != long(i) || distance(s) != long(i)) {
+      printf("\tState %u has distance %ld, expected %u\n", i, d, i);
+      return false;
+    }
+    if (0==i) continue;
+    bool fires;
+    mxd->evaluate(events[t.getEvent(i)], t.getState(i-1), s, fires);
+    if (!fires) {
+      printf("\tEvent %u does not go from state %u to state %u\n",
+        t.getEvent(i), i-1, i);
+      return false;
+    }
+  }
+  bool in;
+  mdd->evaluate(target, t.getState(t.getNumStates()-1), in);
+  if (!in) {
+    printf("\tLast state is not a target\n");
+    return false;
+  }
+  return true;
+}
+
+int main()
+{
+  MEDDLY::initialize();
+
+  int sizes[VARS];
+  for (int i=0; i<VARS; i++) sizes[i] = MAX+1;
+  domain* d = createDomainBottomUp(sizes, VARS);
+  forest* mdd = d->createForest(false, forest::BOOLEAN, forest::MULTI_TERMINAL);
+  forest* evmdd = d->createForest(false, forest::INTEGER, forest::EVPLUS);
+  forest* mxd = d->createForest(true, forest::BOOLEAN, forest::MULTI_TERMINAL);
+
+  dd_edge events[EVENTS] = {
+    dd_edge(mxd), dd_edge(mxd), dd_edge(mxd), dd_edge(mxd), dd_edge(mxd)
+  };
+  dd_edge nsf(mxd);
+  for (int e=0; e<EVENTS; e++) {
+    buildEvent(mxd, e, events[e]);
+    apply(UNION, nsf, events[e], nsf);
+  }
+
+  int* s = new int[VARS+1];
+  for (int k=0; k<=VARS; k++) s[k] = 0;
+  const long zero = 0;
+  dd_edge init(evmdd), dist(evmdd);
+  evmdd->createEdge(&s, &zero, 1, init);
+  apply(REACHABLE_STATES_DFS, init, nsf, dist);
+
+  //
+  // Distances
+  //
+  printf("Distances from REACHABLE_STATES_DFS\n");
+  long states = 0;
+  do {
+    long ds;
+    evmdd->evaluate(dist, s, ds);
+    if (ds != distance(s)) {
+      printf("\tState");
+      for (int k=1; k<=VARS; k++) printf(" %d", s[k]);
+      printf(" has distance %ld, expected %ld\n", ds, distance(s));
+      return 1;
+    }
+    states++;
+  } while (next(s));
+  printf("\t%ld states, as expected\n", states);
+
+  //
+  // Traces
+  //
+  printf("Shortest traces\n");
+  specialized_operation* op = SHORTEST_TRACE->buildOperation(
+    new trace_opname::trace_args(dist, events, EVENTS)
+  );
+
+  int t1[] = { 0, MAX, MAX, MAX, MAX };   // the farthest state, at 1+3*MAX
+  int t2[] = { 0, MAX, 0, 0, 0 };         // through the jump, at 1
+  int t3[] = { 0, MAX-1, 2, 0, 1 };       // without the jump, at MAX+2
+  int t4[] = { 0, 0, 0, 0, 0 };           // initial, at 0
+  int* one[] = { t1 };
+  int* jump[] = { t2 };
+  int* nojump[] = { t3 };
+  int* set[] = { t1, t3, t2 };
+  int* initial[] = { t4, t1 };
+  bool ok =
+    checkTrace(op, mdd, evmdd, mxd, dist, events, one, 1) &&
+    checkTrace(op, mdd, evmdd, mxd, dist, events, jump, 1) &&
+    checkTrace(op, mdd, evmdd, mxd, dist, events, nojump, 1) &&
+    checkTrace(op, mdd, evmdd, mxd, dist, events, set, 3) &&
+    checkTrace(op, mdd, evmdd, mxd, dist, events, initial, 2) &&
+    // again, after the memo of earlier traces was cleared
+    checkTrace(op, mdd, evmdd, mxd, dist, events, one, 1);
+  if (!ok) return 1;
+
+  // no target states: no trace
+  dd_edge empty(mdd);
+  trace_opname::trace t;
+  op->compute(empty, t);
+  if (t.getNumStates()) {
+    printf("\tTrace to an empty set\n");
+    return 1;
+  }
+  destroyOperation(op);
+
+  delete[] s;
+  destroyDomain(d);
+  MEDDLY::cleanup();
+  printf("Done\n");
+  return 0;
+}
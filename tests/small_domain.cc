@@ -0,0 +1,64 @@
+
+/*
+    Meddly: Multi-terminal and Edge-valued Decision Diagram LibrarY.
+    Copyright (C) 2009, Iowa State University Research Foundation, Inc.
+
+    This library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published 
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "small_domain.h"
+
+void setDigits(int x, int* m)
+{
+  for (int k=1; k<=VARS; k++) {
+    m[k] = x % BASE;
+    x /= BASE;
+  }
+}
+
+void build(MEDDLY::forest* F, predicate f, MEDDLY::dd_edge &e)
+{
+  int** from = new int*[STATES*STATES];
+  int** to = new int*[STATES*STATES];
+  int N = 0;
+  const int ys = F->isForRelations() ? STATES : 1;
+  for (int x=0; x<STATES; x++) {
+    for (int y=0; y<ys; y++) {
+      if (!f(x, y)) continue;
+      from[N] = new int[VARS+1];
+      to[N] = new int[VARS+1];
+      setDigits(x, from[N]);
+      setDigits(y, to[N]);
+      N++;
+    }
+  }
+  e.set(0);
+  if (N) {
+    if (F->isForRelations()) F->createEdge(from, to, N, e);
+    else                     F->createEdge(from, N, e);
+  }
+  for (int i=0; i<N; i++) {
+    delete[] from[i];
+    delete[] to[i];
+  }
+  delete[] from;
+  delete[] to;
+}
+
+bool evenSum(int x, int y)    { return (digit(x,1)+digit(x,2)+digit(x,3)) % 2 == 0; }
+bool small(int x, int y)      { return x < 15; }
+bool middle(int x, int y)     { return digit(x,2) == 1 || digit(x,3) == 0; }
+bool increasing(int x, int y) { return y >= x; }
+bool multiple(int x, int y)   { return (x+y) % 3 == 0; }
+bool nearby(int x, int y)     { return y-x < 3 && x-y < 3; }
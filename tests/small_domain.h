@@ -0,0 +1,64 @@
+
+/*
+    Meddly: Multi-terminal and Edge-valued Decision Diagram LibrarY.
+    Copyright (C) 2009, Iowa State University Research Foundation, Inc.
+
+    This library is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published 
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+    Explicit sets and relations over a small domain, for tests that
+    check an operation against the same operation done by enumeration.
+    A state is a number in [0, STATES), whose base-BASE digits are the
+    values of variables 1..VARS; relations are predicates on pairs.
+*/
+
+#ifndef SMALL_DOMAIN
+#define SMALL_DOMAIN
+
+#include "../src/meddly.h"
+
+const int VARS = 3;
+const int BASE = 3;
+const int STATES = 27;   // BASE^VARS
+
+typedef bool (*predicate)(int x, int y);
+
+/// Value of variable k in state x.
+inline int digit(int x, int k)
+{
+  for (k--; k; k--) x /= BASE;
+  return x % BASE;
+}
+
+/// Write the values of the variables of state x into m[1..VARS].
+void setDigits(int x, int* m);
+
+/** Build the set { x : f(x,0) }, or the relation { (x,y) : f(x,y) }
+    if F is a forest for relations.
+*/
+void build(MEDDLY::forest* F, predicate f, MEDDLY::dd_edge &e);
+
+//
+// Predicates shared by the tests
+//
+
+bool evenSum(int x, int y);
+bool small(int x, int y);
+bool middle(int x, int y);
+bool increasing(int x, int y);
+bool multiple(int x, int y);
+bool nearby(int x, int y);
+
+#endif